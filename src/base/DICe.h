@@ -100,6 +100,15 @@ namespace DICe{
   typedef float scalar_t;
 #endif
 
+#if DICE_FLOAT_GRADIENTS && !DICE_KOKKOS
+  /// image gradient storage type (the values are widened to scalar_t when they are used,
+  /// only differs from scalar_t for DICE_USE_DOUBLE builds)
+  typedef float gradient_t;
+#else
+  /// image gradient storage type
+  typedef scalar_t gradient_t;
+#endif
+
 /// integer type
 typedef int int_t;
 
@@ -144,6 +153,8 @@ const char* const gauss_filter_team_size = "gauss_filter_team_size";
 /// String parameter name
 const char* const gauss_filter_mask_size = "gauss_filter_mask_size";
 /// String parameter name
+const char* const num_image_pyramid_levels = "num_image_pyramid_levels";
+/// String parameter name
 const char* const correlation_routine = "correlation_routine";
 /// String parameter name
 const char* const use_global_dic = "use_global_dic";
@@ -329,6 +340,12 @@ const char* const num_image_integration_points = "num_image_integration_points";
 const char* const global_element_type = "global_element_type";
 /// String parameter name, only for global DIC
 const char* const use_fixed_point_iterations = "use_fixed_point_iterations";
+/// String parameter name, only for global DIC
+const char* const global_use_matrix_free = "global_use_matrix_free";
+/// String parameter name, only for global DIC
+const char* const global_preconditioner = "global_preconditioner";
+/// String parameter name, only for global DIC
+const char* const global_num_mesh_levels = "global_num_mesh_levels";
 /// String parameter name
 const char* const system_type_3D = "system_type_3D";
 /// String parameter name
@@ -358,6 +375,14 @@ const char* const write_exodus_output = "write_exodus_output";
 /// String parameter name
 const char* const threshold_block_size = "threshold_block_size";
 /// String parameter name
+const char* const phase_correlation_window_size = "phase_correlation_window_size";
+/// String parameter name
+const char* const use_reliability_guided_ordering = "use_reliability_guided_ordering";
+/// String parameter name
+const char* const feature_matching_roi_margin = "feature_matching_roi_margin";
+/// String parameter name
+const char* const motion_detection_block_size = "motion_detection_block_size";
+/// String parameter name
 const char* const subimage_width = "subimage_width";
 /// String parameter name
 const char* const subimage_height = "subimage_height";
@@ -457,6 +482,9 @@ enum Initialization_Method {
   USE_ZEROS,
   USE_FEATURE_MATCHING,
   USE_IMAGE_REGISTRATION,
+  USE_LOCAL_PHASE_CORRELATION,
+  USE_PREDICTOR,
+  USE_MOTION_MODEL,
   INITIALIZATION_METHOD_NOT_APPLICABLE,
   // DON'T ADD ANY BELOW MAX
   MAX_INITIALIZATION_METHOD,
@@ -472,6 +500,9 @@ const static char * initializationMethodStrings[] = {
   "USE_ZEROS",
   "USE_FEATURE_MATCHING",
   "USE_IMAGE_REGISTRATION",
+  "USE_LOCAL_PHASE_CORRELATION",
+  "USE_PREDICTOR",
+  "USE_MOTION_MODEL",
   "INITIALIZATION_METHOD_NOT_APPLICABLE"
 };
 
@@ -842,6 +873,13 @@ const Correlation_Parameter gauss_filter_mask_size_param(gauss_filter_mask_size,
   true,
   "The size in pixels of the Gaussian filter (3, 5, 7, 9, 11, or 13).");
 /// Correlation parameter and properties
+const Correlation_Parameter num_image_pyramid_levels_param(num_image_pyramid_levels,
+  SIZE_PARAM,
+  true,
+  "The number of Gaussian pyramid levels to build for each image (1 uses only the full resolution image). "
+  "If greater than 1, each subset is first solved on the coarsest level and the result is refined level by level to the full resolution, "
+  "which extends the displacement that can be captured from the initial guess.");
+/// Correlation parameter and properties
 const Correlation_Parameter pixel_integration_order_param(pixel_integration_order,
   SIZE_PARAM,
   true,
@@ -851,6 +889,31 @@ const Correlation_Parameter threshold_block_size_param(threshold_block_size,
   SIZE_PARAM,
   true,
   "The block size to use for the feature matching initializer when thresholding is enabled.");
+/// Correlation parameter and properties
+const Correlation_Parameter phase_correlation_window_size_param(phase_correlation_window_size,
+  SIZE_PARAM,
+  true,
+  "The width in pixels of the square window around each subset used by the USE_LOCAL_PHASE_CORRELATION initializer. "
+  "Motions up to half the window size can be captured. If not set, twice the subset size is used.");
+/// Correlation parameter and properties
+const Correlation_Parameter use_reliability_guided_ordering_param(use_reliability_guided_ordering,
+  BOOL_PARAM,
+  true,
+  "Correlate the subsets of the GENERIC_ROUTINE in order of reliability rather than in the fixed seed order. "
+  "Starting from the seeds, the neighbors of the subset with the best converged gamma are correlated next, "
+  "each initialized from that neighbor. Subsets on the frontier are correlated in parallel if threads are available.");
+/// Correlation parameter and properties
+const Correlation_Parameter feature_matching_roi_margin_param(feature_matching_roi_margin,
+  SIZE_PARAM,
+  true,
+  "If set, the feature matching initializer only detects features within this many pixels of the subsets rather than in the whole image.");
+/// Correlation parameter and properties
+const Correlation_Parameter motion_detection_block_size_param(motion_detection_block_size,
+  SIZE_PARAM,
+  true,
+  "The width in pixels of the blocks used to compare the motion windows with the previous frame (TEST_FOR_MOTION). "
+  "The intensities are summed over each block before differencing, which is cheaper and less sensitive to noise. "
+  "The default of 1 compares every pixel.");
 
 /// Correlation parameter and properties
 const Correlation_Parameter obstruction_skin_factor_param(obstruction_skin_factor,
@@ -1164,6 +1227,25 @@ const Correlation_Parameter global_element_type_param(global_element_type,
   "Used only for global, this is the element type to use for the global method."
 );
 /// Correlation parameter and properties
+const Correlation_Parameter global_use_matrix_free_param(global_use_matrix_free,
+  BOOL_PARAM,
+  true,
+  "Used only for global, apply the tangent element by element rather than assembling a sparse matrix (not available for mixed formulations)."
+);
+/// Correlation parameter and properties
+const Correlation_Parameter global_preconditioner_param(global_preconditioner,
+  STRING_PARAM,
+  true,
+  "Used only for global, the preconditioner to use for the linear solve (ILU, JACOBI, or CHEBYSHEV). ILU requires an assembled tangent, JACOBI and CHEBYSHEV require global_use_matrix_free."
+);
+/// Correlation parameter and properties
+const Correlation_Parameter global_num_mesh_levels_param(global_num_mesh_levels,
+  SIZE_PARAM,
+  true,
+  "Used only for global, the number of mesh levels to use for coarse-to-fine continuation (1 solves only on the target mesh). "
+  "Each coarser level uses four times the mesh_size of the level above it and its solution is used as the initial guess for the next finer level."
+);
+/// Correlation parameter and properties
 const Correlation_Parameter num_image_integration_points_param(num_image_integration_points,
   SIZE_PARAM,
   true,
@@ -1252,7 +1334,7 @@ const Correlation_Parameter remove_outlier_pixels_param(remove_outlier_pixels,
 // TODO don't forget to update this when adding a new one
 /// The total number of valid correlation parameters
 /// Vector of valid parameter names
-const int_t num_valid_correlation_params = 89;
+const int_t num_valid_correlation_params = 97;
 /// Vector oIf valid parameter names
 const Correlation_Parameter valid_correlation_params[num_valid_correlation_params] = {
   correlation_routine_param,
@@ -1323,6 +1405,7 @@ const Correlation_Parameter valid_correlation_params[num_valid_correlation_param
   gauss_filter_use_hierarchical_parallelism_param,
   gauss_filter_team_size_param,
   gauss_filter_mask_size_param,
+  num_image_pyramid_levels_param,
   rotate_ref_image_90_param,
   rotate_def_image_90_param,
   rotate_ref_image_180_param,
@@ -1338,17 +1421,24 @@ const Correlation_Parameter valid_correlation_params[num_valid_correlation_param
   global_formulation_param,
   global_solver_param,
   global_element_type_param,
+  global_use_matrix_free_param,
+  global_preconditioner_param,
+  global_num_mesh_levels_param,
   num_image_integration_points_param,
   use_fixed_point_iterations_param,
   compute_laplacian_image_param,
   enable_projection_shape_function_param,
   write_exodus_output_param,
-  threshold_block_size_param
+  threshold_block_size_param,
+  phase_correlation_window_size_param,
+  use_reliability_guided_ordering_param,
+  feature_matching_roi_margin_param,
+  motion_detection_block_size_param
 };
 
 // TODO don't forget to update this when adding a new one
 /// The total number of valid correlation parameters
-const int_t num_valid_global_correlation_params = 31;
+const int_t num_valid_global_correlation_params = 34;
 /// Vector of valid parameter names
 const Correlation_Parameter valid_global_correlation_params[num_valid_global_correlation_params] = {
   use_global_dic_param,
@@ -1380,6 +1470,9 @@ const Correlation_Parameter valid_global_correlation_params[num_valid_global_cor
   mms_spec_param,
   num_image_integration_points_param,
   global_element_type_param,
+  global_use_matrix_free_param,
+  global_preconditioner_param,
+  global_num_mesh_levels_param,
   use_fixed_point_iterations_param,
   initial_condition_file_param
 };
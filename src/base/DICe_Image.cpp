@@ -49,9 +49,44 @@
 #include <Teuchos_ParameterList.hpp>
 
 #include <cassert>
+#include <algorithm>
+#include <vector>
 
 namespace DICe {
 
+namespace {
+
+/// strides along x and y of an intensity array of the given dimensions
+/// (the array may be stored column major for some Kokkos builds)
+inline void
+layout_strides(const int_t width,
+  const int_t height,
+  int_t & stride_x,
+  int_t & stride_y){
+  stride_x = default_is_layout_right() ? 1 : height;
+  stride_y = default_is_layout_right() ? width : 1;
+}
+
+/// returns the sum of row_sum(y) for y from y_begin to y_end-1, the rows are spread over the threads
+/// and their sums are added up in order so the result doesn't depend on the number of threads
+template<typename Row_Sum>
+scalar_t
+ordered_row_sum(const int_t y_begin,
+  const int_t y_end,
+  const Row_Sum & row_sum){
+  if(y_end<=y_begin) return 0.0;
+  std::vector<scalar_t> row_sums(y_end-y_begin,0.0);
+#pragma omp parallel for schedule(static)
+  for(int_t y=y_begin;y<y_end;++y)
+    row_sums[y-y_begin] = row_sum(y);
+  scalar_t sum = 0.0;
+  for(size_t i=0;i<row_sums.size();++i)
+    sum += row_sums[i];
+  return sum;
+}
+
+}
+
 Image::Image(intensity_t * intensities,
   const int_t width,
   const int_t height,
@@ -95,6 +130,8 @@ Image::Image(const int_t width,
 /// post allocation tasks
 void
 Image::post_allocation_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params){
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
   gauss_filter_mask_size_ = 7; // default sizes
   gauss_filter_half_mask_ = 4;
   if(params==Teuchos::null) return;
@@ -104,23 +141,37 @@ Image::post_allocation_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params
   const int gauss_filter_team_size = params->get<int>(DICe::gauss_filter_team_size,256);
   gauss_filter_mask_size_ = params->get<int>(DICe::gauss_filter_mask_size,7);
   gauss_filter_half_mask_ = gauss_filter_mask_size_/2+1;
-  if(gauss_filter_image){
-    gauss_filter(-1,gauss_filter_use_hierarchical_parallelism,gauss_filter_team_size);
-  }
   const bool compute_image_gradients = params->get<bool>(DICe::compute_image_gradients,false);
   DEBUG_MSG("Image::post_allocation_tasks(): compute_image_gradients is " << compute_image_gradients);
   const bool image_grad_use_hierarchical_parallelism = params->get<bool>(DICe::image_grad_use_hierarchical_parallelism,false);
   const int image_grad_team_size = params->get<int>(DICe::image_grad_team_size,256);
-  if(compute_image_gradients)
+  if(gauss_filter_image&&compute_image_gradients){
+    gauss_filter_and_compute_gradients(-1,gauss_filter_use_hierarchical_parallelism,gauss_filter_team_size,
+      image_grad_use_hierarchical_parallelism,image_grad_team_size);
+  }
+  else if(gauss_filter_image){
+    gauss_filter(-1,gauss_filter_use_hierarchical_parallelism,gauss_filter_team_size);
+  }
+  else if(compute_image_gradients){
     compute_gradients(image_grad_use_hierarchical_parallelism,image_grad_team_size);
+  }
   if(params->isParameter(DICe::compute_laplacian_image)){
     if(params->get<bool>(DICe::compute_laplacian_image)==true){
       TEUCHOS_TEST_FOR_EXCEPTION(laplacian_==Teuchos::null,std::runtime_error,"");
       TEUCHOS_TEST_FOR_EXCEPTION(laplacian_.size()!=width_*height_,std::runtime_error,"");
       Teuchos::RCP<Teuchos::ParameterList> imgParams = Teuchos::rcp(new Teuchos::ParameterList());
       imgParams->set(DICe::compute_image_gradients,true); // automatically compute the gradients if the ref image is changed
-      Teuchos::RCP<Image> grad_x_img = Teuchos::rcp(new Image(width_,height_,grad_x_,imgParams));
-      Teuchos::RCP<Image> grad_y_img = Teuchos::rcp(new Image(width_,height_,grad_y_,imgParams));
+      // the gradients may be stored with a different type than the intensities
+      Teuchos::ArrayRCP<intensity_t> grad_x_values(width_*height_,0.0);
+      Teuchos::ArrayRCP<intensity_t> grad_y_values(width_*height_,0.0);
+      for(int_t y=0;y<height_;++y){
+        for(int_t x=0;x<width_;++x){
+          grad_x_values[y*width_+x] = grad_x(x,y);
+          grad_y_values[y*width_+x] = grad_y(x,y);
+        }
+      }
+      Teuchos::RCP<Image> grad_x_img = Teuchos::rcp(new Image(width_,height_,grad_x_values,imgParams));
+      Teuchos::RCP<Image> grad_y_img = Teuchos::rcp(new Image(width_,height_,grad_y_values,imgParams));
       for(int_t y=0;y<height_;++y){
         for(int_t x=0;x<width_;++x){
           laplacian_[y*width_ + x] = grad_x_img->grad_x(x,y) + grad_y_img->grad_y(x,y);
@@ -128,6 +179,10 @@ Image::post_allocation_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params
       }
     }
   }
+  // the pyramid is built last so that the coarse levels are created from the filtered intensities
+  const int_t num_pyramid_levels = params->get<int_t>(DICe::num_image_pyramid_levels,1);
+  if(num_pyramid_levels>1)
+    create_pyramid(num_pyramid_levels);
 }
 
 /// returns true if the image is a frame from a video sequence cine or netcdf file
@@ -145,47 +200,117 @@ scalar_t
 Image::diff(Teuchos::RCP<Image> rhs) const{
   if(rhs->width()!=width_||rhs->height()!=height_)
     return -1.0;
-  scalar_t diff = 0.0;
-  scalar_t diff_ = 0.0;
-  for(int_t i=0;i<width_*height_;++i){
-    diff_ = (*this)(i) - (*rhs)(i);
-    diff += diff_*diff_;
-  }
+  // both images have the same memory layout so the order of the pixels doesn't matter here
+  const intensity_t * lhs_intens = intensities().getRawPtr();
+  const intensity_t * rhs_intens = rhs->intensities().getRawPtr();
+  const int_t width = width_;
+  const scalar_t diff = ordered_row_sum(0,height_,[&](const int_t y){
+    const intensity_t * lhs_row = lhs_intens + y*width;
+    const intensity_t * rhs_row = rhs_intens + y*width;
+    scalar_t row_sum = 0.0;
+#pragma omp simd reduction(+:row_sum)
+    for(int_t x=0;x<width;++x){
+      const scalar_t diff_ = lhs_row[x] - rhs_row[x];
+      row_sum += diff_*diff_;
+    }
+    return row_sum;
+  });
   return std::sqrt(diff);
 }
 
+scalar_t
+Image::block_diff(Teuchos::RCP<Image> rhs,
+  const int_t border,
+  const int_t block_size) const{
+  TEUCHOS_TEST_FOR_EXCEPTION(block_size<1,std::invalid_argument,"Error, invalid block size " << block_size);
+  if(rhs->width()!=width_||rhs->height()!=height_)
+    return -1.0;
+  const int_t x_begin = border;
+  const int_t x_end = width_ - border;
+  const int_t y_begin = border;
+  const int_t y_end = height_ - border;
+  if(x_end<=x_begin||y_end<=y_begin) return 0.0;
+  const intensity_t * lhs_intens = intensities().getRawPtr();
+  const intensity_t * rhs_intens = rhs->intensities().getRawPtr();
+  int_t stride_x = 0, stride_y = 0;
+  layout_strides(width_,height_,stride_x,stride_y);
+  const int_t num_block_rows = (y_end - y_begin + block_size - 1)/block_size;
+  const int_t num_block_cols = (x_end - x_begin + block_size - 1)/block_size;
+  // each row of blocks is one row of the ordered sum
+  const scalar_t diff = ordered_row_sum(0,num_block_rows,[&](const int_t by){
+    std::vector<scalar_t> block_sums(block_size>1 ? num_block_cols : 0,0.0);
+    const int_t y_last = std::min(y_begin + (by+1)*block_size,y_end);
+    scalar_t row_sum = 0.0;
+    for(int_t y=y_begin+by*block_size;y<y_last;++y){
+      const intensity_t * lhs_row = lhs_intens + y*stride_y;
+      const intensity_t * rhs_row = rhs_intens + y*stride_y;
+      if(block_size==1){
+#pragma omp simd reduction(+:row_sum)
+        for(int_t x=x_begin;x<x_end;++x){
+          const scalar_t diff_ = lhs_row[x*stride_x] - rhs_row[x*stride_x];
+          row_sum += diff_*diff_;
+        }
+      }
+      else{
+        for(int_t bx=0;bx<num_block_cols;++bx){
+          const int_t x_last = std::min(x_begin + (bx+1)*block_size,x_end);
+          scalar_t block_sum = 0.0;
+#pragma omp simd reduction(+:block_sum)
+          for(int_t x=x_begin+bx*block_size;x<x_last;++x)
+            block_sum += lhs_row[x*stride_x] - rhs_row[x*stride_x];
+          block_sums[bx] += block_sum;
+        }
+      }
+    }
+    for(size_t bx=0;bx<block_sums.size();++bx)
+      row_sum += block_sums[bx]*block_sums[bx];
+    return row_sum;
+  });
+  return std::sqrt(diff)/block_size;
+}
+
 /// normalize the image intensity values
 Teuchos::RCP<Image>
 Image::normalize(const Teuchos::RCP<Teuchos::ParameterList> & params){
   Teuchos::ArrayRCP<intensity_t> normalized_intens(width_*height_,0.0);
   // TODO make the normalization more selective (only include the ROI)
-  intensity_t mean = 0.0;
-  int_t num_pixels = 0;
   const int_t buffer = 10;
-  for(int_t y=buffer;y<height_-buffer;++y){
-    for(int_t x=buffer;x<width_-buffer;++x){
-      mean += (*this)(x,y);
-      //if(num_pixels<10)
-      //std::cout << " x " << x << " y " << y << " " << (*this)(x,y) << " p1 " << (*this)(x-1,y-1) << std::endl;
-      num_pixels++;
-    }
-  }
+  const int_t num_pixels = std::max(0,width_-2*buffer)*std::max(0,height_-2*buffer);
   TEUCHOS_TEST_FOR_EXCEPTION(num_pixels<=0,std::runtime_error,"");
-  mean/=num_pixels;
+  const intensity_t * intens = intensities().getRawPtr();
+  int_t stride_x = 0, stride_y = 0;
+  layout_strides(width_,height_,stride_x,stride_y);
+  const int_t x_end = width_ - buffer;
+  const scalar_t sum = ordered_row_sum(buffer,height_-buffer,[&](const int_t y){
+    scalar_t row_sum = 0.0;
+#pragma omp simd reduction(+:row_sum)
+    for(int_t x=buffer;x<x_end;++x)
+      row_sum += intens[y*stride_y+x*stride_x];
+    return row_sum;
+  });
+  const intensity_t mean = sum/num_pixels;
   DEBUG_MSG("Image::normalize() mean " << mean << " num pixels in mean " << num_pixels);
 
-  intensity_t mean_sum = 0.0;
-  for(int_t y=buffer;y<height_-buffer;++y){
-    for(int_t x=buffer;x<width_-buffer;++x){
-      mean_sum += ((*this)(x,y) - mean)*((*this)(x,y) - mean);
+  scalar_t mean_sum = ordered_row_sum(buffer,height_-buffer,[&](const int_t y){
+    scalar_t row_sum = 0.0;
+#pragma omp simd reduction(+:row_sum)
+    for(int_t x=buffer;x<x_end;++x){
+      const scalar_t value = intens[y*stride_y+x*stride_x] - mean;
+      row_sum += value*value;
     }
-  }
+    return row_sum;
+  });
   mean_sum = std::sqrt(mean_sum);
   DEBUG_MSG("Image::normalize() mean sum " << mean_sum);
   TEUCHOS_TEST_FOR_EXCEPTION(mean_sum==0.0,std::runtime_error,
     "Error, mean sum should not be zero");
-  for(int_t i=0;i<width_*height_;++i)
-    normalized_intens[i] = ((*this)(i) - mean) / mean_sum;
+#pragma omp parallel for schedule(static)
+  for(int_t y=0;y<height_;++y){
+    intensity_t * out = normalized_intens.getRawPtr() + y*width_;
+#pragma omp simd
+    for(int_t x=0;x<width_;++x)
+      out[x] = (intens[y*stride_y+x*stride_x] - mean) / mean_sum;
+  }
    Teuchos::RCP<Image> result = Teuchos::rcp(new Image(width_,height_,normalized_intens,params));
    return result;
 }
@@ -205,11 +330,130 @@ Image::replace_intensities(Teuchos::ArrayRCP<intensity_t> intensities){
   default_constructor_tasks(params);
 }
 
+void
+Image::create_interleaved_channels(){
+  TEUCHOS_TEST_FOR_EXCEPTION(!has_gradients_,std::runtime_error,
+    "Error, the image gradients must be computed before creating the interleaved channels");
+  interleaved_channels_ = Teuchos::ArrayRCP<intensity_t>(3*width_*height_,0.0);
+  for(int_t y=0;y<height_;++y){
+    for(int_t x=0;x<width_;++x){
+      const int_t index = 3*(y*width_+x);
+      interleaved_channels_[index+0] = (*this)(x,y);
+      interleaved_channels_[index+1] = grad_x(x,y);
+      interleaved_channels_[index+2] = grad_y(x,y);
+    }
+  }
+}
+
+void
+Image::create_pyramid(const int_t num_levels){
+  TEUCHOS_TEST_FOR_EXCEPTION(num_levels<1,std::invalid_argument,"Error, invalid number of pyramid levels " << num_levels);
+  pyramid_.clear();
+  // mask size used to low pass filter each level before decimation
+  const int_t pyramid_mask_size = 7;
+  // no level is allowed to be smaller than this in either dimension
+  const int_t min_level_dim = 4*pyramid_mask_size;
+  int_t fine_width = width_;
+  int_t fine_height = height_;
+  Teuchos::ArrayRCP<intensity_t> fine_intensities(width_*height_,0.0);
+  for(int_t i=0;i<width_*height_;++i)
+    fine_intensities[i] = (*this)(i);
+  for(int_t level=1;level<num_levels;++level){
+    const int_t coarse_width = fine_width/2;
+    const int_t coarse_height = fine_height/2;
+    if(coarse_width<min_level_dim||coarse_height<min_level_dim){
+      DEBUG_MSG("Image::create_pyramid(): stopping at " << level << " levels, the image is too small to coarsen further");
+      break;
+    }
+    // the filtered image wraps (and overwrites) the work array, which is a copy of the previous level
+    Image filtered(fine_width,fine_height,fine_intensities);
+    filtered.gauss_filter(pyramid_mask_size);
+    Teuchos::ArrayRCP<intensity_t> coarse_intensities(coarse_width*coarse_height,0.0);
+    for(int_t y=0;y<coarse_height;++y)
+      for(int_t x=0;x<coarse_width;++x)
+        coarse_intensities[y*coarse_width+x] = filtered(2*x,2*y);
+    const int_t scale = 1 << level;
+    pyramid_.push_back(Teuchos::rcp(new Image(coarse_width,coarse_height,coarse_intensities,Teuchos::null,offset_x_/scale,offset_y_/scale)));
+    fine_intensities = Teuchos::ArrayRCP<intensity_t>(coarse_width*coarse_height,0.0);
+    for(int_t i=0;i<coarse_width*coarse_height;++i)
+      fine_intensities[i] = coarse_intensities[i];
+    fine_width = coarse_width;
+    fine_height = coarse_height;
+  }
+  DEBUG_MSG("Image::create_pyramid(): created " << num_pyramid_levels() << " pyramid levels");
+}
+
+void
+Image::interpolate_bicubic_fused(intensity_t & intensity_val,
+  scalar_t & grad_x_val,
+  scalar_t & grad_y_val,
+  const scalar_t & local_x,
+  const scalar_t & local_y)const{
+  assert(interleaved_channels_!=Teuchos::null);
+  const intensity_t * channels = interleaved_channels_.getRawPtr();
+  intensity_val = 0.0;
+  grad_x_val = 0.0;
+  grad_y_val = 0.0;
+  // same boundary treatment as interpolate_bicubic(), bilinear near the edge and zero outside
+  if(local_x<1.0||local_x>=width_-2.0||local_y<1.0||local_y>=height_-2.0){
+    if(local_x<0.0||local_x>=width_-1.5||local_y<0.0||local_y>=height_-1.5) return;
+    const int_t x1 = (int_t)local_x;
+    const int_t x2 = x1+1;
+    const int_t y1 = (int_t)local_y;
+    const int_t y2  = y1+1;
+    const scalar_t w11 = (x2-local_x)*(y2-local_y);
+    const scalar_t w21 = (local_x-x1)*(y2-local_y);
+    const scalar_t w22 = (local_x-x1)*(local_y-y1);
+    const scalar_t w12 = (x2-local_x)*(local_y-y1);
+    const intensity_t * c11 = &channels[3*(y1*width_+x1)];
+    const intensity_t * c21 = &channels[3*(y1*width_+x2)];
+    const intensity_t * c22 = &channels[3*(y2*width_+x2)];
+    const intensity_t * c12 = &channels[3*(y2*width_+x1)];
+    intensity_val = c11[0]*w11 + c21[0]*w21 + c22[0]*w22 + c12[0]*w12;
+    grad_x_val = c11[1]*w11 + c21[1]*w21 + c22[1]*w22 + c12[1]*w12;
+    grad_y_val = c11[2]*w11 + c21[2]*w21 + c22[2]*w22 + c12[2]*w12;
+    return;
+  }
+  const int_t x0 = (int_t)local_x;
+  const int_t y0 = (int_t)local_y;
+  const scalar_t dx = local_x - x0;
+  const scalar_t dy = local_y - y0;
+  // separable Catmull-Rom weights (the same interpolant as interpolate_bicubic())
+  const scalar_t wx[4] = {dx*(-0.5 + dx*(1.0 - 0.5*dx)),
+                          1.0 + dx*dx*(-2.5 + 1.5*dx),
+                          dx*(0.5 + dx*(2.0 - 1.5*dx)),
+                          dx*dx*(-0.5 + 0.5*dx)};
+  const scalar_t wy[4] = {dy*(-0.5 + dy*(1.0 - 0.5*dy)),
+                          1.0 + dy*dy*(-2.5 + 1.5*dy),
+                          dy*(0.5 + dy*(2.0 - 1.5*dy)),
+                          dy*dy*(-0.5 + 0.5*dy)};
+  scalar_t intens = 0.0, gx = 0.0, gy = 0.0;
+  for(int_t j=0;j<4;++j){
+    const intensity_t * row = &channels[3*((y0-1+j)*width_ + x0-1)];
+    const scalar_t row_intens = wx[0]*row[0] + wx[1]*row[3] + wx[2]*row[6] + wx[3]*row[9];
+    const scalar_t row_gx = wx[0]*row[1] + wx[1]*row[4] + wx[2]*row[7] + wx[3]*row[10];
+    const scalar_t row_gy = wx[0]*row[2] + wx[1]*row[5] + wx[2]*row[8] + wx[3]*row[11];
+    intens += wy[j]*row_intens;
+    gx += wy[j]*row_gx;
+    gy += wy[j]*row_gy;
+  }
+  intensity_val = intens;
+  grad_x_val = gx;
+  grad_y_val = gy;
+}
+
 scalar_t
 Image::mean()const{
-  scalar_t mean_value = 0.0;
-  for(int_t i=0;i<width_*height_;++i)
-    mean_value += (*this)(i);
+  const intensity_t * intens = intensities().getRawPtr();
+  const int_t width = width_;
+  const scalar_t mean_value = ordered_row_sum(0,height_,[&](const int_t y){
+    const intensity_t * row = intens + y*width;
+    scalar_t row_sum = 0.0;
+#pragma omp simd reduction(+:row_sum)
+    for(int_t x=0;x<width;++x)
+      row_sum += row[x];
+    return row_sum;
+  });
   return mean_value / (width_*height_);
 }
 
@@ -241,7 +485,11 @@ Image::write_overlap_image(const std::string & file_name,
 void
 Image::write_grad_x(const std::string & file_name){
   try{
-    utils::write_image(file_name.c_str(),width_,height_,grad_x_array().getRawPtr(),default_is_layout_right());
+    // the gradients may be stored with a different type than the intensities
+    Teuchos::ArrayRCP<intensity_t> values(width_*height_,0.0);
+    for(int_t i=0;i<width_*height_;++i)
+      values[i] = grad_x_[i];
+    utils::write_image(file_name.c_str(),width_,height_,values.getRawPtr(),default_is_layout_right());
   }
   catch(...){
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, write image grad_x failure.");
@@ -251,7 +499,11 @@ Image::write_grad_x(const std::string & file_name){
 void
 Image::write_grad_y(const std::string & file_name){
   try{
-    utils::write_image(file_name.c_str(),width_,height_,grad_y_array().getRawPtr(),default_is_layout_right());
+    // the gradients may be stored with a different type than the intensities
+    Teuchos::ArrayRCP<intensity_t> values(width_*height_,0.0);
+    for(int_t i=0;i<width_*height_;++i)
+      values[i] = grad_y_[i];
+    utils::write_image(file_name.c_str(),width_,height_,values.getRawPtr(),default_is_layout_right());
   }
   catch(...){
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, write image grad_y failure.");
@@ -268,26 +520,34 @@ Image::apply_rotation(const Rotation_Value rotation,
   }
   Teuchos::RCP<Image> result;
   Teuchos::ArrayRCP<intensity_t> new_intensities(width_*height_,0.0);
+  const intensity_t * intens = intensities().getRawPtr();
+  int_t stride_x = 0, stride_y = 0;
+  layout_strides(width_,height_,stride_x,stride_y);
+  intensity_t * new_intens = new_intensities.getRawPtr();
+  // each thread writes whole rows of the rotated image
   if(rotation==NINTY_DEGREES){
-    for(int_t y=0;y<height_;++y){
-      for(int_t x=0;x<width_;++x){
-        new_intensities[(width_-1-x)*height_+y] = (*this)(x,y);
-      }
+#pragma omp parallel for schedule(static)
+    for(int_t x=0;x<width_;++x){
+      intensity_t * out = new_intens + (width_-1-x)*height_;
+      for(int_t y=0;y<height_;++y)
+        out[y] = intens[y*stride_y+x*stride_x];
     }
     // note the height and width are swapped in the constructor call on purpose due to the transformation
     result = Teuchos::rcp(new Image(height_,width_,new_intensities,params));
   }else if(rotation==ONE_HUNDRED_EIGHTY_DEGREES){
+#pragma omp parallel for schedule(static)
     for(int_t y=0;y<height_;++y){
-      for(int_t x=0;x<width_;++x){
-        new_intensities[y*width_+x] = (*this)(width_-1-x,height_-1-y);
-      }
+      intensity_t * out = new_intens + y*width_;
+      for(int_t x=0;x<width_;++x)
+        out[x] = intens[(height_-1-y)*stride_y+(width_-1-x)*stride_x];
     }
     result = Teuchos::rcp(new Image(width_,height_,new_intensities,params));
   }else if(rotation==TWO_HUNDRED_SEVENTY_DEGREES){
-    for(int_t y=0;y<height_;++y){
-      for(int_t x=0;x<width_;++x){
-        new_intensities[x*height_+(height_-1-y)] = (*this)(x,y);
-      }
+#pragma omp parallel for schedule(static)
+    for(int_t x=0;x<width_;++x){
+      intensity_t * out = new_intens + x*height_;
+      for(int_t y=0;y<height_;++y)
+        out[height_-1-y] = intens[y*stride_y+x*stride_x];
     }
     // note the height and width are swapped in the constructor call on purpose due to the transformation
     result = Teuchos::rcp(new Image(height_,width_,new_intensities,params));
@@ -46,6 +46,10 @@
   #include <DICe_Kokkos.h>
 #endif
 #include <Teuchos_ParameterList.hpp>
+
+#include <vector>
+#include <cstdint>
+
 namespace DICe {
 
 /// forward declaration of the conformal_area_def
@@ -238,22 +242,28 @@ public:
   /// y is row, x is column
   /// \param x image coordinate x
   /// \param y image coordinate y
-  const intensity_t& operator()(const int_t x, const int_t y) const;
+  /// (returned by value since the raw intensities may be stored at their native depth)
+  intensity_t operator()(const int_t x, const int_t y) const;
 
   /// intensity accessors:
   /// note the internal arrays are stored as (row,column) so the indices have to be switched from coordinates x,y to y,x
   /// y is row, x is column
   /// \param i pixel index
-  const intensity_t& operator()(const int_t i) const;
+  intensity_t operator()(const int_t i) const;
 
   /// returns a copy of the intenisity values as an array
+  /// (for an image stored at native depth this converts the storage to the intensity type since the caller
+  /// may modify the values, so it should not be called while other threads are interpolating the image)
   Teuchos::ArrayRCP<intensity_t> intensities()const;
 
+  /// returns the bit depth (8 or 16) the raw intensities are stored with, or 0 if they are stored with the intensity type
+  int_t native_depth()const;
+
   /// returns a copy of the grad_x values as an array
-  Teuchos::ArrayRCP<scalar_t> grad_x_array()const;
+  Teuchos::ArrayRCP<gradient_t> grad_x_array()const;
 
   /// returns a copy of the grad_y values as an array
-  Teuchos::ArrayRCP<scalar_t> grad_y_array()const;
+  Teuchos::ArrayRCP<gradient_t> grad_y_array()const;
 
   /// replaces the intensity values of the image
   /// \param intensities the new intensity value array
@@ -341,6 +351,30 @@ public:
   intensity_t interpolate_bicubic(const scalar_t & local_x,
     const scalar_t & local_y);
 
+  /// interpolate the intensity and gradients together from the interleaved channels
+  /// (one set of bicubic weights and one gather of the 4x4 neighborhood for all three values)
+  /// note: create_interleaved_channels() must be called first
+  /// \param intensity_val output interpolated intensity
+  /// \param grad_x_val output interpolated x gradient
+  /// \param grad_y_val output interpolated y gradient
+  /// \param local_x local image coordinate x
+  /// \param local_y local image coordinate y
+  void interpolate_bicubic_fused(intensity_t & intensity_val,
+    scalar_t & grad_x_val,
+    scalar_t & grad_y_val,
+    const scalar_t & local_x,
+    const scalar_t & local_y)const;
+
+  /// pack the intensities and gradients into one array with three values per pixel
+  /// (intensity, grad x, grad y) for use in interpolate_bicubic_fused(), the gradients must already be computed
+  /// note: the interleaved channels are cleared if the intensities or gradients change
+  void create_interleaved_channels();
+
+  /// returns true if the interleaved channels are available
+  bool has_interleaved_channels()const{
+    return interleaved_channels_!=Teuchos::null;
+  }
+
   /// interpolant
   /// \param local_x local image coordinate x
   /// \param local_y local image coordinate y
@@ -358,13 +392,13 @@ public:
   /// y is row, x is column
   /// \param x image coordinate x
   /// \param y image coordinate y
-  const scalar_t& grad_x(const int_t x,
+  const gradient_t& grad_x(const int_t x,
     const int_t y) const;
 
   /// gradient accessor for y
   /// \param x image coordinate x
   /// \param y image coordinate y
-  const scalar_t& grad_y(const int_t x,
+  const gradient_t& grad_y(const int_t x,
     const int_t y) const ;
 
   /// laplacian accessor:
@@ -464,6 +498,33 @@ public:
   void gauss_filter(const int_t mask_size=-1,const bool use_hierarchical_parallelism=false,
     const int_t team_size=256);
 
+  /// filter the image using the gauss filter and compute the gradients of the filtered image
+  /// (same result as gauss_filter() followed by compute_gradients(), but the serial build
+  /// computes the gradients of each band of rows while it is being filtered so the image is only swept once)
+  /// \param mask_size the size of the gauss filter mask (-1 uses the current size)
+  /// \param filter_use_hierarchical_parallelism see gauss_filter()
+  /// \param filter_team_size see gauss_filter()
+  /// \param grad_use_hierarchical_parallelism see compute_gradients()
+  /// \param grad_team_size see compute_gradients()
+  void gauss_filter_and_compute_gradients(const int_t mask_size=-1,
+    const bool filter_use_hierarchical_parallelism=false,
+    const int_t filter_team_size=256,
+    const bool grad_use_hierarchical_parallelism=false,
+    const int_t grad_team_size=256);
+
+  /// filter the image and/or compute the gradients only for the pixels inside a set of tiles
+  /// (the values in the tiles are the same as for the whole image, the pixels outside the tiles are left untouched)
+  /// \param tile_size the image is divided into square tiles of this size starting at the top left corner
+  /// \param active_tiles one flag per tile, row major over the tile grid, true if the tile should be processed
+  /// \param filter true if the intensities should be gauss filtered
+  /// \param gradients true if the image gradients should be computed
+  /// \param mask_size the size of the gauss filter mask (-1 uses the current size)
+  void preprocess_tiles(const int_t tile_size,
+    const std::vector<bool> & active_tiles,
+    const bool filter,
+    const bool gradients,
+    const int_t mask_size=-1);
+
   /// sets the file name of the image
   void set_file_name(const std::string & file_name) {
     file_name_ = file_name;
@@ -483,11 +544,42 @@ public:
   /// returns the difference of two images:
   scalar_t diff(Teuchos::RCP<Image> rhs)const;
 
+  /// \brief returns the norm of the difference of two images computed from sums over square blocks of pixels
+  ///
+  /// The difference of each block sum is divided by the block size so that for smooth differences the result is
+  /// close to the per-pixel norm (block_size 1 gives the per-pixel norm), returns -1 if the images are not the same size
+  /// \param rhs the image to diff against
+  /// \param border the number of pixels along each edge to leave out
+  /// \param block_size the width of the blocks in pixels
+  scalar_t block_diff(Teuchos::RCP<Image> rhs,
+    const int_t border=0,
+    const int_t block_size=1)const;
+
   /// returns the size of the gauss filter mask
   int_t gauss_filter_mask_size()const{
     return gauss_filter_mask_size_;
   }
 
+  /// build a Gaussian pyramid from the current intensity values, each level is
+  /// low pass filtered with gauss_filter and decimated by a factor of two from the level above it
+  /// (levels stop early if the image becomes too small to filter)
+  /// \param num_levels the total number of levels including the full resolution image
+  void create_pyramid(const int_t num_levels);
+
+  /// returns the number of pyramid levels including the full resolution image
+  int_t num_pyramid_levels()const{
+    return pyramid_.size() + 1;
+  }
+
+  /// returns the image for the given pyramid level, level 1 is half resolution, level 2 quarter, etc.
+  /// the local coordinates of level l are the local coordinates of this image divided by 2^l
+  /// \param level the pyramid level (must be between 1 and num_pyramid_levels()-1)
+  Teuchos::RCP<Image> pyramid_level(const int_t level)const{
+    TEUCHOS_TEST_FOR_EXCEPTION(level<1||level>=num_pyramid_levels(),std::invalid_argument,
+      "Error, invalid pyramid level " << level << " (num levels " << num_pyramid_levels() << ")");
+    return pyramid_[level-1];
+  }
+
 #if DICE_KOKKOS
   /// tag
   struct Init_Mask_Tag {};
@@ -505,13 +597,23 @@ public:
   KOKKOS_INLINE_FUNCTION
   void operator()(const Grad_Tag &, const member_type team_member)const;
   /// tag
+  struct Gauss_Row_Flat_Tag{};
+  /// Gauss filter the rows of the image into the work array (first pass of the separable filter)
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const Gauss_Row_Flat_Tag &, const int_t pixel_index)const;
+  /// tag
   struct Gauss_Flat_Tag{};
-  /// Gauss filter the image
+  /// Gauss filter the columns of the work array into the image (second pass of the separable filter)
   KOKKOS_INLINE_FUNCTION
   void operator()(const Gauss_Flat_Tag &, const int_t pixel_index)const;
   /// tag
+  struct Gauss_Row_Tag{};
+  /// Gauss filter the rows of the image into the work array (first pass of the separable filter)
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const Gauss_Row_Tag &, const member_type team_member)const;
+  /// tag
   struct Gauss_Tag{};
-  /// Gauss filter the image
+  /// Gauss filter the columns of the work array into the image (second pass of the separable filter)
   KOKKOS_INLINE_FUNCTION
   void operator()(const Gauss_Tag &, const member_type team_member)const;
   /// returns the view of the intensity values
@@ -533,6 +635,65 @@ public:
 #endif
 
 private:
+#if !DICE_KOKKOS
+  /// apply the 1D Gauss filter along one row of the image for the columns that get filtered
+  /// \param y the row to filter
+  /// \param filtered_row [out] the filtered values, one per filtered column
+  void gauss_filter_row(const int_t y,
+    intensity_t * filtered_row)const;
+
+  /// set the gauss filter mask size and coefficients
+  /// \param mask_size the size of the gauss filter mask (-1 uses the current size)
+  void set_gauss_filter_coeffs(const int_t mask_size);
+
+  /// filter the image in place and optionally compute the gradients in the same pass
+  /// \param mask_size the size of the gauss filter mask (-1 uses the current size)
+  /// \param compute_gradients true if the gradients should be computed as the rows are filtered
+  /// (and smoothed as they are computed if the gradient method is CONVOLUTION_5_POINT)
+  void gauss_filter_in_place(const int_t mask_size,
+    const bool compute_gradients);
+
+  /// compute the finite difference gradients for one row of the image
+  /// \param y the row
+  void compute_gradients_finite_difference_row(const int_t y);
+
+  /// compute the finite difference gradients for one row from intensities stored with type T
+  /// \param intens pointer to the intensity values
+  /// \param y the row
+  template<typename T>
+  void compute_gradients_finite_difference_row(const T * intens,
+    const int_t y);
+
+  /// copy a block of intensities into values (row by row) converting them to the intensity type
+  /// \param x0 left column of the block
+  /// \param y0 top row of the block
+  /// \param w width of the block
+  /// \param h height of the block
+  /// \param values [out] the w*h intensity values
+  void gather_intensities(const int_t x0,
+    const int_t y0,
+    const int_t w,
+    const int_t h,
+    intensity_t * values)const;
+
+  /// keep the raw intensities at their native depth if every value is an integer that fits in 8 or 16 bits
+  /// (only for images that own their storage and are not going to be filtered)
+  /// \param params the image parameters
+  void store_native_depth(const Teuchos::RCP<Teuchos::ParameterList> & params);
+
+  /// convert the native depth values to a working copy with the intensity type and drop them,
+  /// called before the intensities are filtered or modified (no-op if the image is not stored at native depth)
+  void release_native_depth()const;
+
+  /// smooth one row of the finite difference gradients with the 5 point convolution weights
+  /// (the first and last two columns are left as they are)
+  /// \param y the row (at least two rows from the top and bottom of the image)
+  /// \param raw_x the unsmoothed grad_x rows y-2 to y+2
+  /// \param raw_y the unsmoothed grad_y rows y-2 to y+2
+  void smooth_gradients_row(const int_t y,
+    const gradient_t * const raw_x[5],
+    const gradient_t * const raw_y[5]);
+#endif
   /// pixel container width_
   int_t width_;
   /// pixel container height_
@@ -559,19 +720,25 @@ private:
   /// image laplacian container
   scalar_dual_view_2d laplacian_;
 #else
-  /// pixel container
-  Teuchos::ArrayRCP<intensity_t> intensities_;
-  /// device intensity work array
-  Teuchos::ArrayRCP<intensity_t> intensities_temp_;
+  /// pixel container (working copy, null while the intensities are only stored at native depth)
+  mutable Teuchos::ArrayRCP<intensity_t> intensities_;
+  /// raw intensities stored at 8 bit depth (null unless the image was read that way)
+  mutable Teuchos::ArrayRCP<uint8_t> native_intensities_8_;
+  /// raw intensities stored at 16 bit depth (null unless the image was read that way)
+  mutable Teuchos::ArrayRCP<uint16_t> native_intensities_16_;
   /// mask coefficients
   Teuchos::ArrayRCP<scalar_t> mask_;
   /// image gradient x container
-  Teuchos::ArrayRCP<scalar_t> grad_x_;
+  Teuchos::ArrayRCP<gradient_t> grad_x_;
   /// image gradient y container
-  Teuchos::ArrayRCP<scalar_t> grad_y_;
+  Teuchos::ArrayRCP<gradient_t> grad_y_;
   /// image gradient y container
   Teuchos::ArrayRCP<scalar_t> laplacian_;
 #endif
+  /// interleaved intensity, grad x, grad y values (three per pixel) for the fused interpolant
+  Teuchos::ArrayRCP<intensity_t> interleaved_channels_;
+  /// coarse levels of the Gaussian pyramid (the full resolution level is this image)
+  std::vector<Teuchos::RCP<Image> > pyramid_;
   /// flag that the gradients have been computed
   bool has_gradients_;
   /// flag that the image has been filtered
@@ -580,8 +747,8 @@ private:
   scalar_t grad_c1_;
   /// coeff used in computing gradients
   scalar_t grad_c2_;
-  /// Gauss filter coefficients
-  scalar_t gauss_filter_coeffs_[13][13]; // 13 is the maximum size for the filter window
+  /// 1D Gauss filter coefficients (the 2D mask is the outer product of these with themselves)
+  scalar_t gauss_filter_coeffs_[13]; // 13 is the maximum size for the filter window
   /// Gauss filter mask size
   int_t gauss_filter_mask_size_;
   /// half the gauss filter mask size
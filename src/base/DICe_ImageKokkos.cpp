@@ -276,25 +276,31 @@ Image::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & pa
   post_allocation_tasks(params);
 }
 
-const intensity_t&
+intensity_t
 Image::operator()(const int_t x, const int_t y) const {
   return intensities_.h_view(y,x);
 }
 
-const intensity_t&
+intensity_t
 Image::operator()(const int_t i) const {
   const int_t y = i / width_;
   const int_t x = i - y*width_;
   return intensities_.h_view(y,x);
 }
 
-const scalar_t&
+int_t
+Image::native_depth()const{
+  // the intensities are always stored with the intensity type in the dual views
+  return 0;
+}
+
+const gradient_t&
 Image::grad_x(const int_t x,
   const int_t y) const {
   return grad_x_.h_view(y,x);
 }
 
-const scalar_t&
+const gradient_t&
 Image::grad_y(const int_t x,
   const int_t y) const {
   return grad_y_.h_view(y,x);
@@ -306,15 +312,15 @@ Image::mask(const int_t x,
   return mask_.h_view(y,x);
 }
 
-Teuchos::ArrayRCP<scalar_t>
+Teuchos::ArrayRCP<gradient_t>
 Image::grad_x_array()const{
-  Teuchos::ArrayRCP<scalar_t> array(grad_x_.h_view.ptr_on_device(),0,width_*height_,false);
+  Teuchos::ArrayRCP<gradient_t> array(grad_x_.h_view.ptr_on_device(),0,width_*height_,false);
   return array;
 }
 
-Teuchos::ArrayRCP<scalar_t>
+Teuchos::ArrayRCP<gradient_t>
 Image::grad_y_array()const{
-  Teuchos::ArrayRCP<scalar_t> array(grad_y_.h_view.ptr_on_device(),0,width_*height_,false);
+  Teuchos::ArrayRCP<gradient_t> array(grad_y_.h_view.ptr_on_device(),0,width_*height_,false);
   return array;
 }
 
@@ -382,6 +388,7 @@ Image::compute_gradients_finite_difference(){
 
 void
 Image::compute_gradients(const bool use_hierarchical_parallelism, const int_t team_size){
+  interleaved_channels_ = Teuchos::null;
   TEUCHOS_TEST_FOR_EXCEPTION(gradient_method_!=FINITE_DIFFERENCE,std::runtime_error,
     "Error, gradient method must be FINITE_DIFFERENCE (this is the only method implemented for Kokkos");
   // Flat gradients:
@@ -399,6 +406,8 @@ Image::compute_gradients(const bool use_hierarchical_parallelism, const int_t te
 void
 Image::apply_mask(const Conformal_Area_Def & area_def,
   const bool smooth_edges){
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
   // first create the mask:
   create_mask(area_def,smooth_edges);
   // then apply it to the image intensity values
@@ -410,6 +419,8 @@ Image::apply_mask(const Conformal_Area_Def & area_def,
 
 void
 Image::apply_mask(const bool smooth_edges){
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
   // make sure the mask is synced from host to device
   mask_.modify<host_space>();
   mask_.sync<device_space>();
@@ -431,36 +442,27 @@ void
 Image::create_mask(const Conformal_Area_Def & area_def,
   const bool smooth_edges){
   assert(area_def.has_boundary());
-  std::set<std::pair<int_t,int_t> > coords;
-  for(size_t i=0;i<area_def.boundary()->size();++i){
-    std::set<std::pair<int_t,int_t> > shapeCoords = (*area_def.boundary())[i]->get_owned_pixels();
-    coords.insert(shapeCoords.begin(),shapeCoords.end());
-  }
+  pixel_spans spans;
+  for(size_t i=0;i<area_def.boundary()->size();++i)
+    spans = union_spans(spans,(*area_def.boundary())[i]->get_owned_spans());
   // now remove any excluded regions:
-  // now set the inactive bit for the second set of multishapes if they exist.
   if(area_def.has_excluded_area()){
-    for(size_t i=0;i<area_def.excluded_area()->size();++i){
-      std::set<std::pair<int_t,int_t> > removeCoords = (*area_def.excluded_area())[i]->get_owned_pixels();
-      typename std::set<std::pair<int_t,int_t> >::iterator it = removeCoords.begin();
-      for(;it!=removeCoords.end();++it){
-        if(coords.find(*it)!=coords.end())
-          coords.erase(*it);
-      } // end removeCoords loop
-    } // end excluded_area loop
+    for(size_t i=0;i<area_def.excluded_area()->size();++i)
+      spans = subtract_spans(spans,(*area_def.excluded_area())[i]->get_owned_spans());
   } // end has excluded area
 
-  // at this point all the coordinate pairs are in the set
-  const int_t num_area_pixels = coords.size();
+  // at this point all the pixels are in the spans
+  const int_t num_area_pixels = num_span_pixels(spans);
   // resize the storage arrays now that the num_pixels is known
   pixel_coord_device_view_1d x("x",num_area_pixels);
   pixel_coord_device_view_1d y("y",num_area_pixels);
   int_t index = 0;
-  // NOTE: the pairs are (y,x) not (x,y) so that the ordering is correct in the set
-  typename std::set<std::pair<int_t,int_t> >::iterator set_it = coords.begin();
-  for( ; set_it!=coords.end();++set_it){
-    x(index) = set_it->second - offset_x_;
-    y(index) = set_it->first - offset_y_;
-    index++;
+  for(size_t i=0;i<spans.size();++i){
+    for(int_t px=spans[i].x_begin;px<spans[i].x_end;++px){
+      x(index) = px - offset_x_;
+      y(index) = spans[i].y - offset_y_;
+      index++;
+    }
   }
   Mask_Init_Functor init_functor(mask_.d_view,x,y);
   Kokkos::parallel_for(num_area_pixels,init_functor);
@@ -517,11 +519,40 @@ Image::apply_transformation(Teuchos::RCP<Local_Shape_Function> shape_function,
   }
 }
 
+void
+Image::gauss_filter_and_compute_gradients(const int_t mask_size,
+  const bool filter_use_hierarchical_parallelism,
+  const int_t filter_team_size,
+  const bool grad_use_hierarchical_parallelism,
+  const int_t grad_team_size){
+  // the device kernels are already launched per pixel so the two steps stay separate here
+  gauss_filter(mask_size,filter_use_hierarchical_parallelism,filter_team_size);
+  compute_gradients(grad_use_hierarchical_parallelism,grad_team_size);
+}
+
+void
+Image::preprocess_tiles(const int_t tile_size,
+  const std::vector<bool> & active_tiles,
+  const bool filter,
+  const bool gradients,
+  const int_t mask_size){
+  // the device kernels process the whole image
+  if(filter)
+    gauss_filter(mask_size);
+  if(gradients)
+    compute_gradients();
+}
+
 void
 Image::gauss_filter(const int_t mask_size,const bool use_hierarchical_parallelism,
   const int_t team_size){
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
 
-  if(mask_size>0) gauss_filter_mask_size_ = mask_size;
+  if(mask_size>0){
+    gauss_filter_mask_size_ = mask_size;
+    gauss_filter_half_mask_ = gauss_filter_mask_size_/2+1;
+  }
 
   std::vector<scalar_t> coeffs(13,0.0);
 
@@ -558,18 +589,18 @@ Image::gauss_filter(const int_t mask_size,const bool use_hierarchical_parallelis
       "Error, the Gauss filter mask size is invalid (options include 5,7,9,11,13)");
   }
 
-  for(int_t j=0;j<gauss_filter_mask_size_;++j){
-    for(int_t i=0;i<gauss_filter_mask_size_;++i){
-      gauss_filter_coeffs_[i][j] = coeffs[i]*coeffs[j];
-    }
-  }
-  // deep copy the intesity array to the device temporary container
-  Kokkos::deep_copy(intensities_temp_,intensities_.d_view);
-  // Flat gradients:
-  if(use_hierarchical_parallelism)
+  for(int_t i=0;i<gauss_filter_mask_size_;++i)
+    gauss_filter_coeffs_[i] = coeffs[i];
+  // the mask is separable so the rows are filtered into the work array and then the columns of the
+  // work array are filtered back into the intensities (no copy of the intensities is needed)
+  if(use_hierarchical_parallelism){
+    Kokkos::parallel_for(Kokkos::TeamPolicy<Gauss_Row_Tag>(height_,team_size),*this);
     Kokkos::parallel_for(Kokkos::TeamPolicy<Gauss_Tag>(height_,team_size),*this);
-  else   // Hierarchical filtering:
+  }
+  else{
+    Kokkos::parallel_for(Kokkos::RangePolicy<Gauss_Row_Flat_Tag>(0,num_pixels()),*this);
     Kokkos::parallel_for(Kokkos::RangePolicy<Gauss_Flat_Tag>(0,num_pixels()),*this);
+  }
   // copy the intensity array back to the host
   intensities_.modify<device_space>();
   intensities_.sync<host_space>();
@@ -747,6 +778,19 @@ Image::operator()(const Grad_Tag &, const member_type team_member)const{
   });
 }
 
+KOKKOS_INLINE_FUNCTION
+void
+Image::operator()(const Gauss_Row_Flat_Tag &, const int_t pixel_index)const{
+  const int_t y = pixel_index / width_;
+  const int_t x = pixel_index - y*width_;
+  if(x>=gauss_filter_half_mask_&&x<width_-gauss_filter_half_mask_){
+    intensity_t value = 0.0;
+    for(int_t i=0;i<gauss_filter_mask_size_;++i)
+      value += gauss_filter_coeffs_[i]*intensities_.d_view(y,x+(i-gauss_filter_half_mask_+1));
+    intensities_temp_(y,x) = value;
+  }
+}
+
 KOKKOS_INLINE_FUNCTION
 void
 Image::operator()(const Gauss_Flat_Tag &, const int_t pixel_index)const{
@@ -754,16 +798,28 @@ Image::operator()(const Gauss_Flat_Tag &, const int_t pixel_index)const{
   const int_t x = pixel_index - y*width_;
   if(x>=gauss_filter_half_mask_&&x<width_-gauss_filter_half_mask_&&y>=gauss_filter_half_mask_&&y<height_-gauss_filter_half_mask_){
     intensity_t value = 0.0;
-    for(int_t i=0;i<gauss_filter_mask_size_;++i){
-      for(int_t j=0;j<gauss_filter_mask_size_;++j){
-        // assumes intensity values have already been deep copied into intensities_temp_
-        value += gauss_filter_coeffs_[i][j]*intensities_temp_(y+(j-gauss_filter_half_mask_+1),x+(i-gauss_filter_half_mask_+1));
-      } //j
-    } //i
+    for(int_t j=0;j<gauss_filter_mask_size_;++j)
+      // assumes the rows have already been filtered into intensities_temp_
+      value += gauss_filter_coeffs_[j]*intensities_temp_(y+(j-gauss_filter_half_mask_+1),x);
     intensities_.d_view(y,x) = value;
   }
 }
 
+KOKKOS_INLINE_FUNCTION
+void
+Image::operator()(const Gauss_Row_Tag &, const member_type team_member)const{
+  const int_t row = team_member.league_rank();
+  Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, width_),
+    [=] (const int_t col){
+    if(col>=gauss_filter_half_mask_&&col<width_-gauss_filter_half_mask_){
+      intensity_t value = 0.0;
+      for(int_t i=0;i<gauss_filter_mask_size_;++i)
+        value += gauss_filter_coeffs_[i]*intensities_.d_view(row,col+(i-gauss_filter_half_mask_+1));
+      intensities_temp_(row,col) = value;
+    }
+  });
+}
+
 KOKKOS_INLINE_FUNCTION
 void
 Image::operator()(const Gauss_Tag &, const member_type team_member)const{
@@ -772,12 +828,9 @@ Image::operator()(const Gauss_Tag &, const member_type team_member)const{
     [=] (const int_t col){
     if(col>=gauss_filter_half_mask_&&col<width_-gauss_filter_half_mask_&&row>=gauss_filter_half_mask_&&row<height_-gauss_filter_half_mask_){
       intensity_t value = 0.0;
-      for(int_t i=0;i<gauss_filter_mask_size_;++i){
-        for(int_t j=0;j<gauss_filter_mask_size_;++j){
-          // assumes intensity values have already been deep copied into intensities_temp_
-          value += gauss_filter_coeffs_[i][j]*intensities_temp_(row+(j-gauss_filter_half_mask_+1),col+(i-gauss_filter_half_mask_+1));
-        } //j
-      } //i
+      for(int_t j=0;j<gauss_filter_mask_size_;++j)
+        // assumes the rows have already been filtered into intensities_temp_
+        value += gauss_filter_coeffs_[j]*intensities_temp_(row+(j-gauss_filter_half_mask_+1),col);
       intensities_.d_view(row,col) = value;
     }
   });
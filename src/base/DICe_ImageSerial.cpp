@@ -46,6 +46,8 @@
 #include <DICe_Shape.h>
 
 #include <cassert>
+#include <algorithm>
+#include <cmath>
 
 namespace DICe {
 
@@ -59,6 +61,25 @@ inline scalar_t keys_f2(const scalar_t & s){
   return 0.08333333333333*s*s*s - 0.66666666666666*s*s + 1.75*s - 1.5;
 }
 
+/// copy a w x h block of intensities stored with type T into values (row by row) converting them to the intensity type
+template<typename T>
+inline void gather_block(const T * intens,
+  const int_t width,
+  const int_t x0,
+  const int_t y0,
+  const int_t w,
+  const int_t h,
+  intensity_t * values){
+  for(int_t j=0;j<h;++j){
+    const T * row = intens + (y0+j)*width + x0;
+    for(int_t i=0;i<w;++i)
+      values[j*w+i] = row[i];
+  }
+}
+
+/// weights of the 5 point gradient smoothing along one direction (the 2D weights are the products of these)
+const scalar_t smooth_gradient_weights[5] = {0.0625, 0.25, 0.375, 0.25, 0.0625};
+
 Image::Image(const char * file_name,
   const Teuchos::RCP<Teuchos::ParameterList> & params):
   offset_x_(0),
@@ -80,6 +101,7 @@ Image::Image(const char * file_name,
   catch(...){
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, image file read failure");
   }
+  store_native_depth(params);
   // copy the image to the device (no-op for OpenMP, or serial)
   default_constructor_tasks(params);
 }
@@ -125,6 +147,7 @@ Image::Image(const char * file_name,
   catch(...){
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, image file read failure");
   }
+  store_native_depth(params);
   default_constructor_tasks(params);
 }
 
@@ -180,29 +203,21 @@ Image::Image(Teuchos::RCP<Image> img,
 
   // initialize the pixel containers
   intensities_ = Teuchos::ArrayRCP<intensity_t>(height_*width_,0.0);
-  intensities_temp_ = Teuchos::ArrayRCP<intensity_t>(height_*width_,0.0);
-  grad_x_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,0.0);
-  grad_y_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,0.0);
-  mask_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,0.0);
-  // deep copy values over
-  int_t src_y=0, src_x=0;
+  grad_x_ = Teuchos::ArrayRCP<gradient_t>(height_*width_,0.0);
+  grad_y_ = Teuchos::ArrayRCP<gradient_t>(height_*width_,0.0);
+  mask_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,1.0);
+  // deep copy the part of each row that is inside the parent (the pixels outside are zero with a mask value of 1)
+  const int_t x_begin = std::max(0,-offset_x_);
+  const int_t x_end = std::min(width_,src_width-offset_x_);
   for(int_t y=0;y<height_;++y){
-    src_y = y + offset_y_;
-    for(int_t x=0;x<width_;++x){
-      src_x = x + offset_x_;
-      if(src_x>=0&&src_x<src_width&&src_y>=0&&src_y<src_height){
-        intensities_[y*width_+x] = (*img)(src_x,src_y);
-        grad_x_[y*width_+x] = img->grad_x(src_x,src_y);
-        grad_y_[y*width_+x] = img->grad_y(src_x,src_y);
-        mask_[y*width_+x] = img->mask(src_x,src_y);
-      }
-      else{
-        intensities_[y*width_+x] = 0.0;
-        grad_x_[y*width_+x] = 0.0;
-        grad_y_[y*width_+x] = 0.0;
-        mask_[y*width_+x] = 1.0;
-      }
-    }
+    const int_t src_y = y + offset_y_;
+    if(src_y<0||src_y>=src_height||x_begin>=x_end) continue;
+    const int_t src = src_y*src_width + offset_x_;
+    const int_t dst = y*width_;
+    img->gather_intensities(offset_x_+x_begin,src_y,x_end-x_begin,1,intensities_.getRawPtr()+dst+x_begin);
+    std::copy(img->grad_x_.getRawPtr()+src+x_begin,img->grad_x_.getRawPtr()+src+x_end,grad_x_.getRawPtr()+dst+x_begin);
+    std::copy(img->grad_y_.getRawPtr()+src+x_begin,img->grad_y_.getRawPtr()+src+x_end,grad_y_.getRawPtr()+dst+x_begin);
+    std::copy(img->mask_.getRawPtr()+src+x_begin,img->mask_.getRawPtr()+src+x_end,mask_.getRawPtr()+dst+x_begin);
   }
   grad_c1_ = 1.0/12.0;
   grad_c2_ = -8.0/12.0;
@@ -238,13 +253,14 @@ Image::initialize_array_image(intensity_t * intensities){
   assert(width_>0);
   assert(height_>0);
   intensities_ = Teuchos::ArrayRCP<intensity_t>(intensities,0,width_*height_,false);
+  native_intensities_8_ = Teuchos::null;
+  native_intensities_16_ = Teuchos::null;
 }
 
 void
 Image::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params){
-  grad_x_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,0.0);
-  grad_y_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,0.0);
-  intensities_temp_ = Teuchos::ArrayRCP<intensity_t>(height_*width_,0.0);
+  grad_x_ = Teuchos::ArrayRCP<gradient_t>(height_*width_,0.0);
+  grad_y_ = Teuchos::ArrayRCP<gradient_t>(height_*width_,0.0);
   mask_ = Teuchos::ArrayRCP<scalar_t>(height_*width_,0.0);
   if(params!=Teuchos::null){
     if(params->isParameter(DICe::compute_laplacian_image)){
@@ -268,44 +284,119 @@ Image::update_image_fields(const char * file_name,
 //    filter_failed = params->get<bool>(DICe::filter_failed_cine_pixels,false);
 //    convert_to_8_bit = params->get<bool>(DICe::convert_cine_to_8_bit,true);
 //  }
+  // the previous frame may have been stored at native depth
+  native_intensities_8_ = Teuchos::null;
+  native_intensities_16_ = Teuchos::null;
+  if(intensities_==Teuchos::null)
+    intensities_ = Teuchos::ArrayRCP<intensity_t>(width_*height_,0.0);
   try{
     utils::read_image(file_name,intensities_.getRawPtr(),params);
   }
   catch(...){
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, image file read failure");
   }
+  store_native_depth(params);
   post_allocation_tasks(params);
 }
 
-const intensity_t&
+intensity_t
 Image::operator()(const int_t x, const int_t y) const {
   TEUCHOS_TEST_FOR_EXCEPTION(x<0||x>=width_,std::runtime_error,"x = " << x);
   TEUCHOS_TEST_FOR_EXCEPTION(y<0||y>=height_,std::runtime_error," y = " << y);
-  return intensities_[y*width_+x];
+  return (*this)(y*width_+x);
 }
 
-const intensity_t&
+intensity_t
 Image::operator()(const int_t i) const {
+  if(native_intensities_8_!=Teuchos::null) return native_intensities_8_[i];
+  if(native_intensities_16_!=Teuchos::null) return native_intensities_16_[i];
   return intensities_[i];
 }
 
-const scalar_t&
+int_t
+Image::native_depth()const{
+  if(native_intensities_8_!=Teuchos::null) return 8;
+  if(native_intensities_16_!=Teuchos::null) return 16;
+  return 0;
+}
+
+void
+Image::gather_intensities(const int_t x0,
+  const int_t y0,
+  const int_t w,
+  const int_t h,
+  intensity_t * values)const{
+  if(native_intensities_8_!=Teuchos::null)
+    gather_block(native_intensities_8_.getRawPtr(),width_,x0,y0,w,h,values);
+  else if(native_intensities_16_!=Teuchos::null)
+    gather_block(native_intensities_16_.getRawPtr(),width_,x0,y0,w,h,values);
+  else
+    gather_block(intensities_.getRawPtr(),width_,x0,y0,w,h,values);
+}
+
+void
+Image::store_native_depth(const Teuchos::RCP<Teuchos::ParameterList> & params){
+  native_intensities_8_ = Teuchos::null;
+  native_intensities_16_ = Teuchos::null;
+  // the filter needs a working copy with the intensity type anyway
+  if(params!=Teuchos::null&&params->isParameter(DICe::gauss_filter_images)&&params->get<bool>(DICe::gauss_filter_images))
+    return;
+  // the storage belongs to someone else
+  if(intensity_rcp_!=Teuchos::null||intensities_==Teuchos::null)
+    return;
+  const int_t num_px = width_*height_;
+  intensity_t max_value = 0.0;
+  for(int_t i=0;i<num_px;++i){
+    const intensity_t value = intensities_[i];
+    // the values have been scaled or spread by the reader (this also catches nan)
+    if(!(value>=0.0&&value<=65535.0&&value==std::floor(value))) return;
+    max_value = std::max(max_value,value);
+  }
+  if(max_value<=255.0){
+    native_intensities_8_ = Teuchos::ArrayRCP<uint8_t>(num_px);
+    for(int_t i=0;i<num_px;++i)
+      native_intensities_8_[i] = static_cast<uint8_t>(intensities_[i]);
+  }
+  else{
+    native_intensities_16_ = Teuchos::ArrayRCP<uint16_t>(num_px);
+    for(int_t i=0;i<num_px;++i)
+      native_intensities_16_[i] = static_cast<uint16_t>(intensities_[i]);
+  }
+  DEBUG_MSG("Image::store_native_depth(): storing the intensities of " << file_name_ << " with " << native_depth() << " bits");
+  intensities_ = Teuchos::null;
+}
+
+void
+Image::release_native_depth()const{
+#pragma omp critical (dice_image_native_depth)
+  {
+    if(native_intensities_8_!=Teuchos::null||native_intensities_16_!=Teuchos::null){
+      Teuchos::ArrayRCP<intensity_t> working(width_*height_,0.0);
+      gather_intensities(0,0,width_,height_,working.getRawPtr());
+      intensities_ = working;
+      native_intensities_8_ = Teuchos::null;
+      native_intensities_16_ = Teuchos::null;
+    }
+  }
+}
+
+const gradient_t&
 Image::grad_x(const int_t x,
   const int_t y) const {
   return grad_x_[y*width_+x];
 }
 
-Teuchos::ArrayRCP<scalar_t>
+Teuchos::ArrayRCP<gradient_t>
 Image::grad_x_array() const {
   return grad_x_;
 }
 
-Teuchos::ArrayRCP<scalar_t>
+Teuchos::ArrayRCP<gradient_t>
 Image::grad_y_array() const {
   return grad_y_;
 }
 
-const scalar_t&
+const gradient_t&
 Image::grad_y(const int_t x,
   const int_t y) const {
   return grad_y_[y*width_+x];
@@ -325,6 +416,7 @@ Image::laplacian(const int_t x,
 
 Teuchos::ArrayRCP<intensity_t>
 Image::intensities()const{
+  release_native_depth();
   return intensities_;
 }
 
@@ -344,10 +436,12 @@ Image::interpolate_bilinear_all(intensity_t& intensity_val,
     const int_t x2 = x1+1;
     const int_t y1 = (int_t)local_y;
     const int_t y2  = y1+1;
-    intensity_val = intensities_[y1*width_+x1]*(x2-local_x)*(y2-local_y)
-      +intensities_[y1*width_+x2]*(local_x-x1)*(y2-local_y)
-      +intensities_[y2*width_+x2]*(local_x-x1)*(local_y-y1)
-      +intensities_[y2*width_+x1]*(x2-local_x)*(local_y-y1);
+    intensity_t f[4];
+    gather_intensities(x1,y1,2,2,f);
+    intensity_val = f[0]*(x2-local_x)*(y2-local_y)
+      +f[1]*(local_x-x1)*(y2-local_y)
+      +f[3]*(local_x-x1)*(local_y-y1)
+      +f[2]*(x2-local_x)*(local_y-y1);
     if (compute_gradient) {
       grad_x_val = grad_x_[y1*width_+x1]*(x2-local_x)*(y2-local_y)
         +grad_x_[y1*width_+x2]*(local_x-x1)*(y2-local_y)
@@ -370,10 +464,12 @@ Image::interpolate_bilinear(const scalar_t & local_x, const scalar_t & local_y){
   const int_t x2 = x1+1;
   const int_t y1 = (int_t)local_y;
   const int_t y2  = y1+1;
-  return intensities_[y1*width_+x1]*(x2-local_x)*(y2-local_y)
-      +intensities_[y1*width_+x2]*(local_x-x1)*(y2-local_y)
-      +intensities_[y2*width_+x2]*(local_x-x1)*(local_y-y1)
-      +intensities_[y2*width_+x1]*(x2-local_x)*(local_y-y1);
+  intensity_t f[4];
+  gather_intensities(x1,y1,2,2,f);
+  return f[0]*(x2-local_x)*(y2-local_y)
+      +f[1]*(local_x-x1)*(y2-local_y)
+      +f[3]*(local_x-x1)*(local_y-y1)
+      +f[2]*(x2-local_x)*(local_y-y1);
 }
 
 scalar_t
@@ -413,6 +509,7 @@ Image::interpolate_bicubic_all(intensity_t& intensity_val,
       grad_x_val = this->interpolate_grad_x_bilinear(local_x,local_y);
       grad_y_val = this->interpolate_grad_y_bilinear(local_x,local_y);
     }
+    return;
   }
   const int_t x0  = (int_t)local_x;
   const int_t x1  = x0+1;
@@ -429,22 +526,24 @@ Image::interpolate_bicubic_all(intensity_t& intensity_val,
   const scalar_t y_2 = y * y;
   const scalar_t y_3 = y_2 * y;
   // intensity
-  const intensity_t fm10  = intensities_[y0*width_+xm1];
-  const intensity_t f00   = intensities_[y0*width_+x0];
-  const intensity_t f10   = intensities_[y0*width_+x1];
-  const intensity_t f20   = intensities_[y0*width_+x2];
-  const intensity_t fm11  = intensities_[y1*width_+xm1];
-  const intensity_t f01   = intensities_[y1*width_+x0];
-  const intensity_t f11   = intensities_[y1*width_+x1];
-  const intensity_t f21   = intensities_[y1*width_+x2];
-  const intensity_t fm12  = intensities_[y2*width_+xm1];
-  const intensity_t f02   = intensities_[y2*width_+x0];
-  const intensity_t f12   = intensities_[y2*width_+x1];
-  const intensity_t f22   = intensities_[y2*width_+x2];
-  const intensity_t fm1m1 = intensities_[ym1*width_+xm1];
-  const intensity_t f0m1  = intensities_[ym1*width_+x0];
-  const intensity_t f1m1  = intensities_[ym1*width_+x1];
-  const intensity_t f2m1  = intensities_[ym1*width_+x2];
+  intensity_t f[16];
+  gather_intensities(xm1,ym1,4,4,f);
+  const intensity_t fm10  = f[4];
+  const intensity_t f00   = f[5];
+  const intensity_t f10   = f[6];
+  const intensity_t f20   = f[7];
+  const intensity_t fm11  = f[8];
+  const intensity_t f01   = f[9];
+  const intensity_t f11   = f[10];
+  const intensity_t f21   = f[11];
+  const intensity_t fm12  = f[12];
+  const intensity_t f02   = f[13];
+  const intensity_t f12   = f[14];
+  const intensity_t f22   = f[15];
+  const intensity_t fm1m1 = f[0];
+  const intensity_t f0m1  = f[1];
+  const intensity_t f1m1  = f[2];
+  const intensity_t f2m1  = f[3];
   #ifdef DICE_USE_DOUBLE
     intensity_val = f00 + (-0.5*f0m1 + .5*f01)*y + (f0m1 - 2.5*f00 + 2.0*f01 - .5*f02)*y_2 + (-0.5*f0m1 + 1.5*f00 - 1.5*f01 + .5*f02)*y_3
       + ((-0.5*fm10 + .5*f10) + (0.25*fm1m1 - .25*fm11 - .25*f1m1 + .25*f11)*y + (-0.5*fm1m1 + 1.25*fm10 - fm11 + .25*fm12 +
@@ -567,22 +666,24 @@ Image::interpolate_bicubic(const scalar_t & local_x, const scalar_t & local_y){
   const scalar_t x_3 = x_2 * x;
   const scalar_t y_2 = y * y;
   const scalar_t y_3 = y_2 * y;
-  const intensity_t fm10  = intensities_[y0*width_+xm1];
-  const intensity_t f00   = intensities_[y0*width_+x0];
-  const intensity_t f10   = intensities_[y0*width_+x1];
-  const intensity_t f20   = intensities_[y0*width_+x2];
-  const intensity_t fm11  = intensities_[y1*width_+xm1];
-  const intensity_t f01   = intensities_[y1*width_+x0];
-  const intensity_t f11   = intensities_[y1*width_+x1];
-  const intensity_t f21   = intensities_[y1*width_+x2];
-  const intensity_t fm12  = intensities_[y2*width_+xm1];
-  const intensity_t f02   = intensities_[y2*width_+x0];
-  const intensity_t f12   = intensities_[y2*width_+x1];
-  const intensity_t f22   = intensities_[y2*width_+x2];
-  const intensity_t fm1m1 = intensities_[ym1*width_+xm1];
-  const intensity_t f0m1  = intensities_[ym1*width_+x0];
-  const intensity_t f1m1  = intensities_[ym1*width_+x1];
-  const intensity_t f2m1  = intensities_[ym1*width_+x2];
+  intensity_t f[16];
+  gather_intensities(xm1,ym1,4,4,f);
+  const intensity_t fm10  = f[4];
+  const intensity_t f00   = f[5];
+  const intensity_t f10   = f[6];
+  const intensity_t f20   = f[7];
+  const intensity_t fm11  = f[8];
+  const intensity_t f01   = f[9];
+  const intensity_t f11   = f[10];
+  const intensity_t f21   = f[11];
+  const intensity_t fm12  = f[12];
+  const intensity_t f02   = f[13];
+  const intensity_t f12   = f[14];
+  const intensity_t f22   = f[15];
+  const intensity_t fm1m1 = f[0];
+  const intensity_t f0m1  = f[1];
+  const intensity_t f1m1  = f[2];
+  const intensity_t f2m1  = f[3];
 #ifdef DICE_USE_DOUBLE
   return f00 + (-0.5*f0m1 + .5*f01)*y + (f0m1 - 2.5*f00 + 2*f01 - .5*f02)*y_2 + (-0.5*f0m1 + 1.5*f00 - 1.5*f01 + .5*f02)*y_3
       + ((-0.5*fm10 + .5*f10) + (0.25*fm1m1 - .25*fm11 - .25*f1m1 + .25*f11)*y + (-0.5*fm1m1 + 1.25*fm10 - fm11 + .25*fm12 +
@@ -729,13 +830,13 @@ Image::interpolate_keys_fourth_all(intensity_t& intensity_val,
     grad_x_val = 0.0;
     grad_y_val = 0.0;
   }
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  //static intensity_t value=0.0;
-  static intensity_t cc = 0.0;
+  // the work variables are not static so that several threads can interpolate at once
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t dx = 0.0;
+  scalar_t dy = 0.0;
+  int_t ix=0,iy=0;
+  intensity_t cc = 0.0;
   ix = (int_t)local_x;
   iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5) {
@@ -759,11 +860,12 @@ Image::interpolate_keys_fourth_all(intensity_t& intensity_val,
   coeffs_y[3] = keys_f0(1.0-dy);
   coeffs_y[4] = keys_f1(2.0-dy);
   coeffs_y[5] = keys_f2(3.0-dy);
-  //value = 0.0;
+  intensity_t f[36];
+  gather_intensities(ix-2,iy-2,6,6,f);
   for(int_t m=0;m<6;++m){
     for(int_t n=0;n<6;++n){
       cc = coeffs_y[m]*coeffs_x[n];
-      intensity_val += cc*intensities_[(iy-2+m)*width_ + ix-2+n];
+      intensity_val += cc*f[m*6+n];
       if (compute_gradient) {
         grad_x_val += cc*grad_x_[(iy-2+m)*width_ + ix-2+n];
         grad_y_val += cc*grad_y_[(iy-2+m)*width_ + ix-2+n];
@@ -775,12 +877,12 @@ Image::interpolate_keys_fourth_all(intensity_t& intensity_val,
 
 intensity_t
 Image::interpolate_keys_fourth(const scalar_t & local_x, const scalar_t & local_y){
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  static intensity_t value=0.0;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t dx = 0.0;
+  scalar_t dy = 0.0;
+  int_t ix=0,iy=0;
+  intensity_t value=0.0;
   ix = (int_t)local_x;
   iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5)
@@ -800,9 +902,11 @@ Image::interpolate_keys_fourth(const scalar_t & local_x, const scalar_t & local_
   coeffs_y[4] = keys_f1(2.0-dy);
   coeffs_y[5] = keys_f2(3.0-dy);
   value = 0.0;
+  intensity_t f[36];
+  gather_intensities(ix-2,iy-2,6,6,f);
   for(int_t m=0;m<6;++m){
     for(int_t n=0;n<6;++n){
-      value += coeffs_y[m]*coeffs_x[n]*intensities_[(iy-2+m)*width_ + ix-2+n];
+      value += coeffs_y[m]*coeffs_x[n]*f[m*6+n];
     }
   }
   return value;
@@ -810,12 +914,12 @@ Image::interpolate_keys_fourth(const scalar_t & local_x, const scalar_t & local_
 
 scalar_t
 Image::interpolate_grad_x_keys_fourth(const scalar_t & local_x, const scalar_t & local_y){
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  static intensity_t value=0.0;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t dx = 0.0;
+  scalar_t dy = 0.0;
+  int_t ix=0,iy=0;
+  intensity_t value=0.0;
   ix = (int_t)local_x;
   iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5)
@@ -845,12 +949,12 @@ Image::interpolate_grad_x_keys_fourth(const scalar_t & local_x, const scalar_t &
 
 scalar_t
 Image::interpolate_grad_y_keys_fourth(const scalar_t & local_x, const scalar_t & local_y){
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  static intensity_t value=0.0;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t dx = 0.0;
+  scalar_t dy = 0.0;
+  int_t ix=0,iy=0;
+  intensity_t value=0.0;
   ix = (int_t)local_x;
   iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5)
@@ -880,6 +984,7 @@ Image::interpolate_grad_y_keys_fourth(const scalar_t & local_x, const scalar_t &
 
 void
 Image::compute_gradients(const bool use_hierarchical_parallelism, const int_t team_size){
+  interleaved_channels_ = Teuchos::null;
   if(gradient_method_==FINITE_DIFFERENCE){
     DEBUG_MSG("Image::compute_gradients(): using FINITE_DIFFERENCE");
     compute_gradients_finite_difference();
@@ -894,69 +999,98 @@ Image::compute_gradients(const bool use_hierarchical_parallelism, const int_t te
 
 void
 Image::smooth_gradients_convolution_5_point(){
-
-  static scalar_t smooth_coeffs[][5] = {{0.00390625, 0.015625, 0.0234375, 0.015625, 0.00390625},
-                                        {0.015625,   0.0625,   0.09375,   0.0625,   0.015625},
-                                        {0.0234375,  0.09375,  0.140625,  0.09375,  0.0234375},
-                                        {0.015625,   0.0625,   0.09375,   0.0625,   0.015625},
-                                        {0.00390625, 0.015625, 0.0234375, 0.015625, 0.00390625}};
-  static int_t smooth_offsets[] =  {-2, -1, 0, 1, 2};
-
-  Teuchos::ArrayRCP<scalar_t> grad_x_temp(width_*height_,0.0);
-  Teuchos::ArrayRCP<scalar_t> grad_y_temp(width_*height_,0.0);
-  for(int_t i=0;i<width_*height_;++i){
-    grad_x_temp[i] = grad_x_[i];
-    grad_y_temp[i] = grad_y_[i];
+  // the unsmoothed rows y-2 to y+2 are kept in a ring buffer of five rows so the rows can be smoothed in place
+  std::vector<gradient_t> ring_x(5*width_,0.0);
+  std::vector<gradient_t> ring_y(5*width_,0.0);
+  const gradient_t * rows_x[5];
+  const gradient_t * rows_y[5];
+  for(int_t y=0;y<height_;++y){
+    std::copy(grad_x_.getRawPtr()+y*width_,grad_x_.getRawPtr()+(y+1)*width_,&ring_x[(y%5)*width_]);
+    std::copy(grad_y_.getRawPtr()+y*width_,grad_y_.getRawPtr()+(y+1)*width_,&ring_y[(y%5)*width_]);
+    if(y<4) continue;
+    for(int_t i=0;i<5;++i){
+      rows_x[i] = &ring_x[((y-4+i)%5)*width_];
+      rows_y[i] = &ring_y[((y-4+i)%5)*width_];
+    }
+    smooth_gradients_row(y-2,rows_x,rows_y);
   }
-  for(int_t y=2;y<height_-2;++y){
-    for(int_t x=2;x<width_-2;++x){
-      scalar_t value_x = 0.0, value_y = 0.0;
-      for(int_t i=0;i<5;++i){
-        for(int_t j=0;j<5;++j){
-          value_x += smooth_coeffs[i][j] * grad_x_temp[(y + smooth_offsets[i])*width_ + x + smooth_offsets[j]];
-          value_y += smooth_coeffs[i][j] * grad_y_temp[(y + smooth_offsets[i])*width_ + x + smooth_offsets[j]];
-        }
+}
+
+void
+Image::smooth_gradients_row(const int_t y,
+  const gradient_t * const raw_x[5],
+  const gradient_t * const raw_y[5]){
+  assert(y>=2&&y<height_-2);
+  gradient_t * out_x = grad_x_.getRawPtr() + y*width_;
+  gradient_t * out_y = grad_y_.getRawPtr() + y*width_;
+  for(int_t x=2;x<width_-2;++x){
+    scalar_t value_x = 0.0, value_y = 0.0;
+    for(int_t i=0;i<5;++i){
+      for(int_t j=0;j<5;++j){
+        const scalar_t coeff = smooth_gradient_weights[i]*smooth_gradient_weights[j];
+        value_x += coeff * raw_x[i][x-2+j];
+        value_y += coeff * raw_y[i][x-2+j];
       }
-      grad_x_[y*width_+x] = value_x;
-      grad_y_[y*width_+x] = value_y;
     }
+    out_x[x] = value_x;
+    out_y[x] = value_y;
   }
 }
 
 void
 Image::compute_gradients_finite_difference(){
-  for(int_t y=0;y<height_;++y){
-    for(int_t x=0;x<width_;++x){
-      if(x<2){
-        grad_x_[y*width_+x] = intensities_[y*width_+x+1] - intensities_[y*width_+x];
-      }
-      /// check if this pixel is near the right edge
-      else if(x>=width_-2){
-        grad_x_[y*width_+x] = intensities_[y*width_+x] - intensities_[y*width_+x-1];
-      }
-      else{
-        grad_x_[y*width_+x] = grad_c1_*intensities_[y*width_+x-2] + grad_c2_*intensities_[y*width_+x-1]
-            - grad_c2_*intensities_[y*width_+x+1] - grad_c1_*intensities_[y*width_+x+2];
-      }
-      /// check if this pixel is near the top edge
-      if(y<2){
-        grad_y_[y*width_+x] = intensities_[(y+1)*width_+x] - intensities_[y*width_+x];
-      }
-      /// check if this pixel is near the bottom edge
-      else if(y>=height_-2){
-        grad_y_[y*width_+x] = intensities_[y*width_+x] - intensities_[(y-1)*width_+x];
-      }
-      else{
-        grad_y_[y*width_+x] = grad_c1_*intensities_[(y-2)*width_+x] + grad_c2_*intensities_[(y-1)*width_+x]
-            - grad_c2_*intensities_[(y+1)*width_+x] - grad_c1_*intensities_[(y+2)*width_+x];
-      }
+#pragma omp parallel for schedule(static)
+  for(int_t y=0;y<height_;++y)
+    compute_gradients_finite_difference_row(y);
+}
+
+template<typename T>
+void
+Image::compute_gradients_finite_difference_row(const T * intens,
+  const int_t y){
+  for(int_t x=0;x<width_;++x){
+    if(x<2){
+      grad_x_[y*width_+x] = intens[y*width_+x+1] - intens[y*width_+x];
+    }
+    /// check if this pixel is near the right edge
+    else if(x>=width_-2){
+      grad_x_[y*width_+x] = intens[y*width_+x] - intens[y*width_+x-1];
+    }
+    else{
+      grad_x_[y*width_+x] = grad_c1_*intens[y*width_+x-2] + grad_c2_*intens[y*width_+x-1]
+          - grad_c2_*intens[y*width_+x+1] - grad_c1_*intens[y*width_+x+2];
+    }
+    /// check if this pixel is near the top edge
+    if(y<2){
+      grad_y_[y*width_+x] = intens[(y+1)*width_+x] - intens[y*width_+x];
+    }
+    /// check if this pixel is near the bottom edge
+    else if(y>=height_-2){
+      grad_y_[y*width_+x] = intens[y*width_+x] - intens[(y-1)*width_+x];
+    }
+    else{
+      grad_y_[y*width_+x] = grad_c1_*intens[(y-2)*width_+x] + grad_c2_*intens[(y-1)*width_+x]
+          - grad_c2_*intens[(y+1)*width_+x] - grad_c1_*intens[(y+2)*width_+x];
     }
   }
 }
 
+void
+Image::compute_gradients_finite_difference_row(const int_t y){
+  if(native_intensities_8_!=Teuchos::null)
+    compute_gradients_finite_difference_row(native_intensities_8_.getRawPtr(),y);
+  else if(native_intensities_16_!=Teuchos::null)
+    compute_gradients_finite_difference_row(native_intensities_16_.getRawPtr(),y);
+  else
+    compute_gradients_finite_difference_row(intensities_.getRawPtr(),y);
+}
+
 void
 Image::apply_mask(const Conformal_Area_Def & area_def,
   const bool smooth_edges){
+  release_native_depth();
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
   // first create the mask:
   create_mask(area_def,smooth_edges);
   for(int_t i=0;i<num_pixels();++i)
@@ -965,6 +1099,9 @@ Image::apply_mask(const Conformal_Area_Def & area_def,
 
 void
 Image::apply_mask(const bool smooth_edges){
+  release_native_depth();
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
   if(smooth_edges){
     static scalar_t smoothing_coeffs[5][5];
     std::vector<scalar_t> coeffs(5,0.0);
@@ -1003,27 +1140,18 @@ void
 Image::create_mask(const Conformal_Area_Def & area_def,
   const bool smooth_edges){
   assert(area_def.has_boundary());
-  std::set<std::pair<int_t,int_t> > coords;
-  for(size_t i=0;i<area_def.boundary()->size();++i){
-    std::set<std::pair<int_t,int_t> > shapeCoords = (*area_def.boundary())[i]->get_owned_pixels();
-    coords.insert(shapeCoords.begin(),shapeCoords.end());
-  }
+  pixel_spans spans;
+  for(size_t i=0;i<area_def.boundary()->size();++i)
+    spans = union_spans(spans,(*area_def.boundary())[i]->get_owned_spans());
   // now remove any excluded regions:
-  // now set the inactive bit for the second set of multishapes if they exist.
   if(area_def.has_excluded_area()){
-    for(size_t i=0;i<area_def.excluded_area()->size();++i){
-      std::set<std::pair<int_t,int_t> > removeCoords = (*area_def.excluded_area())[i]->get_owned_pixels();
-      std::set<std::pair<int_t,int_t> >::iterator it = removeCoords.begin();
-      for(;it!=removeCoords.end();++it){
-        if(coords.find(*it)!=coords.end())
-          coords.erase(*it);
-      } // end removeCoords loop
-    } // end excluded_area loop
+    for(size_t i=0;i<area_def.excluded_area()->size();++i)
+      spans = subtract_spans(spans,(*area_def.excluded_area())[i]->get_owned_spans());
   } // end has excluded area
-  // NOTE: the pairs are (y,x) not (x,y) so that the ordering is correct in the set
-  std::set<std::pair<int_t,int_t> >::iterator set_it = coords.begin();
-  for( ; set_it!=coords.end();++set_it){
-    mask_[(set_it->first - offset_y_)*width_+set_it->second - offset_x_] = 1.0;
+  for(size_t i=0;i<spans.size();++i){
+    const int_t row_offset = (spans[i].y - offset_y_)*width_ - offset_x_;
+    for(int_t x=spans[i].x_begin;x<spans[i].x_end;++x)
+      mask_[row_offset + x] = 1.0;
   }
   if(smooth_edges){
     static scalar_t smoothing_coeffs[5][5];
@@ -1075,11 +1203,43 @@ Image::apply_transformation(Teuchos::RCP<Local_Shape_Function> shape_function,
   }
 }
 
+void
+Image::gauss_filter_row(const int_t y,
+  intensity_t * filtered_row)const{
+  const int_t num_cols = width_ - 2*gauss_filter_half_mask_;
+  const int_t half = gauss_filter_mask_size_/2;
+  const intensity_t * row = intensities_.getRawPtr() + y*width_ + gauss_filter_half_mask_ - half;
+  for(int_t x=0;x<num_cols;++x)
+    filtered_row[x] = 0.0;
+  for(int_t i=0;i<gauss_filter_mask_size_;++i){
+    const intensity_t coeff = gauss_filter_coeffs_[i];
+    const intensity_t * in = row + i;
+#pragma omp simd
+    for(int_t x=0;x<num_cols;++x)
+      filtered_row[x] += coeff*in[x];
+  }
+}
+
 void
 Image::gauss_filter(const int_t mask_size,const bool use_hierarchical_parallelism,
   const int_t team_size){
   DEBUG_MSG("Image::gauss_filter: mask_size " << gauss_filter_mask_size_);
+  gauss_filter_in_place(mask_size,false);
+}
 
+void
+Image::gauss_filter_and_compute_gradients(const int_t mask_size,
+  const bool filter_use_hierarchical_parallelism,
+  const int_t filter_team_size,
+  const bool grad_use_hierarchical_parallelism,
+  const int_t grad_team_size){
+  DEBUG_MSG("Image::gauss_filter_and_compute_gradients: mask_size " << gauss_filter_mask_size_);
+  gauss_filter_in_place(mask_size,true);
+  has_gradients_ = true;
+}
+
+void
+Image::set_gauss_filter_coeffs(const int_t mask_size){
   if(mask_size>0){
     gauss_filter_mask_size_=mask_size;
     gauss_filter_half_mask_ = gauss_filter_mask_size_/2+1;
@@ -1122,30 +1282,321 @@ Image::gauss_filter(const int_t mask_size,const bool use_hierarchical_parallelis
   TEUCHOS_TEST_FOR_EXCEPTION(width_<gauss_filter_mask_size_||height_<gauss_filter_mask_size_,std::runtime_error,
     "Error, image too small (" << width_ << " x " << height_ << ") for gauss filtering with mask size " << gauss_filter_mask_size_);
 
-  // copy over the old intensities
-  for(int_t i=0;i<num_pixels();++i)
-    intensities_temp_[i] = intensities_[i];
+  for(int_t i=0;i<gauss_filter_mask_size_;++i)
+    gauss_filter_coeffs_[i] = coeffs[i];
+}
+
+void
+Image::gauss_filter_in_place(const int_t mask_size,
+  const bool compute_gradients){
+  release_native_depth();
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
+  set_gauss_filter_coeffs(mask_size);
 
-  for(int_t j=0;j<gauss_filter_mask_size_;++j){
-    for(int_t i=0;i<gauss_filter_mask_size_;++i){
-      gauss_filter_coeffs_[i][j] = coeffs[i]*coeffs[j];
+  // the mask is separable so the filter is applied as a pass along the rows followed by a pass along the columns
+  // (2*mask_size rather than mask_size^2 multiply-adds per pixel). Only the pixels at least gauss_filter_half_mask_
+  // from the edge are filtered, the rest keep their original values.
+  const int_t half = gauss_filter_mask_size_/2;
+  const int_t first = gauss_filter_half_mask_;
+  const int_t num_cols = width_ - 2*gauss_filter_half_mask_;
+  const int_t num_rows = height_ - 2*gauss_filter_half_mask_;
+  const bool smooth = compute_gradients&&gradient_method_==CONVOLUTION_5_POINT;
+  if(num_cols<=0||num_rows<=0){
+    if(compute_gradients)
+      compute_gradients_finite_difference();
+    if(smooth)
+      smooth_gradients_convolution_5_point();
+    has_gauss_filter_ = true;
+    return;
+  }
+  // the filter works in place on bands of rows. Each band keeps the row-filtered values of the last mask_size rows
+  // in a ring buffer and writes each output row as soon as the rows below it have been row-filtered. The rows just
+  // outside a band belong to its neighbors so they are row-filtered for every band before any band writes its output.
+  const int_t num_bands = std::max(1,std::min(16,num_rows/(8*gauss_filter_mask_size_)));
+  std::vector<intensity_t> halo_rows(num_bands*2*half*num_cols,0.0);
+#pragma omp parallel for schedule(static) if(num_bands>1)
+  for(int_t band=0;band<num_bands;++band){
+    const int_t y_begin = first + (band*num_rows)/num_bands;
+    const int_t y_end = first + ((band+1)*num_rows)/num_bands;
+    intensity_t * halo = &halo_rows[band*2*half*num_cols];
+    for(int_t j=0;j<half;++j){
+      gauss_filter_row(y_begin-half+j,&halo[j*num_cols]);
+      gauss_filter_row(y_end+j,&halo[(half+j)*num_cols]);
     }
   }
-  for(int_t y=0;y<height_;++y){
-    for(int_t x=0;x<width_;++x){
-      if(x>=gauss_filter_half_mask_&&x<width_-gauss_filter_half_mask_&&y>=gauss_filter_half_mask_&&y<height_-gauss_filter_half_mask_){
-        intensity_t value = 0.0;
-        for(int_t i=0;i<gauss_filter_mask_size_;++i){
-          for(int_t j=0;j<gauss_filter_mask_size_;++j){
-            // assumes intensity values have already been deep copied into intensities_temp_
-            value += gauss_filter_coeffs_[i][j]*intensities_temp_[(y+(j-gauss_filter_half_mask_+1))*width_+x+(i-gauss_filter_half_mask_+1)];
-          } //j
-        } //i
-        intensities_[y*width_+x] = value;
+  // when the gradients are requested each band also computes the finite difference gradients of a row as soon as
+  // the two filtered rows below it have been written, while the rows are still in cache. The gradient rows within two
+  // rows of the boundary between two bands need filtered values from both bands so they are computed after all
+  // the bands are done. The unfiltered rows at the top and bottom of the image never change so the first and last
+  // band take care of their gradients.
+  // For CONVOLUTION_5_POINT each gradient row is smoothed in turn as soon as the two gradient rows below it are done.
+  // The unsmoothed gradient rows are kept in a ring buffer of five rows. Each band also saves its first and last four
+  // unsmoothed rows, which the rows near the band boundaries need once the boundary gradients are computed.
+  intensity_t * intensities = intensities_.getRawPtr();
+  std::vector<gradient_t> edge_rows(smooth ? num_bands*16*width_ : 0,0.0);
+#pragma omp parallel for schedule(static) if(num_bands>1)
+  for(int_t band=0;band<num_bands;++band){
+    const int_t y_begin = first + (band*num_rows)/num_bands;
+    const int_t y_end = first + ((band+1)*num_rows)/num_bands;
+    const int_t grad_begin = band==0 ? 0 : y_begin + 2;
+    const int_t grad_end = band==num_bands-1 ? height_ : y_end - 2;
+    const intensity_t * halo = &halo_rows[band*2*half*num_cols];
+    const int_t smooth_begin = std::max(2,grad_begin+2);
+    const int_t smooth_end = std::min(height_-2,grad_end-2);
+    std::vector<gradient_t> ring_x(smooth ? 5*width_ : 0,0.0);
+    std::vector<gradient_t> ring_y(smooth ? 5*width_ : 0,0.0);
+    gradient_t * band_edge_rows = smooth ? &edge_rows[band*16*width_] : NULL;
+    // the gradient rows of a band are computed in order from grad_begin to grad_end
+    auto gradient_row = [&](const int_t y){
+      compute_gradients_finite_difference_row(y);
+      if(!smooth) return;
+      const gradient_t * gx = grad_x_.getRawPtr() + y*width_;
+      const gradient_t * gy = grad_y_.getRawPtr() + y*width_;
+      std::copy(gx,gx+width_,&ring_x[(y%5)*width_]);
+      std::copy(gy,gy+width_,&ring_y[(y%5)*width_]);
+      // edge row slots 0-3 are the first rows of the band, 4-7 the last ones (grad_x, then grad_y from slot 8)
+      int_t slot = -1;
+      if(band>0&&y<grad_begin+4) slot = y - grad_begin;
+      else if(band<num_bands-1&&y>=grad_end-4) slot = 4 + y - (grad_end-4);
+      if(slot>=0){
+        std::copy(gx,gx+width_,band_edge_rows+slot*width_);
+        std::copy(gy,gy+width_,band_edge_rows+(8+slot)*width_);
+      }
+      if(y-2<smooth_begin||y-2>=smooth_end) return;
+      const gradient_t * rows_x[5];
+      const gradient_t * rows_y[5];
+      for(int_t i=0;i<5;++i){
+        rows_x[i] = &ring_x[((y-4+i)%5)*width_];
+        rows_y[i] = &ring_y[((y-4+i)%5)*width_];
+      }
+      smooth_gradients_row(y-2,rows_x,rows_y);
+    };
+    if(compute_gradients){
+      for(int_t y=grad_begin;y<y_begin-2;++y)
+        gradient_row(y);
+    }
+    // ring buffer slot for row y is (y - y_begin + half) % mask_size
+    std::vector<intensity_t> ring(gauss_filter_mask_size_*num_cols,0.0);
+    for(int_t j=0;j<half;++j){
+      std::copy(halo+j*num_cols,halo+(j+1)*num_cols,&ring[j*num_cols]);
+      if(y_begin+j<y_end)
+        gauss_filter_row(y_begin+j,&ring[(half+j)*num_cols]);
+      else
+        std::copy(halo+(half+y_begin+j-y_end)*num_cols,halo+(half+y_begin+j-y_end+1)*num_cols,&ring[(half+j)*num_cols]);
+    }
+    for(int_t y=y_begin;y<y_end;++y){
+      // row-filter the bottom row of the window for this output row (from the halo if it belongs to the next band)
+      const int_t next_row = y + half;
+      intensity_t * next_slot = &ring[((next_row-y_begin+half)%gauss_filter_mask_size_)*num_cols];
+      if(next_row<y_end)
+        gauss_filter_row(next_row,next_slot);
+      else
+        std::copy(halo+(half+next_row-y_end)*num_cols,halo+(half+next_row-y_end+1)*num_cols,next_slot);
+      // column pass straight into the output row (the rows in the window are no longer read from the image)
+      intensity_t * out = intensities + y*width_ + first;
+      for(int_t x=0;x<num_cols;++x)
+        out[x] = 0.0;
+      for(int_t j=0;j<gauss_filter_mask_size_;++j){
+        const intensity_t coeff = gauss_filter_coeffs_[j];
+        const intensity_t * in = &ring[((y-half+j-y_begin+half)%gauss_filter_mask_size_)*num_cols];
+#pragma omp simd
+        for(int_t x=0;x<num_cols;++x)
+          out[x] += coeff*in[x];
+      }
+      if(compute_gradients&&y-2>=grad_begin&&y-2<grad_end)
+        gradient_row(y-2);
+    }
+    if(compute_gradients){
+      for(int_t y=std::max(grad_begin,y_end-2);y<grad_end;++y)
+        gradient_row(y);
+    }
+  }
+  if(smooth){
+    // around each band boundary b the gradient rows b-2 to b+1 are computed now and the rows b-4 to b+3 are smoothed
+    // from the unsmoothed rows b-6 to b+5 (the first and last four of those were saved by the two bands)
+#pragma omp parallel for schedule(static) if(num_bands>2)
+    for(int_t band=1;band<num_bands;++band){
+      const int_t b = first + (band*num_rows)/num_bands;
+      const gradient_t * above = &edge_rows[(band-1)*16*width_];
+      const gradient_t * below = &edge_rows[band*16*width_];
+      std::vector<gradient_t> raw_x(12*width_,0.0);
+      std::vector<gradient_t> raw_y(12*width_,0.0);
+      for(int_t j=0;j<4;++j){
+        std::copy(above+(4+j)*width_,above+(5+j)*width_,&raw_x[j*width_]);
+        std::copy(above+(12+j)*width_,above+(13+j)*width_,&raw_y[j*width_]);
+        compute_gradients_finite_difference_row(b-2+j);
+        std::copy(grad_x_.getRawPtr()+(b-2+j)*width_,grad_x_.getRawPtr()+(b-1+j)*width_,&raw_x[(4+j)*width_]);
+        std::copy(grad_y_.getRawPtr()+(b-2+j)*width_,grad_y_.getRawPtr()+(b-1+j)*width_,&raw_y[(4+j)*width_]);
+        std::copy(below+j*width_,below+(j+1)*width_,&raw_x[(8+j)*width_]);
+        std::copy(below+(8+j)*width_,below+(9+j)*width_,&raw_y[(8+j)*width_]);
+      }
+      const gradient_t * rows_x[5];
+      const gradient_t * rows_y[5];
+      for(int_t y=b-4;y<b+4;++y){
+        for(int_t i=0;i<5;++i){
+          rows_x[i] = &raw_x[(y-2+i-(b-6))*width_];
+          rows_y[i] = &raw_y[(y-2+i-(b-6))*width_];
+        }
+        smooth_gradients_row(y,rows_x,rows_y);
       }
     }
   }
+  else if(compute_gradients){
+#pragma omp parallel for schedule(static) if(num_bands>1)
+    for(int_t i=0;i<(num_bands-1)*4;++i){
+      const int_t band = i/4 + 1;
+      compute_gradients_finite_difference_row(first + (band*num_rows)/num_bands - 2 + i%4);
+    }
+  }
   has_gauss_filter_ = true;
 }
 
+void
+Image::preprocess_tiles(const int_t tile_size,
+  const std::vector<bool> & active_tiles,
+  const bool filter,
+  const bool gradients,
+  const int_t mask_size){
+  TEUCHOS_TEST_FOR_EXCEPTION(tile_size<=0,std::invalid_argument,"Error, invalid tile size " << tile_size);
+  const int_t tiles_x = (width_ + tile_size - 1)/tile_size;
+  const int_t tiles_y = (height_ + tile_size - 1)/tile_size;
+  TEUCHOS_TEST_FOR_EXCEPTION((int_t)active_tiles.size()!=tiles_x*tiles_y,std::invalid_argument,
+    "Error, active tile flags size " << active_tiles.size() << " does not match the tile grid " << tiles_x << " x " << tiles_y);
+  DEBUG_MSG("Image::preprocess_tiles(): tile size " << tile_size << " filter " << filter << " gradients " << gradients);
+  release_native_depth();
+  interleaved_channels_ = Teuchos::null;
+  pyramid_.clear();
+  if(filter)
+    set_gauss_filter_coeffs(mask_size);
+  std::vector<int_t> tiles;
+  for(int_t i=0;i<tiles_x*tiles_y;++i)
+    if(active_tiles[i]) tiles.push_back(i);
+  const int_t num_tiles = tiles.size();
+  const int_t half = gauss_filter_mask_size_/2;
+  const int_t hm = gauss_filter_half_mask_;
+  const bool smooth = gradients&&gradient_method_==CONVOLUTION_5_POINT;
+  // the smoothing reads the gradients two pixels past the tile and the gradients read the filtered values two pixels past that
+  const int_t grad_margin = smooth ? 2 : 0;
+  const int_t margin = gradients ? grad_margin + 2 : 0;
+  const int_t tile_pixels = tile_size*tile_size;
+  // every tile is computed from the original intensities first and written back once all the tiles are done
+  // since the filter windows of neighboring tiles overlap
+  std::vector<scalar_t> results(num_tiles*3*tile_pixels,0.0);
+#pragma omp parallel for schedule(dynamic)
+  for(int_t t=0;t<num_tiles;++t){
+    const int_t x0 = (tiles[t]%tiles_x)*tile_size;
+    const int_t y0 = (tiles[t]/tiles_x)*tile_size;
+    const int_t x1 = std::min(x0+tile_size,width_);
+    const int_t y1 = std::min(y0+tile_size,height_);
+    // filtered values for the tile plus the margin needed by the gradients
+    const int_t fx0 = std::max(x0-margin,0);
+    const int_t fy0 = std::max(y0-margin,0);
+    const int_t fx1 = std::min(x1+margin,width_);
+    const int_t fy1 = std::min(y1+margin,height_);
+    const int_t fw = fx1 - fx0;
+    const int_t fh = fy1 - fy0;
+    std::vector<scalar_t> filtered(fw*fh,0.0);
+    if(filter){
+      // row pass for the rows the column pass needs (only the interior pixels are filtered)
+      const int_t ry0 = std::max(fy0-half,0);
+      const int_t ry1 = std::min(fy1+half,height_);
+      std::vector<scalar_t> row_filtered((ry1-ry0)*fw,0.0);
+      for(int_t y=ry0;y<ry1;++y){
+        for(int_t x=std::max(fx0,hm);x<std::min(fx1,width_-hm);++x){
+          scalar_t value = 0.0;
+          for(int_t i=0;i<gauss_filter_mask_size_;++i)
+            value += gauss_filter_coeffs_[i]*intensities_[y*width_+x-half+i];
+          row_filtered[(y-ry0)*fw+x-fx0] = value;
+        }
+      }
+      for(int_t y=fy0;y<fy1;++y){
+        for(int_t x=fx0;x<fx1;++x){
+          if(x>=hm&&x<width_-hm&&y>=hm&&y<height_-hm){
+            scalar_t value = 0.0;
+            for(int_t j=0;j<gauss_filter_mask_size_;++j)
+              value += gauss_filter_coeffs_[j]*row_filtered[(y-half+j-ry0)*fw+x-fx0];
+            filtered[(y-fy0)*fw+x-fx0] = value;
+          }
+          else
+            filtered[(y-fy0)*fw+x-fx0] = intensities_[y*width_+x];
+        }
+      }
+    }
+    else{
+      for(int_t y=fy0;y<fy1;++y)
+        for(int_t x=fx0;x<fx1;++x)
+          filtered[(y-fy0)*fw+x-fx0] = intensities_[y*width_+x];
+    }
+    scalar_t * tile_intens = &results[t*3*tile_pixels];
+    scalar_t * tile_grad_x = tile_intens + tile_pixels;
+    scalar_t * tile_grad_y = tile_grad_x + tile_pixels;
+    for(int_t y=y0;y<y1;++y)
+      for(int_t x=x0;x<x1;++x)
+        tile_intens[(y-y0)*tile_size+x-x0] = filtered[(y-fy0)*fw+x-fx0];
+    if(!gradients) continue;
+    // finite difference gradients of the filtered values (same edge treatment as compute_gradients_finite_difference())
+    const int_t gx0 = std::max(x0-grad_margin,0);
+    const int_t gy0 = std::max(y0-grad_margin,0);
+    const int_t gx1 = std::min(x1+grad_margin,width_);
+    const int_t gy1 = std::min(y1+grad_margin,height_);
+    const int_t gw = gx1 - gx0;
+    std::vector<scalar_t> fd_x(gw*(gy1-gy0),0.0);
+    std::vector<scalar_t> fd_y(gw*(gy1-gy0),0.0);
+    for(int_t y=gy0;y<gy1;++y){
+      for(int_t x=gx0;x<gx1;++x){
+        const int_t i = (y-fy0)*fw+x-fx0;
+        scalar_t & dx = fd_x[(y-gy0)*gw+x-gx0];
+        scalar_t & dy = fd_y[(y-gy0)*gw+x-gx0];
+        if(x<2) dx = filtered[i+1] - filtered[i];
+        else if(x>=width_-2) dx = filtered[i] - filtered[i-1];
+        else dx = grad_c1_*filtered[i-2] + grad_c2_*filtered[i-1] - grad_c2_*filtered[i+1] - grad_c1_*filtered[i+2];
+        if(y<2) dy = filtered[i+fw] - filtered[i];
+        else if(y>=height_-2) dy = filtered[i] - filtered[i-fw];
+        else dy = grad_c1_*filtered[i-2*fw] + grad_c2_*filtered[i-fw] - grad_c2_*filtered[i+fw] - grad_c1_*filtered[i+2*fw];
+      }
+    }
+    for(int_t y=y0;y<y1;++y){
+      for(int_t x=x0;x<x1;++x){
+        scalar_t value_x = fd_x[(y-gy0)*gw+x-gx0];
+        scalar_t value_y = fd_y[(y-gy0)*gw+x-gx0];
+        if(smooth&&x>=2&&x<width_-2&&y>=2&&y<height_-2){
+          // same weights as smooth_gradients_convolution_5_point()
+          value_x = 0.0; value_y = 0.0;
+          for(int_t i=0;i<5;++i){
+            for(int_t j=0;j<5;++j){
+              const scalar_t coeff = smooth_gradient_weights[i]*smooth_gradient_weights[j];
+              value_x += coeff*fd_x[(y-2+i-gy0)*gw+x-2+j-gx0];
+              value_y += coeff*fd_y[(y-2+i-gy0)*gw+x-2+j-gx0];
+            }
+          }
+        }
+        tile_grad_x[(y-y0)*tile_size+x-x0] = value_x;
+        tile_grad_y[(y-y0)*tile_size+x-x0] = value_y;
+      }
+    }
+  }
+#pragma omp parallel for schedule(static)
+  for(int_t t=0;t<num_tiles;++t){
+    const int_t x0 = (tiles[t]%tiles_x)*tile_size;
+    const int_t y0 = (tiles[t]/tiles_x)*tile_size;
+    const int_t x1 = std::min(x0+tile_size,width_);
+    const int_t y1 = std::min(y0+tile_size,height_);
+    const scalar_t * tile_intens = &results[t*3*tile_pixels];
+    for(int_t y=y0;y<y1;++y){
+      for(int_t x=x0;x<x1;++x){
+        const int_t i = (y-y0)*tile_size+x-x0;
+        if(filter)
+          intensities_[y*width_+x] = tile_intens[i];
+        if(gradients){
+          grad_x_[y*width_+x] = tile_intens[tile_pixels+i];
+          grad_y_[y*width_+x] = tile_intens[2*tile_pixels+i];
+        }
+      }
+    }
+  }
+  if(filter) has_gauss_filter_ = true;
+  if(gradients) has_gradients_ = true;
+}
+
 }// End DICe Namespace
@@ -65,11 +65,14 @@ void apply_transform(Teuchos::RCP<Image> image_in,
   shape_function->insert_motion(-u,-v);
   const scalar_t CX = cx + u;
   const scalar_t CY = cy + v;
-  scalar_t mapped_x=0.0, mapped_y=0.0;
+  Teuchos::ArrayRCP<intensity_t> intensities_out = image_out->intensities();
+  // the rows are independent (map and the interpolant don't modify any shared state)
+#pragma omp parallel for schedule(static)
   for(int_t y=0;y<height;++y){
+    scalar_t mapped_x=0.0, mapped_y=0.0;
     for(int_t x=0;x<width;++x){
       shape_function->map(x,y,CX,CY,mapped_x,mapped_y);
-      image_out->intensities()[y*width+x] = image_in->interpolate_keys_fourth(mapped_x,mapped_y);
+      intensities_out[y*width+x] = image_in->interpolate_keys_fourth(mapped_x,mapped_y);
     }// x
   }// y
   shape_function->insert_motion(u,v);
@@ -84,6 +87,23 @@ void SinCos_Image_Deformer::compute_deformation(const scalar_t & coord_x,
   by = 0.5*amplitude_ - cos(beta*coord_x)*sin(beta*coord_y)*0.5*amplitude_;
 }
 
+void SinCos_Image_Deformer::compute_deformation_row(const scalar_t & coord_x_begin,
+  const scalar_t & coord_y,
+  const int_t num_pts,
+  scalar_t * bx,
+  scalar_t * by){
+  const scalar_t beta = period_==0.0 ? 0.0 : DICE_TWOPI*(1.0/period_);
+  // the y terms are the same for the whole row
+  const scalar_t sin_y = sin(beta*coord_y);
+  const scalar_t cos_y = cos(beta*coord_y);
+#pragma omp simd
+  for(int_t i=0;i<num_pts;++i){
+    const scalar_t coord_x = coord_x_begin + i;
+    bx[i] = 0.5*amplitude_ + sin(beta*coord_x)*cos_y*0.5*amplitude_;
+    by[i] = 0.5*amplitude_ - cos(beta*coord_x)*sin_y*0.5*amplitude_;
+  }
+}
+
 void SinCos_Image_Deformer::compute_deriv_deformation(const scalar_t & coord_x,
   const scalar_t & coord_y,
   scalar_t & bxx,
@@ -112,6 +132,18 @@ void DICChallenge14_Image_Deformer::compute_deformation(const scalar_t & coord_x
   by = 0.0;
 }
 
+void DICChallenge14_Image_Deformer::compute_deformation_row(const scalar_t & coord_x_begin,
+  const scalar_t & coord_y,
+  const int_t num_pts,
+  scalar_t * bx,
+  scalar_t * by){
+  for(int_t i=0;i<num_pts;++i){
+    const scalar_t coord_x = coord_x_begin + i;
+    bx[i] = coord_x < 100.0 ? 0.0 : 0.1*std::sin(coeff_*(coord_x-100.0)*(coord_x-100.0));
+    by[i] = 0.0;
+  }
+}
+
 void DICChallenge14_Image_Deformer::compute_deriv_deformation(const scalar_t & coord_x,
   const scalar_t & coord_y,
   scalar_t & bxx,
@@ -125,6 +157,15 @@ void DICChallenge14_Image_Deformer::compute_deriv_deformation(const scalar_t & c
 }
 
 
+void Image_Deformer::compute_deformation_row(const scalar_t & coord_x_begin,
+  const scalar_t & coord_y,
+  const int_t num_pts,
+  scalar_t * bx,
+  scalar_t * by){
+  for(int_t i=0;i<num_pts;++i)
+    compute_deformation(coord_x_begin + i,coord_y,bx[i],by[i]);
+}
+
 void Image_Deformer::compute_displacement_error(const scalar_t & coord_x,
   const scalar_t & coord_y,
   const scalar_t & sol_x,
@@ -238,23 +279,28 @@ Image_Deformer::deform_image(Teuchos::RCP<Image> ref_image){
 
   // Note: uses 5 x 5 point sampling grid to evaluate the deformed intensity
   const int_t num_pts = 5;
-  static scalar_t offsets_x[5] = {0.0,-0.5,0.5,0.5,-0.5};
-  static scalar_t offsets_y[5] = {0.0,-0.5,-0.5,0.5,0.5};
+  static const scalar_t offsets_x[5] = {0.0,-0.5,0.5,0.5,-0.5};
+  static const scalar_t offsets_y[5] = {0.0,-0.5,-0.5,0.5,0.5};
   Teuchos::ArrayRCP<intensity_t> def_intens(w*h,0.0);
-  scalar_t bx=0.0,by=0.0;
+  intensity_t * def_intens_ptr = def_intens.getRawPtr();
+  // the rows are independent, the displacements of each sample point in a row
+  // are evaluated with one call rather than a virtual call per pixel
+#pragma omp parallel for schedule(dynamic,4)
   for(int_t j=0;j<h;++j){
-    for(int_t i=0;i<w;++i){
-      scalar_t avg_intens = 0.0;
-      for(int_t pt=0;pt<num_pts;++pt){
+    std::vector<scalar_t> bx(w,0.0);
+    std::vector<scalar_t> by(w,0.0);
+    std::vector<scalar_t> avg_intens(w,0.0);
+    for(int_t pt=0;pt<num_pts;++pt){
+      const scalar_t sample_y = j - offsets_y[pt];
+      compute_deformation_row(ox - offsets_x[pt],sample_y+oy,w,&bx[0],&by[0]);
+      for(int_t i=0;i<w;++i){
         const scalar_t sample_x = i - offsets_x[pt];
-        const scalar_t sample_y = j - offsets_y[pt];
-        compute_deformation(sample_x+ox,sample_y+oy,bx,by);
-        scalar_t intens = ref_image->interpolate_keys_fourth(sample_x-bx,sample_y-by);
-        avg_intens += intens;
-      } // end avg points
-      def_intens[j*w+i] = num_pts==0.0?0.0:avg_intens/num_pts;
-    } // end pixel i
-  } // ens pixel j
+        avg_intens[i] += ref_image->interpolate_keys_fourth(sample_x-bx[i],sample_y-by[i]);
+      } // end pixel i
+    } // end avg points
+    for(int_t i=0;i<w;++i)
+      def_intens_ptr[j*w+i] = avg_intens[i]/num_pts;
+  } // end pixel j
 
   // no weighted average ...
 //  Teuchos::ArrayRCP<intensity_t> def_intens(w*h,0.0);
@@ -582,9 +628,18 @@ Teuchos::RCP<Image> create_synthetic_speckle_image(const int_t w,
   const intensity_t mag = 255.0*0.5;
 
   Teuchos::ArrayRCP<intensity_t> intensities(w*h,0.0);
+  intensity_t * intensities_ptr = intensities.getRawPtr();
+  // the pattern is separable so the cosines in x are only computed once
+  std::vector<scalar_t> cos_x(w,0.0);
+  for(int_t x=0;x<w;++x)
+    cos_x[x] = std::cos(gamma*(x+offset_x));
+#pragma omp parallel for schedule(static)
   for(int_t y=0;y<h;++y){
+    const scalar_t cos_y = std::cos(gamma*(y+offset_y));
+    intensity_t * row = intensities_ptr + y*w;
+#pragma omp simd
     for(int_t x=0;x<w;++x){
-      intensities[y*w+x] = mag + mag*std::cos(gamma*(x+offset_x))*std::cos(gamma*(y+offset_y));
+      row[x] = mag + mag*cos_x[x]*cos_y;
     }
   }
   Teuchos::RCP<Image> img = Teuchos::rcp(new Image(w,h,intensities,params,offset_x,offset_y));
@@ -161,6 +161,21 @@ public:
     scalar_t & bx,
     scalar_t & by){TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Cannot call this base class method")};
 
+  /// \brief compute the analytical displacement for a row of points one pixel apart
+  ///
+  /// The points are (coord_x_begin + i, coord_y) for i = 0 to num_pts-1. The base class calls compute_deformation()
+  /// for each point, derived classes override this with a loop that needs no virtual call per point.
+  /// \param coord_x_begin the x-coordinate of the first point
+  /// \param coord_y the y-coordinate of the row
+  /// \param num_pts the number of points in the row
+  /// \param bx [out] array of x displacements (of size num_pts)
+  /// \param by [out] array of y displacements (of size num_pts)
+  virtual void compute_deformation_row(const scalar_t & coord_x_begin,
+    const scalar_t & coord_y,
+    const int_t num_pts,
+    scalar_t * bx,
+    scalar_t * by);
+
   /// compute the analytical derivatives at the given coordinates
   /// \param coord_x the x-coordinate for the evaluation location
   /// \param coord_y the y-coordinate
@@ -281,6 +296,13 @@ public:
     scalar_t & bx,
     scalar_t & by);
 
+  /// See base class documentation
+  virtual void compute_deformation_row(const scalar_t & coord_x_begin,
+    const scalar_t & coord_y,
+    const int_t num_pts,
+    scalar_t * bx,
+    scalar_t * by);
+
   /// compute the analytical derivatives at the given coordinates
   /// \param coord_x the x-coordinate for the evaluation location
   /// \param coord_y the y-coordinate
@@ -339,6 +361,13 @@ public:
     scalar_t & bx,
     scalar_t & by);
 
+  /// See base class documentation
+  virtual void compute_deformation_row(const scalar_t & coord_x_begin,
+    const scalar_t & coord_y,
+    const int_t num_pts,
+    scalar_t * bx,
+    scalar_t * by);
+
   /// compute the analytical derivatives at the given coordinates
   /// \param coord_x the x-coordinate for the evaluation location
   /// \param coord_y the y-coordinate
@@ -397,6 +426,18 @@ public:
     bx = value_x_;
     by = value_y_;
   }
+
+  /// See base class documentation
+  virtual void compute_deformation_row(const scalar_t & coord_x_begin,
+    const scalar_t & coord_y,
+    const int_t num_pts,
+    scalar_t * bx,
+    scalar_t * by){
+    for(int_t i=0;i<num_pts;++i){
+      bx[i] = value_x_;
+      by[i] = value_y_;
+    }
+  }
   /// compute the analytical derivatives at the given coordinates
   /// \param coord_x the x-coordinate for the evaluation location
   /// \param coord_y the y-coordinate
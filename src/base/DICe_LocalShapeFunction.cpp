@@ -66,11 +66,8 @@ void
 Local_Shape_Function::save_fields(Schema * schema,
   const int_t subset_gid){
   assert(schema);
-  // iterate the fields and save off the values
-  std::map<Field_Spec,size_t>::const_iterator it = spec_map_.begin();
-  const std::map<Field_Spec,size_t>::const_iterator it_end = spec_map_.end();
-  for(;it!=it_end;++it)
-    schema->global_field_value(subset_gid,it->first) = parameters_[it->second];
+  // save off the values of all the parameters in one pass
+  schema->scatter_local_field_values(schema->subset_local_id(subset_gid),spec_map_,parameters_);
 }
 
 void
@@ -120,15 +117,14 @@ void
 Local_Shape_Function::initialize_parameters_from_fields(Schema * schema,
   const int_t subset_gid){
   assert(schema);
-  std::map<Field_Spec,size_t>::const_iterator it = spec_map_.begin();
-  const std::map<Field_Spec,size_t>::const_iterator it_end = spec_map_.end();
+  schema->gather_local_field_values(schema->subset_local_id(subset_gid),spec_map_,parameters_);
+#ifdef DICE_DEBUG_MSG
   std::stringstream dbg_str;
   dbg_str << "Subset initialized from subset gid " << subset_gid << " with values:";
-  for(;it!=it_end;++it){
-    (*this)(it->first) = schema->global_field_value(subset_gid,it->first);
-    dbg_str << " " << parameter(it->first);
-  }
+  for(size_t i=0;i<parameters_.size();++i)
+    dbg_str << " " << parameters_[i];
   DEBUG_MSG(dbg_str.str());
+#endif
 }
 
 Affine_Shape_Function::Affine_Shape_Function(const bool enable_rotation,
@@ -217,10 +213,11 @@ Affine_Shape_Function::map(const scalar_t & x,
   scalar_t & out_x,
   scalar_t & out_y){
 
-  static scalar_t dx=0.0,dy=0.0;
-  static scalar_t Dx=0.0,Dy=0.0;
-  static scalar_t dispx=0.0,dispy=0.0,theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0;
-  static scalar_t cost=0.0,sint=0.0;
+  // the work variables are not static so that several threads can map points at once
+  scalar_t dx=0.0,dy=0.0;
+  scalar_t Dx=0.0,Dy=0.0;
+  scalar_t dispx=0.0,dispy=0.0,theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0;
+  scalar_t cost=0.0,sint=0.0;
 
   dispx = parameters_[dx_ind_];
   dispy = parameters_[dy_ind_];
@@ -244,38 +241,39 @@ Affine_Shape_Function::initialize_parameters_from_fields(Schema * schema,
   const int_t subset_gid){
   assert(schema);
   const Projection_Method projection = schema->projection_method();
+  const int_t subset_lid = schema->subset_local_id(subset_gid);
   if(schema->translation_enabled()){
     DEBUG_MSG("Subset " << subset_gid << " Translation is enabled.");
     if(schema->frame_id() > schema->first_frame_id()+2 && projection == VELOCITY_BASED){
-      (*this)(SUBSET_DISPLACEMENT_X_FS) = schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS) +
-          (schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS)-schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_NM1_FS));
-      (*this)(SUBSET_DISPLACEMENT_Y_FS) = schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS) +
-          (schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS)-schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_NM1_FS));
+      (*this)(SUBSET_DISPLACEMENT_X_FS) = schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS) +
+          (schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS)-schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_NM1_FS));
+      (*this)(SUBSET_DISPLACEMENT_Y_FS) = schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS) +
+          (schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS)-schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_NM1_FS));
 
     }
     else{
-      (*this)(SUBSET_DISPLACEMENT_X_FS) = schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS);
-      (*this)(SUBSET_DISPLACEMENT_Y_FS) = schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS);
+      (*this)(SUBSET_DISPLACEMENT_X_FS) = schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS);
+      (*this)(SUBSET_DISPLACEMENT_Y_FS) = schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS);
     }
   }
   if(schema->rotation_enabled()){
     DEBUG_MSG("Subset " << subset_gid << " Rotation is enabled.");
     if(schema->frame_id() > schema->first_frame_id()+2 && projection == VELOCITY_BASED){
-      (*this)(ROTATION_Z_FS) = schema->global_field_value(subset_gid,ROTATION_Z_FS) +
-          (schema->global_field_value(subset_gid,ROTATION_Z_FS)-schema->global_field_value(subset_gid,ROTATION_Z_NM1_FS));
+      (*this)(ROTATION_Z_FS) = schema->local_field_value(subset_lid,ROTATION_Z_FS) +
+          (schema->local_field_value(subset_lid,ROTATION_Z_FS)-schema->local_field_value(subset_lid,ROTATION_Z_NM1_FS));
     }
     else{
-      (*this)(ROTATION_Z_FS) = schema->global_field_value(subset_gid,ROTATION_Z_FS);
+      (*this)(ROTATION_Z_FS) = schema->local_field_value(subset_lid,ROTATION_Z_FS);
     }
   }
   if(schema->normal_strain_enabled()){
     DEBUG_MSG("Subset " << subset_gid << " Normal strain is enabled.");
-    (*this)(NORMAL_STRETCH_XX_FS) = schema->global_field_value(subset_gid,NORMAL_STRETCH_XX_FS);
-    (*this)(NORMAL_STRETCH_YY_FS) = schema->global_field_value(subset_gid,NORMAL_STRETCH_YY_FS);
+    (*this)(NORMAL_STRETCH_XX_FS) = schema->local_field_value(subset_lid,NORMAL_STRETCH_XX_FS);
+    (*this)(NORMAL_STRETCH_YY_FS) = schema->local_field_value(subset_lid,NORMAL_STRETCH_YY_FS);
   }
   if(schema->shear_strain_enabled()){
     DEBUG_MSG("Subset " << subset_gid << " Shear strain is enabled.");
-    (*this)(SHEAR_STRETCH_XY_FS) = schema->global_field_value(subset_gid,SHEAR_STRETCH_XY_FS);
+    (*this)(SHEAR_STRETCH_XY_FS) = schema->local_field_value(subset_lid,SHEAR_STRETCH_XY_FS);
   }
 //  if(sid!=subset_gid)
 //    DEBUG_MSG("Subset " << subset_gid << " was initialized from the field values of subset " << sid);
@@ -349,9 +347,9 @@ Affine_Shape_Function::residuals(const scalar_t & x,
   const bool use_ref_grads){
   assert((int_t)residuals.size()==num_params_);
 
-  static scalar_t dx=0.0,dy=0.0,Dx=0.0,Dy=0.0,delTheta=0.0,delEx=0.0,delEy=0.0,delGxy=0.0;
-  static scalar_t Gx=0.0,Gy=0.0;
-  static scalar_t theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0,cosTheta=0.0,sinTheta=0.0;
+  scalar_t dx=0.0,dy=0.0,Dx=0.0,Dy=0.0,delTheta=0.0,delEx=0.0,delEy=0.0,delGxy=0.0;
+  scalar_t Gx=0.0,Gy=0.0;
+  scalar_t theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0,cosTheta=0.0,sinTheta=0.0;
   theta = has_rotz_ ? parameters_[rotz_ind_] : 0.0;
   dudx  = has_nsxx_ ? parameters_[nsxx_ind_] : 0.0;
   dvdy  = has_nsyy_ ? parameters_[nsyy_ind_] : 0.0;
@@ -577,12 +575,13 @@ Quadratic_Shape_Function::save_fields(Schema * schema,
   // since u, v, and theta are not explicitly parameters, need to save them
   // manually here
   scalar_t u=0.0,v=0.0,theta=0.0;
-  const scalar_t cx = schema->global_field_value(subset_gid,SUBSET_COORDINATES_X_FS);
-  const scalar_t cy = schema->global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS);
+  const int_t subset_lid = schema->subset_local_id(subset_gid);
+  const scalar_t cx = schema->local_field_value(subset_lid,SUBSET_COORDINATES_X_FS);
+  const scalar_t cy = schema->local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS);
   map_to_u_v_theta(cx,cy,u,v,theta);
-  schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS) = u;
-  schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS) = v;
-  schema->global_field_value(subset_gid,ROTATION_Z_FS) = theta;
+  schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS) = u;
+  schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS) = v;
+  schema->local_field_value(subset_lid,ROTATION_Z_FS) = theta;
 }
 
 void
@@ -785,12 +784,13 @@ Rigid_Body_Shape_Function::save_fields(Schema * schema,
   // since u, v, and theta are not explicitly parameters, need to save them
   // manually here
   scalar_t u=0.0,v=0.0,theta=0.0;
-  const scalar_t cx = schema->global_field_value(subset_gid,SUBSET_COORDINATES_X_FS);
-  const scalar_t cy = schema->global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS);
+  const int_t subset_lid = schema->subset_local_id(subset_gid);
+  const scalar_t cx = schema->local_field_value(subset_lid,SUBSET_COORDINATES_X_FS);
+  const scalar_t cy = schema->local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS);
   map_to_u_v_theta(cx,cy,u,v,theta);
-  schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS) = u;
-  schema->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS) = v;
-  schema->global_field_value(subset_gid,ROTATION_Z_FS) = theta;
+  schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS) = u;
+  schema->local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS) = v;
+  schema->local_field_value(subset_lid,ROTATION_Z_FS) = theta;
 }
 
 void
@@ -329,6 +329,13 @@ public:
     return (*epetra_mv_)[field_index][local_id];
   }
 
+  /// \brief pointer to the contiguous local values of one field
+  /// \param field_index the index of the field to access
+  /// The pointer stays valid for the life of this MultiField (the storage is never reallocated)
+  mv_scalar_type * local_values(const int_t field_index=0){
+    return (*epetra_mv_)[field_index];
+  }
+
   /// \brief axpby for MultiField
   /// \param alpha Multiplier of the input MultiField
   /// \param multifield Input multifield
@@ -350,6 +350,14 @@ public:
     return tpetra_mv_->getLocalView<host_device_type>()(local_id,field_index);
   }
 
+  /// \brief pointer to the contiguous local values of one field (host view)
+  /// \param field_index the index of the field to access
+  /// The pointer stays valid for the life of this MultiField (the storage is never reallocated)
+  scalar_t * local_values(const int_t field_index=0){
+    auto host_view = tpetra_mv_->getLocalView<host_device_type>();
+    return host_view.data() + field_index*host_view.stride(1);
+  }
+
   /// \brief put that same value in all elements of this Multivector
   /// \param value The value to populate with
   void put_scalar(const scalar_t & value){
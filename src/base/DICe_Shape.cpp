@@ -43,10 +43,179 @@
 #include <DICe_Shape.h>
 #include <DICe_LocalShapeFunction.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace DICe {
 
+pixel_spans
+union_spans(const pixel_spans & lhs,
+  const pixel_spans & rhs){
+  pixel_spans result;
+  result.reserve(lhs.size()+rhs.size());
+  size_t i=0,j=0;
+  while(i<lhs.size()||j<rhs.size()){
+    // take the next span in row-major order from either list
+    const Pixel_Span & next = (j>=rhs.size()||(i<lhs.size()&&lhs[i]<rhs[j])) ? lhs[i++] : rhs[j++];
+    // merge with the last span if they overlap or touch
+    if(!result.empty()&&result.back().y==next.y&&next.x_begin<=result.back().x_end){
+      result.back().x_end = std::max(result.back().x_end,next.x_end);
+    }
+    else{
+      result.push_back(next);
+    }
+  }
+  return result;
+}
+
+pixel_spans
+subtract_spans(const pixel_spans & lhs,
+  const pixel_spans & rhs){
+  pixel_spans result;
+  result.reserve(lhs.size());
+  size_t j=0;
+  for(size_t i=0;i<lhs.size();++i){
+    const Pixel_Span & span = lhs[i];
+    int_t x_begin = span.x_begin;
+    // skip the removed spans that end before this one starts
+    while(j<rhs.size()&&(rhs[j].y<span.y||(rhs[j].y==span.y&&rhs[j].x_end<=x_begin))) ++j;
+    // cut out the removed spans that overlap this one (j is kept since they may overlap the next span too)
+    for(size_t k=j;k<rhs.size()&&rhs[k].y==span.y&&rhs[k].x_begin<span.x_end;++k){
+      if(rhs[k].x_begin>x_begin)
+        result.push_back(Pixel_Span(span.y,x_begin,rhs[k].x_begin));
+      x_begin = std::max(x_begin,rhs[k].x_end);
+    }
+    if(x_begin<span.x_end)
+      result.push_back(Pixel_Span(span.y,x_begin,span.x_end));
+  }
+  return result;
+}
+
+bool
+spans_contain(const pixel_spans & spans,
+  const int_t x,
+  const int_t y){
+  // find the last span that starts at or before the pixel
+  pixel_spans::const_iterator it = std::upper_bound(spans.begin(),spans.end(),Pixel_Span(y,x,x));
+  if(it==spans.begin()) return false;
+  --it;
+  return it->y==y && x<it->x_end;
+}
+
+int_t
+num_span_pixels(const pixel_spans & spans){
+  int_t num_pixels = 0;
+  for(size_t i=0;i<spans.size();++i)
+    num_pixels += spans[i].x_end - spans[i].x_begin;
+  return num_pixels;
+}
+
+std::set<std::pair<int_t,int_t> >
+spans_to_set(const pixel_spans & spans){
+  std::set<std::pair<int_t,int_t> > coordSet;
+  // the spans are already sorted so each insert is at the end of the set
+  for(size_t i=0;i<spans.size();++i)
+    for(int_t x=spans[i].x_begin;x<spans[i].x_end;++x)
+      coordSet.insert(coordSet.end(),std::pair<int_t,int_t>(spans[i].y,x));
+  return coordSet;
+}
+
+namespace {
+
+/// returns true if the sum of the angles subtended by the polygon sides is at least PI
+bool
+winding_angle_inside(const int_t x,
+  const int_t y,
+  const int_t num_vertices,
+  const std::vector<int_t> & verts_x,
+  const std::vector<int_t> & verts_y){
+  scalar_t dx1=0,dx2=0,dy1=0,dy2=0;
+  scalar_t angle=0.0;
+  for (int_t i=0;i<num_vertices;i++) {
+    // get the two end points of the polygon side and construct
+    // a vector from the point to each one:
+    dx1 = verts_x[i] - x;
+    dy1 = verts_y[i] - y;
+    dx2 = verts_x[i+1] - x;
+    dy2 = verts_y[i+1] - y;
+    angle += angle_2d(dx1,dy1,dx2,dy2);
+  }
+  // if the angle is greater than PI, the point is in the polygon
+  return std::abs(angle) >= DICE_PI;
+}
+
+/// \brief Scanline rasterization of a closed polygon (the first vertex is repeated at the end of the vertex vectors)
+///
+/// Away from the boundary the winding number is constant between the crossings of the sides with the row,
+/// so the runs are filled directly. The pixels next to a crossing and the rows that pass through a vertex
+/// are tested with the winding angle so that the owned pixels are the same as the per-pixel test.
+pixel_spans
+scanline_polygon(const int_t num_vertices,
+  const std::vector<int_t> & verts_x,
+  const std::vector<int_t> & verts_y,
+  const int_t min_x,
+  const int_t max_x,
+  const int_t min_y,
+  const int_t max_y){
+  pixel_spans spans;
+  if(max_x<min_x||max_y<min_y) return spans;
+  const int_t w = max_x - min_x + 1;
+  std::vector<char> inside(w,0);
+  std::vector<int_t> vertex_rows(verts_y.begin(),verts_y.begin()+num_vertices);
+  std::sort(vertex_rows.begin(),vertex_rows.end());
+  // crossing x position and the direction of the side (+1 down, -1 up)
+  std::vector<std::pair<double,int_t> > crossings;
+  for(int_t y=min_y;y<=max_y;++y){
+    if(std::binary_search(vertex_rows.begin(),vertex_rows.end(),y)){
+      // sides touch or run along this row
+      for(int_t x=min_x;x<=max_x;++x)
+        inside[x-min_x] = winding_angle_inside(x,y,num_vertices,verts_x,verts_y);
+    }
+    else{
+      std::fill(inside.begin(),inside.end(),0);
+      crossings.clear();
+      for(int_t i=0;i<num_vertices;++i){
+        const int_t y0 = verts_y[i];
+        const int_t y1 = verts_y[i+1];
+        if((y0<y&&y1>y)||(y0>y&&y1<y))
+          crossings.push_back(std::pair<double,int_t>(verts_x[i] + (double)(y-y0)*(verts_x[i+1]-verts_x[i])/(double)(y1-y0),y1>y0?1:-1));
+      }
+      std::sort(crossings.begin(),crossings.end());
+      int_t winding = 0;
+      for(size_t k=0;k+1<crossings.size();++k){
+        winding += crossings[k].second;
+        if(winding==0) continue;
+        const int_t x_begin = std::max((int_t)std::floor(crossings[k].first)+1,min_x);
+        const int_t x_end = std::min((int_t)std::ceil(crossings[k+1].first)-1,max_x);
+        for(int_t x=x_begin;x<=x_end;++x)
+          inside[x-min_x] = 1;
+      }
+      // the pixels on or next to the boundary are left to the winding angle
+      for(size_t k=0;k<crossings.size();++k){
+        const int_t x_begin = std::max((int_t)std::floor(crossings[k].first)-1,min_x);
+        const int_t x_end = std::min((int_t)std::ceil(crossings[k].first)+1,max_x);
+        for(int_t x=x_begin;x<=x_end;++x)
+          inside[x-min_x] = winding_angle_inside(x,y,num_vertices,verts_x,verts_y);
+      }
+    }
+    // collect the runs of owned pixels in this row
+    int_t x=0;
+    while(x<w){
+      if(!inside[x]){
+        ++x;
+        continue;
+      }
+      const int_t x_begin = x;
+      while(x<w&&inside[x]) ++x;
+      spans.push_back(Pixel_Span(y,min_x+x_begin,min_x+x));
+    }
+  }
+  return spans;
+}
+
+} // anonymous namespace
+
 Polygon::Polygon(std::vector<int_t> & coords_x,
   std::vector<int_t> & coords_y):
   vertex_coordinates_x_(coords_x),
@@ -131,9 +300,8 @@ Polygon::deactivate_pixels(const int_t size,
 }
 
 
-// NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match loops over y then x
-std::set<std::pair<int_t,int_t> >
-Polygon::get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function,
+pixel_spans
+Polygon::get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function,
   const int_t cx,
   const int_t cy,
   const scalar_t skin_factor)const{
@@ -191,31 +359,7 @@ Polygon::get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function,
     } // vertex_loop
   }
 
-  std::set<std::pair<int_t,int_t> > coordSet;
-
-  scalar_t dx1=0,dx2=0,dy1=0,dy2=0;
-  scalar_t angle=0;
-  // rip over the points in the extents of the polygon to determine which onese are inside
-  for(int_t y=min_y;y<=max_y;++y){
-    for(int_t x=min_x;x<=max_x;++x){
-      // x and y are the global coordinates of the point to test
-      angle=0.0;
-      for (int_t i=0;i<num_vertices_;i++) {
-        // get the two end points of the polygon side and construct
-        // a vector from the point to each one:
-        dx1 = verts_x[i] - x;
-        dy1 = verts_y[i] - y;
-        dx2 = verts_x[i+1] - x;
-        dy2 = verts_y[i+1] - y;
-        angle += angle_2d(dx1,dy1,dx2,dy2);
-      }
-      // if the angle is greater than PI, the point is in the polygon
-      if(std::abs(angle) >= DICE_PI){
-        coordSet.insert(std::pair<int_t,int_t>(y,x));
-      }
-    }
-  }
-  return coordSet;
+  return scanline_polygon(num_vertices_,verts_x,verts_y,min_x,max_x,min_y,max_y);
 }
 
 Circle::Circle(const int_t centroid_x,
@@ -254,28 +398,37 @@ Circle::deactivate_pixels(const int_t size,
   }
 }
 
-// NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match loops over y then x
-std::set<std::pair<int_t,int_t> >
-Circle::get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function,
+pixel_spans
+Circle::get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function,
   const int_t cx,
   const int_t cy,
   const scalar_t skin_factor)const{
   TEUCHOS_TEST_FOR_EXCEPTION(shape_function!=Teuchos::null,std::runtime_error,"Error, circle deformation has not been implemented yet");
-  std::set<std::pair<int_t,int_t> > coordSet;
+  pixel_spans spans;
 
   scalar_t dx=0,dy=0;
-  // rip over the points in the extents of the circle to determine which onese are inside
+  // each row of the circle is one run centered on the centroid
   for(int_t y=min_y_;y<=max_y_;++y){
-    for(int_t x=min_x_;x<=max_x_;++x){
-      // x and y are the global coordinates of the point to test
-      dx = (x-centroid_x_)*(x-centroid_x_);
-      dy = (y-centroid_y_)*(y-centroid_y_);
-      if(dx + dy <= radius2_){
-        coordSet.insert(std::pair<int_t,int_t>(y,x));
-      }
+    dy = (y-centroid_y_)*(y-centroid_y_);
+    if(dy > radius2_) continue;
+    // start from the square root and correct it so the end pixels satisfy the same test as before
+    int_t half_width = (int_t)std::sqrt(radius2_ - dy);
+    dx = half_width*half_width;
+    while(half_width>0&&dx + dy > radius2_){
+      --half_width;
+      dx = half_width*half_width;
+    }
+    dx = (half_width+1)*(half_width+1);
+    while(dx + dy <= radius2_){
+      ++half_width;
+      dx = (half_width+1)*(half_width+1);
     }
+    const int_t x_begin = std::max(centroid_x_ - half_width,min_x_);
+    const int_t x_end = std::min(centroid_x_ + half_width,max_x_) + 1;
+    if(x_begin<x_end)
+      spans.push_back(Pixel_Span(y,x_begin,x_end));
   }
-  return coordSet;
+  return spans;
 }
 
 Rectangle::Rectangle(const int_t centroid_x,
@@ -317,14 +470,13 @@ Rectangle::deactivate_pixels(const int_t size,
   }
 }
 
-// NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match loops over y then x
-std::set<std::pair<int_t,int_t> >
-Rectangle::get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function,
+pixel_spans
+Rectangle::get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function,
   const int_t cx,
   const int_t cy,
   const scalar_t skin_factor)const{
 
-  std::set<std::pair<int_t,int_t> > coordSet;
+  pixel_spans spans;
 
   if(shape_function!=Teuchos::null){
     int_t min_x = 0;
@@ -390,38 +542,13 @@ Rectangle::get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function,
       }
     } // vertex_loop
 
-    scalar_t dx1=0,dx2=0,dy1=0,dy2=0;
-    scalar_t angle=0;
-    // rip over the points in the extents of the polygon to determine which onese are inside
-    for(int_t y=min_y;y<=max_y;++y){
-      for(int_t x=min_x;x<=max_x;++x){
-        // x and y are the global coordinates of the point to test
-        angle=0.0;
-        for (int_t i=0;i<4;i++) {
-          // get the two end points of the polygon side and construct
-          // a vector from the point to each one:
-          dx1 = verts_x[i] - x;
-          dy1 = verts_y[i] - y;
-          dx2 = verts_x[i+1] - x;
-          dy2 = verts_y[i+1] - y;
-          angle += angle_2d(dx1,dy1,dx2,dy2);
-        }
-        // if the angle is greater than PI, the point is in the polygon
-        if(std::abs(angle) >= DICE_PI){
-          coordSet.insert(std::pair<int_t,int_t>(y,x));
-        }
-      }
-    }
+    spans = scanline_polygon(4,verts_x,verts_y,min_x,max_x,min_y,max_y);
   } // has deformation
   else{
-    // rip over the points in the extents of the circle to determine which onese are inside
-    for(int_t y=0;y<height_;++y){
-      for(int_t x=0;x<width_;++x){
-        coordSet.insert(std::pair<int_t,int_t>(origin_y_+y,origin_x_+x));
-      }
-    }
+    for(int_t y=0;y<height_;++y)
+      spans.push_back(Pixel_Span(origin_y_+y,origin_x_,origin_x_+width_));
   }
-  return coordSet;
+  return spans;
 }
 
 }// End DICe Namespace
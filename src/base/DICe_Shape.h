@@ -48,12 +48,80 @@
 #include <Teuchos_ArrayRCP.hpp>
 
 #include <set>
+#include <vector>
 #include <cassert>
 
 namespace DICe {
 
 class Local_Shape_Function;
 
+/// \class DICe::Pixel_Span
+/// \brief A run of consecutive pixels in one row of an image
+///
+/// Shapes are rasterized as a list of spans sorted by y then x_begin with no two spans
+/// overlapping (see DICe::pixel_spans). This is much lighter than a set of pixel coordinates for large areas
+/// and the union or difference of two span lists is linear in the number of spans.
+struct DICE_LIB_DLL_EXPORT
+Pixel_Span {
+  /// \brief Constructor
+  /// \param span_y global y-coordinate of the row
+  /// \param span_x_begin global x-coordinate of the first pixel in the span
+  /// \param span_x_end global x-coordinate one past the last pixel in the span
+  Pixel_Span(const int_t span_y,
+    const int_t span_x_begin,
+    const int_t span_x_end):
+    y(span_y),
+    x_begin(span_x_begin),
+    x_end(span_x_end){};
+
+  /// spans are ordered by row then by the first pixel
+  bool operator<(const Pixel_Span & rhs)const{
+    return y < rhs.y || (y == rhs.y && x_begin < rhs.x_begin);
+  }
+
+  /// row of the span
+  int_t y;
+  /// first pixel in the span
+  int_t x_begin;
+  /// one past the last pixel in the span
+  int_t x_end;
+};
+
+/// A list of spans sorted by y then x_begin, the spans do not overlap
+typedef std::vector<Pixel_Span> pixel_spans;
+
+/// \brief Returns the union of two sorted span lists
+/// \param lhs the first list of spans
+/// \param rhs the second list of spans
+DICE_LIB_DLL_EXPORT
+pixel_spans union_spans(const pixel_spans & lhs,
+  const pixel_spans & rhs);
+
+/// \brief Returns the pixels of the first span list that are not in the second
+/// \param lhs the list of spans to subtract from
+/// \param rhs the list of spans to remove
+DICE_LIB_DLL_EXPORT
+pixel_spans subtract_spans(const pixel_spans & lhs,
+  const pixel_spans & rhs);
+
+/// \brief Returns true if the pixel is covered by one of the spans (binary search over the list)
+/// \param spans the sorted list of spans
+/// \param x global x-coordinate of the pixel
+/// \param y global y-coordinate of the pixel
+DICE_LIB_DLL_EXPORT
+bool spans_contain(const pixel_spans & spans,
+  const int_t x,
+  const int_t y);
+
+/// Returns the total number of pixels covered by a list of spans
+DICE_LIB_DLL_EXPORT
+int_t num_span_pixels(const pixel_spans & spans);
+
+/// \brief Converts a list of spans to a set of pixel coordinates
+/// NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match with loops over y then x
+DICE_LIB_DLL_EXPORT
+std::set<std::pair<int_t,int_t> > spans_to_set(const pixel_spans & spans);
+
 /// \class DICe::Shape
 /// \brief Generic class for defining regions in an image
 ///
@@ -70,19 +138,28 @@ public:
   Shape(){};
   virtual ~Shape(){};
 
-  /// \brief Returns a set of the coordinates of all pixels interior to this shape.
-  /// NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match with loops over y then x
+  /// \brief Returns the pixels interior to this shape as a sorted list of row spans
   /// \param shape_function Optional mapping to the deformed shape, otherwise reference map is used
   /// \param cx Optional x centroid of the map
   /// \param cy Optional y centroid of the map
   /// \param skin_factor Optional padding added to the outside of the shape to make it larger or smaller
-  virtual std::set<std::pair<int_t,int_t> > get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
+  virtual pixel_spans get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
     const int_t cx=0,
     const int_t cy=0,
     const scalar_t skin_factor=1.0)const{
     assert(false && "  DICe ERROR: Base class implementation of this method should not be called.");
-    std::set<std::pair<int_t,int_t> > nullSet;
-    return nullSet;
+    pixel_spans nullSpans;
+    return nullSpans;
+  }
+
+  /// \brief Returns a set of the coordinates of all pixels interior to this shape.
+  /// NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match with loops over y then x
+  /// The arguments are the same as for get_owned_spans(), prefer the spans for large shapes
+  virtual std::set<std::pair<int_t,int_t> > get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
+    const int_t cx=0,
+    const int_t cy=0,
+    const scalar_t skin_factor=1.0)const{
+    return spans_to_set(get_owned_spans(shape_function,cx,cy,skin_factor));
   }
 
   /// \brief Method used to turn pixels off that fall inside the shape.
@@ -128,8 +205,7 @@ public:
   virtual ~Polygon(){};
 
   /// See base class documentation
-  // NOTE: The pair is (y,x) not (x,y) so that the ordering in the set will match loops over y then x
-  virtual std::set<std::pair<int_t,int_t> > get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
+  virtual pixel_spans get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
     const int_t cx=0,
     const int_t cy=0,
     const scalar_t skin_factor=1.0)const;
@@ -224,7 +300,7 @@ public:
   virtual ~Circle(){};
 
   /// See base class documentation
-  virtual std::set<std::pair<int_t,int_t> > get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
+  virtual pixel_spans get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
     const int_t cx=0,
     const int_t cy=0,
     const scalar_t skin_factor=1.0)const;
@@ -274,7 +350,7 @@ public:
   virtual ~Rectangle(){};
 
   /// See base class documentation
-  virtual std::set<std::pair<int_t,int_t> > get_owned_pixels(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
+  virtual pixel_spans get_owned_spans(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
     const int_t cx=0,
     const int_t cy=0,
     const scalar_t skin_factor=1.0)const;
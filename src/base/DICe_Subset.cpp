@@ -58,26 +58,29 @@ Subset::is_obstructed_pixel(const scalar_t & coord_x,
   int_t c_y = (int_t)coord_y;
   if(coord_y - (int_t)coord_y >= 0.5) c_y++;
   // now check if c_x and c_y are obstructed
-  // Note the x and y coordinates are switched because that is how they live in the set
-  // this was done for performance in loops over y then x
-  std::pair<int_t,int_t> point(c_y,c_x);
-  const bool obstructed = obstructed_coords_.find(point)!=obstructed_coords_.end();
-  return obstructed;
+  return spans_contain(obstructed_coords_,c_x,c_y);
 }
 
-std::set<std::pair<int_t,int_t> >
-Subset::deformed_shapes(Teuchos::RCP<Local_Shape_Function> shape_function,
+pixel_spans
+Subset::deformed_spans(Teuchos::RCP<Local_Shape_Function> shape_function,
   const int_t cx,
   const int_t cy,
   const scalar_t & skin_factor){
-  std::set<std::pair<int_t,int_t> > coords;
-  if(!is_conformal_) return coords;
+  pixel_spans spans;
+  if(!is_conformal_) return spans;
   for(size_t i=0;i<conformal_subset_def_.boundary()->size();++i){
-    std::set<std::pair<int_t,int_t> > shapeCoords =
-        (*conformal_subset_def_.boundary())[i]->get_owned_pixels(shape_function,cx,cy,skin_factor);
-    coords.insert(shapeCoords.begin(),shapeCoords.end());
+    spans = union_spans(spans,
+      (*conformal_subset_def_.boundary())[i]->get_owned_spans(shape_function,cx,cy,skin_factor));
   }
-  return coords;
+  return spans;
+}
+
+std::set<std::pair<int_t,int_t> >
+Subset::deformed_shapes(Teuchos::RCP<Local_Shape_Function> shape_function,
+  const int_t cx,
+  const int_t cy,
+  const scalar_t & skin_factor){
+  return spans_to_set(deformed_spans(shape_function,cx,cy,skin_factor));
 }
 
 void
@@ -101,8 +104,7 @@ Subset::turn_off_obstructed_pixels(Teuchos::RCP<Local_Shape_Function> shape_func
     if(has_blocks){
       px = ((int_t)(X + 0.5) == (int_t)(X)) ? (int_t)(X) : (int_t)(X) + 1;
       py = ((int_t)(Y + 0.5) == (int_t)(Y)) ? (int_t)(Y) : (int_t)(Y) + 1;
-      if(pixels_blocked_by_other_subsets_.find(std::pair<int_t,int_t>(py,px))
-          !=pixels_blocked_by_other_subsets_.end()){
+      if(spans_contain(pixels_blocked_by_other_subsets_,px,py)){
         is_deactivated_this_step(i) = true;
       }
     }
@@ -290,4 +292,87 @@ Subset::noise_std_dev(Teuchos::RCP<Image> image,
   return variance;
 }
 
+scalar_t
+Subset::trial_gamma(const Teuchos::RCP<Image> & image,
+  const Teuchos::RCP<Local_Shape_Function> & shape_function,
+  const Interpolation_Method interp,
+  const int_t stride){
+  assert(stride>0);
+  // coordinates for points x and y are always in global coordinates
+  const int_t offset_x = image->offset_x();
+  const int_t offset_y = image->offset_y();
+  const int_t w = image->width();
+  const int_t h = image->height();
+  const scalar_t ox=(scalar_t)offset_x,oy=(scalar_t)offset_y;
+  const bool has_blocks = !pixels_blocked_by_other_subsets_.empty();
+  const bool has_channels = image->has_interleaved_channels();
+  // gather the reference and deformed intensities of the pixels that would be active for this deformation
+  std::vector<intensity_t> ref_values;
+  std::vector<intensity_t> def_values;
+  ref_values.reserve(num_pixels()/stride+1);
+  def_values.reserve(num_pixels()/stride+1);
+  intensity_t def_value = 0.0;
+  scalar_t grad_x_value = 0.0;
+  scalar_t grad_y_value = 0.0;
+  scalar_t mapped_x = 0.0;
+  scalar_t mapped_y = 0.0;
+  int_t px,py;
+  for(int_t i=0;i<num_pixels();i+=stride){
+    if(!is_active(i)) continue;
+    shape_function->map(x(i),y(i),cx_,cy_,mapped_x,mapped_y);
+    px = ((int_t)(mapped_x + 0.5) == (int_t)(mapped_x)) ? (int_t)(mapped_x) : (int_t)(mapped_x) + 1;
+    py = ((int_t)(mapped_y + 0.5) == (int_t)(mapped_y)) ? (int_t)(mapped_y) : (int_t)(mapped_y) + 1;
+    if(px<offset_x+4||px>=offset_x+w-4||py<offset_y+4||py>=offset_y+h-4) continue;
+    if(is_obstructed_pixel(mapped_x,mapped_y)) continue;
+    if(has_blocks){
+      if(spans_contain(pixels_blocked_by_other_subsets_,px,py)) continue;
+    }
+    if(interp==BILINEAR){
+      image->interpolate_bilinear_all(def_value,grad_x_value,grad_y_value,false,mapped_x-ox,mapped_y-oy);
+    }
+    else if(interp==BICUBIC){
+      if(has_channels)
+        image->interpolate_bicubic_fused(def_value,grad_x_value,grad_y_value,mapped_x-ox,mapped_y-oy);
+      else
+        image->interpolate_bicubic_all(def_value,grad_x_value,grad_y_value,false,mapped_x-ox,mapped_y-oy);
+    }
+    else if(interp==KEYS_FOURTH){
+      image->interpolate_keys_fourth_all(def_value,grad_x_value,grad_y_value,false,mapped_x-ox,mapped_y-oy);
+    }
+    else{
+      TEUCHOS_TEST_FOR_EXCEPTION(true,std::invalid_argument,
+        "Error, unknown interpolation method requested");
+    }
+    ref_values.push_back(ref_intensities(i));
+    def_values.push_back(def_value);
+  }
+  // same arithmetic as gamma() so that a stride of one gives the same value
+  const int_t num_values = ref_values.size();
+  if(num_values==0) return -1.0;
+  scalar_t mean_ref = 0.0;
+  scalar_t mean_def = 0.0;
+  for(int_t i=0;i<num_values;++i){
+    mean_ref += ref_values[i];
+    mean_def += def_values[i];
+  }
+  mean_ref /= num_values;
+  mean_def /= num_values;
+  scalar_t mean_sum_ref = 0.0;
+  scalar_t mean_sum_def = 0.0;
+  for(int_t i=0;i<num_values;++i){
+    mean_sum_ref += (ref_values[i]-mean_ref)*(ref_values[i]-mean_ref);
+    mean_sum_def += (def_values[i]-mean_def)*(def_values[i]-mean_def);
+  }
+  mean_sum_ref = std::sqrt(mean_sum_ref);
+  mean_sum_def = std::sqrt(mean_sum_def);
+  if(mean_sum_ref==0.0||mean_sum_def==0.0) return -1.0;
+  scalar_t gamma = 0.0;
+  scalar_t value = 0.0;
+  for(int_t i=0;i<num_values;++i){
+    value = (def_values[i]-mean_def)/mean_sum_def - (ref_values[i]-mean_ref)/mean_sum_ref;
+    gamma += value*value;
+  }
+  return gamma;
+}
+
 }// End DICe Namespace
@@ -211,6 +211,17 @@ public:
   /// returns the ZNSSD gamma correlation value between the reference and deformed subsets
   scalar_t gamma();
 
+  /// \brief returns the ZNSSD gamma correlation value for the given deformation without changing the state of the subset
+  /// (pixels are deactivated using the same rules as initialize(), so several threads can evaluate trial deformations at once)
+  /// \param image the deformed image
+  /// \param shape_function the deformation map
+  /// \param interp the interpolation method
+  /// \param stride if greater than one only every stride-th pixel is used (gives a cheap estimate of gamma)
+  scalar_t trial_gamma(const Teuchos::RCP<Image> & image,
+    const Teuchos::RCP<Local_Shape_Function> & shape_function,
+    const Interpolation_Method interp,
+    const int_t stride=1);
+
   /// returns the un-normalized difference between the the reference and deformed intensity values
   scalar_t diff_ref_def() const;
 
@@ -292,11 +303,17 @@ public:
   bool is_obstructed_pixel(const scalar_t & coord_x,
     const scalar_t & coord_y)const;
 
-  /// \brief EXPERIMENTAL Returns a pointer to the set of pixels currently obstructed by another subset
-  std::set<std::pair<int_t,int_t> > * pixels_blocked_by_other_subsets(){
+  /// \brief EXPERIMENTAL Returns a pointer to the spans of pixels currently obstructed by another subset
+  pixel_spans * pixels_blocked_by_other_subsets(){
     return & pixels_blocked_by_other_subsets_;
   }
 
+  /// \brief EXPERIMENTAL Return the pixels covered by the deformed subset boundary as row spans
+  pixel_spans deformed_spans(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
+    const int_t cx=0,
+    const int_t cy=0,
+    const scalar_t & skin_factor=1.0);
+
   /// \brief EXPERIMENTAL Return the deformed geometry information for the subset boundary
   std::set<std::pair<int_t,int_t> > deformed_shapes(Teuchos::RCP<Local_Shape_Function> shape_function=Teuchos::null,
     const int_t cx=0,
@@ -360,14 +377,10 @@ private:
   /// initial x position of the pixels in the reference image
   Teuchos::ArrayRCP<int_t> y_;
 #endif
-  /// \brief EXPERIMENTAL Holds the obstruction coordinates if they exist.
-  /// NOTE: The coordinates are switched for this (i.e. (Y,X)) so that
-  /// the loops over y then x will be more efficient
-  std::set<std::pair<int_t,int_t> > obstructed_coords_;
-  /// \brief EXPERIMENTAL Holds the pixels blocked by other subsets if they exist.
-  /// NOTE: The coordinates are switched for this (i.e. (Y,X)) so that
-  /// the loops over y then x will be more efficient
-  std::set<std::pair<int_t,int_t> > pixels_blocked_by_other_subsets_;
+  /// \brief EXPERIMENTAL Holds the obstruction coordinates as row spans if they exist.
+  pixel_spans obstructed_coords_;
+  /// \brief EXPERIMENTAL Holds the pixels blocked by other subsets as row spans if they exist.
+  pixel_spans pixels_blocked_by_other_subsets_;
   /// centroid location x
   int_t cx_; // assumed to be the middle of the pixel
   /// centroid location y
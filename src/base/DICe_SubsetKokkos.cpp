@@ -151,27 +151,25 @@ Subset::Subset(const int_t cx,
   TEUCHOS_TEST_FOR_EXCEPTION(cx<0,std::invalid_argument,"Error, cannot have negative coordinates for cx");
   TEUCHOS_TEST_FOR_EXCEPTION(cy<0,std::invalid_argument,"Error, cannot have negative coordinates for cy");
   assert(subset_def.has_boundary());
-  std::set<std::pair<int_t,int_t> > coords;
-  for(size_t i=0;i<subset_def.boundary()->size();++i){
-    std::set<std::pair<int_t,int_t> > shapeCoords = (*subset_def.boundary())[i]->get_owned_pixels();
-    coords.insert(shapeCoords.begin(),shapeCoords.end());
-  }
+  pixel_spans spans;
+  for(size_t i=0;i<subset_def.boundary()->size();++i)
+    spans = union_spans(spans,(*subset_def.boundary())[i]->get_owned_spans());
   // warn the user if the centroid is outside the subset
-  std::pair<int_t,int_t> centroid_pair = std::pair<int_t,int_t>(cy_,cx_);
-  if(coords.find(centroid_pair)==coords.end())
+  if(!spans_contain(spans,cx_,cy_))
     std::cout << "*** Warning: centroid " << cx_ << " " << cy_ << " is outside the subset boundary" << std::endl;
-  // at this point all the coordinate pairs are in the set
-  num_pixels_ = coords.size();
+  // at this point all the pixels are in the spans
+  num_pixels_ = num_span_pixels(spans);
   // resize the storage arrays now that the num_pixels is known
   x_ = pixel_coord_dual_view_1d("x",num_pixels_);
   y_ = pixel_coord_dual_view_1d("y",num_pixels_);
   int_t index = 0;
-  // NOTE: the pairs are (y,x) not (x,y) so that the ordering is correct in the set
-  typename std::set<std::pair<int_t,int_t> >::iterator set_it = coords.begin();
-  for( ; set_it!=coords.end();++set_it){
-    x_.h_view(index) = set_it->second;
-    y_.h_view(index) = set_it->first;
-    index++;
+  // the spans are ordered by y then x
+  for(size_t i=0;i<spans.size();++i){
+    for(int_t x=spans[i].x_begin;x<spans[i].x_end;++x){
+      x_.h_view(index) = x;
+      y_.h_view(index) = spans[i].y;
+      index++;
+    }
   }
   x_.modify<host_space>();
   y_.modify<host_space>();
@@ -198,8 +196,7 @@ Subset::Subset(const int_t cx,
   is_active_.sync<device_space>();
   if(subset_def.has_obstructed_area()){
     for(size_t i=0;i<subset_def.obstructed_area()->size();++i){
-      std::set<std::pair<int_t,int_t> > obstructedArea = (*subset_def.obstructed_area())[i]->get_owned_pixels();
-      obstructed_coords_.insert(obstructedArea.begin(),obstructedArea.end());
+      obstructed_coords_ = union_spans(obstructed_coords_,(*subset_def.obstructed_area())[i]->get_owned_spans());
     }
   }
 }
@@ -119,26 +119,24 @@ Subset::Subset(const int_t cx,
   sub_image_id_(0)
 {
   assert(subset_def.has_boundary());
-  std::set<std::pair<int_t,int_t> > coords;
-  for(size_t i=0;i<subset_def.boundary()->size();++i){
-    std::set<std::pair<int_t,int_t> > shapeCoords = (*subset_def.boundary())[i]->get_owned_pixels();
-    coords.insert(shapeCoords.begin(),shapeCoords.end());
-  }
-  // at this point all the coordinate pairs are in the set
-  num_pixels_ = coords.size();
+  pixel_spans spans;
+  for(size_t i=0;i<subset_def.boundary()->size();++i)
+    spans = union_spans(spans,(*subset_def.boundary())[i]->get_owned_spans());
+  // at this point all the pixels are in the spans
+  num_pixels_ = num_span_pixels(spans);
   x_ = Teuchos::ArrayRCP<int_t>(num_pixels_,0);
   y_ = Teuchos::ArrayRCP<int_t>(num_pixels_,0);
   int_t index = 0;
-  // NOTE: the pairs are (y,x) not (x,y) so that the ordering is correct in the set
-  std::set<std::pair<int_t,int_t> >::iterator set_it = coords.begin();
-  for( ; set_it!=coords.end();++set_it){
-    x_[index] = set_it->second;
-    y_[index] = set_it->first;
-    index++;
+  // the spans are ordered by y then x
+  for(size_t i=0;i<spans.size();++i){
+    for(int_t x=spans[i].x_begin;x<spans[i].x_end;++x){
+      x_[index] = x;
+      y_[index] = spans[i].y;
+      index++;
+    }
   }
   // warn the user if the centroid is outside the subset
-  std::pair<int_t,int_t> centroid_pair = std::pair<int_t,int_t>(cy_,cx_);
-  if(coords.find(centroid_pair)==coords.end())
+  if(!spans_contain(spans,cx_,cy_))
     std::cout << "*** Warning: centroid " << cx_ << " " << cy_ << " is outside the subset boundary" << std::endl;
   ref_intensities_ = Teuchos::ArrayRCP<intensity_t>(num_pixels_,0.0);
   def_intensities_ = Teuchos::ArrayRCP<intensity_t>(num_pixels_,0.0);
@@ -157,8 +155,7 @@ Subset::Subset(const int_t cx,
   }
   if(subset_def.has_obstructed_area()){
     for(size_t i=0;i<subset_def.obstructed_area()->size();++i){
-      std::set<std::pair<int_t,int_t> > obstructedArea = (*subset_def.obstructed_area())[i]->get_owned_pixels();
-      obstructed_coords_.insert(obstructedArea.begin(),obstructedArea.end());
+      obstructed_coords_ = union_spans(obstructed_coords_,(*subset_def.obstructed_area())[i]->get_owned_spans());
     }
   }
 }
@@ -388,6 +385,8 @@ Subset::initialize(Teuchos::RCP<Image> image,
   else{
     int_t px,py;
     const bool has_blocks = !pixels_blocked_by_other_subsets_.empty();
+    // use the fused intensity + gradient interpolant if the image has interleaved channels
+    const bool has_channels = image->has_interleaved_channels();
     // initialize the work variables
     scalar_t mapped_x = 0.0;
     scalar_t mapped_y = 0.0;
@@ -406,8 +405,7 @@ Subset::initialize(Teuchos::RCP<Image> image,
         continue;
       }
       if(has_blocks){
-        if(pixels_blocked_by_other_subsets_.find(std::pair<int_t,int_t>(py,px))
-            !=pixels_blocked_by_other_subsets_.end()){
+        if(spans_contain(pixels_blocked_by_other_subsets_,px,py)){
           is_deactivated_this_step(i) = true;
           continue;
         }
@@ -419,8 +417,14 @@ Subset::initialize(Teuchos::RCP<Image> image,
                image->has_gradients(), mapped_x-ox, mapped_y-oy);
       }
       else if(interp==BICUBIC){
-        image->interpolate_bicubic_all(intensities_[i], grad_x_[i], grad_y_[i],
-               image->has_gradients(), mapped_x-ox, mapped_y-oy);
+        if(has_channels){
+          image->interpolate_bicubic_fused(intensities_[i], grad_x_[i], grad_y_[i],
+                 mapped_x-ox, mapped_y-oy);
+        }
+        else{
+          image->interpolate_bicubic_all(intensities_[i], grad_x_[i], grad_y_[i],
+                 image->has_gradients(), mapped_x-ox, mapped_y-oy);
+        }
       }
       else if(interp==KEYS_FOURTH){
         image->interpolate_keys_fourth_all(intensities_[i], grad_x_[i], grad_y_[i],
@@ -53,6 +53,9 @@
 #include <fstream>
 #include <math.h>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
 
 #include <Teuchos_TimeMonitor.hpp>
 
@@ -307,6 +310,105 @@ Phase_Correlation_Initializer::pre_execution_tasks(){
   DEBUG_MSG("Phase_Correlation_Initializer::pre_execution_tasks(): initial displacements ux: " << phase_cor_u_x_ << " uy: " << phase_cor_u_y_);
 }
 
+Local_Phase_Correlation_Initializer::Local_Phase_Correlation_Initializer(Schema * schema,
+  const int_t window_size):
+Initializer(schema),
+window_size_(window_size){
+  if(schema)
+    TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
+    "Local_Phase_Correlation_Initializer cannot be used with rigid body shape function (only field value init is allowed)");
+  if(window_size_<=0){
+    // conformal subsets have no subset_dim so a fixed default is used
+    window_size_ = schema&&schema->subset_dim()>0 ? 2*schema->subset_dim() : 64;
+  }
+  // round up to a size with only small prime factors so the transforms stay fast
+  window_size_ = kiss_fft_next_fast_size(std::max(window_size_,(int_t)16));
+  DEBUG_MSG("Local_Phase_Correlation_Initializer(): window size " << window_size_);
+};
+
+Status_Flag
+Local_Phase_Correlation_Initializer::initial_guess(const int_t subset_gid,
+  Teuchos::RCP<Local_Shape_Function> shape_function){
+  const int_t subset_lid = schema_->subset_local_id(subset_gid);
+  scalar_t shift_x = 0.0;
+  scalar_t shift_y = 0.0;
+  if(subset_lid>=0&&subset_lid<(int_t)shift_valid_.size()&&shift_valid_[subset_lid]==1){
+    shift_x = shift_x_[subset_lid];
+    shift_y = shift_y_[subset_lid];
+  }
+  shape_function->insert_motion(shift_x + schema_->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS),
+    shift_y + schema_->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS),
+    schema_->global_field_value(subset_gid,ROTATION_Z_FS));
+  return INITIALIZE_SUCCESSFUL;
+};
+
+void
+Local_Phase_Correlation_Initializer::pre_execution_tasks(){
+  Teuchos::RCP<Image> prev_img = schema_->prev_img();
+  Teuchos::RCP<Image> def_img = schema_->def_img();
+  assert(prev_img!=Teuchos::null);
+  assert(def_img!=Teuchos::null);
+  const int_t num_subsets = schema_->local_num_subsets();
+  shift_x_.assign(num_subsets,0.0);
+  shift_y_.assign(num_subsets,0.0);
+  shift_valid_.assign(num_subsets,0);
+  const int_t N = window_size_;
+  if(N>prev_img->width()||N>prev_img->height()||N>def_img->width()||N>def_img->height()){
+    DEBUG_MSG("Local_Phase_Correlation_Initializer::pre_execution_tasks(): window size " << N << " is larger than the images, using zero shifts");
+    return;
+  }
+  // window origins (in the local coordinates of each image) are gathered first since the schema fields
+  // are not accessed from the threads, windows near the boundary are shifted to fit inside the image
+  std::vector<int_t> prev_origin_x(num_subsets,0), prev_origin_y(num_subsets,0);
+  std::vector<int_t> def_origin_x(num_subsets,0), def_origin_y(num_subsets,0);
+  for(int_t sid=0;sid<num_subsets;++sid){
+    const int_t cx = (int_t)std::floor(schema_->local_field_value(sid,SUBSET_COORDINATES_X_FS)
+      + schema_->local_field_value(sid,SUBSET_DISPLACEMENT_X_FS) + 0.5);
+    const int_t cy = (int_t)std::floor(schema_->local_field_value(sid,SUBSET_COORDINATES_Y_FS)
+      + schema_->local_field_value(sid,SUBSET_DISPLACEMENT_Y_FS) + 0.5);
+    prev_origin_x[sid] = std::min(std::max(cx - N/2 - prev_img->offset_x(),0),prev_img->width()-N);
+    prev_origin_y[sid] = std::min(std::max(cy - N/2 - prev_img->offset_y(),0),prev_img->height()-N);
+    def_origin_x[sid] = std::min(std::max(cx - N/2 - def_img->offset_x(),0),def_img->width()-N);
+    def_origin_y[sid] = std::min(std::max(cy - N/2 - def_img->offset_y(),0),def_img->height()-N);
+  }
+  // a shift is only trusted if its peak stands above the level expected from uncorrelated windows
+  const scalar_t min_peak = 4.0/N;
+  Teuchos::ArrayRCP<intensity_t> prev_intensities = prev_img->intensities();
+  Teuchos::ArrayRCP<intensity_t> def_intensities = def_img->intensities();
+  const intensity_t * prev_values = prev_intensities.getRawPtr();
+  const intensity_t * def_values = def_intensities.getRawPtr();
+  const int_t prev_w = prev_img->width();
+  const int_t def_w = def_img->width();
+  // make sure the shared FFT plans exist before the threads start
+  fft_plan(N,0);
+  fft_plan(N,1);
+#pragma omp parallel
+  {
+    std::vector<scalar_t> window_a(N*N);
+    std::vector<scalar_t> window_b(N*N);
+#pragma omp for schedule(dynamic)
+    for(int_t sid=0;sid<num_subsets;++sid){
+      for(int_t y=0;y<N;++y){
+        const intensity_t * prev_row = prev_values + (prev_origin_y[sid]+y)*prev_w + prev_origin_x[sid];
+        const intensity_t * def_row = def_values + (def_origin_y[sid]+y)*def_w + def_origin_x[sid];
+        for(int_t x=0;x<N;++x){
+          window_a[y*N+x] = prev_row[x];
+          window_b[y*N+x] = def_row[x];
+        }
+      }
+      scalar_t u_x = 0.0, u_y = 0.0;
+      const scalar_t peak = phase_correlate_windows(N,N,&window_a[0],&window_b[0],u_x,u_y);
+      if(peak>min_peak){
+        // the windows may have been placed differently in the two images
+        shift_x_[sid] = u_x + (def_origin_x[sid] + def_img->offset_x()) - (prev_origin_x[sid] + prev_img->offset_x());
+        shift_y_[sid] = u_y + (def_origin_y[sid] + def_img->offset_y()) - (prev_origin_y[sid] + prev_img->offset_y());
+        shift_valid_[sid] = 1;
+      }
+    }
+  }
+  DEBUG_MSG("Local_Phase_Correlation_Initializer::pre_execution_tasks(): correlated " << num_subsets << " windows of size " << N);
+}
+
 Search_Initializer::Search_Initializer(Schema * schema,
   Teuchos::RCP<Subset> subset,
   const scalar_t & step_size_u,
@@ -314,7 +416,8 @@ Search_Initializer::Search_Initializer(Schema * schema,
   const scalar_t & step_size_v,
   const scalar_t & search_dim_v,
   const scalar_t & step_size_theta,
-  const scalar_t & search_dim_theta):
+  const scalar_t & search_dim_theta,
+  const bool use_integer_pre_search):
 Initializer(schema),
 subset_(subset),
 step_size_u_(step_size_u),
@@ -322,7 +425,8 @@ step_size_v_(step_size_v),
 search_dim_u_(search_dim_u),
 search_dim_v_(search_dim_v),
 step_size_theta_(step_size_theta),
-search_dim_theta_(search_dim_theta){
+search_dim_theta_(search_dim_theta),
+use_integer_pre_search_(use_integer_pre_search){
   if(schema)
     TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
     "Search_Initializer cannot be used with rigid body shape function (only field value init is allowed)");
@@ -341,11 +445,11 @@ Search_Initializer::initial_guess(const int_t subset_gid,
   // start with the input deformation
   scalar_t orig_u = 0.0,orig_v=0.0,orig_t=0.0;
   shape_function->map_to_u_v_theta(subset_->centroid_x(),subset_->centroid_y(),orig_u,orig_v,orig_t);
-  const scalar_t start_u = step_size_u_ < 0.0 ? orig_u : orig_u - search_dim_u_;
-  const scalar_t start_v = step_size_v_ < 0.0 ? orig_v : orig_v - search_dim_v_;
+  scalar_t start_u = step_size_u_ < 0.0 ? orig_u : orig_u - search_dim_u_;
+  scalar_t start_v = step_size_v_ < 0.0 ? orig_v : orig_v - search_dim_v_;
   const scalar_t start_t = step_size_theta_ < 0.0 ? orig_t : orig_t - search_dim_theta_;
-  const scalar_t end_u = step_size_u_ < 0.0 ? orig_u : orig_u + search_dim_u_;
-  const scalar_t end_v = step_size_v_ < 0.0 ? orig_v : orig_v + search_dim_v_;
+  scalar_t end_u = step_size_u_ < 0.0 ? orig_u : orig_u + search_dim_u_;
+  scalar_t end_v = step_size_v_ < 0.0 ? orig_v : orig_v + search_dim_v_;
   const scalar_t end_t = step_size_theta_ < 0.0 ? orig_t : orig_t + search_dim_theta_;
   if(step_size_u_ < 0.0) step_size_u_ = 1.0;
   if(step_size_v_ < 0.0) step_size_v_ = 1.0;
@@ -355,10 +459,28 @@ Search_Initializer::initial_guess(const int_t subset_gid,
   scalar_t min_u = 0.0;
   scalar_t min_v = 0.0;
   scalar_t min_theta = 0.0;
+
+  // for larger translation windows, locate the best integer shift from the raw pixels first
+  // and only warp the subset in a one pixel neighborhood of that shift
+  const scalar_t num_translation_trials = (std::floor((end_u-start_u)/step_size_u_)+1.0)*(std::floor((end_v-start_v)/step_size_v_)+1.0);
+  if(use_integer_pre_search_&&num_translation_trials>9.0){
+    scalar_t int_u = 0.0, int_v = 0.0, int_gamma = 100.0;
+    if(integer_translation_search(start_u,end_u,start_v,end_v,0.5*(start_t+end_t),int_u,int_v,int_gamma)){
+      DEBUG_MSG("Search_Initializer::initial_guess(): integer pre-search best shift u " << int_u << " v " << int_v << " gamma " << int_gamma);
+      if(end_u>start_u){
+        start_u = std::max(start_u,int_u-1.0);
+        end_u = std::min(end_u,int_u+1.0);
+      }
+      if(end_v>start_v){
+        start_v = std::max(start_v,int_v-1.0);
+        end_v = std::min(end_v,int_v+1.0);
+      }
+    }
+  }
   // search in u, v, and theta
   DEBUG_MSG("Search ranges " << start_u << " to " << end_u << " " << start_v << " to " << end_v << " " << start_t << " to " << end_t);
-  for(scalar_t trial_v = start_v;trial_v<=end_v;trial_v+=step_size_u_){
-    for(scalar_t trial_u = start_u;trial_u<=end_u;trial_u+=step_size_v_){
+  for(scalar_t trial_v = start_v;trial_v<=end_v;trial_v+=step_size_v_){
+    for(scalar_t trial_u = start_u;trial_u<=end_u;trial_u+=step_size_u_){
       for(scalar_t trial_t = start_t;trial_t<=end_t;trial_t+=step_size_theta_){
         shape_function->insert_motion(trial_u,trial_v,trial_t);
         subset_->initialize(schema_->def_img(),DEF_INTENSITIES,shape_function);
@@ -395,6 +517,325 @@ Search_Initializer::initial_guess(const int_t subset_gid,
     return INITIALIZE_FAILED;
 };
 
+bool
+Search_Initializer::integer_translation_search(const scalar_t & start_u,
+  const scalar_t & end_u,
+  const scalar_t & start_v,
+  const scalar_t & end_v,
+  const scalar_t & theta,
+  scalar_t & best_u,
+  scalar_t & best_v,
+  scalar_t & best_gamma){
+  Teuchos::RCP<Image> def_img = schema_->def_img();
+  const int_t w = def_img->width();
+  const int_t h = def_img->height();
+  const int_t ox = def_img->offset_x();
+  const int_t oy = def_img->offset_y();
+  const int_t cx = subset_->centroid_x();
+  const int_t cy = subset_->centroid_y();
+  const scalar_t cost = std::cos(theta);
+  const scalar_t sint = std::sin(theta);
+
+  // gather the active pixels at zero displacement (rotated and rounded once) along with the
+  // zero mean, unit norm reference intensities so that each shift only needs three sums
+  const int_t num_pixels = subset_->num_pixels();
+  std::vector<int_t> pixel_x;
+  std::vector<int_t> pixel_y;
+  std::vector<scalar_t> ref_norm;
+  pixel_x.reserve(num_pixels);
+  pixel_y.reserve(num_pixels);
+  ref_norm.reserve(num_pixels);
+  scalar_t mean_ref = 0.0;
+  int_t min_x = w, max_x = -1, min_y = h, max_y = -1;
+  for(int_t i=0;i<num_pixels;++i){
+    if(!subset_->is_active(i)||subset_->is_deactivated_this_step(i)) continue;
+    const scalar_t dx = subset_->x(i) - cx;
+    const scalar_t dy = subset_->y(i) - cy;
+    const int_t px = cx + (int_t)std::floor(cost*dx - sint*dy + 0.5) - ox;
+    const int_t py = cy + (int_t)std::floor(sint*dx + cost*dy + 0.5) - oy;
+    pixel_x.push_back(px);
+    pixel_y.push_back(py);
+    ref_norm.push_back(subset_->ref_intensities(i));
+    mean_ref += subset_->ref_intensities(i);
+    min_x = std::min(min_x,px); max_x = std::max(max_x,px);
+    min_y = std::min(min_y,py); max_y = std::max(max_y,py);
+  }
+  const int_t num_active = static_cast<int_t>(ref_norm.size());
+  if(num_active==0) return false;
+  mean_ref /= num_active;
+  scalar_t ref_norm_sum = 0.0;
+  for(int_t i=0;i<num_active;++i){
+    ref_norm[i] -= mean_ref;
+    ref_norm_sum += ref_norm[i]*ref_norm[i];
+  }
+  if(ref_norm_sum<=0.0) return false;
+  ref_norm_sum = std::sqrt(ref_norm_sum);
+  std::vector<int_t> pixel_index(num_active);
+  for(int_t i=0;i<num_active;++i){
+    ref_norm[i] /= ref_norm_sum;
+    pixel_index[i] = pixel_y[i]*w + pixel_x[i];
+  }
+
+  // integer shifts covering the window (a dimension with no extent is rounded to the nearest pixel)
+  const int_t stride_u = std::max(1,(int_t)std::floor(step_size_u_+0.5));
+  const int_t stride_v = std::max(1,(int_t)std::floor(step_size_v_+0.5));
+  const int_t first_u = end_u>start_u ? (int_t)std::ceil(start_u) : (int_t)std::floor(start_u+0.5);
+  const int_t last_u = end_u>start_u ? (int_t)std::floor(end_u) : first_u;
+  const int_t first_v = end_v>start_v ? (int_t)std::ceil(start_v) : (int_t)std::floor(start_v+0.5);
+  const int_t last_v = end_v>start_v ? (int_t)std::floor(end_v) : first_v;
+
+  Teuchos::ArrayRCP<intensity_t> intensities = def_img->intensities();
+  const intensity_t * def_values = intensities.getRawPtr();
+  bool found = false;
+  best_gamma = 100.0;
+  for(int_t sv=first_v;sv<=last_v;sv+=stride_v){
+    if(min_y+sv<0||max_y+sv>=h) continue;
+    for(int_t su=first_u;su<=last_u;su+=stride_u){
+      if(min_x+su<0||max_x+su>=w) continue;
+      const intensity_t * shifted = def_values + sv*w + su;
+      scalar_t sum_d = 0.0, sum_dd = 0.0, sum_rd = 0.0;
+      for(int_t i=0;i<num_active;++i){
+        const scalar_t d = shifted[pixel_index[i]];
+        sum_d += d;
+        sum_dd += d*d;
+        sum_rd += ref_norm[i]*d;
+      }
+      // the reference is zero mean so the deformed mean drops out of the numerator
+      const scalar_t def_norm_sq = sum_dd - sum_d*sum_d/num_active;
+      if(def_norm_sq<=0.0) continue;
+      const scalar_t gamma = 2.0 - 2.0*sum_rd/std::sqrt(def_norm_sq);
+      if(gamma < best_gamma){
+        best_gamma = gamma;
+        best_u = su;
+        best_v = sv;
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+/// bilinear interpolation of an image in local coordinates (used on the coarse pyramid levels, which carry no gradients)
+/// returns false if the point is outside the image
+inline bool pyramid_sample(const Image & img,
+  const scalar_t & x,
+  const scalar_t & y,
+  scalar_t & value){
+  if(x<0.0||y<0.0) return false;
+  const int_t x1 = (int_t)x;
+  const int_t y1 = (int_t)y;
+  if(x1+1>=img.width()||y1+1>=img.height()) return false;
+  const scalar_t dx = x - x1;
+  const scalar_t dy = y - y1;
+  value = (1.0-dx)*(1.0-dy)*img(x1,y1) + dx*(1.0-dy)*img(x1+1,y1)
+      + (1.0-dx)*dy*img(x1,y1+1) + dx*dy*img(x1+1,y1+1);
+  return true;
+}
+
+/// zero mean normalized residuals of the deformed samples at a position in the local coordinates of a pyramid level
+/// \param img the pyramid level image
+/// \param x x position of the subset centroid
+/// \param y y position of the subset centroid
+/// \param off_x x offsets of the samples from the centroid
+/// \param off_y y offsets of the samples from the centroid
+/// \param ref zero mean, unit norm reference values
+/// \param residuals [out] normalized deformed value minus the reference value for each sample
+/// returns gamma (the sum of the squared residuals) or -1 if a sample is outside the image
+inline scalar_t pyramid_gamma(const Image & img,
+  const scalar_t & x,
+  const scalar_t & y,
+  const std::vector<scalar_t> & off_x,
+  const std::vector<scalar_t> & off_y,
+  const std::vector<scalar_t> & ref,
+  std::vector<scalar_t> & residuals){
+  const int_t n = ref.size();
+  scalar_t mean_def = 0.0;
+  for(int_t i=0;i<n;++i){
+    if(!pyramid_sample(img,x+off_x[i],y+off_y[i],residuals[i])) return -1.0;
+    mean_def += residuals[i];
+  }
+  mean_def /= n;
+  scalar_t norm_def = 0.0;
+  for(int_t i=0;i<n;++i){
+    residuals[i] -= mean_def;
+    norm_def += residuals[i]*residuals[i];
+  }
+  if(norm_def<=0.0) return -1.0;
+  norm_def = std::sqrt(norm_def);
+  scalar_t gamma = 0.0;
+  for(int_t i=0;i<n;++i){
+    residuals[i] = residuals[i]/norm_def - ref[i];
+    gamma += residuals[i]*residuals[i];
+  }
+  return gamma;
+}
+
+Pyramid_Initializer::Pyramid_Initializer(Schema * schema,
+  Teuchos::RCP<Subset> subset):
+Initializer(schema),
+subset_(subset){
+  TEUCHOS_TEST_FOR_EXCEPTION(subset_==Teuchos::null,std::runtime_error,"Error, Pyramid_Initializer requires a subset");
+  if(schema)
+    TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
+    "Pyramid_Initializer cannot be used with rigid body shape function (only field value init is allowed)");
+};
+
+Status_Flag
+Pyramid_Initializer::initial_guess(const int_t subset_gid,
+  Teuchos::RCP<Local_Shape_Function> shape_function){
+  DEBUG_MSG("Pyramid_Initializer::initial_guess(): called for subset " << subset_gid);
+  const int_t num_levels = std::min(schema_->ref_img()->num_pyramid_levels(),
+    schema_->def_img(subset_->sub_image_id())->num_pyramid_levels());
+  if(num_levels<2){
+    DEBUG_MSG("Pyramid_Initializer::initial_guess(): images have no pyramid, leaving the initial guess unchanged");
+    return INITIALIZE_SUCCESSFUL;
+  }
+  scalar_t orig_u = 0.0,orig_v = 0.0,orig_t = 0.0;
+  shape_function->map_to_u_v_theta(subset_->centroid_x(),subset_->centroid_y(),orig_u,orig_v,orig_t);
+  scalar_t u = orig_u;
+  scalar_t v = orig_v;
+  // the coarsest level gets a wider integer search since it has to absorb the error in the incoming guess
+  for(int_t level=num_levels-1;level>=1;--level){
+    const int_t search_radius = level==num_levels-1 ? 2 : 1;
+    const bool level_success = solve_level(level,orig_t,search_radius,u,v);
+    DEBUG_MSG("Pyramid_Initializer::initial_guess(): subset " << subset_gid << " level " << level << " success " << level_success << " u " << u << " v " << v);
+  }
+  // small corrections are left to the optimizer so that any strains in the shape function are preserved
+  if(std::abs(u-orig_u)>0.5||std::abs(v-orig_v)>0.5){
+    shape_function->insert_motion(u,v,orig_t);
+  }
+  return INITIALIZE_SUCCESSFUL;
+}
+
+bool
+Pyramid_Initializer::solve_level(const int_t level,
+  const scalar_t & theta,
+  const int_t search_radius,
+  scalar_t & u,
+  scalar_t & v){
+  Teuchos::RCP<Image> ref_img = schema_->ref_img();
+  Teuchos::RCP<Image> def_img = schema_->def_img(subset_->sub_image_id());
+  const Image & ref_level = *ref_img->pyramid_level(level);
+  const Image & def_level = *def_img->pyramid_level(level);
+  const int_t scale = 1 << level;
+  const scalar_t inv_scale = 1.0/scale;
+  const int_t cx = subset_->centroid_x();
+  const int_t cy = subset_->centroid_y();
+  const scalar_t cost = std::cos(theta);
+  const scalar_t sint = std::sin(theta);
+
+  // reference samples are the subset pixels that fall on this level's grid, the gradients are central
+  // differences of the interpolated level (each sample is one level pixel from its neighbors)
+  const int_t num_pixels = subset_->num_pixels();
+  std::vector<scalar_t> offset_x;
+  std::vector<scalar_t> offset_y;
+  std::vector<scalar_t> ref_values;
+  std::vector<scalar_t> grad_x;
+  std::vector<scalar_t> grad_y;
+  for(int_t i=0;i<num_pixels;++i){
+    if(!subset_->is_active(i)||subset_->is_deactivated_this_step(i)) continue;
+    const int_t dx = subset_->x(i) - cx;
+    const int_t dy = subset_->y(i) - cy;
+    if(dx%scale!=0||dy%scale!=0) continue;
+    const scalar_t rx = (subset_->x(i) - ref_img->offset_x())*inv_scale;
+    const scalar_t ry = (subset_->y(i) - ref_img->offset_y())*inv_scale;
+    scalar_t r = 0.0, r_xm = 0.0, r_xp = 0.0, r_ym = 0.0, r_yp = 0.0;
+    if(!pyramid_sample(ref_level,rx,ry,r)||!pyramid_sample(ref_level,rx-1.0,ry,r_xm)||!pyramid_sample(ref_level,rx+1.0,ry,r_xp)
+        ||!pyramid_sample(ref_level,rx,ry-1.0,r_ym)||!pyramid_sample(ref_level,rx,ry+1.0,r_yp)) continue;
+    offset_x.push_back((cost*dx - sint*dy)*inv_scale);
+    offset_y.push_back((sint*dx + cost*dy)*inv_scale);
+    ref_values.push_back(r);
+    grad_x.push_back(0.5*(r_xp - r_xm));
+    grad_y.push_back(0.5*(r_yp - r_ym));
+  }
+  const int_t num_samples = ref_values.size();
+  // too few samples to be meaningful on this level
+  if(num_samples<16) return false;
+
+  // zero mean, unit norm reference values so that the sum of squared residuals is 2 - 2 ZNCC (same as Subset::gamma())
+  scalar_t mean_ref = 0.0;
+  for(int_t i=0;i<num_samples;++i)
+    mean_ref += ref_values[i];
+  mean_ref /= num_samples;
+  scalar_t norm_ref = 0.0;
+  for(int_t i=0;i<num_samples;++i){
+    ref_values[i] -= mean_ref;
+    norm_ref += ref_values[i]*ref_values[i];
+  }
+  if(norm_ref<=0.0) return false;
+  norm_ref = std::sqrt(norm_ref);
+  scalar_t H_xx = 0.0, H_xy = 0.0, H_yy = 0.0;
+  for(int_t i=0;i<num_samples;++i){
+    ref_values[i] /= norm_ref;
+    grad_x[i] /= norm_ref;
+    grad_y[i] /= norm_ref;
+    H_xx += grad_x[i]*grad_x[i];
+    H_xy += grad_x[i]*grad_y[i];
+    H_yy += grad_y[i]*grad_y[i];
+  }
+  const scalar_t det_H = H_xx*H_yy - H_xy*H_xy;
+  if(det_H<=0.0) return false;
+
+  // the subset centroid in the local coordinates of this level at zero displacement
+  const scalar_t base_x = (cx - def_img->offset_x())*inv_scale;
+  const scalar_t base_y = (cy - def_img->offset_y())*inv_scale;
+  std::vector<scalar_t> residuals(num_samples,0.0);
+
+  const scalar_t start_u = u*inv_scale;
+  const scalar_t start_v = v*inv_scale;
+  scalar_t start_gamma = pyramid_gamma(def_level,base_x+start_u,base_y+start_v,offset_x,offset_y,ref_values,residuals);
+  if(start_gamma<0.0) start_gamma = 4.0; // worst possible match, any valid position is an improvement
+
+  // integer search around the incoming guess
+  scalar_t level_u = start_u;
+  scalar_t level_v = start_v;
+  scalar_t best_gamma = start_gamma;
+  for(int_t j=-search_radius;j<=search_radius;++j){
+    for(int_t i=-search_radius;i<=search_radius;++i){
+      if(i==0&&j==0) continue;
+      const scalar_t gamma = pyramid_gamma(def_level,base_x+start_u+i,base_y+start_v+j,offset_x,offset_y,ref_values,residuals);
+      if(gamma>=0.0&&gamma<best_gamma){
+        best_gamma = gamma;
+        level_u = start_u + i;
+        level_v = start_v + j;
+      }
+    }
+  }
+
+  // Gauss-Newton refinement of the translation (the reference gradients stand in for the deformed gradients)
+  const int_t max_iterations = 25;
+  const scalar_t tol = 0.01; // level pixels
+  const scalar_t max_travel = search_radius + 2.0; // level pixels, beyond this the solve has wandered off
+  scalar_t gn_u = level_u;
+  scalar_t gn_v = level_v;
+  for(int_t it=0;it<max_iterations;++it){
+    if(pyramid_gamma(def_level,base_x+gn_u,base_y+gn_v,offset_x,offset_y,ref_values,residuals)<0.0) break;
+    scalar_t b_x = 0.0, b_y = 0.0;
+    for(int_t i=0;i<num_samples;++i){
+      b_x += grad_x[i]*residuals[i];
+      b_y += grad_y[i]*residuals[i];
+    }
+    const scalar_t delta_u = -(H_yy*b_x - H_xy*b_y)/det_H;
+    const scalar_t delta_v = -(H_xx*b_y - H_xy*b_x)/det_H;
+    gn_u += delta_u;
+    gn_v += delta_v;
+    if(std::abs(gn_u-start_u)>max_travel||std::abs(gn_v-start_v)>max_travel) break;
+    if(std::abs(delta_u)<tol&&std::abs(delta_v)<tol){
+      const scalar_t gamma = pyramid_gamma(def_level,base_x+gn_u,base_y+gn_v,offset_x,offset_y,ref_values,residuals);
+      if(gamma>=0.0&&gamma<best_gamma){
+        best_gamma = gamma;
+        level_u = gn_u;
+        level_v = gn_v;
+      }
+      break;
+    }
+  }
+  if(best_gamma>=start_gamma) return false;
+  u = level_u*scale;
+  v = level_v*scale;
+  return true;
+}
+
 Status_Flag
 Field_Value_Initializer::initial_guess(const int_t subset_gid,
   Teuchos::RCP<Local_Shape_Function> shape_function){
@@ -402,7 +843,7 @@ Field_Value_Initializer::initial_guess(const int_t subset_gid,
   // logic for using neighbor values
   if(schema_->initialization_method()==DICe::USE_NEIGHBOR_VALUES ||
       (schema_->initialization_method()==DICe::USE_NEIGHBOR_VALUES_FIRST_STEP_ONLY && schema_->frame_id()==schema_->first_frame_id())){
-    sid = schema_->global_field_value(subset_gid,NEIGHBOR_ID_FS);
+    sid = schema_->initialization_neighbor_id(subset_gid);
   }
 
   if(sid==-1) // catch case that subset does not have a neighbor
@@ -433,11 +874,325 @@ Field_Value_Initializer::initial_guess(const int_t subset_gid,
   return INITIALIZE_FAILED;
 };
 
+Predictor_Initializer::Predictor_Initializer(Schema * schema,
+  const int_t num_neighbors):
+  Initializer(schema),
+  num_neighbors_(num_neighbors){
+  TEUCHOS_TEST_FOR_EXCEPTION(num_neighbors_<1,std::invalid_argument,"Error, the number of neighbors for the predictor initializer must be positive");
+  if(schema){
+    TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
+      "Predictor_Initializer cannot be used with rigid body shape function (only field value init is allowed)");
+    // the displacement fields are zeroed every frame for the incremental formulation so there is no history to extrapolate
+    TEUCHOS_TEST_FOR_EXCEPTION(schema->use_incremental_formulation(),std::runtime_error,
+      "Predictor_Initializer cannot be used with the incremental formulation");
+  }
+};
+
+void
+Predictor_Initializer::pre_execution_tasks(){
+  const int_t num_subsets = schema_->local_num_subsets();
+  if(point_cloud_==Teuchos::null||(int_t)point_cloud_->pts.size()!=num_subsets){
+    point_cloud_ = Teuchos::rcp(new Point_Cloud_2D<scalar_t>());
+    point_cloud_->pts.resize(num_subsets);
+    for(int_t sid=0;sid<num_subsets;++sid){
+      point_cloud_->pts[sid].x = schema_->local_field_value(sid,SUBSET_COORDINATES_X_FS);
+      point_cloud_->pts[sid].y = schema_->local_field_value(sid,SUBSET_COORDINATES_Y_FS);
+    }
+    DEBUG_MSG("Predictor_Initializer: building the kd-tree");
+    kd_tree_ = Teuchos::rcp(new kd_tree_2d_t(2 /*dim*/, *point_cloud_.get(), nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */) ) );
+    kd_tree_->buildIndex();
+    history_.assign(9*num_subsets,0.0);
+    history_size_.assign(num_subsets,0);
+  }
+  prediction_.assign(3*num_subsets,0.0);
+  visited_.assign(num_subsets,0);
+  // the current field values are the solution of the previous frame, push them onto the history
+  const Field_Spec components[3] = {SUBSET_DISPLACEMENT_X_FS,SUBSET_DISPLACEMENT_Y_FS,ROTATION_Z_FS};
+  const int_t frame_stride = 3*num_subsets;
+  for(int_t sid=0;sid<num_subsets;++sid){
+    // a failed step breaks the history for this subset
+    if(schema_->local_field_value(sid,SIGMA_FS)==-1.0)
+      history_size_[sid] = 0;
+    else
+      history_size_[sid] = std::min(history_size_[sid]+1,3);
+    for(int_t c=0;c<3;++c){
+      const int_t index = c*num_subsets + sid;
+      history_[2*frame_stride + index] = history_[frame_stride + index];
+      history_[frame_stride + index] = history_[index];
+      history_[index] = schema_->local_field_value(sid,components[c]);
+      const scalar_t & h0 = history_[index];
+      const scalar_t & h1 = history_[frame_stride + index];
+      const scalar_t & h2 = history_[2*frame_stride + index];
+      if(history_size_[sid]==3)
+        prediction_[index] = 3.0*h0 - 3.0*h1 + h2;
+      else if(history_size_[sid]==2)
+        prediction_[index] = 2.0*h0 - h1;
+      else
+        prediction_[index] = h0;
+    }
+  }
+}
+
+scalar_t
+Predictor_Initializer::weighted_fit(const scalar_t & query_x,
+  const scalar_t & query_y,
+  const std::vector<scalar_t> & x,
+  const std::vector<scalar_t> & y,
+  const std::vector<scalar_t> & w,
+  const std::vector<scalar_t> & values)const{
+  assert(x.size()==y.size()&&x.size()==w.size()&&x.size()==values.size());
+  assert(x.size()>0);
+  // normal equations for value = a + b*dx + c*dy with the coordinates relative to the query point,
+  // so the value of the fit at the query point is a
+  scalar_t m00 = 0.0, m01 = 0.0, m02 = 0.0, m11 = 0.0, m12 = 0.0, m22 = 0.0;
+  scalar_t r0 = 0.0, r1 = 0.0, r2 = 0.0;
+  for(size_t i=0;i<x.size();++i){
+    const scalar_t dx = x[i] - query_x;
+    const scalar_t dy = y[i] - query_y;
+    m00 += w[i]; m01 += w[i]*dx; m02 += w[i]*dy;
+    m11 += w[i]*dx*dx; m12 += w[i]*dx*dy; m22 += w[i]*dy*dy;
+    r0 += w[i]*values[i]; r1 += w[i]*values[i]*dx; r2 += w[i]*values[i]*dy;
+  }
+  assert(m00>0.0);
+  const scalar_t mean = r0/m00;
+  if(x.size()<3) return mean;
+  const scalar_t c00 = m11*m22 - m12*m12;
+  const scalar_t c01 = m02*m12 - m01*m22;
+  const scalar_t c02 = m01*m12 - m02*m11;
+  const scalar_t det = m00*c00 + m01*c01 + m02*c02;
+  // colinear neighbors do not determine a plane
+  if(std::abs(det) <= 1.0E-6*m00*m11*m22) return mean;
+  return (c00*r0 + c01*r1 + c02*r2)/det;
+}
+
+Status_Flag
+Predictor_Initializer::initial_guess(const int_t subset_gid,
+  Teuchos::RCP<Local_Shape_Function> shape_function){
+  assert(kd_tree_!=Teuchos::null);
+  const int_t sid = schema_->subset_local_id(subset_gid);
+  TEUCHOS_TEST_FOR_EXCEPTION(sid<0||sid>=(int_t)visited_.size(),std::runtime_error,
+    "Error: Only subset ids on this processor can be used for initialization");
+  const int_t num_subsets = visited_.size();
+  visited_[sid] = 1;
+  const bool has_history = history_size_[sid]>0;
+  const scalar_t cx = point_cloud_->pts[sid].x;
+  const scalar_t cy = point_cloud_->pts[sid].y;
+  // the closest point is the subset itself
+  const size_t num_search = std::min(num_neighbors_+1,num_subsets);
+  scalar_t query_pt[2];
+  query_pt[0] = cx;
+  query_pt[1] = cy;
+  std::vector<size_t> ret_index(num_search);
+  std::vector<scalar_t> out_dist_sqr(num_search);
+  kd_tree_->knnSearch(&query_pt[0], num_search, &ret_index[0], &out_dist_sqr[0]);
+
+  // gather the neighbors that have converged in this frame, if this subset has a temporal prediction
+  // the neighbors contribute how far off their own prediction was, otherwise their values are used directly
+  const Field_Spec components[3] = {SUBSET_DISPLACEMENT_X_FS,SUBSET_DISPLACEMENT_Y_FS,ROTATION_Z_FS};
+  std::vector<scalar_t> neigh_x;
+  std::vector<scalar_t> neigh_y;
+  std::vector<scalar_t> neigh_w;
+  std::vector<scalar_t> neigh_values[3];
+  for(size_t i=0;i<num_search;++i){
+    const int_t neigh = ret_index[i];
+    if(neigh==sid||visited_[neigh]==0) continue;
+    if(schema_->local_field_value(neigh,SIGMA_FS)==-1.0) continue;
+    if(has_history&&history_size_[neigh]==0) continue;
+    neigh_x.push_back(point_cloud_->pts[neigh].x);
+    neigh_y.push_back(point_cloud_->pts[neigh].y);
+    neigh_w.push_back(1.0/(1.0 + out_dist_sqr[i]));
+    for(int_t c=0;c<3;++c){
+      const scalar_t offset = has_history ? prediction_[c*num_subsets + neigh] : 0.0;
+      neigh_values[c].push_back(schema_->local_field_value(neigh,components[c]) - offset);
+    }
+  }
+  if(!has_history&&neigh_x.empty())
+    return INITIALIZE_FAILED;
+  scalar_t motion[3];
+  for(int_t c=0;c<3;++c){
+    motion[c] = has_history ? prediction_[c*num_subsets + sid] : 0.0;
+    if(!neigh_x.empty())
+      motion[c] += weighted_fit(cx,cy,neigh_x,neigh_y,neigh_w,neigh_values[c]);
+  }
+  DEBUG_MSG("Predictor_Initializer::initial_guess(): subset " << subset_gid << " history size " << history_size_[sid] <<
+    " converged neighbors " << neigh_x.size() << " u: " << motion[0] << " v: " << motion[1] << " theta: " << motion[2]);
+  shape_function->initialize_parameters_from_fields(schema_,subset_gid);
+  shape_function->insert_motion(motion[0],motion[1],motion[2]);
+  return INITIALIZE_SUCCESSFUL;
+};
+
+Motion_Model_Initializer::Motion_Model_Initializer(Schema * schema,
+  const scalar_t & displacement_noise,
+  const scalar_t & rotation_noise):
+  Initializer(schema){
+  TEUCHOS_TEST_FOR_EXCEPTION(displacement_noise<=0.0||rotation_noise<=0.0,std::invalid_argument,
+    "Error, the measurement noise for the motion model initializer must be positive");
+  noise_[0] = displacement_noise;
+  noise_[1] = displacement_noise;
+  noise_[2] = rotation_noise;
+  if(schema){
+    TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
+      "Motion_Model_Initializer cannot be used with rigid body shape function (only field value init is allowed)");
+    // the displacement fields are zeroed every frame for the incremental formulation so there is nothing to follow
+    TEUCHOS_TEST_FOR_EXCEPTION(schema->use_incremental_formulation(),std::runtime_error,
+      "Motion_Model_Initializer cannot be used with the incremental formulation");
+  }
+};
+
+void
+Motion_Model_Initializer::update(const int_t index,
+  const scalar_t & value){
+  scalar_t * x = &state_[3*index];
+  scalar_t * P = &covariance_[9*index];
+  const int_t component = index/(int_t)active_.size();
+  const scalar_t r = noise_[component]*noise_[component];
+  // only the value is measured
+  const scalar_t innovation = value - x[0];
+  const scalar_t S = P[0] + r;
+  const scalar_t K[3] = {P[0]/S,P[3]/S,P[6]/S};
+  for(int_t i=0;i<3;++i)
+    x[i] += K[i]*innovation;
+  const scalar_t P0[3] = {P[0],P[1],P[2]};
+  for(int_t i=0;i<3;++i)
+    for(int_t j=0;j<3;++j)
+      P[3*i+j] -= K[i]*P0[j];
+}
+
+void
+Motion_Model_Initializer::predict(const int_t index){
+  // one frame of constant acceleration motion, the process noise is a white jerk with
+  // the same standard deviation as the measurements
+  static const scalar_t F[9] = {1.0,1.0,0.5, 0.0,1.0,1.0, 0.0,0.0,1.0};
+  static const scalar_t Q[9] = {1.0/20.0,1.0/8.0,1.0/6.0, 1.0/8.0,1.0/3.0,1.0/2.0, 1.0/6.0,1.0/2.0,1.0};
+  scalar_t * x = &state_[3*index];
+  scalar_t * P = &covariance_[9*index];
+  const int_t component = index/(int_t)active_.size();
+  const scalar_t q = noise_[component]*noise_[component];
+  const scalar_t x_prev[3] = {x[0],x[1],x[2]};
+  for(int_t i=0;i<3;++i){
+    x[i] = 0.0;
+    for(int_t k=0;k<3;++k)
+      x[i] += F[3*i+k]*x_prev[k];
+  }
+  scalar_t FP[9];
+  for(int_t i=0;i<3;++i){
+    for(int_t j=0;j<3;++j){
+      FP[3*i+j] = 0.0;
+      for(int_t k=0;k<3;++k)
+        FP[3*i+j] += F[3*i+k]*P[3*k+j];
+    }
+  }
+  for(int_t i=0;i<3;++i){
+    for(int_t j=0;j<3;++j){
+      P[3*i+j] = q*Q[3*i+j];
+      for(int_t k=0;k<3;++k)
+        P[3*i+j] += FP[3*i+k]*F[3*j+k];
+    }
+  }
+}
+
+void
+Motion_Model_Initializer::pre_execution_tasks(){
+  const int_t num_subsets = schema_->local_num_subsets();
+  if((int_t)active_.size()!=num_subsets){
+    state_.assign(9*num_subsets,0.0);
+    covariance_.assign(27*num_subsets,0.0);
+    active_.assign(num_subsets,0);
+    missed_frames_.assign(num_subsets,0);
+  }
+  // number of frames a subset can coast on its prediction before the filter is restarted
+  const int_t max_missed_frames = 3;
+  // the current field values are the solution of the previous frame
+  const Field_Spec components[3] = {SUBSET_DISPLACEMENT_X_FS,SUBSET_DISPLACEMENT_Y_FS,ROTATION_Z_FS};
+  for(int_t sid=0;sid<num_subsets;++sid){
+    const bool converged = schema_->local_field_value(sid,SIGMA_FS)!=-1.0;
+    if(!converged){
+      missed_frames_[sid]++;
+      if(missed_frames_[sid]>max_missed_frames)
+        active_[sid] = 0;
+      if(!active_[sid]) continue;
+    }
+    for(int_t c=0;c<3;++c){
+      const int_t index = c*num_subsets + sid;
+      if(converged&&!active_[sid]){
+        // start at the converged value, the rate and acceleration are not known yet
+        const scalar_t initial_std_dev = 100.0*noise_[c];
+        for(int_t i=0;i<9;++i)
+          covariance_[9*index+i] = 0.0;
+        covariance_[9*index] = noise_[c]*noise_[c];
+        covariance_[9*index+4] = initial_std_dev*initial_std_dev;
+        covariance_[9*index+8] = initial_std_dev*initial_std_dev;
+        state_[3*index] = schema_->local_field_value(sid,components[c]);
+        state_[3*index+1] = 0.0;
+        state_[3*index+2] = 0.0;
+      }
+      else if(converged){
+        update(index,schema_->local_field_value(sid,components[c]));
+      }
+      predict(index);
+    }
+    if(converged){
+      active_[sid] = 1;
+      missed_frames_[sid] = 0;
+    }
+  }
+}
+
+bool
+Motion_Model_Initializer::prediction(const int_t subset_gid,
+  scalar_t * motion,
+  scalar_t * std_dev)const{
+  const int_t sid = schema_->subset_local_id(subset_gid);
+  if(sid<0||sid>=(int_t)active_.size()||!active_[sid]) return false;
+  const int_t num_subsets = active_.size();
+  for(int_t c=0;c<3;++c){
+    const int_t index = c*num_subsets + sid;
+    motion[c] = state_[3*index];
+    std_dev[c] = std::sqrt(covariance_[9*index]);
+  }
+  return true;
+}
+
+scalar_t
+Motion_Model_Initializer::search_dim(const int_t subset_gid,
+  const scalar_t & step,
+  const scalar_t & max_dim)const{
+  scalar_t motion[3];
+  scalar_t std_dev[3];
+  if(!prediction(subset_gid,motion,std_dev)) return max_dim;
+  const scalar_t predicted_dim = std::ceil(3.0*std::max(std_dev[0],std_dev[1]));
+  return std::min(max_dim,std::max(step,predicted_dim));
+}
+
+Status_Flag
+Motion_Model_Initializer::initial_guess(const int_t subset_gid,
+  Teuchos::RCP<Local_Shape_Function> shape_function){
+  TEUCHOS_TEST_FOR_EXCEPTION(schema_->subset_local_id(subset_gid)<0,std::runtime_error,
+    "Error: Only subset ids on this processor can be used for initialization");
+  scalar_t motion[3];
+  scalar_t std_dev[3];
+  if(!prediction(subset_gid,motion,std_dev)){
+    // no filter for this subset yet, fall back to the last converged values
+    if(schema_->global_field_value(subset_gid,SIGMA_FS)==-1.0)
+      return INITIALIZE_FAILED;
+    shape_function->initialize_parameters_from_fields(schema_,subset_gid);
+    return INITIALIZE_USING_PREVIOUS_FRAME_SUCCESSFUL;
+  }
+  DEBUG_MSG("Motion_Model_Initializer::initial_guess(): subset " << subset_gid << " u: " << motion[0] << " (" << std_dev[0] <<
+    ") v: " << motion[1] << " (" << std_dev[1] << ") theta: " << motion[2] << " (" << std_dev[2] << ")");
+  shape_function->initialize_parameters_from_fields(schema_,subset_gid);
+  shape_function->insert_motion(motion[0],motion[1],motion[2]);
+  return INITIALIZE_SUCCESSFUL;
+};
+
 Feature_Matching_Initializer::Feature_Matching_Initializer(Schema * schema,
-  const int_t threshold_block_size):
+  const int_t threshold_block_size,
+  const int_t roi_margin):
   Initializer(schema),
   threshold_block_size_(threshold_block_size),
+  roi_margin_(roi_margin),
   first_call_(true){
+  matcher_ = Teuchos::rcp(new Feature_Matcher(threshold_block_size_));
   if(schema)
     TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
     "Feature_Matching_Initializer cannot be used with rigid body shape function (only field value init is allowed)");
@@ -449,6 +1204,22 @@ Feature_Matching_Initializer::pre_execution_tasks(){
   assert(schema_->def_img()!=Teuchos::null);
   if(first_call_){
     prev_img_ = schema_->ref_img();
+    // restrict the features to the area around the subsets
+    if(roi_margin_>=0&&schema_->local_num_subsets()>0){
+      const int_t half_size = schema_->subset_dim() > 0 ? schema_->subset_dim()/2 : 0;
+      scalar_t min_x = schema_->local_field_value(0,SUBSET_COORDINATES_X_FS);
+      scalar_t min_y = schema_->local_field_value(0,SUBSET_COORDINATES_Y_FS);
+      scalar_t max_x = min_x;
+      scalar_t max_y = min_y;
+      for(int_t i=1;i<schema_->local_num_subsets();++i){
+        min_x = std::min(min_x,(scalar_t)schema_->local_field_value(i,SUBSET_COORDINATES_X_FS));
+        min_y = std::min(min_y,(scalar_t)schema_->local_field_value(i,SUBSET_COORDINATES_Y_FS));
+        max_x = std::max(max_x,(scalar_t)schema_->local_field_value(i,SUBSET_COORDINATES_X_FS));
+        max_y = std::max(max_y,(scalar_t)schema_->local_field_value(i,SUBSET_COORDINATES_Y_FS));
+      }
+      matcher_->set_roi((int_t)min_x - half_size - roi_margin_,(int_t)min_y - half_size - roi_margin_,
+        (int_t)max_x + half_size + roi_margin_,(int_t)max_y + half_size + roi_margin_);
+    }
   }
   // read both images and match features between them
   std::vector<scalar_t> left_x;
@@ -462,14 +1233,14 @@ Feature_Matching_Initializer::pre_execution_tasks(){
     std::stringstream outname;
     create_directory(".dice");
     outname << ".dice/fm_initializer_" << schema_->mesh()->get_comm()->get_rank() << ".png";
-    match_features(prev_img_,schema_->def_img(0),left_x,left_y,right_x,right_y,tol,outname.str(),threshold_block_size_);
+    matcher_->match(prev_img_,schema_->def_img(0),left_x,left_y,right_x,right_y,tol,outname.str());
     int_t num_matches = left_x.size();
     DEBUG_MSG("number of features matched: " << num_matches);
     // test if not enough features were found, if so try a tighter tolerance
     if(num_matches < 50){
       DEBUG_MSG("did not find enough features, attempting again with tighter tolerance");
       const float tight_tol = 0.001f;
-      match_features(prev_img_,schema_->def_img(0),left_x,left_y,right_x,right_y,tight_tol,outname.str(),threshold_block_size_);
+      matcher_->match(prev_img_,schema_->def_img(0),left_x,left_y,right_x,right_y,tight_tol,outname.str());
       num_matches = left_x.size();
     }
     TEUCHOS_TEST_FOR_EXCEPTION(num_matches < 10,std::runtime_error,"Error, not enough features matched for feature matching initializer./n"
@@ -660,6 +1431,9 @@ Zero_Value_Initializer::initial_guess(const int_t subset_gid,
 };
 
 
+/// separable weights of the 13 pixel optical flow window
+static const scalar_t optical_flow_window_weights[13] = {0.51,0.64,0.84,0.91,0.96,0.99,1.0,0.99,0.96,0.91,0.84,0.64,0.51};
+
 Optical_Flow_Initializer::Optical_Flow_Initializer(Schema * schema,
   Teuchos::RCP<Subset> subset):
   Initializer(schema),
@@ -685,7 +1459,8 @@ Optical_Flow_Initializer::Optical_Flow_Initializer(Schema * schema,
   ref_cy_(0.0),
   initial_u_(0.0),
   initial_v_(0.0),
-  initial_t_(0.0)
+  initial_t_(0.0),
+  has_flow_update_(false)
  {
   if(schema)
     TEUCHOS_TEST_FOR_EXCEPTION(schema->shape_function_type()==DICe::RIGID_BODY_SF,std::runtime_error,
@@ -716,21 +1491,15 @@ Optical_Flow_Initializer::Optical_Flow_Initializer(Schema * schema,
     }
   }
   // create the window coefficients
-  std::vector<scalar_t> coeffs(13,0.0);
-//  coeffs[0] = 0.000; coeffs[1] = 0.0046; coeffs[2] = 0.03255; coeffs[3] = 0.1455; coeffs[4] = 0.42474; coeffs[5] = 0.80735;
-//  coeffs[6] = 1.0;
-//  coeffs[7] = 0.80735; coeffs[8] = 0.42474; coeffs[9] = 0.1455; coeffs[10] = 0.03255; coeffs[11] = 0.0046; coeffs[12] = 0.000;
-  coeffs[0] = 0.51; coeffs[1] = 0.64; coeffs[2] = 0.84; coeffs[3] = 0.91; coeffs[4] = 0.96; coeffs[5] = 0.99;
-  coeffs[6] = 1.0;
-  coeffs[7] = 0.99; coeffs[8] = 0.96; coeffs[9] = 0.91; coeffs[10] = 0.84; coeffs[11] = 0.64; coeffs[12] = 0.51;
-
   for(int_t j=0;j<window_size_;++j){
     for(int_t i=0;i<window_size_;++i){
-      window_coeffs_[i][j] = coeffs[i]*coeffs[j];
+      window_coeffs_[i][j] = optical_flow_window_weights[i]*optical_flow_window_weights[j];
     }
   }
   ids_[0] = 0;
   ids_[1] = 0;
+  flow_update_x_[0] = 0.0; flow_update_x_[1] = 0.0;
+  flow_update_y_[0] = 0.0; flow_update_y_[1] = 0.0;
 }
 
 bool
@@ -921,6 +1690,143 @@ Optical_Flow_Initializer::set_locations(const int_t subset_gid){
   return INITIALIZE_SUCCESSFUL;
 }
 
+/// returns true if the solve for this subset is skipped in the current frame
+/// (the optical flow points then keep accumulating their displacements)
+static bool
+optical_flow_solve_skipped(Schema * schema,
+  const int_t subset_gid){
+  bool skip_solve = false;
+  if(schema->skip_solve_flags()->find(subset_gid)!=schema->skip_solve_flags()->end()){
+    skip_solve = frame_should_be_skipped(schema->frame_id(),schema->skip_solve_flags()->find(subset_gid)->second);
+  }
+  if(schema->skip_all_solves())
+    skip_solve = true;
+  return skip_solve;
+}
+
+bool
+Optical_Flow_Initializer::flow_points(const int_t subset_gid,
+  scalar_t * pt_x,
+  scalar_t * pt_y){
+  assert(schema_->prev_img()!=Teuchos::null);
+  has_flow_update_ = false;
+  if(reset_locations_==false){
+    if(is_near_deactivated(ids_[0])||is_near_deactivated(ids_[1]))
+      reset_locations_=true;
+  }
+  if(reset_locations_){
+    // initial_guess() will fall back to the field values
+    if(set_locations(subset_gid)!=INITIALIZE_SUCCESSFUL) return false;
+  }
+  // move the points to the last converged solution unless the solve was skipped
+  if(!optical_flow_solve_skipped(schema_,subset_gid)){
+    Teuchos::RCP<Local_Shape_Function> shape_function = shape_function_factory(schema_);
+    shape_function->initialize_parameters_from_fields(schema_,subset_gid);
+    const int_t cx = subset_->centroid_x();
+    const int_t cy = subset_->centroid_y();
+    shape_function->map(subset_->x(ids_[0]),subset_->y(ids_[0]),cx,cy,current_pt1_x_,current_pt1_y_);
+    shape_function->map(subset_->x(ids_[1]),subset_->y(ids_[1]),cx,cy,current_pt2_x_,current_pt2_y_);
+  }
+  pt_x[0] = current_pt1_x_;
+  pt_y[0] = current_pt1_y_;
+  pt_x[1] = current_pt2_x_;
+  pt_y[1] = current_pt2_y_;
+  return true;
+}
+
+void
+Optical_Flow_Initializer::track_points(Teuchos::RCP<Image> prev_img,
+  Teuchos::RCP<Image> def_img,
+  const std::vector<scalar_t> & pt_x,
+  const std::vector<scalar_t> & pt_y,
+  std::vector<scalar_t> & update_x,
+  std::vector<scalar_t> & update_y){
+  TEUCHOS_TEST_FOR_EXCEPTION(prev_img==Teuchos::null||def_img==Teuchos::null,std::runtime_error,
+    "Error, the previous and deformed images must be set for optical flow");
+  TEUCHOS_TEST_FOR_EXCEPTION(pt_x.size()!=pt_y.size(),std::runtime_error,"Error, point coordinate arrays must be the same size");
+  const int_t num_points = pt_x.size();
+  update_x.assign(num_points,0.0);
+  update_y.assign(num_points,0.0);
+  // gather the pyramid levels up front so that no reference counts are touched by the threads
+  const int_t num_levels = std::min(prev_img->num_pyramid_levels(),def_img->num_pyramid_levels());
+  std::vector<const Image*> prev_levels(num_levels,prev_img.get());
+  std::vector<const Image*> def_levels(num_levels,def_img.get());
+  for(int_t level=1;level<num_levels;++level){
+    prev_levels[level] = prev_img->pyramid_level(level).get();
+    def_levels[level] = def_img->pyramid_level(level).get();
+  }
+  DEBUG_MSG("Optical_Flow_Initializer::track_points(): tracking " << num_points << " points using " << num_levels << " pyramid level(s)");
+  static const scalar_t grad_coeffs[5] = {-1.0,8.0,0.0,-8.0,1.0};
+  const int_t window_size = 13;
+  const int_t half_window_size = 7;
+#pragma omp parallel for schedule(dynamic) if(num_points>2)
+  for(int_t pt=0;pt<num_points;++pt){
+    // nearest pixel to the point in the full resolution image
+    int_t px = (int_t)pt_x[pt];
+    if(pt_x[pt] - (int_t)(pt_x[pt]) >= 0.5) px++;
+    int_t py = (int_t)pt_y[pt];
+    if(pt_y[pt] - (int_t)(pt_y[pt]) >= 0.5) py++;
+    // displacement estimate in the pixels of the current level
+    scalar_t guess_x = 0.0;
+    scalar_t guess_y = 0.0;
+    for(int_t level=num_levels-1;level>=0;--level){
+      const Image * prev = prev_levels[level];
+      const Image * def = def_levels[level];
+      const int_t prev_w = prev->width();
+      const int_t prev_h = prev->height();
+      const int_t def_w = def->width();
+      const int_t def_h = def->height();
+      const scalar_t scale = static_cast<scalar_t>(1 << level);
+      const int_t cx = (int_t)std::floor(px/scale + 0.5);
+      const int_t cy = (int_t)std::floor(py/scale + 0.5);
+      // the deformed window is shifted by the estimate from the coarser levels
+      const int_t shift_x = (int_t)std::floor(guess_x + 0.5);
+      const int_t shift_y = (int_t)std::floor(guess_y + 0.5);
+      scalar_t H00 = 0.0, H01 = 0.0, H11 = 0.0;
+      scalar_t q0 = 0.0, q1 = 0.0;
+      for(int_t j=0;j<window_size;++j){
+        const int_t y = cy - half_window_size + j;
+        if(y<2||y>=prev_h-2||y+shift_y<0||y+shift_y>=def_h) continue;
+        for(int_t i=0;i<window_size;++i){
+          const int_t x = cx - half_window_size + i;
+          if(x<2||x>=prev_w-2||x+shift_x<0||x+shift_x>=def_w) continue;
+          // gradients from the previous image
+          scalar_t Ix = 0.0;
+          scalar_t Iy = 0.0;
+          for(int_t k=0;k<5;++k){
+            Ix += (-1.0/12.0)*grad_coeffs[k]*(*prev)(x-2+k,y);
+            Iy += (-1.0/12.0)*grad_coeffs[k]*(*prev)(x,y-2+k);
+          }
+          const scalar_t It = (*def)(x+shift_x,y+shift_y) - (*prev)(x,y);
+          const scalar_t w_coeff = optical_flow_window_weights[i]*optical_flow_window_weights[j];
+          const scalar_t w_coeff_sq = w_coeff*w_coeff;
+          H00 += Ix*Ix*w_coeff_sq;
+          H01 += Ix*Iy*w_coeff_sq;
+          H11 += Iy*Iy*w_coeff_sq;
+          q0 += Ix*It*w_coeff_sq;
+          q1 += Iy*It*w_coeff_sq;
+        }
+      }
+      // solve the 2x2 system directly
+      scalar_t delta_x = 0.0;
+      scalar_t delta_y = 0.0;
+      const scalar_t det = H00*H11 - H01*H01;
+      if(det!=0.0){
+        delta_x = -(H11*q0 - H01*q1)/det;
+        delta_y = -(H00*q1 - H01*q0)/det;
+      }
+      guess_x = shift_x + delta_x;
+      guess_y = shift_y + delta_y;
+      if(level>0){
+        guess_x *= 2.0;
+        guess_y *= 2.0;
+      }
+    }
+    update_x[pt] = guess_x;
+    update_y[pt] = guess_y;
+  }
+}
+
 Status_Flag
 Optical_Flow_Initializer::initial_guess(const int_t subset_gid,
   Teuchos::RCP<Local_Shape_Function> shape_function){
@@ -935,119 +1841,60 @@ Optical_Flow_Initializer::initial_guess(const int_t subset_gid,
     if(is_near_deactivated(ids_[0])||is_near_deactivated(ids_[1]))
       reset_locations_=true;
   }
+  // the batched result is only valid for the first call in this frame and if the points have not moved since
+  const bool use_flow_update = has_flow_update_&&!reset_locations_;
+  has_flow_update_ = false;
 
-  if(reset_locations_){
-    Status_Flag location_flag = set_locations(subset_gid);
-    if(location_flag!=INITIALIZE_SUCCESSFUL) {
-      DEBUG_MSG("Optical_Flow_Initializer::initial_guess() set_locations FAILURE, using field values to initialize");
-      shape_function->insert_motion(schema_->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS),
-        schema_->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS),
-        schema_->global_field_value(subset_gid,ROTATION_Z_FS));
-      return INITIALIZE_SUCCESSFUL;
-    }
+  scalar_t update_x[2] = {0.0,0.0};
+  scalar_t update_y[2] = {0.0,0.0};
+  if(use_flow_update){
+    DEBUG_MSG("Optical_Flow_Initializer::initial_guess() using the displacements from the batched tracking pass");
+    update_x[0] = flow_update_x_[0];
+    update_x[1] = flow_update_x_[1];
+    update_y[0] = flow_update_y_[0];
+    update_y[1] = flow_update_y_[1];
   }
+  else{
+    if(reset_locations_){
+      Status_Flag location_flag = set_locations(subset_gid);
+      if(location_flag!=INITIALIZE_SUCCESSFUL) {
+        DEBUG_MSG("Optical_Flow_Initializer::initial_guess() set_locations FAILURE, using field values to initialize");
+        shape_function->insert_motion(schema_->global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS),
+          schema_->global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS),
+          schema_->global_field_value(subset_gid,ROTATION_Z_FS));
+        return INITIALIZE_SUCCESSFUL;
+      }
+    }
 
-  // check if the solve was skipped, if not use the last converged solution for the
-  // new position of the optical flow points
-  bool skip_solve = false;
-
-  if(schema_->skip_solve_flags()->find(subset_gid)!=schema_->skip_solve_flags()->end()){
-    skip_solve = frame_should_be_skipped(schema_->frame_id(),schema_->skip_solve_flags()->find(subset_gid)->second);
-  }
-  if(schema_->skip_all_solves())
-    skip_solve = true;
+    // check if the solve was skipped, if not use the last converged solution for the
+    // new position of the optical flow points
+    if(!optical_flow_solve_skipped(schema_,subset_gid)){
+      const int_t cx = subset_->centroid_x();
+      const int_t cy = subset_->centroid_y();
+      // compute the deformed shape:
+      // mapped location
+      shape_function->map(subset_->x(ids_[0]),subset_->y(ids_[0]),cx,cy,current_pt1_x_,current_pt1_y_);
+      // mapped location
+      shape_function->map(subset_->x(ids_[1]),subset_->y(ids_[1]),cx,cy,current_pt2_x_,current_pt2_y_);
+    }
 
-  // reset the current locations of the optical flow points based on the last solution
-  if(!skip_solve){
-    const int_t cx = subset_->centroid_x();
-    const int_t cy = subset_->centroid_y();
-    // compute the deformed shape:
-    // mapped location
-    shape_function->map(subset_->x(ids_[0]),subset_->y(ids_[0]),cx,cy,current_pt1_x_,current_pt1_y_);
-    // mapped location
-    shape_function->map(subset_->x(ids_[1]),subset_->y(ids_[1]),cx,cy,current_pt2_x_,current_pt2_y_);
+    // do the optical flow about these points...
+    std::vector<scalar_t> pt_x(2,0.0);
+    std::vector<scalar_t> pt_y(2,0.0);
+    pt_x[0] = current_pt1_x_; pt_y[0] = current_pt1_y_;
+    pt_x[1] = current_pt2_x_; pt_y[1] = current_pt2_y_;
+    std::vector<scalar_t> pt_update_x;
+    std::vector<scalar_t> pt_update_y;
+    track_points(schema_->prev_img(),schema_->def_img(),pt_x,pt_y,pt_update_x,pt_update_y);
+    for(int_t pt=0;pt<2;++pt){
+      update_x[pt] = pt_update_x[pt];
+      update_y[pt] = pt_update_y[pt];
+    }
   }
-
-  int_t pt_def_x[2] = {0,0};
-  int_t pt_def_y[2] = {0,0};
-  // find the nearest pixel for the updated location
-  pt_def_x[0] = (int_t)current_pt1_x_;
-  if(current_pt1_x_ - (int_t)(current_pt1_x_) >= 0.5) pt_def_x[0]++;
-  pt_def_y[0] = (int_t)current_pt1_y_;
-  if(current_pt1_y_ - (int_t)(current_pt1_y_) >= 0.5) pt_def_y[0]++;
-  pt_def_x[1] = (int_t)current_pt2_x_;
-  if(current_pt2_x_ - (int_t)(current_pt2_x_) >= 0.5) pt_def_x[1]++;
-  pt_def_y[1] = (int_t)current_pt2_y_;
-  if(current_pt2_y_ - (int_t)(current_pt2_y_) >= 0.5) pt_def_y[1]++;
-  static scalar_t grad_coeffs[5] = {-1.0,8.0,0.0,-8.0,1.0};
-
-  // do the optical flow about these points...
-  const int N = 2;
-  Teuchos::SerialDenseMatrix<int,double> H(N,N, true);
-  Teuchos::ArrayRCP<double> q(N,0.0);
-  int *IPIV = new int[N+1];
-  double *EIGS = new double[N+1];
-  int LWORK = N*N;
-  int QWORK = 3*N;
-  int INFO = 0;
-  double *WORK = new double[LWORK];
-  double *SWORK = new double[QWORK];
-  Teuchos::LAPACK<int,double> lapack;
-
-  scalar_t update_x[2] = {0.0,0.0};
-  scalar_t update_y[2] = {0.0,0.0};
   for(int_t pt=0;pt<2;++pt){
-    // clear the values of H and q
-    H(0,0) = 0.0;
-    H(1,0) = 0.0;
-    H(0,1) = 0.0;
-    H(1,1) = 0.0;
-    q[0] = 0.0;
-    q[1] = 0.0;
-    scalar_t Ix = 0.0;
-    scalar_t Iy = 0.0;
-    scalar_t It = 0.0;
-    scalar_t w_coeff = 0.0;
-    int_t x=0,y=0;
-    // loop over subset pixels in the deformed location
-    for(int_t j=0;j<window_size_;++j){
-      y = pt_def_y[pt] - half_window_size_ + j;
-      for(int_t i=0;i<window_size_;++i){
-        x = pt_def_x[pt] - half_window_size_ + i;
-        // need to recompute the gradients here because the pixel may be outside the original subset:
-        // get the gradient information from the previous image at the deformed location:
-        Ix = 0.0;
-        Iy = 0.0;
-        for(int_t k=0;k<5;++k){
-          Ix += (-1.0/12.0)*grad_coeffs[k]*(*schema_->prev_img())(x-2+k,y);
-          Iy += (-1.0/12.0)*grad_coeffs[k]*(*schema_->prev_img())(x,y-2+k);
-        }
-        It = (*schema_->def_img())(x,y) - (*schema_->prev_img())(x,y);
-        w_coeff = window_coeffs_[i][j];
-        H(0,0) += Ix*Ix*w_coeff*w_coeff;
-        H(1,0) += Ix*Iy*w_coeff*w_coeff;
-        H(0,1) += Iy*Ix*w_coeff*w_coeff;
-        H(1,1) += Iy*Iy*w_coeff*w_coeff;
-        q[0] += Ix*It*w_coeff*w_coeff;
-        q[1] += Iy*It*w_coeff*w_coeff;
-      }
-    }
-    // do the inversion:
-    for(int_t i=0;i<LWORK;++i) WORK[i] = 0.0;
-    for(int_t i=0;i<N+1;++i) {IPIV[i] = 0;}
-    lapack.GETRF(N,N,H.values(),N,IPIV,&INFO);
-    lapack.GETRI(N,H.values(),N,IPIV,WORK,LWORK,&INFO);
-    // compute u and v
-    update_x[pt] = -H(0,0)*q[0] - H(0,1)*q[1];
-    update_y[pt] = -H(1,0)*q[0] - H(1,1)*q[1];
     DEBUG_MSG("Optical_Flow_Initializer::initial_guess() displacement for point " << pt << ": " << update_x[pt] << " " << update_y[pt]);
   }
 
-  delete[] IPIV;
-  delete[] EIGS;
-  delete[] WORK;
-  delete[] SWORK;
-
   // accumulate the displacements in case solve is skipped
   current_pt1_x_ += update_x[0];
   current_pt1_y_ += update_y[0];
@@ -1089,20 +1936,6 @@ Optical_Flow_Initializer::initial_guess(const int_t subset_gid,
     return INITIALIZE_FAILED;
   }
 
-  Teuchos::ArrayRCP<intensity_t> output_img(schema_->prev_img()->num_pixels(),0.0);
-  for(int_t j=0;j<schema_->prev_img()->height();++j)
-  {
-    for(int_t i=0;i<schema_->prev_img()->width();++i)
-    {
-      if((i==pt_def_x[0]&&j==pt_def_y[0])||(i==pt_def_x[1]&&j==pt_def_y[1])){
-      //if((i==pt1_x_&&j==pt1_y_)||(i==pt2_x_&&j==pt2_y_)){
-        output_img[j*schema_->prev_img()->width()+i] = 255;
-      }else{
-        output_img[j*schema_->prev_img()->width()+i] = (*schema_->prev_img())(i,j);
-      }
-    }
-  }
-
   // Note: these are additive displacements from the previous frame so add them to what's already in the array
   shape_function->insert_motion(initial_u_ + disp_x,initial_v_ + disp_y,initial_t_+ theta_12);
   // leave the rest alone...
@@ -1137,18 +1970,16 @@ Motion_Test_Utility::motion_detected(const int_t sub_image_id){
     TEUCHOS_TEST_FOR_EXCEPTION(!schema_->def_img(sub_image_id)->has_gauss_filter(),std::runtime_error,
       "Error, Gauss filtering required for using motion windows, but gauss filtering is not enabled in the input.");
     const int_t half_mask = schema_->def_img(sub_image_id)->gauss_filter_mask_size()/2;
-    const int_t w = schema_->def_img(sub_image_id)->width();
-    const int_t h = schema_->def_img(sub_image_id)->height();
-    DEBUG_MSG("Motion_Test_Utility::motion_detected(): motion window sub_image_id " << sub_image_id << " width " << w << " height " << h);
+    DEBUG_MSG("Motion_Test_Utility::motion_detected(): motion window sub_image_id " << sub_image_id << " width " <<
+      schema_->def_img(sub_image_id)->width() << " height " << schema_->def_img(sub_image_id)->height());
     //diff the two images and see if the difference is above the user requested tolerance
-    scalar_t diff = 0.0;
-    // skip the outer edges since they are not filtered
-    for(int_t y=half_mask+1;y<h-(half_mask+1);++y){
-      for(int_t x=half_mask+1;x<w-(half_mask+1);++x){
-        diff += ((*schema_->def_img(sub_image_id))(x,y) - (*schema_->prev_img(sub_image_id))(x,y))*((*schema_->def_img(sub_image_id))(x,y) - (*schema_->prev_img(sub_image_id))(x,y));
-      }
+    // the schema diffs all the windows at the start of the frame, compute it here only if that was not done
+    scalar_t diff = schema_->motion_window_diff(sub_image_id);
+    if(diff<0.0){
+      // skip the outer edges since they are not filtered
+      diff = schema_->def_img(sub_image_id)->block_diff(schema_->prev_img(sub_image_id),half_mask+1,
+        schema_->motion_detection_block_size());
     }
-    diff = std::sqrt(diff);
     DEBUG_MSG("Motion_Test_Utility::motion_detected() called, img diff: " << diff << " initial tol: " << tol_);
     if(tol_==-1.0&&diff!=0.0){ // user has not set a tolerance manually
       tol_ = diff + 5.0;
@@ -57,6 +57,7 @@
 #include <opencv2/opencv.hpp>
 
 #include <set>
+#include <vector>
 #include <cassert>
 
 
@@ -68,6 +69,7 @@
 namespace DICe {
 
 class Schema;
+class Feature_Matcher;
 
 /// Deformation triad to store three parameter values in a set
 struct def_triad
@@ -280,6 +282,43 @@ protected:
   scalar_t phase_cor_u_y_;
 };
 
+/// \class DICe::Local_Phase_Correlation_Initializer
+/// \brief A class that phase correlates a window around each subset
+/// between the previous and deformed images. Unlike the Phase_Correlation_Initializer
+/// each subset gets its own shift, so regions that move differently are each initialized
+/// with their own motion. All of the windows are the same size so they share one FFT plan,
+/// and the windows are correlated in parallel before the frame is analyzed.
+class DICE_LIB_DLL_EXPORT
+Local_Phase_Correlation_Initializer : public Initializer{
+public:
+
+  /// constructor
+  /// \param schema the parent schema
+  /// \param window_size width of the square window around each subset (-1 means twice the subset size)
+  Local_Phase_Correlation_Initializer(Schema * schema,
+    const int_t window_size=-1);
+
+  /// virtual destructor
+  virtual ~Local_Phase_Correlation_Initializer(){};
+
+  /// see base class description
+  virtual void pre_execution_tasks();
+
+  /// see base class description
+  virtual Status_Flag initial_guess(const int_t subset_gid,
+    Teuchos::RCP<Local_Shape_Function> shape_function);
+
+protected:
+  /// width and height of the correlation windows
+  int_t window_size_;
+  /// shift in x since the previous frame for each local subset
+  std::vector<scalar_t> shift_x_;
+  /// shift in y since the previous frame for each local subset
+  std::vector<scalar_t> shift_y_;
+  /// 1 if the shift for the local subset had a clear correlation peak
+  std::vector<int_t> shift_valid_;
+};
+
 /// \class DICe::Search_Initializer
 /// \brief A class that searches a nearby neighborhood for the subset
 class DICE_LIB_DLL_EXPORT
@@ -295,6 +334,9 @@ public:
   /// \param search_dim_v the extents of the search in v
   /// \param step_size_theta the angle step size (negative 1 means don't search in this dim)
   /// \param search_dim_theta the extents of the search in angle
+  /// \param use_integer_pre_search if true, the translation window is first scanned at integer
+  /// pixel shifts using the normalized cross correlation of the raw pixels and the interpolated
+  /// warps are only used to refine the best shift
   Search_Initializer(Schema * schema,
     Teuchos::RCP<Subset> subset,
     const scalar_t & step_size_u,
@@ -302,7 +344,8 @@ public:
     const scalar_t & step_size_v,
     const scalar_t & search_dim_v,
     const scalar_t & step_size_theta,
-    const scalar_t & search_dim_theta);
+    const scalar_t & search_dim_theta,
+    const bool use_integer_pre_search=true);
 
   /// virtual destructor
   virtual ~Search_Initializer(){};
@@ -315,6 +358,27 @@ public:
     Teuchos::RCP<Local_Shape_Function> shape_function);
 
 protected:
+  /// \brief evaluate gamma at every integer pixel shift in the given translation window
+  /// without interpolating the deformed image (the subset pixels are rotated by theta
+  /// and rounded once, then each shift is a zero mean normalized cross correlation over the raw pixels)
+  /// \param start_u lower bound of the u window
+  /// \param end_u upper bound of the u window
+  /// \param start_v lower bound of the v window
+  /// \param end_v upper bound of the v window
+  /// \param theta rotation used to position the subset pixels
+  /// \param best_u [out] u shift with the lowest gamma
+  /// \param best_v [out] v shift with the lowest gamma
+  /// \param best_gamma [out] the lowest gamma (2 - 2 ZNCC, the same measure as Subset::gamma())
+  /// returns false if no shift in the window kept the subset inside the image
+  bool integer_translation_search(const scalar_t & start_u,
+    const scalar_t & end_u,
+    const scalar_t & start_v,
+    const scalar_t & end_v,
+    const scalar_t & theta,
+    scalar_t & best_u,
+    scalar_t & best_v,
+    scalar_t & best_gamma);
+
   /// pointer to a specific subset
   Teuchos::RCP<Subset> subset_;
   /// search step size in x and y
@@ -327,9 +391,56 @@ protected:
   scalar_t step_size_theta_;
   /// extent of search in theta
   scalar_t search_dim_theta_;
+  /// scan the translation window at integer shifts before warping the subset
+  bool use_integer_pre_search_;
 };
 
 
+/// \class DICe::Pyramid_Initializer
+/// \brief refines the current guess for a subset coarse-to-fine using the Gaussian pyramids
+/// of the reference and deformed images (see Image::create_pyramid()). The translation is solved
+/// on the coarsest level first, where large motions are only a few pixels, and each level's
+/// result seeds the next finer level. The rotation is held fixed.
+class DICE_LIB_DLL_EXPORT
+Pyramid_Initializer : public Initializer{
+public:
+
+  /// constructor
+  /// \param schema the parent schema
+  /// \param subset pointer to the subset to refine
+  Pyramid_Initializer(Schema * schema,
+    Teuchos::RCP<Subset> subset);
+
+  /// virtual destructor
+  virtual ~Pyramid_Initializer(){};
+
+  /// see base class description
+  virtual void pre_execution_tasks(){};
+
+  /// see base class description, the motion already in the shape function is the starting point
+  /// (usually the result of the schema's initializer) and is only replaced if the pyramid moves it
+  /// by more than half a pixel
+  virtual Status_Flag initial_guess(const int_t subset_gid,
+    Teuchos::RCP<Local_Shape_Function> shape_function);
+
+protected:
+  /// \brief solve for the translation on one pyramid level using the subset pixels that fall on the level's grid
+  /// \param level the pyramid level (1 is half resolution)
+  /// \param theta rotation used to position the subset pixels
+  /// \param search_radius radius in level pixels of the integer search done before the Gauss-Newton refinement
+  /// \param u [in/out] x displacement in full resolution pixels
+  /// \param v [in/out] y displacement in full resolution pixels
+  /// returns false if the level could not improve the match (u and v are left unchanged)
+  bool solve_level(const int_t level,
+    const scalar_t & theta,
+    const int_t search_radius,
+    scalar_t & u,
+    scalar_t & v);
+
+  /// pointer to a specific subset
+  Teuchos::RCP<Subset> subset_;
+};
+
 /// \class DICe::Field_Value_Initializer
 /// \brief an initializer that grabs values from the field values
 /// in the schema as the first guess, for example, the last frame's solution
@@ -354,6 +465,142 @@ public:
     Teuchos::RCP<Local_Shape_Function> shape_function);
 };
 
+/// \class DICe::Predictor_Initializer
+/// \brief an initializer that predicts the motion of each subset from its own
+/// history and from the neighbors that have already converged in this frame.
+/// The displacement and rotation of the last three frames are extrapolated
+/// in time (quadratic if three frames are available, linear for two). The
+/// difference between the extrapolated and the converged values of the nearest
+/// neighbors (found with a kd-tree) is then fit with a distance weighted plane
+/// and added to the temporal prediction. Subsets without any history use a weighted
+/// fit of the neighbor values directly.
+class DICE_LIB_DLL_EXPORT
+Predictor_Initializer : public Initializer{
+public:
+
+  /// constructor
+  /// \param schema the parent schema
+  /// \param num_neighbors the number of nearest neighbors to use in the spatial fit
+  Predictor_Initializer(Schema * schema,
+    const int_t num_neighbors=8);
+
+  /// virtual destructor
+  virtual ~Predictor_Initializer(){};
+
+  /// see base class description
+  virtual void pre_execution_tasks();
+
+  /// see base class description
+  virtual Status_Flag initial_guess(const int_t subset_gid,
+    Teuchos::RCP<Local_Shape_Function> shape_function);
+
+protected:
+  /// weighted plane fit of the given values at the sample points, evaluated at the query point
+  /// (reduces to a weighted average if there are fewer than three samples or they are colinear)
+  /// \param query_x x coordinate of the point where the fit is evaluated
+  /// \param query_y y coordinate of the point where the fit is evaluated
+  /// \param x x coordinates of the samples
+  /// \param y y coordinates of the samples
+  /// \param w weights of the samples
+  /// \param values values of the samples
+  scalar_t weighted_fit(const scalar_t & query_x,
+    const scalar_t & query_y,
+    const std::vector<scalar_t> & x,
+    const std::vector<scalar_t> & y,
+    const std::vector<scalar_t> & w,
+    const std::vector<scalar_t> & values)const;
+
+  /// number of nearest neighbors to use in the spatial fit
+  int_t num_neighbors_;
+  /// pointer to the kd-tree of the subset reference coordinates
+  Teuchos::RCP<kd_tree_2d_t> kd_tree_;
+  /// pointer to the point cloud used for the neighbor searching
+  Teuchos::RCP<Point_Cloud_2D<scalar_t> > point_cloud_;
+  /// displacement x, displacement y and rotation for the last three frames (most recent first)
+  /// stored as [frame*3*num_subsets + component*num_subsets + local_id]
+  std::vector<scalar_t> history_;
+  /// number of valid frames in the history for each local subset
+  std::vector<int_t> history_size_;
+  /// temporal prediction of displacement x, displacement y and rotation for each local subset
+  /// stored as [component*num_subsets + local_id]
+  std::vector<scalar_t> prediction_;
+  /// 1 if the initial guess for the local subset has been requested in this frame
+  std::vector<int_t> visited_;
+};
+
+/// \class DICe::Motion_Model_Initializer
+/// \brief an initializer that follows each subset with a constant acceleration
+/// Kalman filter. Displacement x, displacement y and rotation are filtered independently,
+/// the state of each component is the value, its rate and its acceleration per frame.
+/// Every frame the converged values of the previous frame are absorbed as measurements
+/// and the state is propagated one frame forward. The predicted values are used as the
+/// initial guess and the predicted standard deviation is available to size the search
+/// window of the fallback initialization. Subsets that fail (sigma of -1) coast on the
+/// prediction for a few frames before their state is discarded.
+class DICE_LIB_DLL_EXPORT
+Motion_Model_Initializer : public Initializer{
+public:
+
+  /// constructor
+  /// \param schema the parent schema
+  /// \param displacement_noise standard deviation of the converged displacements (pixels)
+  /// \param rotation_noise standard deviation of the converged rotations (radians)
+  Motion_Model_Initializer(Schema * schema,
+    const scalar_t & displacement_noise=0.05,
+    const scalar_t & rotation_noise=0.001);
+
+  /// virtual destructor
+  virtual ~Motion_Model_Initializer(){};
+
+  /// see base class description
+  virtual void pre_execution_tasks();
+
+  /// see base class description
+  virtual Status_Flag initial_guess(const int_t subset_gid,
+    Teuchos::RCP<Local_Shape_Function> shape_function);
+
+  /// returns the predicted motion of a subset for the current frame and its standard deviation,
+  /// returns false if there is no prediction for the subset
+  /// \param subset_gid the global id of the subset
+  /// \param motion [out] array of the predicted displacement x, displacement y and rotation
+  /// \param std_dev [out] array of the standard deviations of the predicted values
+  bool prediction(const int_t subset_gid,
+    scalar_t * motion,
+    scalar_t * std_dev)const;
+
+  /// returns the half width of the displacement search window around the prediction of a subset,
+  /// three predicted standard deviations rounded up to whole pixels and kept between step and max_dim
+  /// (max_dim if there is no prediction for the subset)
+  /// \param subset_gid the global id of the subset
+  /// \param step the search step size (pixels)
+  /// \param max_dim the largest half width of the search window (pixels)
+  scalar_t search_dim(const int_t subset_gid,
+    const scalar_t & step,
+    const scalar_t & max_dim)const;
+
+protected:
+  /// absorb a measurement into the state of one component
+  /// \param index the component index (component*num_subsets + local_id)
+  /// \param value the measured value
+  void update(const int_t index,
+    const scalar_t & value);
+
+  /// propagate the state of one component forward one frame
+  /// \param index the component index (component*num_subsets + local_id)
+  void predict(const int_t index);
+
+  /// measurement standard deviation for displacement x, displacement y and rotation
+  scalar_t noise_[3];
+  /// value, rate and acceleration for each component stored as [(component*num_subsets + local_id)*3 + i]
+  std::vector<scalar_t> state_;
+  /// 3x3 covariance of the state for each component stored as [(component*num_subsets + local_id)*9 + 3*i + j]
+  std::vector<scalar_t> covariance_;
+  /// 1 if the filter for the local subset has been started
+  std::vector<int_t> active_;
+  /// number of consecutive frames the local subset has coasted without a converged solution
+  std::vector<int_t> missed_frames_;
+};
+
 /// \class DICe::Feature_Matching_Initializer
 /// \brief an initializer that uses nearby feature matching to initialize the solution
 class DICE_LIB_DLL_EXPORT
@@ -362,8 +609,11 @@ public:
 
   /// constructor
   /// \param schema the parent schema
+  /// \param threshold_block_size block size for thresholding the images before detecting features (-1 means no thresholding)
+  /// \param roi_margin if not negative, features are only detected within this many pixels of the subsets
   Feature_Matching_Initializer(Schema * schema,
-    const int_t threshold_block_size=-1);
+    const int_t threshold_block_size=-1,
+    const int_t roi_margin=-1);
 
   /// virtual destructor
   virtual ~Feature_Matching_Initializer(){};
@@ -389,6 +639,10 @@ protected:
   /// previous image name (used if the images are constructed from file rather than array)
 //  std::string prev_img_name_;
   int_t threshold_block_size_;
+  /// margin around the subsets for the feature detection region (-1 means the whole image)
+  int_t roi_margin_;
+  /// matcher that keeps the features of the previous image for the next frame
+  Teuchos::RCP<Feature_Matcher> matcher_;
   /// first time the pre execution tasks are called
   bool first_call_;
 };
@@ -458,7 +712,9 @@ public:
 /// after the positions have been reset. The displacements and rotations are cumulative
 /// starting with the reference frame. If the positions need to be reset due to
 /// obstructions, the optical flow routine restarts from the new location, which is now
-/// the reference frame.
+/// the reference frame. The points of all the optical flow initializers are tracked together
+/// by the schema in one batched (and threaded) pyramidal Lucas-Kanade pass before the subset
+/// loop so that initial_guess() only has to look up the displacements of its two points.
 class DICE_LIB_DLL_EXPORT
 Optical_Flow_Initializer : public Initializer{
 public:
@@ -493,6 +749,43 @@ public:
   /// \param subset_gid the global id of the subset using this initializer
   Status_Flag set_locations(const int_t subset_gid);
 
+  /// returns the current locations of the two optical flow points for the batched tracking pass,
+  /// the locations are reset if needed and moved to the last converged solution
+  /// returns false if no valid locations exist (the subset is then initialized by initial_guess() alone)
+  /// \param subset_gid the global id of the subset using this initializer
+  /// \param pt_x [out] array of the two x coordinates
+  /// \param pt_y [out] array of the two y coordinates
+  bool flow_points(const int_t subset_gid,
+    scalar_t * pt_x,
+    scalar_t * pt_y);
+
+  /// store the tracked displacements of the two optical flow points for the next call to initial_guess()
+  /// \param update_x array of the two x displacements
+  /// \param update_y array of the two y displacements
+  void set_flow_update(const scalar_t * update_x,
+    const scalar_t * update_y){
+    flow_update_x_[0] = update_x[0];
+    flow_update_x_[1] = update_x[1];
+    flow_update_y_[0] = update_y[0];
+    flow_update_y_[1] = update_y[1];
+    has_flow_update_ = true;
+  }
+
+  /// pyramidal Lucas-Kanade tracking of a set of points from the previous image to the deformed image,
+  /// the coarse levels are taken from the image pyramids (if they exist) and the points are tracked in parallel
+  /// \param prev_img the previous image
+  /// \param def_img the deformed image
+  /// \param pt_x the x coordinates of the points in the previous image
+  /// \param pt_y the y coordinates of the points in the previous image
+  /// \param update_x [out] the x displacement of each point
+  /// \param update_y [out] the y displacement of each point
+  static void track_points(Teuchos::RCP<Image> prev_img,
+    Teuchos::RCP<Image> def_img,
+    const std::vector<scalar_t> & pt_x,
+    const std::vector<scalar_t> & pt_y,
+    std::vector<scalar_t> & update_x,
+    std::vector<scalar_t> & update_y);
+
   /// returns the pixel id of the best location for optical flow
   /// \param best_grad [out] the gradient metric at the best location for an optical flow point
   /// \param existing_points the set of global ids for points that are already OF points
@@ -573,6 +866,12 @@ protected:
   scalar_t initial_t_;
   /// pixel ids of the optical flow points
   int_t ids_[2];
+  /// true if the batched tracking pass has computed the displacements for this frame
+  bool has_flow_update_;
+  /// x displacements of the optical flow points from the batched tracking pass
+  scalar_t flow_update_x_[2];
+  /// y displacements of the optical flow points from the batched tracking pass
+  scalar_t flow_update_y_[2];
 };
 
 //
@@ -74,6 +74,30 @@ Objective::gamma( Teuchos::RCP<Local_Shape_Function> shape_function) const {
   return gamma;
 }
 
+void
+Objective::trial_gammas(const std::vector<Teuchos::RCP<Local_Shape_Function> > & shape_functions,
+  std::vector<scalar_t> & gammas,
+  const int_t stride) const {
+  const int_t num_trials = shape_functions.size();
+  gammas.resize(num_trials);
+  const Interpolation_Method interp = schema_->interpolation_method();
+  TEUCHOS_TEST_FOR_EXCEPTION(interp!=BILINEAR&&interp!=BICUBIC&&interp!=KEYS_FOURTH,std::invalid_argument,
+    "Error, unknown interpolation method requested");
+  const Teuchos::RCP<Image> image = schema_->def_img(subset_->sub_image_id());
+  scalar_t num_active_pixels = 1.0;
+  if(schema_->normalize_gamma_with_active_pixels()){
+    int_t num_active = 0;
+    for(int_t i=0;i<subset_->num_pixels();++i)
+      if(subset_->is_active(i)) num_active++;
+    if(num_active > 0) num_active_pixels = num_active;
+  }
+  // the shape functions and image are passed by reference so the reference counts are not touched from the threads
+#pragma omp parallel for schedule(dynamic) if(num_trials>1)
+  for(int_t i=0;i<num_trials;++i){
+    gammas[i] = subset_->trial_gamma(image,shape_functions[i],interp,stride)/num_active_pixels;
+  }
+}
+
 scalar_t
 Objective::beta(Teuchos::RCP<Local_Shape_Function> shape_function) const {
   // for now return -1 for beta if affine shape functions are used
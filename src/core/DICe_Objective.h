@@ -129,6 +129,15 @@ const int_t y):
   /// \param shape_function pointer to the class that holds the deformation parameter values
   scalar_t gamma( Teuchos::RCP<Local_Shape_Function> shape_function) const;
 
+  /// \brief Evaluates gamma for several trial deformations at once without changing the state of the subset
+  /// (the trial deformations are spread over the available threads)
+  /// \param shape_functions the trial deformations
+  /// \param gammas [out] the gamma value for each trial deformation
+  /// \param stride if greater than one only every stride-th pixel of the subset is used (gives a cheap estimate of gamma)
+  void trial_gammas(const std::vector<Teuchos::RCP<Local_Shape_Function> > & shape_functions,
+    std::vector<scalar_t> & gammas,
+    const int_t stride=1) const;
+
   /// \brief Uncertainty measure for solution
   /// \param shape_function [out] pointer to the class that holds the deformation parameter values
   /// \param noise_level [out] Returned as the standard deviation estimate of the image noise sigma_g from Sutton et.al.
@@ -348,9 +348,14 @@ DICE_LIB_DLL_EXPORT void tracking_default_params(Teuchos::ParameterList *  defau
   defaultParams->set(DICe::global_stabilization_tau,-1.0);
   defaultParams->set(DICe::global_solver,CG_SOLVER);
   defaultParams->set(DICe::global_element_type,"TRI6");
+  defaultParams->set(DICe::global_use_matrix_free,false);
+  defaultParams->set(DICe::global_preconditioner,"ILU");
+  defaultParams->set(DICe::global_num_mesh_levels,1);
+  defaultParams->set(DICe::num_image_pyramid_levels,1);
   defaultParams->set(DICe::num_image_integration_points,20);
   defaultParams->set(DICe::write_exodus_output,true);
   defaultParams->set(DICe::threshold_block_size,-1);
+  defaultParams->set(DICe::use_reliability_guided_ordering,false);
 }
 
 DICE_LIB_DLL_EXPORT void dice_default_params(Teuchos::ParameterList *  defaultParams){
@@ -406,10 +411,15 @@ DICE_LIB_DLL_EXPORT void dice_default_params(Teuchos::ParameterList *  defaultPa
   defaultParams->set(DICe::global_regularization_alpha,1.0);
   defaultParams->set(DICe::global_stabilization_tau,-1.0);
   defaultParams->set(DICe::global_element_type,"TRI6");
+  defaultParams->set(DICe::global_use_matrix_free,false);
+  defaultParams->set(DICe::global_preconditioner,"ILU");
+  defaultParams->set(DICe::global_num_mesh_levels,1);
+  defaultParams->set(DICe::num_image_pyramid_levels,1);
   defaultParams->set(DICe::global_solver,CG_SOLVER);
   defaultParams->set(DICe::num_image_integration_points,20);
   defaultParams->set(DICe::write_exodus_output,true);
   defaultParams->set(DICe::threshold_block_size,-1);
+  defaultParams->set(DICe::use_reliability_guided_ordering,false);
 }
 
 }// End DICe Namespace
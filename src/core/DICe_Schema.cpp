@@ -67,6 +67,15 @@
 
 #include <cassert>
 #include <set>
+#include <queue>
+#include <functional>
+
+// subsets in the same wave of the reliability guided ordering are only correlated on separate
+// threads if the reference counts of the image pointers shared by the subsets are atomic
+#if defined(_OPENMP) && defined(HAVE_TEUCHOS_THREAD_SAFE)
+#include <omp.h>
+#define DICE_THREADED_WAVES
+#endif
 
 namespace DICe {
 
@@ -149,11 +158,21 @@ Schema::Schema(Teuchos::ArrayRCP<scalar_t> coords_x,
 void
 Schema::rotate_def_image(){
   if(def_image_rotation_!=ZERO_DEGREES){
-    for(size_t i=0;i<def_imgs_.size();++i)
+    for(size_t i=0;i<def_imgs_.size();++i){
       def_imgs_[i] = def_imgs_[i]->apply_rotation(def_image_rotation_);
+      create_image_pyramid(def_imgs_[i]);
+    }
   }
 }
 
+void
+Schema::create_image_pyramid(const Teuchos::RCP<Image> & img){
+  if(num_image_pyramid_levels_<=1||img==Teuchos::null) return;
+  // images that were already built with a pyramid (or are too small for one) are left alone
+  if(img->num_pyramid_levels()>1) return;
+  img->create_pyramid(num_image_pyramid_levels_);
+}
+
 void
 Schema::set_def_image(const std::string & defName,
   const int_t id){
@@ -167,6 +186,13 @@ Schema::set_def_image(const std::string & defName,
   imgParams->set(DICe::gradient_method,gradient_method_);
   imgParams->set(DICe::filter_failed_cine_pixels,filter_failed_cine_pixels_);
 
+  // with a region of interest the filter and gradients are applied after the image is read, only near the subsets
+  const bool use_roi = use_def_roi();
+  if(use_roi){
+    imgParams->set(DICe::compute_image_gradients,false);
+    imgParams->set(DICe::gauss_filter_images,false);
+  }
+
   // query the image dimensions:
   if(has_extents_){
     int_t w = 0;
@@ -181,6 +207,8 @@ Schema::set_def_image(const std::string & defName,
     const int_t height = end_y - offset_y;
     DEBUG_MSG("Setting the deformed image using extents x: " << offset_x << " to " << end_x << " y: " << offset_y << " to " << end_y);
     def_imgs_[id] = Teuchos::rcp( new Image(defName.c_str(),offset_x,offset_y,width,height,imgParams));
+    if(use_roi)
+      preprocess_def_image_roi(def_imgs_[id]);
   }
   else{
     // see if the image has already been allocated:
@@ -195,6 +223,38 @@ Schema::set_def_image(const std::string & defName,
     def_imgs_[id] = def_imgs_[id]->apply_rotation(def_image_rotation_);
   }
   def_imgs_[id]->set_file_name(defName);
+  create_image_pyramid(def_imgs_[id]);
+}
+
+bool
+Schema::use_def_roi()const{
+  return has_extents_&&!def_roi_.empty()&&(gauss_filter_images_||compute_def_gradients_)
+      &&def_image_rotation_==ZERO_DEGREES&&num_image_pyramid_levels_<=1&&!use_nonlinear_projection_
+      &&!use_incremental_formulation_&&initialization_method_!=USE_PHASE_CORRELATION
+      &&initialization_method_!=USE_IMAGE_REGISTRATION&&initialization_method_!=USE_FEATURE_MATCHING;
+}
+
+void
+Schema::preprocess_def_image_roi(const Teuchos::RCP<Image> & img){
+  TEUCHOS_TEST_FOR_EXCEPTION(img==Teuchos::null,std::runtime_error,"");
+  const int_t tile_size = 32;
+  const int_t tiles_x = (img->width() + tile_size - 1)/tile_size;
+  const int_t tiles_y = (img->height() + tile_size - 1)/tile_size;
+  std::vector<bool> active_tiles(tiles_x*tiles_y,false);
+  for(size_t i=0;i<def_roi_.size()/4;++i){
+    // the roi is in global coordinates and the image may be a portion of the full image
+    const int_t x0 = std::max(def_roi_[i*4+0] - img->offset_x(),0);
+    const int_t x1 = std::min(def_roi_[i*4+1] - img->offset_x(),img->width()-1);
+    const int_t y0 = std::max(def_roi_[i*4+2] - img->offset_y(),0);
+    const int_t y1 = std::min(def_roi_[i*4+3] - img->offset_y(),img->height()-1);
+    if(x0>x1||y0>y1) continue;
+    for(int_t ty=y0/tile_size;ty<=y1/tile_size;++ty)
+      for(int_t tx=x0/tile_size;tx<=x1/tile_size;++tx)
+        active_tiles[ty*tiles_x+tx] = true;
+  }
+  DEBUG_MSG("Schema::preprocess_def_image_roi(): " << std::count(active_tiles.begin(),active_tiles.end(),true) << " of " <<
+    active_tiles.size() << " tiles in the region of interest");
+  img->preprocess_tiles(tile_size,active_tiles,gauss_filter_images_,compute_def_gradients_,gauss_filter_mask_size_);
 }
 
 void
@@ -204,7 +264,12 @@ Schema::set_def_image(Teuchos::RCP<Image> img,
   assert(def_imgs_.size()>0);
   assert(id<(int_t)def_imgs_.size());
   def_imgs_[id] = img;
-  if(gauss_filter_images_&&!def_imgs_[id]->has_gauss_filter()){ // the filter may have alread been applied to the image
+  const bool needs_filter = gauss_filter_images_&&!def_imgs_[id]->has_gauss_filter(); // the filter may have alread been applied to the image
+  if(needs_filter&&compute_def_gradients_){
+    // filter and gradients in one pass over the image
+    def_imgs_[id]->gauss_filter_and_compute_gradients(gauss_filter_mask_size_);
+  }
+  else if(needs_filter){
       def_imgs_[id]->gauss_filter(gauss_filter_mask_size_);
   }
   if(compute_def_gradients_&&!def_imgs_[id]->has_gradients()){
@@ -216,6 +281,7 @@ Schema::set_def_image(Teuchos::RCP<Image> img,
     imgParams->set(DICe::gradient_method,gradient_method_);
     def_imgs_[id] = def_imgs_[id]->apply_rotation(def_image_rotation_,imgParams);
   }
+  create_image_pyramid(def_imgs_[id]);
 }
 
 void
@@ -238,6 +304,7 @@ Schema::set_def_image(const int_t img_width,
   if(def_image_rotation_!=ZERO_DEGREES){
     def_imgs_[id] = def_imgs_[id]->apply_rotation(def_image_rotation_);
   }
+  create_image_pyramid(def_imgs_[id]);
 }
 
 void
@@ -276,6 +343,7 @@ Schema::set_ref_image(const std::string & refName){
   if(ref_image_rotation_!=ZERO_DEGREES){
     ref_img_ = ref_img_->apply_rotation(ref_image_rotation_,imgParams);
   }
+  create_image_pyramid(ref_img_);
   if(prev_imgs_[0]==Teuchos::null){
     prev_imgs_[0] = Teuchos::rcp( new Image(refName.c_str(),imgParams));
     if(ref_image_rotation_!=ZERO_DEGREES){
@@ -301,6 +369,7 @@ Schema::set_ref_image(const int_t img_width,
   if(ref_image_rotation_!=ZERO_DEGREES){
     ref_img_ = ref_img_->apply_rotation(ref_image_rotation_,imgParams);
   }
+  create_image_pyramid(ref_img_);
   if(prev_imgs_[0]==Teuchos::null){
     prev_imgs_[0] = ref_img_;//Teuchos::rcp( new Image(img_width,img_height,refRCP,imgParams));
     // dont apply the rotation because the pointer is set to the ref image which has already been rotated
@@ -327,6 +396,7 @@ Schema::set_ref_image(Teuchos::RCP<Image> img){
     imgParams->set(DICe::gradient_method,gradient_method_);
     ref_img_ = ref_img_->apply_rotation(ref_image_rotation_,imgParams);
   }
+  create_image_pyramid(ref_img_);
   if(prev_imgs_[0]==Teuchos::null){
     prev_imgs_[0] = ref_img_;
   }
@@ -336,6 +406,7 @@ void
 Schema::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params){
   global_num_subsets_ = 0;
   local_num_subsets_ = 0;
+  field_handles_valid_ = false;
   subset_dim_ = -1;
   step_size_x_ = -1;
   step_size_y_ = -1;
@@ -349,6 +420,7 @@ Schema::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & p
   normalize_gamma_with_active_pixels_ = false;
   gauss_filter_images_ = false;
   gauss_filter_mask_size_ = 7;
+  num_image_pyramid_levels_ = 1;
   init_params_ = params==Teuchos::null ? Teuchos::rcp(new Teuchos::ParameterList()):
     Teuchos::rcp(new Teuchos::ParameterList(*params));
   comm_ = Teuchos::rcp(new MultiField_Comm());
@@ -364,6 +436,10 @@ Schema::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & p
   use_nonlinear_projection_ = false;
   sort_txt_output_ = false;
   threshold_block_size_ = -1;
+  phase_correlation_window_size_ = -1;
+  use_reliability_guided_ordering_ = false;
+  feature_matching_roi_margin_ = -1;
+  motion_detection_block_size_ = 1;
   set_params(params);
   prev_imgs_.push_back(Teuchos::null);
   def_imgs_.push_back(Teuchos::null);
@@ -509,6 +585,8 @@ Schema::set_params(const Teuchos::RCP<Teuchos::ParameterList> & params){
   gauss_filter_images_ = diceParams->get<bool>(DICe::gauss_filter_images,false);
   filter_failed_cine_pixels_ = diceParams->get<bool>(DICe::filter_failed_cine_pixels,false);
   gauss_filter_mask_size_ = diceParams->get<int_t>(DICe::gauss_filter_mask_size,7);
+  num_image_pyramid_levels_ = diceParams->get<int_t>(DICe::num_image_pyramid_levels,1);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_image_pyramid_levels_<1,std::runtime_error,"Error, num_image_pyramid_levels must be 1 or greater");
   compute_ref_gradients_ = diceParams->get<bool>(DICe::compute_ref_gradients,true);
   compute_def_gradients_ = diceParams->get<bool>(DICe::compute_def_gradients,false);
   compute_laplacian_image_ = diceParams->get<bool>(DICe::compute_laplacian_image,false);
@@ -592,6 +670,12 @@ Schema::set_params(const Teuchos::RCP<Teuchos::ParameterList> & params){
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::write_exodus_output),std::runtime_error,"");
   write_exodus_output_ = diceParams->get<bool>(DICe::write_exodus_output);
   threshold_block_size_ = diceParams->get<int>(DICe::threshold_block_size,-1);
+  phase_correlation_window_size_ = diceParams->get<int>(DICe::phase_correlation_window_size,-1);
+  use_reliability_guided_ordering_ = diceParams->get<bool>(DICe::use_reliability_guided_ordering,false);
+  feature_matching_roi_margin_ = diceParams->get<int>(DICe::feature_matching_roi_margin,-1);
+  motion_detection_block_size_ = diceParams->get<int>(DICe::motion_detection_block_size,1);
+  TEUCHOS_TEST_FOR_EXCEPTION(motion_detection_block_size_<1,std::invalid_argument,
+    "Error, " << DICe::motion_detection_block_size << " must be at least 1");
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::use_search_initialization_for_failed_steps),std::runtime_error,"");
   use_search_initialization_for_failed_steps_ = diceParams->get<bool>(DICe::use_search_initialization_for_failed_steps);
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::normalize_gamma_with_active_pixels),std::runtime_error,"");
@@ -724,6 +808,7 @@ Schema::update_extents(const bool use_transformation_augmentation){
   if(conformal_subset_defs_!=Teuchos::null){
     if(conformal_subset_defs_->size()>0){
       has_extents_ = false;
+      def_roi_.clear();
       return;
     }
   }
@@ -787,6 +872,21 @@ Schema::update_extents(const bool use_transformation_augmentation){
     if(current_coords->local_value(i*2+1) > max_y_def) max_y_def = current_coords->local_value(i*2+1);
   }
   const int_t buffer = use_transformation_augmentation&&use_nonlinear_projection_ ? 500 : 100;
+  // the subsets only touch the pixels within the buffer of their current position so for local DIC the deformed
+  // image preprocessing is limited to a box around each one
+  def_roi_.clear();
+  if(analysis_type_==LOCAL_DIC){
+    const int_t roi_radius = std::max(subset_dim_,0)/2 + buffer;
+    def_roi_.reserve(num_pts*4);
+    for(int_t i=0;i<num_pts;++i){
+      const int_t cx = (int_t)std::round(current_coords->local_value(i*2+0));
+      const int_t cy = (int_t)std::round(current_coords->local_value(i*2+1));
+      def_roi_.push_back(cx - roi_radius);
+      def_roi_.push_back(cx + roi_radius);
+      def_roi_.push_back(cy - roi_radius);
+      def_roi_.push_back(cy + roi_radius);
+    }
+  }
   min_x_ref -= buffer; min_y_ref -= buffer;
   max_x_ref += buffer; max_y_ref += buffer;
   min_x_ref = min_x_ref < buffer ? 0 : std::round(min_x_ref);
@@ -1056,6 +1156,7 @@ Schema::initialize(const Teuchos::RCP<Teuchos::ParameterList> & input_params,
   std::set<int_t> neumann_boundary_nodes;
   std::set<int_t> lagrange_boundary_nodes;
 
+  invalidate_field_handles();
   mesh_ = DICe::mesh::create_point_or_tri_mesh(DICe::mesh::MESHLESS,
     overlap_coords_x,
     overlap_coords_y,
@@ -1179,6 +1280,7 @@ Schema::create_mesh(Teuchos::RCP<Decomp> decomp){
   std::vector<std::pair<int_t,int_t> > dirichlet_boundary_nodes;
   std::set<int_t> neumann_boundary_nodes;
   std::set<int_t> lagrange_boundary_nodes;
+  invalidate_field_handles();
   mesh_ = DICe::mesh::create_point_or_tri_mesh(DICe::mesh::MESHLESS,
     decomp->overlap_coords_x(),
     decomp->overlap_coords_y(),
@@ -1258,14 +1360,44 @@ Schema::create_mesh_fields(){
     mesh_->get_field(field_enums::ACCUMULATED_DISP_FS)->put_scalar(0.0);
   }
 
+  cache_field_handles();
+
   // fill the subset coordinates field:
   Teuchos::RCP<MultiField> coords = mesh_->get_field(field_enums::INITIAL_COORDINATES_FS);
+  mv_scalar_type * subset_coords_x = field_values(SUBSET_COORDINATES_X_FS);
+  mv_scalar_type * subset_coords_y = field_values(SUBSET_COORDINATES_Y_FS);
   for(int_t i=0;i<local_num_subsets_;++i){
-    local_field_value(i,SUBSET_COORDINATES_X_FS) = coords->local_value(i*2+0);
-    local_field_value(i,SUBSET_COORDINATES_Y_FS) = coords->local_value(i*2+1);
+    subset_coords_x[i] = coords->local_value(i*2+0);
+    subset_coords_y[i] = coords->local_value(i*2+1);
   }
 }
 
+void
+Schema::cache_field_handles(){
+  TEUCHOS_TEST_FOR_EXCEPTION(mesh_==Teuchos::null,std::runtime_error,"Error: mesh should not be null here");
+  field_handles_.clear();
+  nm1_field_handles_.clear();
+  DICe::mesh::field_registry * registry = mesh_->get_field_registry();
+  DICe::mesh::field_registry::iterator it = registry->begin();
+  const DICe::mesh::field_registry::iterator it_end = registry->end();
+  for(;it!=it_end;++it){
+    const size_t index = field_handle_index(it->first);
+    if(index>=field_handles_.size())
+      field_handles_.resize(index+1,NULL);
+    field_handles_[index] = it->second->local_values();
+  }
+  // pair up each nm1 field with its current state counterpart for save_off_fields()
+  for(it=registry->begin();it!=it_end;++it){
+    if(it->first.get_state()!=DICe::field_enums::STATE_N_MINUS_ONE) continue;
+    DICe::field_enums::Field_Spec fs(it->first.get_field_type(),it->first.get_name(),it->first.get_rank(),DICe::field_enums::NO_FIELD_STATE,true,true);
+    if(registry->find(fs)==it_end) continue;
+    nm1_field_handles_.push_back(std::pair<mv_scalar_type*,mv_scalar_type*>(field_handles_[field_handle_index(it->first)],
+      field_handles_[field_handle_index(fs)]));
+  }
+  field_handles_valid_ = true;
+  DEBUG_MSG("Schema::cache_field_handles(): cached " << registry->size() << " field handles, " << nm1_field_handles_.size() << " nm1 pairs");
+}
+
 void
 Schema::post_execution_tasks(){
   if(analysis_type_==GLOBAL_DIC){
@@ -1459,6 +1591,15 @@ Schema::execute_correlation(){
     DEBUG_MSG("Resetting motion detector: " << it->first);
     it->second->reset();
   }
+  compute_motion_window_diffs();
+
+  // pack the deformed image intensities and gradients for the fused bicubic interpolant used in subset initialization
+  if(interpolation_method_==BICUBIC){
+    for(size_t i=0;i<def_imgs_.size();++i){
+      if(def_imgs_[i]!=Teuchos::null&&def_imgs_[i]->has_gradients()&&!def_imgs_[i]->has_interleaved_channels())
+        def_imgs_[i]->create_interleaved_channels();
+    }
+  }
 
 #ifdef DICE_DEBUG_MSG
   std::stringstream message;
@@ -1507,16 +1648,12 @@ Schema::execute_correlation(){
     TEUCHOS_TEST_FOR_EXCEPTION(motion_window_params_->size()!=0,std::runtime_error,
       "Error, motion windows are intended only for the TRACKING_ROUTINE");
     prepare_optimization_initializers();
-    for(int_t subset_index=0;subset_index<local_num_subsets_;++subset_index){
-      DEBUG_MSG("Schema::execute_correlation(): creating Objective for subset " << this_proc_gid_order_[subset_index]);
-      try{
-        Teuchos::RCP<Objective> obj = Teuchos::rcp(new Objective_ZNSSD(this,this_proc_gid_order_[subset_index]));
-        DEBUG_MSG("Schema::execute_correlation(): Objective creation successful");
-        generic_correlation_routine(obj);
-      }
-      catch(...){
-        DEBUG_MSG("Schema::execute_correlation(): subset " << this_proc_gid_order_[subset_index] << " failed");
-        record_failed_step(this_proc_gid_order_[subset_index],static_cast<int_t>(INITIALIZE_FAILED_BY_EXCEPTION),-1);
+    if(use_reliability_guided_ordering_){
+      reliability_guided_correlation();
+    }
+    else{
+      for(int_t subset_index=0;subset_index<local_num_subsets_;++subset_index){
+        correlate_subset(this_proc_gid_order_[subset_index]);
       }
     }
   }
@@ -1620,11 +1757,16 @@ Schema::prepare_optimization_initializers(){
   // method only needs to be called once, return if the pointers are alread addressed
   if(opt_initializers_.size()>0){
     DEBUG_MSG("Repeat call to prepare_optimization_initializers(), calling pre_execution_tasks");
+    // the default initializer is shared by many subsets in the tracking routine, but
+    // its pre-execution tasks (which can advance its state) should only run once per frame
+    std::set<Initializer*> prepared;
     for(std::map<int_t,Teuchos::RCP<Initializer> >::iterator opt_it = opt_initializers_.begin();
         opt_it != opt_initializers_.end();++opt_it){
       //assert(*opt_it!=Teuchos::null);
-      opt_it->second->pre_execution_tasks();
+      if(prepared.insert(opt_it->second.get()).second)
+        opt_it->second->pre_execution_tasks();
     }
+    track_optical_flow_points();
     return;
   }
 
@@ -1634,13 +1776,25 @@ Schema::prepare_optimization_initializers(){
     DEBUG_MSG("Default initializer is phase correlation initializer");
     default_initializer = Teuchos::rcp(new Phase_Correlation_Initializer(this));
   }
+  else if(initialization_method_==USE_LOCAL_PHASE_CORRELATION){
+    DEBUG_MSG("Default initializer is local phase correlation initializer");
+    default_initializer = Teuchos::rcp(new Local_Phase_Correlation_Initializer(this,phase_correlation_window_size_));
+  }
+  else if(initialization_method_==USE_PREDICTOR){
+    DEBUG_MSG("Default initializer is predictor initializer");
+    default_initializer = Teuchos::rcp(new Predictor_Initializer(this));
+  }
+  else if(initialization_method_==USE_MOTION_MODEL){
+    DEBUG_MSG("Default initializer is motion model initializer");
+    default_initializer = Teuchos::rcp(new Motion_Model_Initializer(this));
+  }
   else if(initialization_method_==USE_ZEROS){
     DEBUG_MSG("Default initializer is zero value initializer");
     default_initializer = Teuchos::rcp(new Zero_Value_Initializer(this));
   }
   else if(initialization_method_==USE_FEATURE_MATCHING){
     DEBUG_MSG("Default initializer is feature matching initializer");
-    default_initializer = Teuchos::rcp(new Feature_Matching_Initializer(this,threshold_block_size_));
+    default_initializer = Teuchos::rcp(new Feature_Matching_Initializer(this,threshold_block_size_,feature_matching_roi_margin_));
   }
   else if(initialization_method_==USE_IMAGE_REGISTRATION){
     DEBUG_MSG("Default initializer is image registration initializer");
@@ -1703,9 +1857,64 @@ Schema::prepare_optimization_initializers(){
   }
 
   // call pre-correlation tasks for initializers
+  std::set<Initializer*> prepared;
   for(std::map<int_t,Teuchos::RCP<Initializer> >::iterator opt_it = opt_initializers_.begin();
       opt_it != opt_initializers_.end();++opt_it){
-    opt_it->second->pre_execution_tasks();
+    if(prepared.insert(opt_it->second.get()).second)
+      opt_it->second->pre_execution_tasks();
+  }
+  track_optical_flow_points();
+}
+
+void
+Schema::track_optical_flow_points(){
+  if(correlation_routine_!=TRACKING_ROUTINE||prev_imgs_[0]==Teuchos::null||def_imgs_[0]==Teuchos::null) return;
+  // gather the points of all the optical flow initializers
+  std::vector<Teuchos::RCP<Optical_Flow_Initializer> > flow_initializers;
+  std::vector<scalar_t> pt_x;
+  std::vector<scalar_t> pt_y;
+  for(std::map<int_t,Teuchos::RCP<Initializer> >::iterator opt_it = opt_initializers_.begin();
+      opt_it != opt_initializers_.end();++opt_it){
+    Teuchos::RCP<Optical_Flow_Initializer> flow_initializer = Teuchos::rcp_dynamic_cast<Optical_Flow_Initializer>(opt_it->second);
+    if(flow_initializer==Teuchos::null) continue;
+    scalar_t x[2] = {0.0,0.0};
+    scalar_t y[2] = {0.0,0.0};
+    if(!flow_initializer->flow_points(opt_it->first,x,y)) continue;
+    flow_initializers.push_back(flow_initializer);
+    pt_x.push_back(x[0]); pt_x.push_back(x[1]);
+    pt_y.push_back(y[0]); pt_y.push_back(y[1]);
+  }
+  if(flow_initializers.empty()) return;
+  DEBUG_MSG("Schema::track_optical_flow_points(): tracking the points of " << flow_initializers.size() << " optical flow initializers");
+  std::vector<scalar_t> update_x;
+  std::vector<scalar_t> update_y;
+  Optical_Flow_Initializer::track_points(prev_imgs_[0],def_imgs_[0],pt_x,pt_y,update_x,update_y);
+  for(size_t i=0;i<flow_initializers.size();++i)
+    flow_initializers[i]->set_flow_update(&update_x[2*i],&update_y[2*i]);
+}
+
+void
+Schema::compute_motion_window_diffs(){
+  motion_window_diffs_.assign(def_imgs_.size(),-1.0);
+  if(motion_window_params_==Teuchos::null) return;
+  // collect the windows that are tested for motion (several subsets can share a window)
+  std::set<int_t> sub_image_ids;
+  for(std::map<int_t,Motion_Window_Params>::const_iterator it=motion_window_params_->begin();
+      it!=motion_window_params_->end();++it){
+    if(!it->second.use_motion_detection_) continue;
+    const int_t use_subset_id = it->second.use_subset_id_==-1 ? it->first : it->second.use_subset_id_;
+    if(motion_window_params_->find(use_subset_id)==motion_window_params_->end()) continue;
+    sub_image_ids.insert(motion_window_params_->find(use_subset_id)->second.sub_image_id_);
+  }
+  for(std::set<int_t>::const_iterator it=sub_image_ids.begin();it!=sub_image_ids.end();++it){
+    const int_t id = *it;
+    if(id<0||id>=(int_t)def_imgs_.size()||id>=(int_t)prev_imgs_.size()) continue;
+    // windows without a Gauss filter are left to the motion test utility, which reports the error
+    if(def_imgs_[id]==Teuchos::null||prev_imgs_[id]==Teuchos::null||!def_imgs_[id]->has_gauss_filter()) continue;
+    // skip the outer edges since they are not filtered
+    const int_t border = def_imgs_[id]->gauss_filter_mask_size()/2 + 1;
+    motion_window_diffs_[id] = def_imgs_[id]->block_diff(prev_imgs_[id],border,motion_detection_block_size_);
+    DEBUG_MSG("Schema::compute_motion_window_diffs(): sub_image_id " << id << " diff " << motion_window_diffs_[id]);
   }
 }
 
@@ -1737,21 +1946,177 @@ Schema::motion_detected(const int_t subset_gid){
   }
 }
 
+void
+Schema::correlate_subset(const int_t subset_gid){
+  DEBUG_MSG("Schema::correlate_subset(): creating Objective for subset " << subset_gid);
+  try{
+    Teuchos::RCP<Objective> obj = Teuchos::rcp(new Objective_ZNSSD(this,subset_gid));
+    DEBUG_MSG("Schema::correlate_subset(): Objective creation successful");
+    generic_correlation_routine(obj);
+  }
+  catch(...){
+    DEBUG_MSG("Schema::correlate_subset(): subset " << subset_gid << " failed");
+    record_failed_step(subset_gid,static_cast<int_t>(INITIALIZE_FAILED_BY_EXCEPTION),-1);
+  }
+}
+
+void
+Schema::create_reliability_neighbors(){
+  DEBUG_MSG("Schema::create_reliability_neighbors(): building the neighbor lists for " << local_num_subsets_ << " subsets");
+  reliability_neighbors_.assign(local_num_subsets_,std::vector<int_t>());
+  // each subset belongs to the seed at the end of its chain of neighbor ids, subsets are only
+  // connected to other subsets with the same seed so that separate regions are not mixed
+  std::vector<int_t> neigh_lids(local_num_subsets_,-1);
+  for(int_t i=0;i<local_num_subsets_;++i){
+    const int_t neigh_gid = local_field_value(i,NEIGHBOR_ID_FS);
+    neigh_lids[i] = neigh_gid < 0 ? -1 : subset_local_id(neigh_gid);
+  }
+  std::vector<int_t> seed(local_num_subsets_,-1);
+  std::vector<int_t> path;
+  for(int_t i=0;i<local_num_subsets_;++i){
+    path.clear();
+    int_t lid = i;
+    int_t root = -1;
+    while(root<0){
+      if(seed[lid]>=0){ root = seed[lid]; break;}
+      if(seed[lid]==-2){ root = lid; break;} // cycle in the neighbor ids
+      seed[lid] = -2;
+      path.push_back(lid);
+      if(neigh_lids[lid]<0||neigh_lids[lid]==lid) root = lid;
+      else lid = neigh_lids[lid];
+    }
+    for(size_t j=0;j<path.size();++j)
+      seed[path[j]] = root;
+  }
+  // the neighbor id chain always connects a subset to its seed
+  for(int_t i=0;i<local_num_subsets_;++i){
+    if(neigh_lids[i]<0||neigh_lids[i]==i) continue;
+    reliability_neighbors_[i].push_back(neigh_lids[i]);
+    reliability_neighbors_[neigh_lids[i]].push_back(i);
+  }
+  // add the nearest neighbors that share the same seed
+  Point_Cloud_2D<scalar_t> point_cloud;
+  point_cloud.pts.resize(local_num_subsets_);
+  for(int_t i=0;i<local_num_subsets_;++i){
+    point_cloud.pts[i].x = local_field_value(i,SUBSET_COORDINATES_X_FS);
+    point_cloud.pts[i].y = local_field_value(i,SUBSET_COORDINATES_Y_FS);
+  }
+  kd_tree_2d_t kd_tree(2 /*dim*/, point_cloud, nanoflann::KDTreeSingleIndexAdaptorParams(10 /* max leaf */));
+  kd_tree.buildIndex();
+  const size_t num_neighbors = std::min(9,local_num_subsets_); // includes the subset itself
+  std::vector<size_t> ret_index(num_neighbors);
+  std::vector<scalar_t> out_dist_sqr(num_neighbors);
+  scalar_t query_pt[2];
+  for(int_t i=0;i<local_num_subsets_;++i){
+    query_pt[0] = point_cloud.pts[i].x;
+    query_pt[1] = point_cloud.pts[i].y;
+    kd_tree.knnSearch(&query_pt[0], num_neighbors, &ret_index[0], &out_dist_sqr[0]);
+    for(size_t j=0;j<num_neighbors;++j){
+      const int_t neigh = ret_index[j];
+      if(neigh==i||seed[neigh]!=seed[i]) continue;
+      reliability_neighbors_[i].push_back(neigh);
+      reliability_neighbors_[neigh].push_back(i);
+    }
+  }
+  for(int_t i=0;i<local_num_subsets_;++i){
+    std::sort(reliability_neighbors_[i].begin(),reliability_neighbors_[i].end());
+    reliability_neighbors_[i].erase(std::unique(reliability_neighbors_[i].begin(),reliability_neighbors_[i].end()),reliability_neighbors_[i].end());
+  }
+}
+
+void
+Schema::reliability_guided_correlation(){
+  // subsets only depend on each other if they are initialized with the neighbor values,
+  // otherwise every subset is a seed and they are all correlated in the first wave
+  const bool use_neighbors = initialization_method_==USE_NEIGHBOR_VALUES ||
+      (initialization_method_==USE_NEIGHBOR_VALUES_FIRST_STEP_ONLY && frame_id_==first_frame_id_);
+  if(use_neighbors&&(int_t)reliability_neighbors_.size()!=local_num_subsets_)
+    create_reliability_neighbors();
+#ifdef DICE_THREADED_WAVES
+  // only the initializers that do not keep state between calls can be called from several threads
+  const bool threaded = initialization_method_==USE_FIELD_VALUES || initialization_method_==USE_NEIGHBOR_VALUES ||
+      initialization_method_==USE_NEIGHBOR_VALUES_FIRST_STEP_ONLY || initialization_method_==USE_ZEROS ||
+      initialization_method_==USE_LOCAL_PHASE_CORRELATION || initialization_method_==USE_MOTION_MODEL;
+  const size_t wave_size = threaded ? omp_get_max_threads() : 1;
+#else
+  const size_t wave_size = 1;
+#endif
+  std::vector<int_t> processed(local_num_subsets_,0);
+  reliability_parents_.assign(local_num_subsets_,-1);
+  // frontier entries are the gamma of the converged parent and the local ids of the subset and its parent
+  typedef std::pair<scalar_t,std::pair<int_t,int_t> > frontier_entry;
+  std::priority_queue<frontier_entry,std::vector<frontier_entry>,std::greater<frontier_entry> > frontier;
+  std::vector<int_t> wave;
+  for(int_t i=0;i<local_num_subsets_;++i){
+    const int_t lid = subset_local_id(this_proc_gid_order_[i]);
+    const int_t neigh_gid = local_field_value(lid,NEIGHBOR_ID_FS);
+    if(!use_neighbors||neigh_gid<0||subset_local_id(neigh_gid)<0){
+      processed[lid] = 1;
+      wave.push_back(lid);
+    }
+  }
+  int_t num_waves = 0;
+  while(!wave.empty()){
+    DEBUG_MSG("Schema::reliability_guided_correlation(): wave " << num_waves << " correlating " << wave.size() << " subsets");
+    const int_t num_wave_subsets = wave.size();
+#ifdef DICE_THREADED_WAVES
+#pragma omp parallel for schedule(dynamic) if(threaded)
+#endif
+    for(int_t i=0;i<num_wave_subsets;++i)
+      correlate_subset(subset_global_id(wave[i]));
+    num_waves++;
+    if(use_neighbors){
+      for(size_t i=0;i<wave.size();++i){
+        const int_t lid = wave[i];
+        // failed subsets do not pass on their solution
+        if(local_field_value(lid,SIGMA_FS)==-1.0) continue;
+        const scalar_t gamma = local_field_value(lid,GAMMA_FS);
+        for(size_t j=0;j<reliability_neighbors_[lid].size();++j){
+          const int_t neigh = reliability_neighbors_[lid][j];
+          if(processed[neigh]==0)
+            frontier.push(frontier_entry(gamma,std::pair<int_t,int_t>(neigh,lid)));
+        }
+      }
+    }
+    wave.clear();
+    while(!frontier.empty()&&wave.size()<wave_size){
+      const int_t lid = frontier.top().second.first;
+      const int_t parent_lid = frontier.top().second.second;
+      frontier.pop();
+      if(processed[lid]!=0) continue;
+      processed[lid] = 1;
+      // the neighbor value initializer looks up the subset to initialize from here,
+      // the NEIGHBOR_ID field is left as defined by the user
+      reliability_parents_[lid] = subset_global_id(parent_lid);
+      wave.push_back(lid);
+    }
+  }
+  // subsets that could not be reached from a converged subset keep their original order and neighbor
+  for(int_t i=0;i<local_num_subsets_;++i){
+    const int_t subset_gid = this_proc_gid_order_[i];
+    if(processed[subset_local_id(subset_gid)]!=0) continue;
+    correlate_subset(subset_gid);
+  }
+  reliability_parents_.clear();
+  DEBUG_MSG("Schema::reliability_guided_correlation(): " << num_waves << " waves");
+}
+
 void
 Schema::record_failed_step(const int_t subset_gid,
   const int_t status,
   const int_t num_iterations){
   DEBUG_MSG("Subset " << subset_gid << " record failed step, status: " << status);
-  global_field_value(subset_gid,SIGMA_FS) = -1.0;
-  global_field_value(subset_gid,MATCH_FS) = -1.0;
-  global_field_value(subset_gid,GAMMA_FS) = -1.0;
-  global_field_value(subset_gid,BETA_FS) = -1.0;
-  global_field_value(subset_gid,OMEGA_FS) = -1.0;
-  global_field_value(subset_gid,NOISE_LEVEL_FS) = -1.0;
-  global_field_value(subset_gid,CONTRAST_LEVEL_FS) = -1.0;
-  global_field_value(subset_gid,ACTIVE_PIXELS_FS) = -1.0;
-  global_field_value(subset_gid,STATUS_FLAG_FS) = status;
-  global_field_value(subset_gid,ITERATIONS_FS) = num_iterations;
+  const int_t subset_lid = subset_local_id(subset_gid);
+  local_field_value(subset_lid,SIGMA_FS) = -1.0;
+  local_field_value(subset_lid,MATCH_FS) = -1.0;
+  local_field_value(subset_lid,GAMMA_FS) = -1.0;
+  local_field_value(subset_lid,BETA_FS) = -1.0;
+  local_field_value(subset_lid,OMEGA_FS) = -1.0;
+  local_field_value(subset_lid,NOISE_LEVEL_FS) = -1.0;
+  local_field_value(subset_lid,CONTRAST_LEVEL_FS) = -1.0;
+  local_field_value(subset_lid,ACTIVE_PIXELS_FS) = -1.0;
+  local_field_value(subset_lid,STATUS_FLAG_FS) = status;
+  local_field_value(subset_lid,ITERATIONS_FS) = num_iterations;
 }
 
 void
@@ -1769,15 +2134,16 @@ Schema::record_step(Teuchos::RCP<Objective> obj,
   const int_t subset_gid = obj->correlation_point_global_id();
   DEBUG_MSG("Subset " << subset_gid << " record step");
   shape_function->save_fields(this,subset_gid);
-  global_field_value(subset_gid,SIGMA_FS) = sigma;
-  global_field_value(subset_gid,MATCH_FS) = match; // 0 means data is successful
-  global_field_value(subset_gid,GAMMA_FS) = gamma;
-  global_field_value(subset_gid,BETA_FS) = beta;
-  global_field_value(subset_gid,NOISE_LEVEL_FS) = noise;
-  global_field_value(subset_gid,CONTRAST_LEVEL_FS) = contrast;
-  global_field_value(subset_gid,ACTIVE_PIXELS_FS) = active_pixels;
-  global_field_value(subset_gid,STATUS_FLAG_FS) = status;
-  global_field_value(subset_gid,ITERATIONS_FS) = num_iterations;
+  const int_t subset_lid = subset_local_id(subset_gid);
+  local_field_value(subset_lid,SIGMA_FS) = sigma;
+  local_field_value(subset_lid,MATCH_FS) = match; // 0 means data is successful
+  local_field_value(subset_lid,GAMMA_FS) = gamma;
+  local_field_value(subset_lid,BETA_FS) = beta;
+  local_field_value(subset_lid,NOISE_LEVEL_FS) = noise;
+  local_field_value(subset_lid,CONTRAST_LEVEL_FS) = contrast;
+  local_field_value(subset_lid,ACTIVE_PIXELS_FS) = active_pixels;
+  local_field_value(subset_lid,STATUS_FLAG_FS) = status;
+  local_field_value(subset_lid,ITERATIONS_FS) = num_iterations;
 }
 
 Status_Flag
@@ -1794,20 +2160,30 @@ Schema::initial_guess(const int_t subset_gid,
   return opt_initializers_.find(sid)->second->initial_guess(subset_gid,shape_function);
 }
 
+Teuchos::RCP<Motion_Model_Initializer>
+Schema::motion_model_initializer(const int_t subset_gid)const{
+  if(initialization_method_!=USE_MOTION_MODEL) return Teuchos::null;
+  const int_t sid = correlation_routine_==TRACKING_ROUTINE ? subset_gid : 0;
+  std::map<int_t,Teuchos::RCP<Initializer> >::const_iterator it = opt_initializers_.find(sid);
+  if(it==opt_initializers_.end()) return Teuchos::null;
+  return Teuchos::rcp_dynamic_cast<Motion_Model_Initializer>(it->second);
+}
+
 void
 Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
 
   const int_t subset_gid = obj->correlation_point_global_id();
-  TEUCHOS_TEST_FOR_EXCEPTION(subset_local_id(subset_gid)==-1,std::runtime_error,
+  const int_t subset_lid = subset_local_id(subset_gid);
+  TEUCHOS_TEST_FOR_EXCEPTION(subset_lid==-1,std::runtime_error,
     "Error: subset id is not local to this process.");
-  DEBUG_MSG("[PROC " << comm_->get_rank() << "] SUBSET " << subset_gid << " (" << global_field_value(subset_gid,SUBSET_COORDINATES_X_FS) <<
-    "," << global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS) << ")");
+  DEBUG_MSG("[PROC " << comm_->get_rank() << "] SUBSET " << subset_gid << " (" << local_field_value(subset_lid,SUBSET_COORDINATES_X_FS) <<
+    "," << local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS) << ")");
 
   // if for some reason the coordinates of this subset are outside the image domain, record a failed step,
   // this may have occurred for a subset in the left image projected to the right that is not in the right image
   if(subset_dim_ > 0){
-    const scalar_t current_pos_x = global_field_value(subset_gid,SUBSET_COORDINATES_X_FS) + global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS);
-    const scalar_t current_pos_y = global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS) + global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS);
+    const scalar_t current_pos_x = local_field_value(subset_lid,SUBSET_COORDINATES_X_FS) + local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS);
+    const scalar_t current_pos_y = local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS) + local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS);
     if(current_pos_x < def_imgs_[0]->offset_x()+subset_dim_/2 || current_pos_x > def_imgs_[0]->width()+def_imgs_[0]->offset_x() - subset_dim_/2 ||
         current_pos_y < def_imgs_[0]->offset_y()+subset_dim_/2 || current_pos_y > def_imgs_[0]->height()+def_imgs_[0]->offset_y() - subset_dim_/2){
       DEBUG_MSG("Invalid subset origin (probably from stereo projection of the left subset not being in the right image)" <<
@@ -1838,9 +2214,9 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
   if(!motion){
     DEBUG_MSG("Subset " << subset_gid << " skipping frame due to no motion");
     // only change the match value and the status flag
-    global_field_value(subset_gid,MATCH_FS) = 0.0;
-    global_field_value(subset_gid,STATUS_FLAG_FS) = static_cast<int_t>(FRAME_SKIPPED_DUE_TO_NO_MOTION);
-    global_field_value(subset_gid,ITERATIONS_FS) = 0;
+    local_field_value(subset_lid,MATCH_FS) = 0.0;
+    local_field_value(subset_lid,STATUS_FLAG_FS) = static_cast<int_t>(FRAME_SKIPPED_DUE_TO_NO_MOTION);
+    local_field_value(subset_lid,ITERATIONS_FS) = 0;
     return;
   }
   //
@@ -1850,8 +2226,20 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
   Status_Flag corr_status = CORRELATION_FAILED;
   int_t num_iterations = -1;
   Teuchos::RCP<Local_Shape_Function> shape_function = shape_function_factory(this);
+  // the motion model (if used) centers the fallback search and the jump test on its prediction
+  scalar_t predicted_motion[3] = {0.0,0.0,0.0};
+  scalar_t predicted_std_dev[3] = {0.0,0.0,0.0};
+  bool has_prediction = false;
+  Teuchos::RCP<Motion_Model_Initializer> motion_model = motion_model_initializer(subset_gid);
+  if(motion_model!=Teuchos::null)
+    has_prediction = motion_model->prediction(subset_gid,predicted_motion,predicted_std_dev);
   try{
     init_status = initial_guess(subset_gid,shape_function);
+    // refine the guess coarse-to-fine on the image pyramids so that large motions land within reach of the optimizer
+    if(init_status!=INITIALIZE_FAILED&&num_image_pyramid_levels_>1&&shape_function_type_!=DICe::RIGID_BODY_SF){
+      Pyramid_Initializer pyramid_initializer(this,obj->subset());
+      init_status = pyramid_initializer.initial_guess(subset_gid,shape_function);
+    }
   }
   catch (...) { // a non-graceful exception occurred in initialization
     record_failed_step(subset_gid,static_cast<int_t>(INITIALIZE_FAILED_BY_EXCEPTION),num_iterations);
@@ -1868,13 +2256,20 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
       stat_container_->register_search_call(subset_gid,frame_id_);
       // before giving up, try a search initialization, then simplex, then give up if it still can't track:
       const scalar_t search_step_xy = 1.0; // pixels
-      const scalar_t search_dim_xy = 10.0; // pixels
+      scalar_t search_dim_xy = 10.0; // pixels
       const scalar_t search_step_theta = 0.01; // radians (keep theta the same)
       const scalar_t search_dim_theta = 0.0;
       // reset the deformation position to the previous step's value
       shape_function->clear();
-      shape_function->insert_motion(global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS),global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS),
-        global_field_value(subset_gid,ROTATION_Z_FS));
+      if(has_prediction){
+        // search three standard deviations around the predicted position
+        shape_function->insert_motion(predicted_motion[0],predicted_motion[1],predicted_motion[2]);
+        search_dim_xy = motion_model->search_dim(subset_gid,search_step_xy,search_dim_xy);
+        DEBUG_MSG("Subset " << subset_gid << " search initialization around the motion model prediction, search dim " << search_dim_xy);
+      }
+      else
+        shape_function->insert_motion(local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS),local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS),
+          local_field_value(subset_lid,ROTATION_Z_FS));
       Search_Initializer searcher(this,obj->subset(),search_step_xy,search_dim_xy,search_step_xy,search_dim_xy,search_step_theta,search_dim_theta);
       init_status = searcher.initial_guess(subset_gid,shape_function);
     }
@@ -1955,9 +2350,10 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
       }
     } // loop over obstructing subset ids
   } // end !override force simplex
-  const scalar_t prev_u = global_field_value(subset_gid,SUBSET_DISPLACEMENT_X_FS);
-  const scalar_t prev_v = global_field_value(subset_gid,SUBSET_DISPLACEMENT_Y_FS);
-  const scalar_t prev_t = global_field_value(subset_gid,ROTATION_Z_FS);
+  // with a motion model the jump is measured from the predicted position rather than the last one
+  const scalar_t prev_u = has_prediction ? predicted_motion[0] : local_field_value(subset_lid,SUBSET_DISPLACEMENT_X_FS);
+  const scalar_t prev_v = has_prediction ? predicted_motion[1] : local_field_value(subset_lid,SUBSET_DISPLACEMENT_Y_FS);
+  const scalar_t prev_t = has_prediction ? predicted_motion[2] : local_field_value(subset_lid,ROTATION_Z_FS);
   //
   // perform the correlation
   //
@@ -1984,7 +2380,7 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
   // test for jump failure (too high displacement or rotation from last step due to subset getting lost)
   bool jump_pass = true;
   scalar_t new_u = 0.0,new_v = 0.0, new_t = 0.0;
-  shape_function->map_to_u_v_theta(global_field_value(subset_gid,SUBSET_COORDINATES_X_FS),global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS),
+  shape_function->map_to_u_v_theta(local_field_value(subset_lid,SUBSET_COORDINATES_X_FS),local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS),
     new_u,new_v,new_t);
   scalar_t diffU = new_u - prev_u;
   scalar_t diffV = new_v - prev_v;
@@ -1997,13 +2393,42 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
   DEBUG_MSG("Subset " << subset_gid << " jump pass: " << jump_pass);
   if(corr_status!=CORRELATION_SUCCESSFUL||!jump_pass){
     bool second_attempt_failed = false;
+    // with a motion model the second attempt starts from the best point of a search
+    // three predicted standard deviations around the prediction
+    const bool predicted_search = has_prediction&&shape_function_type_!=DICe::RIGID_BODY_SF;
+    const scalar_t predicted_search_step = 1.0; // pixels
+    const scalar_t predicted_search_dim = predicted_search ?
+        motion_model->search_dim(subset_gid,predicted_search_step,10.0) : 0.0;
     if(optimization_method_==DICe::SIMPLEX||optimization_method_==DICe::GRADIENT_BASED||force_simplex){
       second_attempt_failed = true;
+      if(predicted_search){
+        if(correlation_routine_==TRACKING_ROUTINE) stat_container_->register_search_call(subset_gid,frame_id_);
+        DEBUG_MSG("Subset " << subset_gid << " retrying from a search around the motion model prediction, search dim " << predicted_search_dim);
+        init_status = initial_guess(subset_gid,shape_function);
+        Search_Initializer searcher(this,obj->subset(),predicted_search_step,predicted_search_dim,
+          predicted_search_step,predicted_search_dim,0.01,0.0);
+        init_status = searcher.initial_guess(subset_gid,shape_function);
+        try{
+          if(optimization_method_==DICe::SIMPLEX||force_simplex)
+            corr_status = obj->computeUpdateRobust(shape_function,num_iterations);
+          else
+            corr_status = obj->computeUpdateFast(shape_function,num_iterations);
+        }
+        catch (...) { //a non-graceful exception occurred
+          corr_status = CORRELATION_FAILED_BY_EXCEPTION;
+        };
+      }
     }
     else if(optimization_method_==DICe::GRADIENT_BASED_THEN_SIMPLEX||optimization_method_==DICe::GRADIENT_THEN_SEARCH){
       if(correlation_routine_==TRACKING_ROUTINE) stat_container_->register_backup_opt_call(subset_gid,frame_id_);
       // try again using simplex
       init_status = initial_guess(subset_gid,shape_function);
+      if(predicted_search&&optimization_method_==DICe::GRADIENT_BASED_THEN_SIMPLEX){
+        DEBUG_MSG("Subset " << subset_gid << " simplex backup from a search around the motion model prediction, search dim " << predicted_search_dim);
+        Search_Initializer searcher(this,obj->subset(),predicted_search_step,predicted_search_dim,
+          predicted_search_step,predicted_search_dim,0.01,0.0);
+        init_status = searcher.initial_guess(subset_gid,shape_function);
+      }
       if(optimization_method_==DICe::GRADIENT_BASED_THEN_SIMPLEX){
         try{
           corr_status = obj->computeUpdateRobust(shape_function,num_iterations);
@@ -2014,12 +2439,13 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
       }
       else if(optimization_method_==DICe::GRADIENT_THEN_SEARCH){
         // search farther in x because we assume that the cross correlation is between two cameras with the same y
+        // (with a motion model the guess above is the prediction, so only three predicted standard deviations are searched)
         const scalar_t search_step_u = 1.0; // pixels
-        const scalar_t search_dim_u = 50.0; // pixels
+        const scalar_t search_dim_u = motion_model!=Teuchos::null ? motion_model->search_dim(subset_gid,search_step_u,50.0) : 50.0; // pixels
         Search_Initializer searcher(this,obj->subset(),search_step_u,search_dim_u,-1.0,0.0,-1.0,0.0);
         init_status = searcher.initial_guess(subset_gid,shape_function);
         scalar_t min_u = 0.0,min_v = 0.0, min_t = 0.0;
-        shape_function->map_to_u_v_theta(global_field_value(subset_gid,SUBSET_COORDINATES_X_FS),global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS),
+        shape_function->map_to_u_v_theta(local_field_value(subset_lid,SUBSET_COORDINATES_X_FS),local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS),
           min_u,min_v,min_t);
         DEBUG_MSG("Subset " << subset_gid << " GRADIENT_THEN_SEARCH method used, search-based initial u: " << min_u);// << " v: " << min_v);
         try{
@@ -2036,6 +2462,12 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
       if(correlation_routine_==TRACKING_ROUTINE) stat_container_->register_backup_opt_call(subset_gid,frame_id_);
       // try again using gradient based
       init_status = initial_guess(subset_gid,shape_function);
+      if(predicted_search){
+        DEBUG_MSG("Subset " << subset_gid << " gradient based backup from a search around the motion model prediction, search dim " << predicted_search_dim);
+        Search_Initializer searcher(this,obj->subset(),predicted_search_step,predicted_search_dim,
+          predicted_search_step,predicted_search_dim,0.01,0.0);
+        init_status = searcher.initial_guess(subset_gid,shape_function);
+      }
       try{
           corr_status = obj->computeUpdateFast(shape_function,num_iterations);
       }
@@ -2085,7 +2517,7 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
     Teuchos::RCP<Path_Initializer> path_initializer =
         Teuchos::rcp_dynamic_cast<Path_Initializer>(opt_initializers_.find(subset_gid)->second);
     scalar_t pt_u = 0.0,pt_v = 0.0,pt_t=0.0;
-    shape_function->map_to_u_v_theta(global_field_value(subset_gid,SUBSET_COORDINATES_X_FS),global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS),
+    shape_function->map_to_u_v_theta(local_field_value(subset_lid,SUBSET_COORDINATES_X_FS),local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS),
       pt_u,pt_v,pt_t);
     path_initializer->closest_triad(pt_u,pt_v,pt_t,id,path_distance);
     DEBUG_MSG("Subset " << subset_gid << " path distance: " << path_distance);
@@ -2101,7 +2533,7 @@ Schema::generic_correlation_routine(Teuchos::RCP<Objective> obj){
   //  Test jumps again
   //
   new_u = 0.0;new_v = 0.0;new_t = 0.0;
-  shape_function->map_to_u_v_theta(global_field_value(subset_gid,SUBSET_COORDINATES_X_FS),global_field_value(subset_gid,SUBSET_COORDINATES_Y_FS),
+  shape_function->map_to_u_v_theta(local_field_value(subset_lid,SUBSET_COORDINATES_X_FS),local_field_value(subset_lid,SUBSET_COORDINATES_Y_FS),
     new_u,new_v,new_t);
   diffU = new_u - prev_u;
   diffV = new_v - prev_v;
@@ -2217,7 +2649,6 @@ Schema::estimate_resolution_error(const Teuchos::RCP<Teuchos::ParameterList> & c
   // search the mesh fields to see if vsg or nlvc strain exist:
   const bool has_vsg = mesh_->has_field(VSG_STRAIN_XX);
   const bool has_nlvc = mesh_->has_field(NLVC_STRAIN_XX);
-  const bool is_subset_based = analysis_type_ == LOCAL_DIC;
 
   scalar_t subset_elem_size = 0.0;
   scalar_t step_size = -1.0;
@@ -2280,38 +2711,6 @@ Schema::estimate_resolution_error(const Teuchos::RCP<Teuchos::ParameterList> & c
   DEBUG_MSG("Attempting to create directory : " << data_dir_str);
   create_directory(data_dir_str);
 
-  std::stringstream result_stream;
-
-  // populate the exact sol, etc
-  mesh_->create_field(EXACT_SOL_VECTOR_FS);
-  Teuchos::RCP<MultiField> exact_disp = mesh_->get_field(EXACT_SOL_VECTOR_FS);
-  mesh_->create_field(EXACT_STRAIN_XX_FS);
-  Teuchos::RCP<MultiField> exact_strain_xx = mesh_->get_field(EXACT_STRAIN_XX_FS);
-  mesh_->create_field(EXACT_STRAIN_YY_FS);
-  Teuchos::RCP<MultiField> exact_strain_yy = mesh_->get_field(EXACT_STRAIN_YY_FS);
-  mesh_->create_field(EXACT_STRAIN_XY_FS);
-  Teuchos::RCP<MultiField> exact_strain_xy = mesh_->get_field(EXACT_STRAIN_XY_FS);
-  // create the error fields
-  mesh_->create_field(DISP_ERROR_FS);
-  Teuchos::RCP<MultiField> disp_error = mesh_->get_field(DISP_ERROR_FS);
-  Teuchos::RCP<MultiField> vsg_error_xx, vsg_error_xy, vsg_error_yy, nlvc_error_xx, nlvc_error_xy, nlvc_error_yy;
-  if(has_vsg){
-    mesh_->create_field(VSG_STRAIN_XX_ERROR_FS);
-    vsg_error_xx = mesh_->get_field(VSG_STRAIN_XX_ERROR_FS);
-    mesh_->create_field(VSG_STRAIN_XY_ERROR_FS);
-    vsg_error_xy = mesh_->get_field(VSG_STRAIN_XY_ERROR_FS);
-    mesh_->create_field(VSG_STRAIN_YY_ERROR_FS);
-    vsg_error_yy = mesh_->get_field(VSG_STRAIN_YY_ERROR_FS);
-  }
-  if(has_nlvc){
-    mesh_->create_field(NLVC_STRAIN_XX_ERROR_FS);
-    nlvc_error_xx = mesh_->get_field(NLVC_STRAIN_XX_ERROR_FS);
-    mesh_->create_field(NLVC_STRAIN_XY_ERROR_FS);
-    nlvc_error_xy = mesh_->get_field(NLVC_STRAIN_XY_ERROR_FS);
-    mesh_->create_field(NLVC_STRAIN_YY_ERROR_FS);
-    nlvc_error_yy = mesh_->get_field(NLVC_STRAIN_YY_ERROR_FS);
-  }
-
   // generate synthetic speckled image instead of using the reference image
   if(speckle_size >= 1.0){
     TEUCHOS_TEST_FOR_EXCEPTION(speckle_size > 500.0,std::runtime_error,"Error, unreasonable speckle size: " << speckle_size);
@@ -2361,257 +2760,405 @@ Schema::estimate_resolution_error(const Teuchos::RCP<Teuchos::ParameterList> & c
     fprintf(infoFilePtr,"\n");
     fclose(infoFilePtr);
   }
-  const int_t spa_dim = mesh_->spatial_dimension();
-  for(scalar_t period=max_period;period>=min_period;period*=period_factor){
-    // reset the displacements between frequency updates, otherwise the existing solution makes a nice initial guess
-    if(is_subset_based){
-      mesh_->get_field(SUBSET_DISPLACEMENT_X_FS)->put_scalar(0.0);
-      mesh_->get_field(SUBSET_DISPLACEMENT_Y_FS)->put_scalar(0.0);
-    }else{
-      mesh_->get_field(DISPLACEMENT_FS)->put_scalar(0.0);
-    }
-    mesh_->get_field(SIGMA_FS)->put_scalar(0.0);
-    for(scalar_t amplitude=min_amp;amplitude<=max_amp;amplitude+=amp_step){
-      if(proc_id==0)
-        std::cout << "processing resolution error for period " << period << " amplitude " << amplitude << std::endl;
-      // create an image deformer class
-      image_deformer_ = Teuchos::rcp(new SinCos_Image_Deformer(period,amplitude));
-      std::stringstream sincos_name;
-      Teuchos::RCP<Image> def_img;
-      std::stringstream amp_ss;
-      std::stringstream per_ss;
-      amp_ss << amplitude;
-      std::string amp_s = amp_ss.str();
-      std::replace( amp_s.begin(), amp_s.end(), '.', 'p'); // replace dots with p for file name
-      per_ss << period;
-      std::string per_s = per_ss.str();
-      std::replace( per_s.begin(), per_s.end(), '.', 'p'); // replace dots with p for file name
-      sincos_name << image_dir_str << "amp_" << std::setprecision(4) << amp_s << "_period_" << std::setprecision(4) << per_s << "_proc_" << proc_id << ".tif";
-
-      // check to see if the deformed image already exists:
-      std::ifstream f(sincos_name.str().c_str());
-      //if(f.good()){
-      //  DEBUG_MSG("using previously saved image");
-      //  def_img = Teuchos::rcp(new DICe::Image(sincos_name.str().c_str()));
-      //}else{
-        DEBUG_MSG("generating new synthetic image");
-        def_img = image_deformer_->deform_image(ref_img());
-        if(noise_percent > 0.0){
-          add_noise_to_image(def_img,noise_percent);
-        }
-        def_img->write(sincos_name.str());
-      //}
-
-      // set the deformed image for the schema
-      set_def_image(def_img);
-      int_t corr_error = execute_correlation();
-      TEUCHOS_TEST_FOR_EXCEPTION(corr_error,std::runtime_error,"Error, correlation unsuccesssful");
-      DEBUG_MSG("Error prediction step correlation return value " << corr_error);
-      execute_post_processors();
-      post_execution_tasks();
-
-      // gather all owned fields here
-      Teuchos::RCP<MultiField> coords = mesh_->get_field(INITIAL_COORDINATES_FS);
-      Teuchos::RCP<MultiField> disp;
-      if(is_subset_based){
-        Teuchos::RCP<MultiField> disp_x = mesh_->get_field(SUBSET_DISPLACEMENT_X_FS);
-        Teuchos::RCP<MultiField> disp_y = mesh_->get_field(SUBSET_DISPLACEMENT_Y_FS);
-        Teuchos::RCP<MultiField_Map> map = mesh_->get_vector_node_dist_map();
-        disp = Teuchos::rcp( new MultiField(map,1,true));
-        for(int_t i=0;i<local_num_subsets_;++i){
-          disp->local_value(i*spa_dim+0) = disp_x->local_value(i);
-          disp->local_value(i*spa_dim+1) = disp_y->local_value(i);
+  // every row of the spatial resolution file starts with the settings of the sweep
+  std::stringstream row_prefix;
+  row_prefix << subset_elem_size << " " << step_size << " " << avg_speckle_size << " " << noise_percent << " " << vsg_size << " " << nlvc_size;
+  std::vector<scalar_t> periods;
+  for(scalar_t period=max_period;period>=min_period;period*=period_factor)
+    periods.push_back(period);
+  const int_t num_periods = periods.size();
+
+  int_t num_workers = 1;
+#ifdef DICE_THREADED_WAVES
+  // the periods are independent (each one starts from zero displacements) so they are correlated concurrently
+  // on separate schemas when this process owns all of the subsets (the error statistics are collective)
+  const bool can_clone = analysis_type_==LOCAL_DIC && comm_->get_size()==1 && motion_window_params_->empty()
+      && path_file_names_->empty() && skip_solve_flags_->empty() && optical_flow_flags_->empty();
+  if(can_clone)
+    num_workers = std::min(num_periods,(int_t)omp_get_max_threads());
+#endif
+  if(num_workers>1){
+#ifdef DICE_THREADED_WAVES
+    DEBUG_MSG("Schema::estimate_resolution_error(): correlating " << num_periods << " periods on " << num_workers << " worker schemas");
+    std::vector<Teuchos::RCP<Schema> > workers(num_workers);
+    std::vector<std::string> worker_prefixes(num_workers);
+    for(int_t worker=0;worker<num_workers;++worker){
+      std::stringstream worker_prefix;
+      worker_prefix << prefix << "_worker_" << worker;
+      worker_prefixes[worker] = worker_prefix.str();
+      workers[worker] = resolution_error_worker(worker_prefixes[worker]);
+    }
+    std::vector<std::string> period_rows(num_periods);
+    int_t num_failed = 0;
+    std::string failure;
+#pragma omp parallel for schedule(static,1) num_threads(num_workers)
+    for(int_t period_it=0;period_it<num_periods;++period_it){
+      const int_t worker = omp_get_thread_num();
+      try{
+        period_rows[period_it] = workers[worker]->resolution_error_period(periods[period_it],correlation_params,
+          row_prefix.str(),image_dir_str,output_folder,worker_prefixes[worker]);
+      }
+      catch(std::exception & e){
+#pragma omp critical (resolution_error_failure)
+        {
+          num_failed++;
+          failure = e.what();
         }
-      }else{
-        disp = mesh_->get_field(DISPLACEMENT_FS);
       }
-      Teuchos::RCP<MultiField> vsg_xx;
-      Teuchos::RCP<MultiField> vsg_xy;
-      Teuchos::RCP<MultiField> vsg_yy;
-      Teuchos::RCP<MultiField> nlvc_xx;
-      Teuchos::RCP<MultiField> nlvc_xy;
-      Teuchos::RCP<MultiField> nlvc_yy;
-      if(has_vsg){
-        vsg_xx = mesh_->get_field(VSG_STRAIN_XX_FS);
-        vsg_xy = mesh_->get_field(VSG_STRAIN_XY_FS);
-        vsg_yy = mesh_->get_field(VSG_STRAIN_YY_FS);
+    }
+    TEUCHOS_TEST_FOR_EXCEPTION(num_failed>0,std::runtime_error,"Error, resolution error sweep failed on " << num_failed << " periods: " << failure);
+    // merge the rows in the order of the sweep
+    if(proc_id==0){
+      std::FILE * infoFilePtr = fopen(data_name.str().c_str(),"a");
+      for(int_t period_it=0;period_it<num_periods;++period_it){
+        fprintf(infoFilePtr,"%s",period_rows[period_it].c_str());
+        *outStream << period_rows[period_it];
       }
-      if(has_nlvc){
-        nlvc_xx = mesh_->get_field(NLVC_STRAIN_XX_FS);
-        nlvc_xy = mesh_->get_field(NLVC_STRAIN_XY_FS);
-        nlvc_yy = mesh_->get_field(NLVC_STRAIN_YY_FS);
+      fclose(infoFilePtr);
+    }
+#endif
+  }
+  else{
+    for(int_t period_it=0;period_it<num_periods;++period_it){
+      const std::string rows = resolution_error_period(periods[period_it],correlation_params,
+        row_prefix.str(),image_dir_str,output_folder,prefix);
+      // write the results to the .info file
+      if(proc_id==0){
+        std::FILE * infoFilePtr = fopen(data_name.str().c_str(),"a");
+        fprintf(infoFilePtr,"%s",rows.c_str());
+        fclose(infoFilePtr);
+        *outStream << rows;
       }
-      // compute the error fields
-      for(int_t i=0;i<local_num_subsets_;++i){
-        const scalar_t x = coords->local_value(i*spa_dim+0);
-        const scalar_t y = coords->local_value(i*spa_dim+1);
-        const scalar_t u = disp->local_value(i*spa_dim+0);
-        const scalar_t v = disp->local_value(i*spa_dim+1);
-        scalar_t exact_u = 0.0;
-        scalar_t exact_v = 0.0;
-        image_deformer_->compute_deformation(x,y,exact_u,exact_v);
-        exact_disp->local_value(i*spa_dim+0) = exact_u;
-        exact_disp->local_value(i*spa_dim+1) = exact_v;
-        scalar_t error_v = 0.0;
-        scalar_t error_u = 0.0;
-        image_deformer_->compute_displacement_error(x,y,u,v,error_u,error_v);
-        disp_error->local_value(i*spa_dim+0) = std::abs(error_u);
-        disp_error->local_value(i*spa_dim+1) = std::abs(error_v);
-        scalar_t strain_xx = 0.0;
-        scalar_t strain_xy = 0.0;
-        scalar_t strain_yy = 0.0;
-        image_deformer_->compute_lagrange_strain(x,y,strain_xx,strain_xy,strain_yy);
-        exact_strain_xx->local_value(i) = strain_xx;
-        exact_strain_xy->local_value(i) = strain_xy;
-        exact_strain_yy->local_value(i) = strain_yy;
-        if(has_vsg){
-          const scalar_t e_xx = vsg_xx->local_value(i);
-          const scalar_t e_xy = vsg_xy->local_value(i);
-          const scalar_t e_yy = vsg_yy->local_value(i);
-          scalar_t error_xx = 0.0;
-          scalar_t error_xy = 0.0;
-          scalar_t error_yy = 0.0;
-          image_deformer_->compute_lagrange_strain_error(x,y,e_xx,e_xy,e_yy,error_xx,error_xy,error_yy);
-          vsg_error_xx->local_value(i) = std::abs(error_xx);
-          vsg_error_xy->local_value(i) = std::abs(error_xy);
-          vsg_error_yy->local_value(i) = std::abs(error_yy);
-        }
-        if(has_nlvc){
-          const scalar_t e_xx = nlvc_xx->local_value(i);
-          const scalar_t e_xy = nlvc_xy->local_value(i);
-          const scalar_t e_yy = nlvc_yy->local_value(i);
-          scalar_t error_xx = 0.0;
-          scalar_t error_xy = 0.0;
-          scalar_t error_yy = 0.0;
-          image_deformer_->compute_lagrange_strain_error(x,y,e_xx,e_xy,e_yy,error_xx,error_xy,error_yy);
-          nlvc_error_xx->local_value(i) = std::abs(error_xx);
-          nlvc_error_xy->local_value(i) = std::abs(error_xy);
-          nlvc_error_yy->local_value(i) = std::abs(error_yy);
-        }
-      } // end local subsets loop
-
-      result_stream << subset_elem_size << " " << step_size << " " << avg_speckle_size << " " << noise_percent << " " << vsg_size << " " << nlvc_size;
-
-      // collect the global stats based on the field info above:
-      scalar_t min_error_u = 0.0;
-      scalar_t max_error_u = 0.0;
-      scalar_t avg_error_u = 0.0;
-      scalar_t std_dev_error_u = 0.0;
-      scalar_t min_error_v = 0.0;
-      scalar_t max_error_v = 0.0;
-      scalar_t avg_error_v = 0.0;
-      scalar_t std_dev_error_v = 0.0;
-      mesh_->field_stats(DISP_ERROR_FS,min_error_u,max_error_u,avg_error_u,std_dev_error_u,0,SIGMA_FS,-1.0);
-      mesh_->field_stats(DISP_ERROR_FS,min_error_v,max_error_v,avg_error_v,std_dev_error_v,1,SIGMA_FS,-1.0);
-      result_stream << " " << std::setprecision(4) << period << " "<< std::setprecision(4) << amplitude
-          << " " << min_error_u << " " << max_error_u << " " << avg_error_u << " " << std_dev_error_u << " " << min_error_v << " " << max_error_v << " " << avg_error_v << " " << std_dev_error_v;
-
-      scalar_t peaks_avg_error_x = 0.0;
-      scalar_t peaks_std_dev_error_x = 0.0;
-      scalar_t peaks_avg_error_y = 0.0;
-      scalar_t peaks_std_dev_error_y = 0.0;
-      // analyze the peaks of the output to evaluate the roll off
-      compute_roll_off_stats(period,full_ref_img_width_,full_ref_img_height_,coords,disp,exact_disp,disp_error,
-        peaks_avg_error_x,peaks_std_dev_error_x,peaks_avg_error_y,peaks_std_dev_error_y);
-      result_stream << " " << peaks_avg_error_x << " " << peaks_std_dev_error_x << " " << peaks_avg_error_y << " " << peaks_std_dev_error_y;
+    }
+  }
+#endif
+}
+
+Teuchos::RCP<Schema>
+Schema::resolution_error_worker(const std::string & worker_prefix){
+  TEUCHOS_TEST_FOR_EXCEPTION(analysis_type_!=LOCAL_DIC,std::runtime_error,"Error, resolution error workers are only available for subset based analyses");
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList(*init_params_));
+  params->set(DICe::output_prefix,worker_prefix);
+  // same subsets in the same global id order
+  Teuchos::ArrayRCP<scalar_t> coords_x(local_num_subsets_,0.0);
+  Teuchos::ArrayRCP<scalar_t> coords_y(local_num_subsets_,0.0);
+  Teuchos::RCP<std::vector<int_t> > neighbor_ids = Teuchos::rcp(new std::vector<int_t>(local_num_subsets_,-1));
+  TEUCHOS_TEST_FOR_EXCEPTION(local_num_subsets_!=global_num_subsets_,std::runtime_error,"Error, resolution error workers require all subsets on this process");
+  for(int_t i=0;i<local_num_subsets_;++i){
+    const int_t gid = subset_global_id(i);
+    coords_x[gid] = local_field_value(i,SUBSET_COORDINATES_X_FS);
+    coords_y[gid] = local_field_value(i,SUBSET_COORDINATES_Y_FS);
+    (*neighbor_ids)[gid] = (int_t)local_field_value(i,NEIGHBOR_ID_FS);
+  }
+  Teuchos::RCP<Schema> worker = Teuchos::rcp(new Schema(coords_x,coords_y,subset_dim_,conformal_subset_defs_,neighbor_ids,params));
+  worker->set_step_size(step_size_x_,step_size_y_);
+  worker->set_obstructing_subset_ids(obstructing_subset_ids_);
+  worker->set_force_simplex(force_simplex_);
+  worker->full_ref_img_width_ = full_ref_img_width_;
+  worker->full_ref_img_height_ = full_ref_img_height_;
+  // the reference image (already filtered, rotated, with gradients and pyramid) is only read during the sweep so it is shared
+  worker->ref_img_ = ref_img_;
+  worker->prev_imgs_[0] = ref_img_;
+  return worker;
+}
+
+std::string
+Schema::resolution_error_period(const scalar_t & period,
+  const Teuchos::RCP<Teuchos::ParameterList> & correlation_params,
+  const std::string & row_prefix,
+  const std::string & image_dir_str,
+  const std::string & output_folder,
+  const std::string & prefix){
+  std::string rows;
+#if DICE_KOKKOS
+#else
+  const int_t proc_id = comm_->get_rank();
+  const scalar_t min_amp = correlation_params->get<scalar_t>(DICe::estimate_resolution_error_min_amplitude,0.5);
+  const scalar_t max_amp = correlation_params->get<scalar_t>(DICe::estimate_resolution_error_max_amplitude,4.0);
+  const scalar_t amp_step = correlation_params->get<scalar_t>(DICe::estimate_resolution_error_amplitude_step,0.5);
+  const scalar_t noise_percent = correlation_params->get<scalar_t>(DICe::estimate_resolution_error_noise_percent,-1.0);
+  const bool has_vsg = mesh_->has_field(VSG_STRAIN_XX);
+  const bool has_nlvc = mesh_->has_field(NLVC_STRAIN_XX);
+  const bool is_subset_based = analysis_type_ == LOCAL_DIC;
+  const int_t spa_dim = mesh_->spatial_dimension();
+  std::stringstream result_stream;
 
+  // populate the exact sol, etc
+  mesh_->create_field(EXACT_SOL_VECTOR_FS);
+  Teuchos::RCP<MultiField> exact_disp = mesh_->get_field(EXACT_SOL_VECTOR_FS);
+  mesh_->create_field(EXACT_STRAIN_XX_FS);
+  Teuchos::RCP<MultiField> exact_strain_xx = mesh_->get_field(EXACT_STRAIN_XX_FS);
+  mesh_->create_field(EXACT_STRAIN_YY_FS);
+  Teuchos::RCP<MultiField> exact_strain_yy = mesh_->get_field(EXACT_STRAIN_YY_FS);
+  mesh_->create_field(EXACT_STRAIN_XY_FS);
+  Teuchos::RCP<MultiField> exact_strain_xy = mesh_->get_field(EXACT_STRAIN_XY_FS);
+  // create the error fields
+  mesh_->create_field(DISP_ERROR_FS);
+  Teuchos::RCP<MultiField> disp_error = mesh_->get_field(DISP_ERROR_FS);
+  Teuchos::RCP<MultiField> vsg_error_xx, vsg_error_xy, vsg_error_yy, nlvc_error_xx, nlvc_error_xy, nlvc_error_yy;
+  if(has_vsg){
+    mesh_->create_field(VSG_STRAIN_XX_ERROR_FS);
+    vsg_error_xx = mesh_->get_field(VSG_STRAIN_XX_ERROR_FS);
+    mesh_->create_field(VSG_STRAIN_XY_ERROR_FS);
+    vsg_error_xy = mesh_->get_field(VSG_STRAIN_XY_ERROR_FS);
+    mesh_->create_field(VSG_STRAIN_YY_ERROR_FS);
+    vsg_error_yy = mesh_->get_field(VSG_STRAIN_YY_ERROR_FS);
+  }
+  if(has_nlvc){
+    mesh_->create_field(NLVC_STRAIN_XX_ERROR_FS);
+    nlvc_error_xx = mesh_->get_field(NLVC_STRAIN_XX_ERROR_FS);
+    mesh_->create_field(NLVC_STRAIN_XY_ERROR_FS);
+    nlvc_error_xy = mesh_->get_field(NLVC_STRAIN_XY_ERROR_FS);
+    mesh_->create_field(NLVC_STRAIN_YY_ERROR_FS);
+    nlvc_error_yy = mesh_->get_field(NLVC_STRAIN_YY_ERROR_FS);
+  }
+
+  // reset the displacements between frequency updates, otherwise the existing solution makes a nice initial guess
+  if(is_subset_based){
+    mesh_->get_field(SUBSET_DISPLACEMENT_X_FS)->put_scalar(0.0);
+    mesh_->get_field(SUBSET_DISPLACEMENT_Y_FS)->put_scalar(0.0);
+  }else{
+    mesh_->get_field(DISPLACEMENT_FS)->put_scalar(0.0);
+  }
+  mesh_->get_field(SIGMA_FS)->put_scalar(0.0);
+  for(scalar_t amplitude=min_amp;amplitude<=max_amp;amplitude+=amp_step){
+    if(proc_id==0)
+      std::cout << "processing resolution error for period " << period << " amplitude " << amplitude << std::endl;
+    // create an image deformer class
+    image_deformer_ = Teuchos::rcp(new SinCos_Image_Deformer(period,amplitude));
+    std::stringstream sincos_name;
+    Teuchos::RCP<Image> def_img;
+    std::stringstream amp_ss;
+    std::stringstream per_ss;
+    amp_ss << amplitude;
+    std::string amp_s = amp_ss.str();
+    std::replace( amp_s.begin(), amp_s.end(), '.', 'p'); // replace dots with p for file name
+    per_ss << period;
+    std::string per_s = per_ss.str();
+    std::replace( per_s.begin(), per_s.end(), '.', 'p'); // replace dots with p for file name
+    sincos_name << image_dir_str << "amp_" << std::setprecision(4) << amp_s << "_period_" << std::setprecision(4) << per_s << "_proc_" << proc_id << ".tif";
+
+    // check to see if the deformed image already exists:
+    std::ifstream f(sincos_name.str().c_str());
+    //if(f.good()){
+    //  DEBUG_MSG("using previously saved image");
+    //  def_img = Teuchos::rcp(new DICe::Image(sincos_name.str().c_str()));
+    //}else{
+      DEBUG_MSG("generating new synthetic image");
+      def_img = image_deformer_->deform_image(ref_img());
+      if(noise_percent > 0.0){
+        add_noise_to_image(def_img,noise_percent);
+      }
+#pragma omp critical (resolution_error_output)
+      def_img->write(sincos_name.str());
+    //}
+
+    // set the deformed image for the schema
+    set_def_image(def_img);
+    int_t corr_error = execute_correlation();
+    TEUCHOS_TEST_FOR_EXCEPTION(corr_error,std::runtime_error,"Error, correlation unsuccesssful");
+    DEBUG_MSG("Error prediction step correlation return value " << corr_error);
+    execute_post_processors();
+    post_execution_tasks();
+
+    // gather all owned fields here
+    Teuchos::RCP<MultiField> coords = mesh_->get_field(INITIAL_COORDINATES_FS);
+    Teuchos::RCP<MultiField> disp;
+    if(is_subset_based){
+      Teuchos::RCP<MultiField> disp_x = mesh_->get_field(SUBSET_DISPLACEMENT_X_FS);
+      Teuchos::RCP<MultiField> disp_y = mesh_->get_field(SUBSET_DISPLACEMENT_Y_FS);
+      Teuchos::RCP<MultiField_Map> map = mesh_->get_vector_node_dist_map();
+      disp = Teuchos::rcp( new MultiField(map,1,true));
+      for(int_t i=0;i<local_num_subsets_;++i){
+        disp->local_value(i*spa_dim+0) = disp_x->local_value(i);
+        disp->local_value(i*spa_dim+1) = disp_y->local_value(i);
+      }
+    }else{
+      disp = mesh_->get_field(DISPLACEMENT_FS);
+    }
+    Teuchos::RCP<MultiField> vsg_xx;
+    Teuchos::RCP<MultiField> vsg_xy;
+    Teuchos::RCP<MultiField> vsg_yy;
+    Teuchos::RCP<MultiField> nlvc_xx;
+    Teuchos::RCP<MultiField> nlvc_xy;
+    Teuchos::RCP<MultiField> nlvc_yy;
+    if(has_vsg){
+      vsg_xx = mesh_->get_field(VSG_STRAIN_XX_FS);
+      vsg_xy = mesh_->get_field(VSG_STRAIN_XY_FS);
+      vsg_yy = mesh_->get_field(VSG_STRAIN_YY_FS);
+    }
+    if(has_nlvc){
+      nlvc_xx = mesh_->get_field(NLVC_STRAIN_XX_FS);
+      nlvc_xy = mesh_->get_field(NLVC_STRAIN_XY_FS);
+      nlvc_yy = mesh_->get_field(NLVC_STRAIN_YY_FS);
+    }
+    // compute the error fields
+    for(int_t i=0;i<local_num_subsets_;++i){
+      const scalar_t x = coords->local_value(i*spa_dim+0);
+      const scalar_t y = coords->local_value(i*spa_dim+1);
+      const scalar_t u = disp->local_value(i*spa_dim+0);
+      const scalar_t v = disp->local_value(i*spa_dim+1);
+      scalar_t exact_u = 0.0;
+      scalar_t exact_v = 0.0;
+      image_deformer_->compute_deformation(x,y,exact_u,exact_v);
+      exact_disp->local_value(i*spa_dim+0) = exact_u;
+      exact_disp->local_value(i*spa_dim+1) = exact_v;
+      scalar_t error_v = 0.0;
+      scalar_t error_u = 0.0;
+      image_deformer_->compute_displacement_error(x,y,u,v,error_u,error_v);
+      disp_error->local_value(i*spa_dim+0) = std::abs(error_u);
+      disp_error->local_value(i*spa_dim+1) = std::abs(error_v);
+      scalar_t strain_xx = 0.0;
+      scalar_t strain_xy = 0.0;
+      scalar_t strain_yy = 0.0;
+      image_deformer_->compute_lagrange_strain(x,y,strain_xx,strain_xy,strain_yy);
+      exact_strain_xx->local_value(i) = strain_xx;
+      exact_strain_xy->local_value(i) = strain_xy;
+      exact_strain_yy->local_value(i) = strain_yy;
       if(has_vsg){
-        scalar_t min_vsg_xx = 0.0;
-        scalar_t max_vsg_xx = 0.0;
-        scalar_t avg_vsg_xx = 0.0;
-        scalar_t std_dev_vsg_xx = 0.0;
-        scalar_t min_vsg_xy = 0.0;
-        scalar_t max_vsg_xy = 0.0;
-        scalar_t avg_vsg_xy = 0.0;
-        scalar_t std_dev_vsg_xy = 0.0;
-        scalar_t min_vsg_yy = 0.0;
-        scalar_t max_vsg_yy = 0.0;
-        scalar_t avg_vsg_yy = 0.0;
-        scalar_t std_dev_vsg_yy = 0.0;
-        mesh_->field_stats(VSG_STRAIN_XX_ERROR_FS,min_vsg_xx,max_vsg_xx,avg_vsg_xx,std_dev_vsg_xx,0,SIGMA_FS,-1.0);
-        mesh_->field_stats(VSG_STRAIN_XY_ERROR_FS,min_vsg_xy,max_vsg_xy,avg_vsg_xy,std_dev_vsg_xy,0,SIGMA_FS,-1.0);
-        mesh_->field_stats(VSG_STRAIN_YY_ERROR_FS,min_vsg_yy,max_vsg_yy,avg_vsg_yy,std_dev_vsg_yy,0,SIGMA_FS,-1.0);
-        result_stream << " " << min_vsg_xx << " " << max_vsg_xx << " " << avg_vsg_xx << " " << std_dev_vsg_xx;
-        result_stream << " " << min_vsg_xy << " " << max_vsg_xy << " " << avg_vsg_xy << " " << std_dev_vsg_xy;
-        result_stream << " " << min_vsg_yy << " " << max_vsg_yy << " " << avg_vsg_yy << " " << std_dev_vsg_yy;
-        scalar_t strain_peaks_avg_error_x = 0.0;
-        scalar_t strain_peaks_std_dev_error_x = 0.0;
-        scalar_t strain_peaks_avg_error_y = 0.0;
-        scalar_t strain_peaks_std_dev_error_y = 0.0;
-        // assemble the strains into a vector
-        Teuchos::RCP<MultiField_Map> map = mesh_->get_vector_node_dist_map();
-        Teuchos::RCP<MultiField> strain = Teuchos::rcp( new MultiField(map,1,true));
-        Teuchos::RCP<MultiField> exact_strain = Teuchos::rcp( new MultiField(map,1,true));
-        Teuchos::RCP<MultiField> strain_error = Teuchos::rcp( new MultiField(map,1,true));
-        for(int_t i=0;i<local_num_subsets_;++i){
-          strain->local_value(i*spa_dim+0) = vsg_xx->local_value(i);
-          strain->local_value(i*spa_dim+1) = vsg_yy->local_value(i);
-          exact_strain->local_value(i*spa_dim+0) = exact_strain_xx->local_value(i);
-          exact_strain->local_value(i*spa_dim+1) = exact_strain_yy->local_value(i);
-          strain_error->local_value(i*spa_dim+0) = vsg_error_xx->local_value(i);
-          strain_error->local_value(i*spa_dim+1) = vsg_error_yy->local_value(i);
-        }
-        // analyze the peaks of the output to evaluate the roll off
-        compute_roll_off_stats(period,full_ref_img_width_,full_ref_img_height_,coords,strain,exact_strain,strain_error,
-          strain_peaks_avg_error_x,strain_peaks_std_dev_error_x,strain_peaks_avg_error_y,strain_peaks_std_dev_error_y);
-        result_stream << " " << strain_peaks_avg_error_x << " " << strain_peaks_std_dev_error_x << " " << strain_peaks_avg_error_y << " " << strain_peaks_std_dev_error_y;
+        const scalar_t e_xx = vsg_xx->local_value(i);
+        const scalar_t e_xy = vsg_xy->local_value(i);
+        const scalar_t e_yy = vsg_yy->local_value(i);
+        scalar_t error_xx = 0.0;
+        scalar_t error_xy = 0.0;
+        scalar_t error_yy = 0.0;
+        image_deformer_->compute_lagrange_strain_error(x,y,e_xx,e_xy,e_yy,error_xx,error_xy,error_yy);
+        vsg_error_xx->local_value(i) = std::abs(error_xx);
+        vsg_error_xy->local_value(i) = std::abs(error_xy);
+        vsg_error_yy->local_value(i) = std::abs(error_yy);
       }
       if(has_nlvc){
-        scalar_t min_nlvc_xx = 0.0;
-        scalar_t max_nlvc_xx = 0.0;
-        scalar_t avg_nlvc_xx = 0.0;
-        scalar_t std_dev_nlvc_xx = 0.0;
-        scalar_t min_nlvc_xy = 0.0;
-        scalar_t max_nlvc_xy = 0.0;
-        scalar_t avg_nlvc_xy = 0.0;
-        scalar_t std_dev_nlvc_xy = 0.0;
-        scalar_t min_nlvc_yy = 0.0;
-        scalar_t max_nlvc_yy = 0.0;
-        scalar_t avg_nlvc_yy = 0.0;
-        scalar_t std_dev_nlvc_yy = 0.0;
-        mesh_->field_stats(NLVC_STRAIN_XX_ERROR_FS,min_nlvc_xx,max_nlvc_xx,avg_nlvc_xx,std_dev_nlvc_xx,0,SIGMA_FS,-1.0);
-        mesh_->field_stats(NLVC_STRAIN_XY_ERROR_FS,min_nlvc_xy,max_nlvc_xy,avg_nlvc_xy,std_dev_nlvc_xy,0,SIGMA_FS,-1.0);
-        mesh_->field_stats(NLVC_STRAIN_YY_ERROR_FS,min_nlvc_yy,max_nlvc_yy,avg_nlvc_yy,std_dev_nlvc_yy,0,SIGMA_FS,-1.0);
-        result_stream << " " << min_nlvc_xx << " " << max_nlvc_xx << " " << avg_nlvc_xx << " " << std_dev_nlvc_xx;
-        result_stream << " " << min_nlvc_xy << " " << max_nlvc_xy << " " << avg_nlvc_xy << " " << std_dev_nlvc_xy;
-        result_stream << " " << min_nlvc_yy << " " << max_nlvc_yy << " " << avg_nlvc_yy << " " << std_dev_nlvc_yy;
-        scalar_t strain_peaks_avg_error_x = 0.0;
-        scalar_t strain_peaks_std_dev_error_x = 0.0;
-        scalar_t strain_peaks_avg_error_y = 0.0;
-        scalar_t strain_peaks_std_dev_error_y = 0.0;
-        // assemble the strains into a vector
-        Teuchos::RCP<MultiField_Map> map = mesh_->get_vector_node_dist_map();
-        Teuchos::RCP<MultiField> strain = Teuchos::rcp( new MultiField(map,1,true));
-        Teuchos::RCP<MultiField> exact_strain = Teuchos::rcp( new MultiField(map,1,true));
-        Teuchos::RCP<MultiField> strain_error = Teuchos::rcp( new MultiField(map,1,true));
-        for(int_t i=0;i<local_num_subsets_;++i){
-          strain->local_value(i*spa_dim+0) = vsg_xx->local_value(i);
-          strain->local_value(i*spa_dim+1) = vsg_yy->local_value(i);
-          exact_strain->local_value(i*spa_dim+0) = exact_strain_xx->local_value(i);
-          exact_strain->local_value(i*spa_dim+1) = exact_strain_yy->local_value(i);
-          strain_error->local_value(i*spa_dim+0) = nlvc_error_xx->local_value(i);
-          strain_error->local_value(i*spa_dim+1) = nlvc_error_yy->local_value(i);
-        }
-        // analyze the peaks of the output to evaluate the roll off
-        compute_roll_off_stats(period,full_ref_img_width_,full_ref_img_height_,coords,strain,exact_strain,strain_error,
-          strain_peaks_avg_error_x,strain_peaks_std_dev_error_x,strain_peaks_avg_error_y,strain_peaks_std_dev_error_y);
-        result_stream << " " << strain_peaks_avg_error_x << " " << strain_peaks_std_dev_error_x << " " << strain_peaks_avg_error_y << " " << strain_peaks_std_dev_error_y;
+        const scalar_t e_xx = nlvc_xx->local_value(i);
+        const scalar_t e_xy = nlvc_xy->local_value(i);
+        const scalar_t e_yy = nlvc_yy->local_value(i);
+        scalar_t error_xx = 0.0;
+        scalar_t error_xy = 0.0;
+        scalar_t error_yy = 0.0;
+        image_deformer_->compute_lagrange_strain_error(x,y,e_xx,e_xy,e_yy,error_xx,error_xy,error_yy);
+        nlvc_error_xx->local_value(i) = std::abs(error_xx);
+        nlvc_error_xy->local_value(i) = std::abs(error_xy);
+        nlvc_error_yy->local_value(i) = std::abs(error_yy);
       }
+    } // end local subsets loop
+
+    result_stream << row_prefix;
+
+    // collect the global stats based on the field info above:
+    scalar_t min_error_u = 0.0;
+    scalar_t max_error_u = 0.0;
+    scalar_t avg_error_u = 0.0;
+    scalar_t std_dev_error_u = 0.0;
+    scalar_t min_error_v = 0.0;
+    scalar_t max_error_v = 0.0;
+    scalar_t avg_error_v = 0.0;
+    scalar_t std_dev_error_v = 0.0;
+    mesh_->field_stats(DISP_ERROR_FS,min_error_u,max_error_u,avg_error_u,std_dev_error_u,0,SIGMA_FS,-1.0);
+    mesh_->field_stats(DISP_ERROR_FS,min_error_v,max_error_v,avg_error_v,std_dev_error_v,1,SIGMA_FS,-1.0);
+    result_stream << " " << std::setprecision(4) << period << " "<< std::setprecision(4) << amplitude
+        << " " << min_error_u << " " << max_error_u << " " << avg_error_u << " " << std_dev_error_u << " " << min_error_v << " " << max_error_v << " " << avg_error_v << " " << std_dev_error_v;
+
+    scalar_t peaks_avg_error_x = 0.0;
+    scalar_t peaks_std_dev_error_x = 0.0;
+    scalar_t peaks_avg_error_y = 0.0;
+    scalar_t peaks_std_dev_error_y = 0.0;
+    // analyze the peaks of the output to evaluate the roll off
+    compute_roll_off_stats(period,full_ref_img_width_,full_ref_img_height_,coords,disp,exact_disp,disp_error,
+      peaks_avg_error_x,peaks_std_dev_error_x,peaks_avg_error_y,peaks_std_dev_error_y);
+    result_stream << " " << peaks_avg_error_x << " " << peaks_std_dev_error_x << " " << peaks_avg_error_y << " " << peaks_std_dev_error_y;
 
-      result_stream << std::endl;
-      write_output(output_folder,prefix,false,true);
-      // write the results to the .info file
-      if(proc_id==0){
-        std::FILE * infoFilePtr = fopen(data_name.str().c_str(),"a");
-        fprintf(infoFilePtr,"%s",result_stream.str().c_str());
-        fclose(infoFilePtr);
-        *outStream << result_stream.str();
+    if(has_vsg){
+      scalar_t min_vsg_xx = 0.0;
+      scalar_t max_vsg_xx = 0.0;
+      scalar_t avg_vsg_xx = 0.0;
+      scalar_t std_dev_vsg_xx = 0.0;
+      scalar_t min_vsg_xy = 0.0;
+      scalar_t max_vsg_xy = 0.0;
+      scalar_t avg_vsg_xy = 0.0;
+      scalar_t std_dev_vsg_xy = 0.0;
+      scalar_t min_vsg_yy = 0.0;
+      scalar_t max_vsg_yy = 0.0;
+      scalar_t avg_vsg_yy = 0.0;
+      scalar_t std_dev_vsg_yy = 0.0;
+      mesh_->field_stats(VSG_STRAIN_XX_ERROR_FS,min_vsg_xx,max_vsg_xx,avg_vsg_xx,std_dev_vsg_xx,0,SIGMA_FS,-1.0);
+      mesh_->field_stats(VSG_STRAIN_XY_ERROR_FS,min_vsg_xy,max_vsg_xy,avg_vsg_xy,std_dev_vsg_xy,0,SIGMA_FS,-1.0);
+      mesh_->field_stats(VSG_STRAIN_YY_ERROR_FS,min_vsg_yy,max_vsg_yy,avg_vsg_yy,std_dev_vsg_yy,0,SIGMA_FS,-1.0);
+      result_stream << " " << min_vsg_xx << " " << max_vsg_xx << " " << avg_vsg_xx << " " << std_dev_vsg_xx;
+      result_stream << " " << min_vsg_xy << " " << max_vsg_xy << " " << avg_vsg_xy << " " << std_dev_vsg_xy;
+      result_stream << " " << min_vsg_yy << " " << max_vsg_yy << " " << avg_vsg_yy << " " << std_dev_vsg_yy;
+      scalar_t strain_peaks_avg_error_x = 0.0;
+      scalar_t strain_peaks_std_dev_error_x = 0.0;
+      scalar_t strain_peaks_avg_error_y = 0.0;
+      scalar_t strain_peaks_std_dev_error_y = 0.0;
+      // assemble the strains into a vector
+      Teuchos::RCP<MultiField_Map> map = mesh_->get_vector_node_dist_map();
+      Teuchos::RCP<MultiField> strain = Teuchos::rcp( new MultiField(map,1,true));
+      Teuchos::RCP<MultiField> exact_strain = Teuchos::rcp( new MultiField(map,1,true));
+      Teuchos::RCP<MultiField> strain_error = Teuchos::rcp( new MultiField(map,1,true));
+      for(int_t i=0;i<local_num_subsets_;++i){
+        strain->local_value(i*spa_dim+0) = vsg_xx->local_value(i);
+        strain->local_value(i*spa_dim+1) = vsg_yy->local_value(i);
+        exact_strain->local_value(i*spa_dim+0) = exact_strain_xx->local_value(i);
+        exact_strain->local_value(i*spa_dim+1) = exact_strain_yy->local_value(i);
+        strain_error->local_value(i*spa_dim+0) = vsg_error_xx->local_value(i);
+        strain_error->local_value(i*spa_dim+1) = vsg_error_yy->local_value(i);
       }
-      result_stream.clear();
-      result_stream.str("");
-    } // end step loop
-  } // end mag loop
+      // analyze the peaks of the output to evaluate the roll off
+      compute_roll_off_stats(period,full_ref_img_width_,full_ref_img_height_,coords,strain,exact_strain,strain_error,
+        strain_peaks_avg_error_x,strain_peaks_std_dev_error_x,strain_peaks_avg_error_y,strain_peaks_std_dev_error_y);
+      result_stream << " " << strain_peaks_avg_error_x << " " << strain_peaks_std_dev_error_x << " " << strain_peaks_avg_error_y << " " << strain_peaks_std_dev_error_y;
+    }
+    if(has_nlvc){
+      scalar_t min_nlvc_xx = 0.0;
+      scalar_t max_nlvc_xx = 0.0;
+      scalar_t avg_nlvc_xx = 0.0;
+      scalar_t std_dev_nlvc_xx = 0.0;
+      scalar_t min_nlvc_xy = 0.0;
+      scalar_t max_nlvc_xy = 0.0;
+      scalar_t avg_nlvc_xy = 0.0;
+      scalar_t std_dev_nlvc_xy = 0.0;
+      scalar_t min_nlvc_yy = 0.0;
+      scalar_t max_nlvc_yy = 0.0;
+      scalar_t avg_nlvc_yy = 0.0;
+      scalar_t std_dev_nlvc_yy = 0.0;
+      mesh_->field_stats(NLVC_STRAIN_XX_ERROR_FS,min_nlvc_xx,max_nlvc_xx,avg_nlvc_xx,std_dev_nlvc_xx,0,SIGMA_FS,-1.0);
+      mesh_->field_stats(NLVC_STRAIN_XY_ERROR_FS,min_nlvc_xy,max_nlvc_xy,avg_nlvc_xy,std_dev_nlvc_xy,0,SIGMA_FS,-1.0);
+      mesh_->field_stats(NLVC_STRAIN_YY_ERROR_FS,min_nlvc_yy,max_nlvc_yy,avg_nlvc_yy,std_dev_nlvc_yy,0,SIGMA_FS,-1.0);
+      result_stream << " " << min_nlvc_xx << " " << max_nlvc_xx << " " << avg_nlvc_xx << " " << std_dev_nlvc_xx;
+      result_stream << " " << min_nlvc_xy << " " << max_nlvc_xy << " " << avg_nlvc_xy << " " << std_dev_nlvc_xy;
+      result_stream << " " << min_nlvc_yy << " " << max_nlvc_yy << " " << avg_nlvc_yy << " " << std_dev_nlvc_yy;
+      scalar_t strain_peaks_avg_error_x = 0.0;
+      scalar_t strain_peaks_std_dev_error_x = 0.0;
+      scalar_t strain_peaks_avg_error_y = 0.0;
+      scalar_t strain_peaks_std_dev_error_y = 0.0;
+      // assemble the strains into a vector
+      Teuchos::RCP<MultiField_Map> map = mesh_->get_vector_node_dist_map();
+      Teuchos::RCP<MultiField> strain = Teuchos::rcp( new MultiField(map,1,true));
+      Teuchos::RCP<MultiField> exact_strain = Teuchos::rcp( new MultiField(map,1,true));
+      Teuchos::RCP<MultiField> strain_error = Teuchos::rcp( new MultiField(map,1,true));
+      for(int_t i=0;i<local_num_subsets_;++i){
+        strain->local_value(i*spa_dim+0) = vsg_xx->local_value(i);
+        strain->local_value(i*spa_dim+1) = vsg_yy->local_value(i);
+        exact_strain->local_value(i*spa_dim+0) = exact_strain_xx->local_value(i);
+        exact_strain->local_value(i*spa_dim+1) = exact_strain_yy->local_value(i);
+        strain_error->local_value(i*spa_dim+0) = nlvc_error_xx->local_value(i);
+        strain_error->local_value(i*spa_dim+1) = nlvc_error_yy->local_value(i);
+      }
+      // analyze the peaks of the output to evaluate the roll off
+      compute_roll_off_stats(period,full_ref_img_width_,full_ref_img_height_,coords,strain,exact_strain,strain_error,
+        strain_peaks_avg_error_x,strain_peaks_std_dev_error_x,strain_peaks_avg_error_y,strain_peaks_std_dev_error_y);
+      result_stream << " " << strain_peaks_avg_error_x << " " << strain_peaks_std_dev_error_x << " " << strain_peaks_avg_error_y << " " << strain_peaks_std_dev_error_y;
+    }
+
+    result_stream << std::endl;
+    rows += result_stream.str();
+    result_stream.clear();
+    result_stream.str("");
+    // the output writers are not thread safe
+#pragma omp critical (resolution_error_output)
+    write_output(output_folder,prefix,false,true);
+} // end step loop
 #endif
+  return rows;
 }
 
 int_t
@@ -3205,8 +3752,8 @@ Schema::check_for_blocking_subsets(const int_t subset_global_id){
   const int_t subset_lid = subset_local_id(subset_global_id);
 
   // turn off pixels in this subset that are blocked by another
-  // get a pointer to the member data in the subset that will store the list of blocked pixels
-  std::set<std::pair<int_t,int_t> > & blocked_pixels =
+  // get a pointer to the member data in the subset that will store the spans of blocked pixels
+  pixel_spans & blocked_pixels =
       *obj_vec_[subset_lid]->subset()->pixels_blocked_by_other_subsets();
   blocked_pixels.clear();
 
@@ -3221,9 +3768,8 @@ Schema::check_for_blocking_subsets(const int_t subset_global_id){
     int_t cy = obj_vec_[local_ss]->subset()->centroid_y();
     Teuchos::RCP<Local_Shape_Function> shape_function = shape_function_factory(this);
     shape_function->initialize_parameters_from_fields(this,global_ss);
-    std::set<std::pair<int_t,int_t> > subset_pixels =
-        obj_vec_[local_ss]->subset()->deformed_shapes(shape_function,cx,cy,obstruction_skin_factor_);
-    blocked_pixels.insert(subset_pixels.begin(),subset_pixels.end());
+    blocked_pixels = union_spans(blocked_pixels,
+      obj_vec_[local_ss]->subset()->deformed_spans(shape_function,cx,cy,obstruction_skin_factor_));
   } // blocking subsets loop
 }
 
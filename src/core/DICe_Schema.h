@@ -535,16 +535,65 @@ public:
   /// \param local_id local ID of the subset
   /// \param spec the Field_Spec of the requested field
   mv_scalar_type & local_field_value(const int_t local_id,
-    const DICe::field_enums::Field_Spec spec){
+    const DICe::field_enums::Field_Spec & spec){
+    assert(local_id<local_num_subsets_);
+    assert(local_id>=0);
+    return field_values(spec)[local_id];
+  }
+
+  /// \brief Return a pointer to the local values of the given field
+  /// \param spec the Field_Spec of the requested field
+  ///
+  /// The fields that exist when create_mesh_fields() finishes are resolved once and cached
+  /// so this is an O(1) table lookup. Fields created later, or any field after the cache
+  /// has been invalidated, fall back to the mesh field registry.
+  mv_scalar_type * field_values(const DICe::field_enums::Field_Spec & spec){
+    const size_t index = field_handle_index(spec);
+    if(field_handles_valid_&&index<field_handles_.size()&&field_handles_[index]!=NULL)
+      return field_handles_[index];
+    return mesh_->get_field(spec)->local_values();
+  }
+
+  /// \brief Copy the values of several fields at one subset into a parameter array
+  /// \param local_id local ID of the subset
+  /// \param spec_map map of field spec to the index in values (i.e. a shape function spec map)
+  /// \param values [out] array to fill, indexed by the spec_map values
+  void gather_local_field_values(const int_t local_id,
+    const std::map<DICe::field_enums::Field_Spec,size_t> & spec_map,
+    std::vector<scalar_t> & values){
     assert(local_id<local_num_subsets_);
     assert(local_id>=0);
-    return mesh_->get_field(spec)->local_value(local_id);
+    std::map<DICe::field_enums::Field_Spec,size_t>::const_iterator it = spec_map.begin();
+    const std::map<DICe::field_enums::Field_Spec,size_t>::const_iterator it_end = spec_map.end();
+    for(;it!=it_end;++it)
+      values[it->second] = field_values(it->first)[local_id];
+  }
+
+  /// \brief Copy a parameter array into several fields at one subset
+  /// \param local_id local ID of the subset
+  /// \param spec_map map of field spec to the index in values (i.e. a shape function spec map)
+  /// \param values array of values to store, indexed by the spec_map values
+  void scatter_local_field_values(const int_t local_id,
+    const std::map<DICe::field_enums::Field_Spec,size_t> & spec_map,
+    const std::vector<scalar_t> & values){
+    assert(local_id<local_num_subsets_);
+    assert(local_id>=0);
+    std::map<DICe::field_enums::Field_Spec,size_t>::const_iterator it = spec_map.begin();
+    const std::map<DICe::field_enums::Field_Spec,size_t>::const_iterator it_end = spec_map.end();
+    for(;it!=it_end;++it)
+      field_values(it->first)[local_id] = values[it->second];
   }
 
   /// \brief Save off the current solution into the storage for frame n - 1 (only used if projection_method is VELOCITY_BASED)
   /// \param global_id global ID of correlation point
   void save_off_fields(const int_t global_id){
     DEBUG_MSG("Saving off solution nm1 for subset (global id) " << global_id);
+    if(field_handles_valid_){
+      const int_t local_id = subset_local_id(global_id);
+      for(size_t i=0;i<nm1_field_handles_.size();++i)
+        nm1_field_handles_[i].first[local_id] = nm1_field_handles_[i].second[local_id];
+      return;
+    }
     for(int_t i=0;i<DICe::field_enums::num_fields_defined;++i){
       DICe::field_enums::Field_Spec fs_nm1 = DICe::field_enums::fs_spec_vec[i];
       if(fs_nm1.get_state()!=DICe::field_enums::STATE_N_MINUS_ONE) continue;
@@ -591,6 +640,11 @@ public:
     return initialization_method_;
   }
 
+  /// Returns the number of image pyramid levels used for coarse-to-fine initialization (1 means no pyramid)
+  int_t num_image_pyramid_levels()const{
+    return num_image_pyramid_levels_;
+  }
+
   /// Returns the projection method (see DICe_Types.h for valid values)
   Projection_Method projection_method()const{
     return projection_method_;
@@ -599,12 +653,25 @@ public:
   /// set up the initializers
   void prepare_optimization_initializers();
 
+  /// \brief Correlate all the local subsets with the generic routine in order of reliability
+  ///
+  /// The seeds are correlated first. The neighbors of each converged subset are then pushed onto
+  /// a priority queue keyed by the gamma of that subset and the best entries are popped and correlated
+  /// next, each initialized from the neighbor that put it on the queue. The subsets popped together form
+  /// a wave that is correlated in parallel if threads are available. Subsets that cannot be reached
+  /// from a converged subset are correlated last in the seed order.
+  void reliability_guided_correlation();
+
   /// get an initial guess for the solution
   /// \param subset_gid the global id of the subset to initialize
   /// \param deformation [out] vector containing the intial guess
   Status_Flag initial_guess(const int_t subset_gid,
     Teuchos::RCP<Local_Shape_Function> shape_function);
 
+  /// returns the motion model initializer for a subset (null if the initialization method is not USE_MOTION_MODEL)
+  /// \param subset_gid the global id of the subset
+  Teuchos::RCP<Motion_Model_Initializer> motion_model_initializer(const int_t subset_gid)const;
+
   /// \brief Create an image that shows the correlation points
   /// \param fileName String name of file to for output
   /// \param use_def_image True if the deformed image should be used, otherwise the reference image is used
@@ -695,6 +762,31 @@ public:
   /// \param subset_gid the global id of the subset to test for motion
   bool motion_detected(const int_t subset_gid);
 
+  /// Returns the block size used to diff the motion windows against the previous frame
+  int_t motion_detection_block_size()const{
+    return motion_detection_block_size_;
+  }
+
+  /// \brief Returns the difference between the motion window and the previous frame computed at the start of this frame
+  /// Returns -1 if the difference was not computed for this window
+  /// \param sub_image_id the id of the motion window image
+  scalar_t motion_window_diff(const int_t sub_image_id)const{
+    if(sub_image_id<0||sub_image_id>=(int_t)motion_window_diffs_.size()) return -1.0;
+    return motion_window_diffs_[sub_image_id];
+  }
+
+  /// \brief Returns the global id of the subset to use for a neighbor value initialization of the given subset
+  ///
+  /// During a reliability guided correlation this is the converged subset that put the given subset
+  /// on the queue, otherwise it is the value of the NEIGHBOR_ID field (-1 if there is no neighbor)
+  /// \param subset_gid the global id of the subset to initialize
+  int_t initialization_neighbor_id(const int_t subset_gid){
+    const int_t lid = subset_local_id(subset_gid);
+    if(lid>=0&&lid<(int_t)reliability_parents_.size()&&reliability_parents_[lid]>=0)
+      return reliability_parents_[lid];
+    return global_field_value(subset_gid,NEIGHBOR_ID_FS);
+  }
+
   /// Fail the current frame for this subset and move on to the next
   /// \param subset_gid the global id of the subset
   /// \param status the reason for failure
@@ -953,6 +1045,10 @@ public:
   }
 
   /// estimate the error in the displacement resolution and strain
+  ///
+  /// The motion periods of the sweep are independent so, when threads are available, they are correlated
+  /// concurrently on worker schemas (subset based analyses on a single process). The rows of the
+  /// spatial resolution file are always written in the order of the sweep.
   /// \param correlation_params parameters to apply to the resolution estimation
   /// \param output_folder where to place the output files
   /// \param resolution_output_folder where to place the spatial resolution output
@@ -1009,10 +1105,32 @@ public:
   }
 
   /// return a pointer to the mesh object that holds all the fields and maps
-  Teuchos::RCP<DICe::mesh::Mesh> & mesh(){
+  Teuchos::RCP<DICe::mesh::Mesh> mesh()const{
     return mesh_;
   }
 
+  /// \brief Replace the mesh that holds the fields (the cached field handles are dropped)
+  /// \param mesh the new mesh
+  void set_mesh(const Teuchos::RCP<DICe::mesh::Mesh> & mesh){
+    invalidate_field_handles();
+    mesh_ = mesh;
+  }
+
+  /// \brief Drop the cached field value pointers
+  ///
+  /// Must be called whenever mesh_ is replaced. Until the handles are cached again
+  /// field_values() looks every field up in the mesh field registry.
+  void invalidate_field_handles(){
+    field_handles_.clear();
+    nm1_field_handles_.clear();
+    field_handles_valid_ = false;
+  }
+
+  /// returns true if the field value pointers are cached
+  bool has_field_handles()const{
+    return field_handles_valid_;
+  }
+
   /// return a copy of the gid order for this processor
   std::vector<int_t> this_proc_gid_order()const{
     return this_proc_gid_order_;
@@ -1050,6 +1168,26 @@ private:
   /// \param params Optional correlation parameters
   void default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params);
 
+  /// \brief Creates a schema with the same subsets and correlation parameters that shares this schema's reference image,
+  /// used to correlate the periods of the resolution error sweep concurrently (subset based, single process only)
+  /// \param worker_prefix output prefix for the files written by the new schema
+  Teuchos::RCP<Schema> resolution_error_worker(const std::string & worker_prefix);
+
+  /// \brief Correlates the synthetic images of every amplitude for one motion period of the resolution error sweep
+  /// and returns the rows of the spatial resolution file in amplitude order
+  /// \param period the motion period in pixels
+  /// \param correlation_params parameters of the resolution estimation (amplitudes and noise level)
+  /// \param row_prefix the leading columns of each row (subset, step, speckle, noise and strain window sizes)
+  /// \param image_dir_str folder for the synthetic images
+  /// \param output_folder where to place the output files
+  /// \param prefix the file prefix to use for output files
+  std::string resolution_error_period(const scalar_t & period,
+    const Teuchos::RCP<Teuchos::ParameterList> & correlation_params,
+    const std::string & row_prefix,
+    const std::string & image_dir_str,
+    const std::string & output_folder,
+    const std::string & prefix);
+
   /// \brief Create an exodus mesh for output
   /// \param decomp pointer to a decomposition
   /// note: the current parallel design for the subset-based methods is that
@@ -1063,6 +1201,48 @@ private:
   /// create all of the fields necessary on the mesh
   void create_mesh_fields();
 
+  /// build the neighbor lists used by reliability_guided_correlation(), each subset is connected to
+  /// its nearest neighbors that belong to the same seed (and to the neighbor in the NEIGHBOR_ID field)
+  void create_reliability_neighbors();
+
+  /// \brief Correlate a single subset with the generic routine, recording a failed step if an exception is thrown
+  /// \param subset_gid the global id of the subset
+  void correlate_subset(const int_t subset_gid);
+
+  /// track the points of all the optical flow initializers from the previous to the deformed image
+  /// in one batched pass so that the optical flow initial guesses are a lookup in the subset loop
+  void track_optical_flow_points();
+
+  /// diff all the motion windows against the previous frame in one pass at the start of the frame
+  /// so that the motion test for each subset is a lookup
+  void compute_motion_window_diffs();
+
+  /// build the Gaussian pyramid for an image if coarse-to-fine initialization is enabled
+  /// (called by the image setters after any filtering or rotation has been applied)
+  /// \param img the image to build the pyramid for
+  void create_image_pyramid(const Teuchos::RCP<Image> & img);
+
+  /// returns true if only the region of interest of the deformed images needs to be filtered and have gradients
+  /// (local DIC with extents, no rotation, projection or pyramid since those read the whole image). The incremental
+  /// formulation and the initializers that work on the whole deformed image (phase correlation, image registration
+  /// and feature matching) also need the whole image preprocessed, since the deformed image becomes the next
+  /// reference or is read outside the region of interest
+  bool use_def_roi()const;
+
+  /// gauss filter and compute the gradients of a deformed image only in the tiles that overlap the region of interest
+  /// \param img the deformed image (loaded without the filter and gradients)
+  void preprocess_def_image_roi(const Teuchos::RCP<Image> & img);
+
+  /// resolve the raw value pointers of all the fields currently on the mesh
+  /// (called at the end of create_mesh_fields())
+  void cache_field_handles();
+
+  /// \brief index of a field in the handle cache
+  /// \param spec the field spec (fields are unique by name and state)
+  static size_t field_handle_index(const DICe::field_enums::Field_Spec & spec){
+    return static_cast<size_t>(spec.get_name())*(DICe::field_enums::STATE_N_PLUS_ONE+1) + static_cast<size_t>(spec.get_state());
+  }
+
   /// Pointer to communicator (can be serial)
   comm_rcp comm_;
   /// The mesh holds the fields and subsets or elements and nodes
@@ -1079,6 +1259,12 @@ private:
   /// map assigns all nodes to all processors. This map is used for post-processors
   /// and output from process 0 or anywhere an all to all communication is needed.
   Teuchos::RCP<DICe::mesh::Mesh> mesh_;
+  /// Cached pointers to the local values of each field, indexed by field_handle_index()
+  std::vector<mv_scalar_type*> field_handles_;
+  /// True if field_handles_ and nm1_field_handles_ point into the fields of mesh_
+  bool field_handles_valid_;
+  /// Pairs of (nm1 field, current field) value pointers used by save_off_fields()
+  std::vector<std::pair<mv_scalar_type*,mv_scalar_type*> > nm1_field_handles_;
   /// Keeps track of the order of gids local to this process
   std::vector<int_t> this_proc_gid_order_;
   /// Vector of objective classes
@@ -1190,6 +1376,8 @@ private:
   bool filter_failed_cine_pixels_;
   /// filter the images using a gauss_filter_mask_size_ point gauss filter
   int_t gauss_filter_mask_size_;
+  /// number of Gaussian pyramid levels for the coarse-to-fine initializer (1 turns the pyramid off)
+  int_t num_image_pyramid_levels_;
   /// Compute the reference image gradients
   bool compute_ref_gradients_;
   /// Compute the deformed image gradients
@@ -1258,6 +1446,9 @@ private:
   std::vector<int_t> ref_extents_;
   /// vector that contains the x and y extents for the deformed images (x_start_def, x_end_def, y_start_def, y_end_def)
   std::vector<int_t> def_extents_;
+  /// boxes around each deformed subset position that define the region of interest of the deformed images
+  /// (x_start, x_end, y_start, y_end for each subset, same buffer as the extents)
+  std::vector<int_t> def_roi_;
   /// store the total image dims (the image size before decomposition across processors)
   int_t full_ref_img_width_;
   /// store the total image dims (the image size before decomposition across processors)
@@ -1268,6 +1459,20 @@ private:
   bool compute_laplacian_image_;
   /// size of threshold to use for feature matching when thresholding is included
   int_t threshold_block_size_;
+  /// window size for the local phase correlation initializer (-1 means twice the subset size)
+  int_t phase_correlation_window_size_;
+  /// margin around the subsets for the feature matching initializer's detection region (-1 means the whole image)
+  int_t feature_matching_roi_margin_;
+  /// width of the blocks summed before diffing the motion windows (1 diffs every pixel)
+  int_t motion_detection_block_size_;
+  /// difference of each motion window from the previous frame for the current frame (indexed by sub image id, -1 if not computed)
+  std::vector<scalar_t> motion_window_diffs_;
+  /// true if the generic routine correlates the subsets in order of reliability rather than the seed order
+  bool use_reliability_guided_ordering_;
+  /// local ids of the subsets that can be initialized from each local subset in the reliability guided ordering
+  std::vector<std::vector<int_t> > reliability_neighbors_;
+  /// global id of the subset each local subset is initialized from in the current reliability guided correlation (-1 uses the NEIGHBOR_ID field)
+  std::vector<int_t> reliability_parents_;
 };
 
 /// \class DICe::Output_Spec
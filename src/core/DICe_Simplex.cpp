@@ -96,19 +96,26 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
     for(int_t j=0;j<num_dofs;++j) std::cout << " " << (*points[i])[j];
     std::cout << std::endl;
 #endif
-    // evaluate gamma at these points
-    for(int_t j=0;j<num_dofs;++j)
-       (*variables)[j] = (*points[i])[j];
-    gamma_values[i] = objective(variables);
-    DEBUG_MSG("Gamma value for this point: " << gamma_values[i]);
-    if(i==0&&gamma_values[i]<threshold&&gamma_values[i]>=0.0){
-      num_iterations = 0;
-      DEBUG_MSG("Initial variables guess is good enough (gamma < " << threshold << " for this guess)");
-      return CORRELATION_SUCCESSFUL;
-    }
-    for(int_t j=0;j<num_dofs;++j)
-       (*variables)[j] = init_variables[j];
   }
+  // evaluate gamma at the initial guess first in case it is good enough to skip the analysis
+  gamma_values[0] = objective(variables);
+  DEBUG_MSG("Gamma value for the initial guess: " << gamma_values[0]);
+  if(gamma_values[0]<threshold&&gamma_values[0]>=0.0){
+    num_iterations = 0;
+    DEBUG_MSG("Initial variables guess is good enough (gamma < " << threshold << " for this guess)");
+    delete [] gamma_values;
+    return CORRELATION_SUCCESSFUL;
+  }
+  // the rest of the vertices are independent of each other so they are evaluated together
+  std::vector< Teuchos::RCP<std::vector<scalar_t> > > batch_points(points.begin()+1,points.end());
+  std::vector<scalar_t> batch_values;
+  batch_objective(variables,batch_points,batch_values);
+  for(int_t i=1;i<mpts;++i){
+    gamma_values[i] = batch_values[i-1];
+    DEBUG_MSG("Gamma value for simplex point " << i << ": " << gamma_values[i]);
+  }
+  for(int_t j=0;j<num_dofs;++j)
+     (*variables)[j] = init_variables[j];
 
   // work variables
 
@@ -179,6 +186,11 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
         (*points[0])[i] = (*points[ilo])[i];
         (*points[ilo])[i] = dum2;
       }
+      // return the best vertex rather than the last trial point (which may not have been accepted)
+      // and evaluate it again so that the state of the objective reflects the solution
+      for (int_t i = 0; i < num_dofs; i++)
+        (*variables)[i] = (*points[0])[i];
+      objective(variables);
       break;
     }
     nfunk += 2;
@@ -194,7 +206,7 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
 
     for(int_t n=0;n<num_dofs;++n)
       (*variables)[n] = ptry[n];
-    ytry = objective(variables);
+    ytry = trial_objective(variables,gamma_values[ihi]);
 
     if (ytry < gamma_values[ihi]) {
       gamma_values[ihi] = ytry;
@@ -212,7 +224,7 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
 
       for(int_t n=0;n<num_dofs;++n)
         (*variables)[n] = ptry[n];
-      ytry = objective(variables);
+      ytry = trial_objective(variables,gamma_values[ihi]);
 
       if (ytry < gamma_values[ihi]) {
         gamma_values[ihi] = ytry;
@@ -231,7 +243,7 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
 
       for(int_t n=0;n<num_dofs;++n)
         (*variables)[n] = ptry[n];
-      ytry = objective(variables);
+      ytry = trial_objective(variables,gamma_values[ihi]);
 
       if (ytry < gamma_values[ihi]) {
         gamma_values[ihi] = ytry;
@@ -241,15 +253,20 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
         }
       }
       if (ytry >= ysave) {
+        // shrink the simplex toward the best vertex, the shrunk vertices are evaluated together
+        batch_points.clear();
         for (int_t i = 0; i < mpts; i++) {
           if (i != ilo) {
             for (int_t j = 0; j < num_dofs; j++)
-              (*points[i])[j] = points_column_sums[j] = 0.5*((*points[i])[j] + (*points[ilo])[j]);
-            for(int_t n=0;n<num_dofs;++n)
-              (*variables)[n] = points_column_sums[n];
-            gamma_values[i] = objective(variables);
+              (*points[i])[j] = 0.5*((*points[i])[j] + (*points[ilo])[j]);
+            batch_points.push_back(points[i]);
           }
         }
+        batch_objective(variables,batch_points,batch_values);
+        for (int_t i = 0, k = 0; i < mpts; i++) {
+          if (i != ilo) gamma_values[i] = batch_values[k++];
+        }
+        ytry = batch_values.back();
         nfunk += num_dofs;
 
         for (int_t j = 0; j < num_dofs; j++) {
@@ -261,7 +278,8 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
       }
     } else --nfunk;
 
-    gamma_new = objective(variables);
+    // the variables hold the last point evaluated so its gamma does not need to be computed again
+    gamma_new = ytry;
 #ifdef DICE_DEBUG_MSG
     std::cout << "Iteration " << iteration;
     for(int_t i=0;i<num_dofs;++i) std::cout << " " << (*variables)[i];
@@ -276,6 +294,34 @@ Simplex::minimize(Teuchos::RCP<std::vector<scalar_t> > variables,
   return CORRELATION_SUCCESSFUL;
 }
 
+void
+Simplex::batch_objective(Teuchos::RCP<std::vector<scalar_t> > variables,
+  const std::vector<Teuchos::RCP<std::vector<scalar_t> > > & points,
+  std::vector<scalar_t> & values){
+  values.resize(points.size());
+  for(size_t i=0;i<points.size();++i){
+    for(size_t j=0;j<variables->size();++j)
+      (*variables)[j] = (*points[i])[j];
+    values[i] = objective(variables);
+  }
+}
+
+scalar_t
+Simplex::trial_objective(Teuchos::RCP<std::vector<scalar_t> > variables,
+  const scalar_t & worst_value){
+  // only reject the trial point if the estimate is well above the worst vertex so that the
+  // noise in the estimate does not change which branch of the method is taken
+  const scalar_t rejection_factor = 2.0;
+  if(worst_value>0.0){
+    const scalar_t estimate = objective_estimate(variables);
+    if(estimate > rejection_factor*worst_value){
+      DEBUG_MSG("Simplex trial point rejected by the objective estimate: " << estimate << " worst vertex: " << worst_value);
+      return estimate;
+    }
+  }
+  return objective(variables);
+}
+
 Status_Flag
 Subset_Simplex::minimize(Teuchos::RCP<Local_Shape_Function> shape_function,
   int_t & num_iterations,
@@ -301,6 +347,53 @@ Subset_Simplex::objective(Teuchos::RCP<std::vector<scalar_t> > variables){
   return obj_->gamma(shape_function_);
 }
 
+void
+Subset_Simplex::batch_objective(Teuchos::RCP<std::vector<scalar_t> > variables,
+  const std::vector<Teuchos::RCP<std::vector<scalar_t> > > & points,
+  std::vector<scalar_t> & values){
+  assert(shape_function_->num_params()==(int_t)variables->size());
+  const bool is_affine = Teuchos::rcp_dynamic_cast<Affine_Shape_Function>(shape_function_)!=Teuchos::null;
+  const bool is_quadratic = Teuchos::rcp_dynamic_cast<Quadratic_Shape_Function>(shape_function_)!=Teuchos::null;
+  // the other shape functions are evaluated one at a time (constructing a rigid body shape function reads the camera system file)
+  if(points.size()<2||(!is_affine&&!is_quadratic)){
+    Simplex::batch_objective(variables,points,values);
+    return;
+  }
+  while(trial_shape_functions_.size()<points.size()){
+    if(is_quadratic)
+      trial_shape_functions_.push_back(Teuchos::rcp(new Quadratic_Shape_Function()));
+    else
+      trial_shape_functions_.push_back(shape_function_factory(obj_->schema()));
+  }
+  // the work shape functions must have the same degrees of freedom as the one being optimized
+  if(trial_shape_functions_[0]->num_params()!=shape_function_->num_params()){
+    Simplex::batch_objective(variables,points,values);
+    return;
+  }
+  std::vector<Teuchos::RCP<Local_Shape_Function> > trials(trial_shape_functions_.begin(),trial_shape_functions_.begin()+points.size());
+  for(size_t i=0;i<points.size();++i){
+    for(size_t j=0;j<points[i]->size();++j)
+      (*trials[i])(j) = (*points[i])[j];
+  }
+  obj_->trial_gammas(trials,values);
+  // leave the variables at the last point as the serial evaluation would
+  for(size_t j=0;j<variables->size();++j)
+    (*variables)[j] = (*points.back())[j];
+}
+
+scalar_t
+Subset_Simplex::objective_estimate(Teuchos::RCP<std::vector<scalar_t> > variables){
+  assert(shape_function_->num_params()==(int_t)variables->size());
+  // every fourth pixel is used, the estimate is only worth it for subsets with enough pixels to be reliable
+  const int_t stride = 4;
+  const int_t min_sampled_pixels = 100;
+  if(obj_->subset()->num_pixels() < stride*min_sampled_pixels) return -1.0;
+  std::vector<Teuchos::RCP<Local_Shape_Function> > trials(1,shape_function_);
+  std::vector<scalar_t> values;
+  obj_->trial_gammas(trials,values,stride);
+  return values[0];
+}
+
 Homography_Simplex::Homography_Simplex(Teuchos::RCP<Image> left_img,
   Teuchos::RCP<Image> right_img,
   Triangulation * tri,
@@ -90,7 +90,29 @@ public:
   /// \param variables the current guess at which to evaluate the objective
   virtual scalar_t objective(Teuchos::RCP<std::vector<scalar_t> > variables)=0;
 
+  /// \brief evaluates the objective at several independent points, the default evaluates them one at a time
+  /// (derived classes can override this to evaluate the points concurrently)
+  /// \param variables work vector, holds the last point on exit (as if the points had been evaluated in order)
+  /// \param points the points at which to evaluate the objective
+  /// \param values [out] the objective value for each point
+  virtual void batch_objective(Teuchos::RCP<std::vector<scalar_t> > variables,
+    const std::vector<Teuchos::RCP<std::vector<scalar_t> > > & points,
+    std::vector<scalar_t> & values);
+
+  /// \brief a cheap estimate of the objective used to reject trial points that are clearly worse than the
+  /// current simplex without a full evaluation, a negative value means no estimate is available (the default)
+  /// \param variables the point at which to estimate the objective
+  virtual scalar_t objective_estimate(Teuchos::RCP<std::vector<scalar_t> > variables){
+    return -1.0;
+  }
+
 protected:
+  /// \brief evaluates the objective at a trial point unless the estimate shows it is clearly worse than the worst vertex
+  /// \param variables the trial point
+  /// \param worst_value the objective value of the worst vertex in the simplex
+  scalar_t trial_objective(Teuchos::RCP<std::vector<scalar_t> > variables,
+    const scalar_t & worst_value);
+
   /// Maximum allowed iterations for convergence
   int_t max_iterations_;
   /// Convergence tolerance
@@ -120,6 +142,15 @@ public:
   /// \param variables the current guess at which to evaluate the objective
   virtual scalar_t objective(Teuchos::RCP<std::vector<scalar_t> > variables);
 
+  /// \brief evaluates the trial deformations concurrently without changing the state of the subset
+  /// (see base class documentation)
+  virtual void batch_objective(Teuchos::RCP<std::vector<scalar_t> > variables,
+    const std::vector<Teuchos::RCP<std::vector<scalar_t> > > & points,
+    std::vector<scalar_t> & values);
+
+  /// \brief estimates gamma from a subsample of the subset pixels (see base class documentation)
+  virtual scalar_t objective_estimate(Teuchos::RCP<std::vector<scalar_t> > variables);
+
   /// call the minimization routine
   /// \param shape_function pointer to a shape function
   /// \param num_iterations the number of iterations
@@ -134,6 +165,8 @@ protected:
   const DICe::Objective * const obj_;
   /// Pointer to a shape function class
   Teuchos::RCP<Local_Shape_Function> shape_function_;
+  /// work shape functions used to evaluate several trial deformations at once
+  std::vector<Teuchos::RCP<Local_Shape_Function> > trial_shape_functions_;
 };
 
 /// a derived optimization class specific for image homography between two cameras
@@ -944,6 +944,9 @@ Triangulation::estimate_projective_transform(Teuchos::RCP<Image> left_img,
   std::vector<scalar_t> proj_yr;
   int_t num_coords = 0;
   create_directory(".dice");
+#ifdef DICE_ENABLE_OPENCV
+  Feature_Matcher matcher;
+#endif
 
   if(use_nonlinear_projection){
     DEBUG_MSG("Triangulation::estimate_projective_transform(): reading initial guess points from file: projection_points.dat");
@@ -988,11 +991,11 @@ Triangulation::estimate_projective_transform(Teuchos::RCP<Image> left_img,
     float feature_tol = 0.005f;
     std::stringstream outname;
     outname << ".dice/fm_projective_trans_" << processor_id << ".png";
-    match_features(left_img,right_img,proj_xl,proj_yl,proj_xr,proj_yr,feature_tol,outname.str());
+    matcher.match(left_img,right_img,proj_xl,proj_yl,proj_xr,proj_yr,feature_tol,outname.str());
     if(proj_xl.size() < 5){
       DEBUG_MSG("Triangulation::estimate_projective_transform(): initial attempt failed with tol = 0.005f, setting to 0.001f and trying again.");
       feature_tol = 0.001f;
-      match_features(left_img,right_img,proj_xl,proj_yl,proj_xr,proj_yr,feature_tol,outname.str());
+      matcher.match(left_img,right_img,proj_xl,proj_yl,proj_xr,proj_yr,feature_tol,outname.str());
     }
     DEBUG_MSG("Triangulation::estimate_projective_transform(): matching features complete");
 #else
@@ -1117,7 +1120,7 @@ Triangulation::estimate_projective_transform(Teuchos::RCP<Image> left_img,
     const float tol = 0.001f;
     std::stringstream outname_nonlin;
     outname_nonlin << ".dice/fm_nonlinear_proj_trans_" << processor_id << ".png";
-    match_features(left_img,projection_opt_img,warp_xl,warp_yl,warp_xr,warp_yr,tol,outname_nonlin.str());
+    matcher.match(left_img,projection_opt_img,warp_xl,warp_yl,warp_xr,warp_yr,tol,outname_nonlin.str());
     DEBUG_MSG("Triangulation::estimate_projective_transform(): matching warp features complete");
 #else
     TEUCHOS_TEST_FOR_EXCEPTION(true, std::runtime_error,"Error, OpeCV required for cross correlation initialization.");
@@ -43,10 +43,134 @@
 
 #include <Teuchos_ArrayRCP.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <vector>
 
 namespace DICe {
 
+/// owns the cached kiss_fft plans, the plans are freed when the program exits
+struct FFT_Plan_Cache{
+  /// destructor
+  ~FFT_Plan_Cache(){
+    for(std::map<std::pair<int_t,int_t>,kiss_fft_cfg>::iterator it=plans.begin();it!=plans.end();++it)
+      kiss_fft_free(it->second);
+  }
+  /// plans keyed by size and direction
+  std::map<std::pair<int_t,int_t>,kiss_fft_cfg> plans;
+};
+
+DICE_LIB_DLL_EXPORT
+kiss_fft_cfg
+fft_plan(const int_t nfft,
+  const int_t inverse){
+  static FFT_Plan_Cache cache;
+  const std::pair<int_t,int_t> key(nfft,inverse==0?0:1);
+  kiss_fft_cfg plan = NULL;
+#pragma omp critical (dice_fft_plan_cache)
+  {
+    std::map<std::pair<int_t,int_t>,kiss_fft_cfg>::iterator it = cache.plans.find(key);
+    if(it==cache.plans.end())
+      it = cache.plans.insert(std::make_pair(key,kiss_fft_alloc(nfft,key.second,0,0))).first;
+    plan = it->second;
+  }
+  return plan;
+}
+
+/// separate the transform of two real sequences that were packed into one complex transform as z = p + i q
+/// \param n the length of the sequences
+/// \param z the transform of the packed sequence
+/// \param p_r [out] real part of the transform of p
+/// \param p_i [out] imaginary part of the transform of p
+/// \param q_r [out] real part of the transform of q
+/// \param q_i [out] imaginary part of the transform of q
+inline void
+unpack_real_pair(const int_t n,
+  const kiss_fft_cpx * z,
+  scalar_t * p_r,
+  scalar_t * p_i,
+  scalar_t * q_r,
+  scalar_t * q_i){
+  // both spectra are conjugate symmetric: P(k) = (Z(k) + conj(Z(n-k)))/2, Q(k) = (Z(k) - conj(Z(n-k)))/2i
+  for(int_t k=0;k<n;++k){
+    const kiss_fft_cpx & zk = z[k];
+    const kiss_fft_cpx & zn = z[k==0?0:n-k];
+    p_r[k] = 0.5*(zk.r + zn.r);
+    p_i[k] = 0.5*(zk.i - zn.i);
+    q_r[k] = 0.5*(zk.i + zn.i);
+    q_i[k] = 0.5*(zn.r - zk.r);
+  }
+}
+
+/// FFT of the columns of a complex w x h row major array (in place), the columns are split across threads
+/// \param w width
+/// \param h height
+/// \param real the real array
+/// \param complex the imaginary array
+/// \param inverse 1 if the FFT should be to the time domain
+void
+columns_fft(const int_t w,
+  const int_t h,
+  scalar_t * real,
+  scalar_t * complex,
+  const int_t inverse){
+  kiss_fft_cfg cfg_ffy = fft_plan(h,inverse);
+#pragma omp parallel
+  {
+    // separate input and output buffers avoid the scratch allocation of an in place kiss_fft
+    std::vector<kiss_fft_cpx> col_in(h);
+    std::vector<kiss_fft_cpx> col_out(h);
+#pragma omp for
+    for(int_t x=0;x<w;++x){
+      for(int_t y=0;y<h;++y){
+        col_in[y].r=real[y*w+x];
+        col_in[y].i=complex[y*w+x];
+      }
+      kiss_fft(cfg_ffy,&col_in[0],&col_out[0]);
+      for(int_t y=0;y<h;++y){
+        real[y*w+x] = col_out[y].r;
+        complex[y*w+x] = col_out[y].i;
+      }
+    }
+  }
+}
+
+DICE_LIB_DLL_EXPORT
+void
+real_rows_fft(const int_t w,
+  const int_t h,
+  scalar_t * real,
+  scalar_t * complex){
+  kiss_fft_cfg cfg_ffx = fft_plan(w,0);
+  const int_t num_pairs = (h+1)/2;
+#pragma omp parallel
+  {
+    std::vector<kiss_fft_cpx> row_in(w);
+    std::vector<kiss_fft_cpx> row_out(w);
+#pragma omp for
+    for(int_t pair=0;pair<num_pairs;++pair){
+      const int_t y = 2*pair;
+      // an odd last row is transformed on its own
+      const bool has_second = y+1<h;
+      for(int_t x=0;x<w;++x){
+        row_in[x].r = real[y*w+x];
+        row_in[x].i = has_second ? real[(y+1)*w+x] : 0.0;
+      }
+      kiss_fft(cfg_ffx,&row_in[0],&row_out[0]);
+      if(has_second){
+        unpack_real_pair(w,&row_out[0],&real[y*w],&complex[y*w],&real[(y+1)*w],&complex[(y+1)*w]);
+      }
+      else{
+        for(int_t x=0;x<w;++x){
+          real[y*w+x] = row_out[x].r;
+          complex[y*w+x] = row_out[x].i;
+        }
+      }
+    }
+  }
+}
+
 DICE_LIB_DLL_EXPORT
 void
 complex_divide(kiss_fft_cpx * lhs,
@@ -149,13 +273,9 @@ phase_correlate_x_y(Teuchos::RCP<Image> image_a,
     return -1.0;
   }
 
-  // fft of image a
-  Teuchos::ArrayRCP<scalar_t> a_r,a_i;
-  DICe::image_fft(image_a,a_r,a_i,0);
-
-  // fft of image b
-  Teuchos::ArrayRCP<scalar_t> b_r,b_i;
-  DICe::image_fft(image_b,b_r,b_i,0);
+  // fft of image a and image b (both real so they share one transform)
+  Teuchos::ArrayRCP<scalar_t> a_r,a_i,b_r,b_i;
+  DICe::image_pair_fft(image_a,image_b,a_r,a_i,b_r,b_i);
 
   // conjugate of image b
   for(int_t i=0;i<w*h;++i)
@@ -278,6 +398,101 @@ phase_correlate_x_y(Teuchos::RCP<Image> image_a,
   return max_real;
 }
 
+/// serial in place 2D FFT of a complex row major array (safe to call from multiple threads)
+/// \param w width
+/// \param h height
+/// \param values the array
+/// \param work work buffer of at least max(w,h) entries
+/// \param inverse 1 if the FFT should be to the time domain
+void
+serial_2d_fft(const int_t w,
+  const int_t h,
+  kiss_fft_cpx * values,
+  kiss_fft_cpx * work,
+  const int_t inverse){
+  kiss_fft_cfg cfg_ffx = fft_plan(w,inverse);
+  kiss_fft_cfg cfg_ffy = fft_plan(h,inverse);
+  for(int_t y=0;y<h;++y){
+    kiss_fft(cfg_ffx,values+y*w,work);
+    for(int_t x=0;x<w;++x)
+      values[y*w+x] = work[x];
+  }
+  for(int_t x=0;x<w;++x){
+    kiss_fft_stride(cfg_ffy,values+x,work,w);
+    for(int_t y=0;y<h;++y)
+      values[y*w+x] = work[y];
+  }
+}
+
+DICE_LIB_DLL_EXPORT
+scalar_t
+phase_correlate_windows(const int_t w,
+  const int_t h,
+  const scalar_t * window_a,
+  const scalar_t * window_b,
+  scalar_t & u_x,
+  scalar_t & u_y){
+  assert(w>2);
+  assert(h>2);
+  u_x = 0.0;
+  u_y = 0.0;
+  // both windows are real so they are transformed together (a in the real part, b in the imaginary part)
+  std::vector<kiss_fft_cpx> z(w*h);
+  std::vector<kiss_fft_cpx> work(std::max(w,h));
+  for(int_t y=0;y<h;++y){
+    const scalar_t y_ham = 0.54 - 0.46*std::cos(DICE_TWOPI*y/(h-1));
+    for(int_t x=0;x<w;++x){
+      const scalar_t ham = y_ham*(0.54 - 0.46*std::cos(DICE_TWOPI*x/(w-1)));
+      z[y*w+x].r = window_a[y*w+x]*ham;
+      z[y*w+x].i = window_b[y*w+x]*ham;
+    }
+  }
+  serial_2d_fft(w,h,&z[0],&work[0],0);
+  // normalized cross power spectrum A conj(B) / |A conj(B)|
+  std::vector<kiss_fft_cpx> cross(w*h);
+  for(int_t y=0;y<h;++y){
+    const int_t ny = y==0 ? 0 : h - y;
+    for(int_t x=0;x<w;++x){
+      const int_t nx = x==0 ? 0 : w - x;
+      const kiss_fft_cpx & zk = z[y*w+x];
+      const kiss_fft_cpx & zn = z[ny*w+nx];
+      const scalar_t a_r = 0.5*(zk.r + zn.r);
+      const scalar_t a_i = 0.5*(zk.i - zn.i);
+      const scalar_t b_r = 0.5*(zk.i + zn.i);
+      const scalar_t b_i = 0.5*(zn.r - zk.r);
+      scalar_t r_r = 0.0, r_i = 0.0;
+      complex_multiply(r_r,r_i,a_r,a_i,b_r,-b_i);
+      const scalar_t mag = std::sqrt(r_r*r_r + r_i*r_i);
+      cross[y*w+x].r = mag > 0.0 ? r_r/mag : 0.0;
+      cross[y*w+x].i = mag > 0.0 ? r_i/mag : 0.0;
+    }
+  }
+  serial_2d_fft(w,h,&cross[0],&work[0],1);
+  int_t peak_x = 0;
+  int_t peak_y = 0;
+  scalar_t peak = -1.0;
+  for(int_t i=0;i<w*h;++i){
+    if(cross[i].r > peak){
+      peak = cross[i].r;
+      peak_x = i%w;
+      peak_y = i/w;
+    }
+  }
+  // sub-pixel location of the peak from a parabola through the neighbors (the correlation surface is periodic)
+  const scalar_t left = cross[peak_y*w+(peak_x+w-1)%w].r;
+  const scalar_t right = cross[peak_y*w+(peak_x+1)%w].r;
+  const scalar_t up = cross[((peak_y+h-1)%h)*w+peak_x].r;
+  const scalar_t down = cross[((peak_y+1)%h)*w+peak_x].r;
+  const scalar_t denom_x = left - 2.0*peak + right;
+  const scalar_t denom_y = up - 2.0*peak + down;
+  const scalar_t sub_x = denom_x < 0.0 ? 0.5*(left - right)/denom_x : 0.0;
+  const scalar_t sub_y = denom_y < 0.0 ? 0.5*(up - down)/denom_y : 0.0;
+  // the peak is at minus the shift of b relative to a
+  u_x = -((peak_x >= w/2 ? peak_x - w : peak_x) + sub_x);
+  u_y = -((peak_y >= h/2 ? peak_y - h : peak_y) + sub_y);
+  return peak/(w*h);
+}
+
 DICE_LIB_DLL_EXPORT
 void
 phase_correlate_row(Teuchos::RCP<Image> image_a,
@@ -296,33 +511,17 @@ phase_correlate_row(Teuchos::RCP<Image> image_a,
   for(int_t i=0;i<w;++i)
     x_ham[i] = 0.54 - 0.46*std::cos(DICE_TWOPI*i/(w-1));
 
-  // compute th fft of image a's row
+  // both rows are real so they are transformed together as a = real part, b = imaginary part
   Teuchos::ArrayRCP<scalar_t> a_real(w,0.0), a_complex(w,0.0);
-  kiss_fft_cpx * img_row = new kiss_fft_cpx[w];
-  kiss_fft_cfg cfg_ffx = kiss_fft_alloc(w,0,0,0);
-  // fft the rows
-  for(int_t x=0;x<w;++x){
-    img_row[x].r=(*image_a)(x,row_id)*x_ham[x];
-    img_row[x].i=0;
-  }
-  kiss_fft(cfg_ffx,img_row,img_row);
-  for(int_t x=0;x<w;++x){
-    a_real[x] = img_row[x].r;
-    a_complex[x] = img_row[x].i;
-  }
-  // compute the fft of b's row:
   Teuchos::ArrayRCP<scalar_t> b_real(w,0.0), b_complex(w,0.0);
+  std::vector<kiss_fft_cpx> row_in(w);
+  std::vector<kiss_fft_cpx> row_out(w);
   for(int_t x=0;x<w;++x){
-    img_row[x].r=(*image_b)(x,row_id)*x_ham[x];
-    img_row[x].i=0;
+    row_in[x].r=(*image_a)(x,row_id)*x_ham[x];
+    row_in[x].i=(*image_b)(x,row_id)*x_ham[x];
   }
-  kiss_fft(cfg_ffx,img_row,img_row);
-  for(int_t x=0;x<w;++x){
-    b_real[x] = img_row[x].r;
-    b_complex[x] = img_row[x].i;
-  }
-  free(cfg_ffx);
-
+  kiss_fft(fft_plan(w,0),&row_in[0],&row_out[0]);
+  unpack_real_pair(w,&row_out[0],a_real.getRawPtr(),a_complex.getRawPtr(),b_real.getRawPtr(),b_complex.getRawPtr());
 
   // conjugate of image b
   for(int_t i=0;i<w;++i)
@@ -343,19 +542,16 @@ phase_correlate_row(Teuchos::RCP<Image> image_a,
   for(int_t i=0;i<w;++i)
     complex_divide(FFTRN_r[i],FFTRN_i[i],FFTR_r[i],FFTR_i[i],FFTR_abs[i],zero[i]);
 
-  kiss_fft_cfg cfg_ffxi = kiss_fft_alloc(w,1,0,0);
-  // fft the rows
+  // inverse fft of the row
   for(int_t x=0;x<w;++x){
-    img_row[x].r=FFTRN_r[x];
-    img_row[x].i=FFTRN_i[x];
+    row_in[x].r=FFTRN_r[x];
+    row_in[x].i=FFTRN_i[x];
   }
-  kiss_fft(cfg_ffxi,img_row,img_row);
+  kiss_fft(fft_plan(w,1),&row_in[0],&row_out[0]);
   for(int_t x=0;x<w;++x){
-    FFTRN_r[x] = img_row[x].r;
-    FFTRN_i[x] = img_row[x].i;
+    FFTRN_r[x] = row_out[x].r;
+    FFTRN_i[x] = row_out[x].i;
   }
-  free(cfg_ffxi);
-  delete[] img_row;
 
   // find the max and convert to theta if necessary
   u = 0;
@@ -540,21 +736,16 @@ image_fft(Teuchos::RCP<Image> image,
 
 }
 
-DICE_LIB_DLL_EXPORT
+/// copy the intensities of an image into a row major array, optionally applying a hamming window
+/// \param image the image
+/// \param hamming_filter true if the hamming window should be applied
+/// \param values [out] the windowed intensities (must be allocated to the image size)
 void
-image_fft(Teuchos::RCP<Image> image,
-  Teuchos::ArrayRCP<scalar_t> & real,
-  Teuchos::ArrayRCP<scalar_t> & complex,
-  const int_t inverse,
-  const bool hamming_filter){
-
+windowed_intensities(Teuchos::RCP<Image> image,
+  const bool hamming_filter,
+  scalar_t * values){
   const int_t w = image->width();
-  assert(w>1);
   const int_t h = image->height();
-  assert(h>1);
-  real = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
-  complex = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
-
   if(hamming_filter){
     Teuchos::ArrayRCP<scalar_t> x_ham(w,0.0);
     Teuchos::ArrayRCP<scalar_t> y_ham(h,0.0);
@@ -566,53 +757,83 @@ image_fft(Teuchos::RCP<Image> image,
     }
     for(int_t y=0;y<h;++y){
       for(int_t x=0;x<w;++x){
-        real[y*w+x] = (*image)(x,y)*x_ham[x]*y_ham[y];
+        values[y*w+x] = (*image)(x,y)*x_ham[x]*y_ham[y];
       }
     }
   }
   else{
     for(int_t y=0;y<h;++y){
       for(int_t x=0;x<w;++x){
-        real[y*w+x] = (*image)(x,y);
+        values[y*w+x] = (*image)(x,y);
       }
     }
   }
+}
 
-  kiss_fft_cpx * img_row = new kiss_fft_cpx[w];
-  kiss_fft_cpx * img_col = new kiss_fft_cpx[h];
-  kiss_fft_cfg cfg_ffx = kiss_fft_alloc(w,inverse,0,0);
-  kiss_fft_cfg cfg_ffy = kiss_fft_alloc(h,inverse,0,0);
-
-  // fft the rows
+DICE_LIB_DLL_EXPORT
+void
+image_pair_fft(Teuchos::RCP<Image> image_a,
+  Teuchos::RCP<Image> image_b,
+  Teuchos::ArrayRCP<scalar_t> & a_real,
+  Teuchos::ArrayRCP<scalar_t> & a_complex,
+  Teuchos::ArrayRCP<scalar_t> & b_real,
+  Teuchos::ArrayRCP<scalar_t> & b_complex,
+  const bool hamming_filter){
+  const int_t w = image_a->width();
+  const int_t h = image_a->height();
+  assert(w>1);
+  assert(h>1);
+  assert(image_b->width()==w && "Error: images must be the same dims");
+  assert(image_b->height()==h && "Error: images must be the same dims");
+  // image a is the real part and image b the imaginary part of one complex transform
+  Teuchos::ArrayRCP<scalar_t> z_real(w*h,0.0);
+  Teuchos::ArrayRCP<scalar_t> z_complex(w*h,0.0);
+  windowed_intensities(image_a,hamming_filter,z_real.getRawPtr());
+  windowed_intensities(image_b,hamming_filter,z_complex.getRawPtr());
+  array_2d_fft_in_place(w,h,z_real,z_complex,0);
+  a_real = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
+  a_complex = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
+  b_real = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
+  b_complex = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
+  // A(k) = (Z(k) + conj(Z(-k)))/2, B(k) = (Z(k) - conj(Z(-k)))/2i
   for(int_t y=0;y<h;++y){
+    const int_t ny = y==0 ? 0 : h - y;
     for(int_t x=0;x<w;++x){
-      img_row[x].r=real[y*w+x];
-      img_row[x].i=0.0;
-    }
-    kiss_fft(cfg_ffx,img_row,img_row);
-    for(int_t x=0;x<w;++x){
-      real[y*w+x] = img_row[x].r;
-      complex[y*w+x] = img_row[x].i;
-    }
-  }
-  // fft the cols
-  for(int_t x=0;x<w;++x){
-    for(int_t y=0;y<h;++y){
-      img_col[y].r=real[y*w+x];
-      img_col[y].i=complex[y*w+x];
-    }
-    kiss_fft(cfg_ffy,img_col,img_col);
-    for(int_t y=0;y<h;++y){
-      real[y*w+x] = img_col[y].r;
-      complex[y*w+x] = img_col[y].i;
+      const int_t nx = x==0 ? 0 : w - x;
+      const int_t k = y*w+x;
+      const int_t n = ny*w+nx;
+      a_real[k] = 0.5*(z_real[k] + z_real[n]);
+      a_complex[k] = 0.5*(z_complex[k] - z_complex[n]);
+      b_real[k] = 0.5*(z_complex[k] + z_complex[n]);
+      b_complex[k] = 0.5*(z_real[n] - z_real[k]);
     }
   }
+}
+
+DICE_LIB_DLL_EXPORT
+void
+image_fft(Teuchos::RCP<Image> image,
+  Teuchos::ArrayRCP<scalar_t> & real,
+  Teuchos::ArrayRCP<scalar_t> & complex,
+  const int_t inverse,
+  const bool hamming_filter){
 
-  free(cfg_ffx);
-  free(cfg_ffy);
-  delete[] img_row;
-  delete[] img_col;
+  const int_t w = image->width();
+  assert(w>1);
+  const int_t h = image->height();
+  assert(h>1);
+  real = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
+  complex = Teuchos::ArrayRCP<scalar_t> (w*h,0.0);
+  windowed_intensities(image,hamming_filter,real.getRawPtr());
 
+  if(inverse==0){
+    // the input is real so the rows are transformed two at a time
+    real_rows_fft(w,h,real.getRawPtr(),complex.getRawPtr());
+    columns_fft(w,h,real.getRawPtr(),complex.getRawPtr(),inverse);
+  }
+  else{
+    array_2d_fft_in_place(w,h,real,complex,inverse);
+  }
 };
 
 DICE_LIB_DLL_EXPORT
@@ -623,39 +844,32 @@ array_2d_fft_in_place(const int_t w,
   Teuchos::ArrayRCP<scalar_t> & complex,
   const int_t inverse){
 
-  kiss_fft_cpx * img_row = new kiss_fft_cpx[w];
-  kiss_fft_cpx * img_col = new kiss_fft_cpx[h];
-  kiss_fft_cfg cfg_ffx = kiss_fft_alloc(w,inverse,0,0);
-  kiss_fft_cfg cfg_ffy = kiss_fft_alloc(h,inverse,0,0);
-
+  assert(real.size()>=w*h);
+  assert(complex.size()>=w*h);
+  scalar_t * real_values = real.getRawPtr();
+  scalar_t * complex_values = complex.getRawPtr();
+  kiss_fft_cfg cfg_ffx = fft_plan(w,inverse);
   // fft the rows
-  for(int_t y=0;y<h;++y){
-    for(int_t x=0;x<w;++x){
-      img_row[x].r=real[y*w+x];
-      img_row[x].i=complex[y*w+x];
-    }
-    kiss_fft(cfg_ffx,img_row,img_row);
-    for(int_t x=0;x<w;++x){
-      real[y*w+x] = img_row[x].r;
-      complex[y*w+x] = img_row[x].i;
-    }
-  }
-  // fft the cols
-  for(int_t x=0;x<w;++x){
-    for(int_t y=0;y<h;++y){
-      img_col[y].r=real[y*w+x];
-      img_col[y].i=complex[y*w+x];
-    }
-    kiss_fft(cfg_ffy,img_col,img_col);
+#pragma omp parallel
+  {
+    // separate input and output buffers avoid the scratch allocation of an in place kiss_fft
+    std::vector<kiss_fft_cpx> row_in(w);
+    std::vector<kiss_fft_cpx> row_out(w);
+#pragma omp for
     for(int_t y=0;y<h;++y){
-      real[y*w+x] = img_col[y].r;
-      complex[y*w+x] = img_col[y].i;
+      for(int_t x=0;x<w;++x){
+        row_in[x].r=real_values[y*w+x];
+        row_in[x].i=complex_values[y*w+x];
+      }
+      kiss_fft(cfg_ffx,&row_in[0],&row_out[0]);
+      for(int_t x=0;x<w;++x){
+        real_values[y*w+x] = row_out[x].r;
+        complex_values[y*w+x] = row_out[x].i;
+      }
     }
   }
-  free(cfg_ffx);
-  free(cfg_ffy);
-  delete[] img_row;
-  delete[] img_col;
+  // fft the cols
+  columns_fft(w,h,real_values,complex_values,inverse);
 };
 
 }// End DICe Namespace
@@ -75,6 +75,25 @@ image_fft(Teuchos::RCP<Image> image,
   const int_t inverse = 0,
   const bool hamming_filter=true);
 
+/// FFT of two images of the same size, since the intensities are real both transforms are
+/// computed with one complex FFT (image a in the real part, image b in the imaginary part)
+/// \param image_a the first image
+/// \param image_b the second image
+/// \param a_real [out] the real part of the FFT of image a
+/// \param a_complex [out] the imaginary part of the FFT of image a
+/// \param b_real [out] the real part of the FFT of image b
+/// \param b_complex [out] the imaginary part of the FFT of image b
+/// \param hamming_filter true if a hamming filter should be applied to the images
+DICE_LIB_DLL_EXPORT
+void
+image_pair_fft(Teuchos::RCP<Image> image_a,
+  Teuchos::RCP<Image> image_b,
+  Teuchos::ArrayRCP<scalar_t> & a_real,
+  Teuchos::ArrayRCP<scalar_t> & a_complex,
+  Teuchos::ArrayRCP<scalar_t> & b_real,
+  Teuchos::ArrayRCP<scalar_t> & b_complex,
+  const bool hamming_filter=true);
+
 /// compute the image fft and return an image with
 /// intensity values as the magnitude of the FFT values
 /// note: the fft values are scaled and the log is taken,
@@ -112,6 +131,25 @@ phase_correlate_x_y(Teuchos::RCP<Image> image_a,
   scalar_t & u_y,
   const bool convert_to_r_theta=false);
 
+/// Phase correlate two equally sized windows stored as row major arrays (a hamming window is applied to both)
+/// Unlike phase_correlate_x_y this does not create any images and runs serially, so many windows can be
+/// correlated at once from different threads. The peak is located to sub-pixel accuracy with a parabolic fit.
+/// the return value is the peak height normalized by the number of pixels (1.0 for a perfect circular shift)
+/// \param w width of the windows
+/// \param h height of the windows
+/// \param window_a the first window
+/// \param window_b the second window
+/// \param u_x [out] displacement x of window b relative to window a
+/// \param u_y [out] displacement y of window b relative to window a
+DICE_LIB_DLL_EXPORT
+scalar_t
+phase_correlate_windows(const int_t w,
+  const int_t h,
+  const scalar_t * window_a,
+  const scalar_t * window_b,
+  scalar_t & u_x,
+  scalar_t & u_y);
+
 /// Phase correlate a single row from two images
 /// \param image_a the first image
 /// \param image_b the second image
@@ -152,6 +190,29 @@ array_2d_fft_in_place(const int_t w,
   Teuchos::ArrayRCP<scalar_t> & complex,
   const int_t inverse = 0);
 
+/// returns a cached kiss_fft plan for the given size and direction, each plan is allocated
+/// once and reused by all of the FFT routines (a plan is read only during a transform so it
+/// can be shared by several threads)
+/// \param nfft the size of the transform
+/// \param inverse 1 for an inverse FFT
+DICE_LIB_DLL_EXPORT
+kiss_fft_cfg
+fft_plan(const int_t nfft,
+  const int_t inverse);
+
+/// FFT of each row of a real valued row major array, pairs of rows are packed into one complex
+/// transform and separated afterwards so only half as many transforms are needed
+/// \param w width
+/// \param h height
+/// \param real [in/out] the real values on input, the real part of the row transforms on output
+/// \param complex [out] the imaginary part of the row transforms
+DICE_LIB_DLL_EXPORT
+void
+real_rows_fft(const int_t w,
+  const int_t h,
+  scalar_t * real,
+  scalar_t * complex);
+
 /// multiply two complex numbers
 /// \param result_r [out] the real result
 /// \param result_i [out] the imaginary result
@@ -71,6 +71,8 @@ BC_Manager::BC_Manager(Global_Algorithm * alg) :
   // positive number is dirichlet node set
   // 0 is a neumann boundary
   // negative number is lagrange multiplier node set
+  // the node ids are resolved through the flat topology rather than the map lookups
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh_->get_topology();
   DICe::mesh::bc_set * bc_set = mesh_->get_node_bc_sets();
   DICe::mesh::bc_set::iterator it = bc_set->begin();
   DICe::mesh::bc_set::iterator it_end = bc_set->end();
@@ -85,11 +87,11 @@ BC_Manager::BC_Manager(Global_Algorithm * alg) :
       for(int_t i=0;i<num_bc_nodes;++i){
         const int_t node_gid = bc_set->find(boundary_node_set_id)->second[i];
         DEBUG_MSG(" lagrange condition on node " << node_gid);
-        bool is_local_node = mesh_->get_scalar_node_dist_map()->is_node_global_elem(node_gid);
-        if(is_local_node){
-          const int_t row_id = mesh_->get_scalar_node_dist_map()->get_local_element(node_gid);
+        const int_t overlap_id = topology->node_overlap_id(node_gid);
+        if(overlap_id<0) continue;
+        const int_t row_id = topology->node_local_id(overlap_id);
+        if(row_id>=0)
           register_mixed_bc(row_id);
-        }
       }
     }else if((int_t)mesh_->bc_defs()->size() < boundary_node_set_id){ // if no bcs are specified, they are all neumann bcs by default
       continue;
@@ -103,25 +105,22 @@ BC_Manager::BC_Manager(Global_Algorithm * alg) :
       const int_t num_bc_nodes = bc_set->find(boundary_node_set_id)->second.size();
       for(int_t i=0;i<num_bc_nodes;++i){
         const int_t node_gid = bc_set->find(boundary_node_set_id)->second[i];
-        bool is_local_node = mesh_->get_vector_node_dist_map()->is_node_global_elem(node_gid*spa_dim_+0);
-        int_t col_id = mesh_->get_vector_node_overlap_map()->get_local_element(node_gid*spa_dim_+0);
+        const int_t overlap_id = topology->node_overlap_id(node_gid);
+        if(overlap_id<0) continue;
+        // the vector maps are ordered the same way as the scalar node maps
+        const int_t local_id = topology->node_local_id(overlap_id);
+        const bool is_local_node = local_id>=0;
         if(comp==0||comp==2){
           DEBUG_MSG("disp x condition on node " << node_gid);
-          if(is_local_node){
-            const int_t row_id = mesh_->get_vector_node_dist_map()->get_local_element(node_gid*spa_dim_+0);
-            register_row_bc(row_id);
-          }
-          register_col_bc(col_id);
+          if(is_local_node)
+            register_row_bc(local_id*spa_dim_+0);
+          register_col_bc(overlap_id*spa_dim_+0);
         }
         if(comp==1||comp==2){
           DEBUG_MSG("disp y condition on node " << node_gid);
-          is_local_node = mesh_->get_vector_node_dist_map()->is_node_global_elem(node_gid*spa_dim_+1);
-          col_id = mesh_->get_vector_node_overlap_map()->get_local_element(node_gid*spa_dim_+1);
-          if(is_local_node){
-            const int_t row_id = mesh_->get_vector_node_dist_map()->get_local_element(node_gid*spa_dim_+1);
-            register_row_bc(row_id);
-          }
-          register_col_bc(col_id);
+          if(is_local_node)
+            register_row_bc(local_id*spa_dim_+1);
+          register_col_bc(overlap_id*spa_dim_+1);
         }
       }
     } // end bcs from node sets
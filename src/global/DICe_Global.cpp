@@ -46,14 +46,19 @@
 #include <DICe_MeshIOUtils.h>
 #include <DICe_ParameterUtilities.h>
 #include <DICe_Preconditioner.h>
+#include <DICe_MatrixFree.h>
 #include <DICe_Parser.h>
 
+#include <cmath>
+#include <limits>
+
 namespace DICe {
 
 namespace global{
 
 Global_Algorithm::Global_Algorithm(Schema * schema,
-  const Teuchos::RCP<Teuchos::ParameterList> & params):
+  const Teuchos::RCP<Teuchos::ParameterList> & params,
+  const int_t mesh_level):
   schema_(schema),
   mesh_size_(1000.0),
   alpha2_(1.0),
@@ -65,7 +70,12 @@ Global_Algorithm::Global_Algorithm(Schema * schema,
   max_iterations_(25),
   element_type_(DICe::mesh::TRI6),
   use_fixed_point_iterations_(false),
-  stabilization_tau_(-1.0)
+  stabilization_tau_(-1.0),
+  use_matrix_free_(false),
+  preconditioner_type_("ILU"),
+  mesh_level_(mesh_level),
+  num_mesh_levels_(1),
+  has_converged_solution_(false)
 {
   TEUCHOS_TEST_FOR_EXCEPTION(!schema,std::runtime_error,"Error, cannot have null schema in this constructor");
   default_constructor_tasks(params);
@@ -82,7 +92,12 @@ Global_Algorithm::Global_Algorithm(const Teuchos::RCP<Teuchos::ParameterList> &
   max_iterations_(25),
   element_type_(DICe::mesh::TRI6),
   use_fixed_point_iterations_(false),
-  stabilization_tau_(-1.0)
+  stabilization_tau_(-1.0),
+  use_matrix_free_(false),
+  preconditioner_type_("ILU"),
+  mesh_level_(0),
+  num_mesh_levels_(1),
+  has_converged_solution_(false)
 {
   default_constructor_tasks(params);
 }
@@ -123,7 +138,15 @@ Global_Algorithm::default_constructor_tasks(const Teuchos::RCP<Teuchos::Paramete
   /// get the mesh size from the params
   if(params->isParameter(DICe::mesh_size))
     mesh_size_ = params->get<double>(DICe::mesh_size);
-  DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): Mesh size " << mesh_size_);
+  num_mesh_levels_ = params->get<int_t>(DICe::global_num_mesh_levels,1);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_mesh_levels_<1,std::runtime_error,"Error, invalid global_num_mesh_levels " << num_mesh_levels_);
+  TEUCHOS_TEST_FOR_EXCEPTION(mesh_level_<0||mesh_level_>=num_mesh_levels_,std::runtime_error,"Error, invalid mesh level " << mesh_level_);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_mesh_levels_>1&&(params->isParameter(DICe::mesh_file)||params->isParameter(DICe::mms_spec)),std::runtime_error,
+    "Error, global_num_mesh_levels > 1 requires a mesh generated from a subset file");
+  // each coarser level quadruples the area constraint (doubles the element edge length)
+  for(int_t i=0;i<mesh_level_;++i)
+    mesh_size_ *= 4.0;
+  DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): Mesh size " << mesh_size_ << " mesh level " << mesh_level_ << " of " << num_mesh_levels_);
 
   TEUCHOS_TEST_FOR_EXCEPTION(!params->isParameter(DICe::output_prefix),std::runtime_error,
     "Error, output_prefix must be defined");
@@ -132,7 +155,10 @@ Global_Algorithm::default_constructor_tasks(const Teuchos::RCP<Teuchos::Paramete
   const std::string output_folder = params->get<std::string>(DICe::output_folder);
   const std::string output_prefix = params->get<std::string>(DICe::output_prefix);
   std::stringstream output_file_name_ss;
-  output_file_name_ss << output_prefix << ".e";
+  output_file_name_ss << output_prefix;
+  if(mesh_level_>0)
+    output_file_name_ss << "_level_" << mesh_level_;
+  output_file_name_ss << ".e";
   output_file_name_ = output_file_name_ss.str();
   DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): output file name: " << output_file_name_);
   if(params->isParameter(DICe::mesh_file)){
@@ -175,10 +201,12 @@ Global_Algorithm::default_constructor_tasks(const Teuchos::RCP<Teuchos::Paramete
     mesh_ = DICe::generate_tri_mesh(element_type_,subset_file,mesh_size_,output_file_name_);
   }
   TEUCHOS_TEST_FOR_EXCEPTION(mesh_==Teuchos::null,std::runtime_error,"Error, mesh should not be a null pointer here.");
-  if(schema_)
-    schema_->mesh() = mesh_;
+  // only the target mesh level is owned by the schema and written to the output file
+  if(schema_&&mesh_level_==0)
+    schema_->set_mesh(mesh_);
 
-  DICe::mesh::create_output_exodus_file(mesh_,output_folder);
+  if(mesh_level_==0)
+    DICe::mesh::create_output_exodus_file(mesh_,output_folder);
   if(is_mixed_formulation())
     mesh_->create_mixed_node_field_maps(mesh_);
 
@@ -226,7 +254,8 @@ Global_Algorithm::default_constructor_tasks(const Teuchos::RCP<Teuchos::Paramete
       mesh_->create_field(field_enums::EXACT_LAGRANGE_MULTIPLIER_FS);
     }
   }
-  DICe::mesh::create_exodus_output_variable_names(mesh_);
+  if(mesh_level_==0)
+    DICe::mesh::create_exodus_output_variable_names(mesh_);
   mesh_->print_field_info();
 
   DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): using global formulation: " << to_string(global_formulation_));
@@ -316,6 +345,31 @@ Global_Algorithm::default_constructor_tasks(const Teuchos::RCP<Teuchos::Paramete
   }
   DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): use_fixed_point_iterations: " << use_fixed_point_iterations_);
 
+  use_matrix_free_ = params->get<bool>(DICe::global_use_matrix_free,false);
+  TEUCHOS_TEST_FOR_EXCEPTION(use_matrix_free_&&is_mixed_formulation(),std::runtime_error,
+    "Error, global_use_matrix_free is not available for mixed formulations");
+  if(params->isParameter(DICe::global_preconditioner)){
+    std::string prec_str = params->get<std::string>(DICe::global_preconditioner);
+    to_upper(prec_str);
+    if(prec_str=="ILU"||prec_str=="JACOBI"||prec_str=="CHEBYSHEV")
+      preconditioner_type_ = prec_str;
+    else{
+      TEUCHOS_TEST_FOR_EXCEPTION(true, std::runtime_error,"Error, invalid preconditioner type: " << prec_str);
+    }
+  }
+  else if(use_matrix_free_)
+    preconditioner_type_ = "JACOBI";
+  TEUCHOS_TEST_FOR_EXCEPTION(use_matrix_free_&&preconditioner_type_=="ILU",std::runtime_error,
+    "Error, the ILU preconditioner requires an assembled tangent (global_use_matrix_free must be false)");
+  TEUCHOS_TEST_FOR_EXCEPTION(!use_matrix_free_&&preconditioner_type_!="ILU",std::runtime_error,
+    "Error, the " << preconditioner_type_ << " preconditioner requires global_use_matrix_free to be true");
+  DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): use_matrix_free: " << use_matrix_free_ << " preconditioner: " << preconditioner_type_);
+
+  // build the coarser levels of the hierarchy once, they are reused for every frame
+  if(mesh_level_+1<num_mesh_levels_){
+    DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): creating coarse mesh level " << mesh_level_+1);
+    coarse_algorithm_ = Teuchos::rcp(new Global_Algorithm(schema_,params,mesh_level_+1));
+  }
 }
 
 void
@@ -399,7 +453,9 @@ Global_Algorithm::pre_execution_tasks(){
   }
 
   if(schema_){
-    initialize_ref_image();
+    // coarse levels share the reference images of the target level
+    if(ref_img_==Teuchos::null)
+      initialize_ref_image();
     set_def_image();
   }
 
@@ -484,27 +540,23 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
   tri2d_nonexact_integration_points(image_integration_order,image_gp_locs,image_gp_weights,num_image_integration_points);
 
   // gather the OVERLAP fields
-  Teuchos::RCP<MultiField> overlap_coords_ptr = mesh_->get_overlap_field(field_enums::INITIAL_COORDINATES_FS);
-  MultiField & overlap_coords = *overlap_coords_ptr;
-  Teuchos::ArrayRCP<const scalar_t> coords_values = overlap_coords.get_1d_view();
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh_->get_topology();
   Teuchos::RCP<MultiField> overlap_disp_ptr = mesh_->get_overlap_field(field_enums::DISPLACEMENT_FS);
   MultiField & overlap_disp = *overlap_disp_ptr;
   Teuchos::ArrayRCP<const scalar_t> disp_values = overlap_disp.get_1d_view();
 
   // element loop
-  DICe::mesh::element_set::iterator elem_it = mesh_->get_element_set()->begin();
-  DICe::mesh::element_set::iterator elem_end = mesh_->get_element_set()->end();
-  for(;elem_it!=elem_end;++elem_it)
+  const int_t num_elem = topology->num_elem();
+  for(int_t elem=0;elem<num_elem;++elem)
   {
-    //std::cout << "*********ELEM: " << elem_it->get()->global_id() << std::endl;
-    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    const int_t * elem_nodes = topology->elem_nodes(elem);
     // compute the shape functions and derivatives for this element:
     for(int_t nd=0;nd<num_funcs;++nd){
-      node_ids[nd] = connectivity[nd]->global_id();
+      node_ids[nd] = topology->node_global_id(elem_nodes[nd]);
+      const scalar_t * node_coords = topology->node_coords(elem_nodes[nd]);
       for(int_t dim=0;dim<spa_dim;++dim){
-        //std::cout << " gid " << node_ids[nd] << std::endl;
-        nodal_coords[nd*spa_dim+dim] = coords_values[connectivity[nd]->overlap_local_id()*spa_dim + dim];
-        nodal_disp[nd*spa_dim+dim] = disp_values[connectivity[nd]->overlap_local_id()*spa_dim + dim];
+        nodal_coords[nd*spa_dim+dim] = node_coords[dim];
+        nodal_disp[nd*spa_dim+dim] = disp_values[elem_nodes[nd]*spa_dim + dim];
       }
     }
     // clear the elem stiffness
@@ -804,25 +856,22 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
 //      mesh_->get_overlap_field(field_enums::RESIDUAL_FS);
 //  MultiField & overlap_residual = *overlap_residual_ptr;
 //  overlap_residual.put_scalar(0.0);
-  Teuchos::RCP<MultiField> overlap_coords_ptr = mesh_->get_overlap_field(field_enums::INITIAL_COORDINATES_FS);
-  MultiField & overlap_coords = *overlap_coords_ptr;
-  Teuchos::ArrayRCP<const scalar_t> coords_values = overlap_coords.get_1d_view();
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh_->get_topology();
   Teuchos::RCP<MultiField> overlap_disp_ptr = mesh_->get_overlap_field(field_enums::DISPLACEMENT_FS);
   MultiField & overlap_disp = *overlap_disp_ptr;
   Teuchos::ArrayRCP<const scalar_t> disp_values = overlap_disp.get_1d_view();
 
   // element loop
-  DICe::mesh::element_set::iterator elem_it = mesh_->get_element_set()->begin();
-  DICe::mesh::element_set::iterator elem_end = mesh_->get_element_set()->end();
-  for(;elem_it!=elem_end;++elem_it)
+  const int_t num_elem = topology->num_elem();
+  for(int_t elem=0;elem<num_elem;++elem)
   {
-    //std::cout << "ELEM: " << elem_it->get()->global_id() << std::endl;
-    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    const int_t * elem_nodes = topology->elem_nodes(elem);
     // compute the shape functions and derivatives for this element:
     for(int_t nd=0;nd<num_funcs;++nd){
+      const scalar_t * node_coords = topology->node_coords(elem_nodes[nd]);
       for(int_t dim=0;dim<spa_dim;++dim){
-        nodal_coords[nd*spa_dim+dim] = coords_values[connectivity[nd]->overlap_local_id()*spa_dim + dim];
-        nodal_disp[nd*spa_dim+dim] = disp_values[connectivity[nd]->overlap_local_id()*spa_dim + dim];
+        nodal_coords[nd*spa_dim+dim] = node_coords[dim];
+        nodal_disp[nd*spa_dim+dim] = disp_values[elem_nodes[nd]*spa_dim + dim];
       }
     }
     // clear the elem force
@@ -946,7 +995,7 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
       //overlap_residual.local_value(nodex_local_id) += elem_force[i*spa_dim+0];
       //overlap_residual.local_value(nodey_local_id) += elem_force[i*spa_dim+1];
       for(int_t dim=0;dim<spa_dim;++dim){
-        int_t row = connectivity[i]->global_id()*spa_dim+dim;
+        int_t row = topology->node_global_id(elem_nodes[i])*spa_dim+dim;
         //const bool is_local_row_node =  mesh_->get_vector_node_dist_map()->is_node_global_elem(row); // using the non-mixed map because the row is a velocity row
         //const bool row_is_bc_node = is_local_row_node ?
         //    bc_manager_->is_row_bc(mesh_->get_vector_node_dist_map()->get_local_element(row)) : false; // same rationalle here
@@ -985,6 +1034,7 @@ Global_Algorithm::execute(){
   }
   Teuchos::RCP<MultiField> disp = mesh_->get_field(field_enums::DISPLACEMENT_FS);
   Teuchos::RCP<MultiField> disp_nm1 = mesh_->get_field(field_enums::DISPLACEMENT_NM1_FS);
+  bool initial_condition_imported = false;
   if(schema_){
     if(schema_->use_incremental_formulation()){
       disp->put_scalar(0.0);
@@ -1009,8 +1059,13 @@ Global_Algorithm::execute(){
         disp_nm1->local_value(i*spa_dim+0) = disp_x[i];
         disp_nm1->local_value(i*spa_dim+1) = disp_y[i];
       }
+      initial_condition_imported = true;
     }
   }
+  // coarse-to-fine continuation, the coarse solution is the initial guess for this mesh
+  // (not needed on the frame where the initial condition file provides the guess)
+  if(coarse_algorithm_!=Teuchos::null&&!initial_condition_imported)
+    solve_coarse_levels();
 //  disp->describe();
 
 //  Teuchos::RCP<DICe::MultiField_Matrix> tangent = compute_tangent(use_fixed_point_iterations_);
@@ -1028,9 +1083,17 @@ Global_Algorithm::execute(){
   int_t it=0;
   for(;it<=max_its;++it){
 
-    Teuchos::RCP<DICe::MultiField_Matrix> tangent = compute_tangent(use_fixed_point_iterations_);
+    Teuchos::RCP<DICe::MultiField_Matrix> tangent;
+    Teuchos::RCP<Matrix_Free_Tangent> matrix_free_tangent;
     linear_problem_->setHermitian(true);
-    linear_problem_->setOperator(tangent->get());
+    if(use_matrix_free_){
+      matrix_free_tangent = Teuchos::rcp(new Matrix_Free_Tangent(this,bc_manager_,use_fixed_point_iterations_));
+      linear_problem_->setOperator(matrix_free_tangent);
+    }
+    else{
+      tangent = compute_tangent(use_fixed_point_iterations_);
+      linear_problem_->setOperator(tangent->get());
+    }
 
     // apply the initial conditions (sets lhs and disp_nm1)
     bc_manager_->apply_ics(it==0);
@@ -1064,10 +1127,19 @@ Global_Algorithm::execute(){
     // solve:
     DEBUG_MSG("Global_Algorithm::execute(): Solving the linear system...");
     DEBUG_MSG("Global_Algorithm::execute(): Preconditioning");
-    Preconditioner_Factory factory;
-    Teuchos::RCP<Teuchos::ParameterList> plist = factory.parameter_list_for_ifpack();
-    Teuchos::RCP<Ifpack_Preconditioner> Prec = factory.create (tangent->get(), plist);
-    Teuchos::RCP<Belos::EpetraPrecOp> belosPrec = Teuchos::rcp( new Belos::EpetraPrecOp( Prec ) );
+    Teuchos::RCP<Belos::EpetraPrecOp> belosPrec;
+    if(preconditioner_type_=="JACOBI"){
+      belosPrec = Teuchos::rcp( new Belos::EpetraPrecOp( Teuchos::rcp(new Jacobi_Preconditioner(matrix_free_tangent)) ) );
+    }
+    else if(preconditioner_type_=="CHEBYSHEV"){
+      belosPrec = Teuchos::rcp( new Belos::EpetraPrecOp( Teuchos::rcp(new Chebyshev_Preconditioner(matrix_free_tangent)) ) );
+    }
+    else{
+      Preconditioner_Factory factory;
+      Teuchos::RCP<Teuchos::ParameterList> plist = factory.parameter_list_for_ifpack();
+      Teuchos::RCP<Ifpack_Preconditioner> Prec = factory.create (tangent->get(), plist);
+      belosPrec = Teuchos::rcp( new Belos::EpetraPrecOp( Prec ) );
+    }
     linear_problem_->setLeftPrec( belosPrec );
     bool is_set = linear_problem_->setProblem(lhs->get(), residual->get());
     TEUCHOS_TEST_FOR_EXCEPTION(!is_set, std::logic_error,
@@ -1142,10 +1214,13 @@ Global_Algorithm::execute(){
 
   DEBUG_MSG("Global_Algorithm::execute(): linear solve complete");
 
-  compute_strains();
+  // the strains are only output for the target mesh level
+  if(mesh_level_==0)
+    compute_strains();
 
   mesh_->print_field_stats();
 
+  has_converged_solution_ = it<max_its;
   if(it>=max_its)
     return CORRELATION_FAILED;
   else
@@ -1168,9 +1243,7 @@ Global_Algorithm::compute_strains(){
   Teuchos::RCP<MultiField> gl_yy = mesh_->get_field(field_enums::GREEN_LAGRANGE_STRAIN_YY_FS);
   Teuchos::RCP<MultiField> gl_xy = mesh_->get_field(field_enums::GREEN_LAGRANGE_STRAIN_XY_FS);
   Teuchos::RCP<MultiField> coords = mesh_->get_field(field_enums::INITIAL_COORDINATES_FS);
-  Teuchos::RCP<MultiField> overlap_coords_ptr = mesh_->get_overlap_field(field_enums::INITIAL_COORDINATES_FS);
-  MultiField & overlap_coords = *overlap_coords_ptr;
-  Teuchos::ArrayRCP<const scalar_t> coords_values = overlap_coords.get_1d_view();
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh_->get_topology();
   Teuchos::RCP<MultiField> overlap_disp_ptr = mesh_->get_overlap_field(field_enums::DISPLACEMENT_FS);
   MultiField & overlap_disp = *overlap_disp_ptr;
   Teuchos::ArrayRCP<const scalar_t> disp_values = overlap_disp.get_1d_view();
@@ -1212,17 +1285,16 @@ Global_Algorithm::compute_strains(){
   scalar_t node_nat_y[] = {0.0, 0.0, 1.0, 0.0, 0.5, 0.5};
 
   // element loop
-  DICe::mesh::element_set::iterator elem_it = mesh_->get_element_set()->begin();
-  DICe::mesh::element_set::iterator elem_end = mesh_->get_element_set()->end();
-  for(;elem_it!=elem_end;++elem_it)
+  const int_t num_elem = topology->num_elem();
+  for(int_t elem=0;elem<num_elem;++elem)
   {
-    //std::cout << "ELEM: " << elem_it->get()->global_id() << std::endl;
-    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    const int_t * elem_nodes = topology->elem_nodes(elem);
     // compute the shape functions and derivatives for this element:
     for(int_t nd=0;nd<num_funcs;++nd){
+      const scalar_t * node_coords = topology->node_coords(elem_nodes[nd]);
       for(int_t dim=0;dim<spa_dim;++dim){
-        nodal_coords[nd*spa_dim+dim] = coords_values[connectivity[nd]->overlap_local_id()*spa_dim+dim];
-        nodal_disp[nd*spa_dim+dim] = disp_values[connectivity[nd]->overlap_local_id()*spa_dim+dim];
+        nodal_coords[nd*spa_dim+dim] = node_coords[dim];
+        nodal_disp[nd*spa_dim+dim] = disp_values[elem_nodes[nd]*spa_dim+dim];
       }
     }
     // iterate the nodes for this element and compute the strain at each node
@@ -1239,13 +1311,13 @@ Global_Algorithm::compute_strains(){
       DICe::global::calc_jacobian(&nodal_coords[0],&DN[0],&jac[0],&inv_jac[0],J,num_funcs,spa_dim);
 
       for(int_t i=0;i<num_funcs;++i){
-        int_t local_index = connectivity[nd]->overlap_local_id();
+        int_t local_index = elem_nodes[nd];
         overlap_dudx_ptr->local_value(local_index) += nodal_disp[i*spa_dim + 0]*(inv_jac[0]*DN[i*spa_dim + 0]+inv_jac[2]*DN[i*spa_dim + 1]);
         overlap_dudy_ptr->local_value(local_index) += nodal_disp[i*spa_dim + 0]*(inv_jac[1]*DN[i*spa_dim + 0]+inv_jac[3]*DN[i*spa_dim + 1]);
         overlap_dvdx_ptr->local_value(local_index) += nodal_disp[i*spa_dim + 1]*(inv_jac[0]*DN[i*spa_dim + 0]+inv_jac[2]*DN[i*spa_dim + 1]);
         overlap_dvdy_ptr->local_value(local_index) += nodal_disp[i*spa_dim + 1]*(inv_jac[1]*DN[i*spa_dim + 0]+inv_jac[3]*DN[i*spa_dim + 1]);
       }
-      overlap_strain_contribs_ptr->local_value(connectivity[nd]->overlap_local_id()) += 1.0;
+      overlap_strain_contribs_ptr->local_value(elem_nodes[nd]) += 1.0;
     }
   }  // elem
 
@@ -1317,6 +1389,336 @@ Global_Algorithm::initialize_ref_image(){
   //grad_x_img_->write("grad_x_img.tif");
   grad_y_img_ = Teuchos::rcp(new Image(w,h,grad_ref_y));
   //grad_y_img_->write("grad_y_img.tif");
+  // pack the intensity and gradients together for the fused interpolant used by the element kernels
+  ref_img_->create_interleaved_channels();
+  if(coarse_algorithm_!=Teuchos::null)
+    coarse_algorithm_->set_ref_images(ref_img_,grad_x_img_,grad_y_img_);
+}
+
+void
+Global_Algorithm::set_ref_images(Teuchos::RCP<Image> ref_img,
+  Teuchos::RCP<Image> grad_x_img,
+  Teuchos::RCP<Image> grad_y_img){
+  TEUCHOS_TEST_FOR_EXCEPTION(ref_img==Teuchos::null||grad_x_img==Teuchos::null||grad_y_img==Teuchos::null,
+    std::runtime_error,"Error, reference images must not be null");
+  ref_img_ = ref_img;
+  grad_x_img_ = grad_x_img;
+  grad_y_img_ = grad_y_img;
+  if(coarse_algorithm_!=Teuchos::null)
+    coarse_algorithm_->set_ref_images(ref_img_,grad_x_img_,grad_y_img_);
+}
+
+/// returns the natural coordinates of a point with respect to the vertices of a triangle and
+/// how far outside the reference triangle the point lies (zero if the point is inside)
+static scalar_t
+tri_natural_coords(const scalar_t * vertex_coords,
+  const scalar_t & x,
+  const scalar_t & y,
+  scalar_t & xi,
+  scalar_t & eta){
+  const scalar_t a11 = vertex_coords[2] - vertex_coords[0];
+  const scalar_t a12 = vertex_coords[4] - vertex_coords[0];
+  const scalar_t a21 = vertex_coords[3] - vertex_coords[1];
+  const scalar_t a22 = vertex_coords[5] - vertex_coords[1];
+  const scalar_t det = a11*a22 - a12*a21;
+  if(std::abs(det)<1.0E-12) return std::numeric_limits<scalar_t>::max();
+  const scalar_t dx = x - vertex_coords[0];
+  const scalar_t dy = y - vertex_coords[1];
+  xi = (a22*dx - a12*dy)/det;
+  eta = (a11*dy - a21*dx)/det;
+  scalar_t outside = 0.0;
+  if(xi<0.0) outside -= xi;
+  if(eta<0.0) outside -= eta;
+  if(xi+eta>1.0) outside += xi + eta - 1.0;
+  return outside;
+}
+
+/// locates each owned node of node_mesh in the elements of elem_mesh and stores the overlap ids
+/// of the element nodes and the shape function values at the node location in ids and weights
+/// (num_funcs entries per node, nodes that could not be located keep an id of -1),
+/// returns the number of nodes that were outside the element mesh
+static int_t
+locate_nodes_in_elements(Teuchos::RCP<DICe::mesh::Mesh> node_mesh,
+  Teuchos::RCP<DICe::mesh::Mesh> elem_mesh,
+  const DICe::mesh::Base_Element_Type elem_type,
+  const scalar_t & cell_size,
+  std::vector<int_t> & ids,
+  std::vector<scalar_t> & weights){
+  const int_t spa_dim = node_mesh->spatial_dimension();
+  DICe::mesh::Shape_Function_Evaluator_Factory shape_func_eval_factory;
+  Teuchos::RCP<DICe::mesh::Shape_Function_Evaluator> shape_func_evaluator = shape_func_eval_factory.create(elem_type);
+  const int_t num_funcs = shape_func_evaluator->num_functions();
+  const int_t num_local_nodes = node_mesh->get_scalar_node_dist_map()->get_num_local_elements();
+  ids.assign(num_local_nodes*num_funcs,-1);
+  weights.assign(num_local_nodes*num_funcs,0.0);
+
+  // gather the vertex coordinates of the elements (the first three nodes are the vertices)
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> elem_topology = elem_mesh->get_topology();
+  const int_t num_elem = elem_topology->num_elem();
+  std::vector<scalar_t> vertex_coords(num_elem*6);
+  std::vector<int_t> elem_node_ids(num_elem*num_funcs);
+  scalar_t min_x = std::numeric_limits<scalar_t>::max();
+  scalar_t min_y = std::numeric_limits<scalar_t>::max();
+  scalar_t max_x = -std::numeric_limits<scalar_t>::max();
+  scalar_t max_y = -std::numeric_limits<scalar_t>::max();
+  int_t elem = 0;
+  for(;elem<num_elem;++elem){
+    const int_t * elem_nodes = elem_topology->elem_nodes(elem);
+    for(int_t nd=0;nd<num_funcs;++nd)
+      elem_node_ids[elem*num_funcs+nd] = elem_nodes[nd];
+    for(int_t nd=0;nd<3;++nd){
+      const scalar_t vx = elem_topology->node_coords(elem_nodes[nd])[0];
+      const scalar_t vy = elem_topology->node_coords(elem_nodes[nd])[1];
+      vertex_coords[elem*6+nd*2+0] = vx;
+      vertex_coords[elem*6+nd*2+1] = vy;
+      if(vx<min_x) min_x = vx;
+      if(vx>max_x) max_x = vx;
+      if(vy<min_y) min_y = vy;
+      if(vy>max_y) max_y = vy;
+    }
+  }
+  if(num_elem==0){
+    DEBUG_MSG("locate_nodes_in_elements(): no elements on this processor, no nodes located");
+    return 0;
+  }
+
+  // bin the elements by bounding box so that each node only tests nearby elements
+  const int_t num_cells_x = (int_t)((max_x - min_x)/cell_size) + 1;
+  const int_t num_cells_y = (int_t)((max_y - min_y)/cell_size) + 1;
+  std::vector<std::vector<int_t> > cells(num_cells_x*num_cells_y);
+  for(elem=0;elem<num_elem;++elem){
+    scalar_t elem_min_x = vertex_coords[elem*6+0], elem_max_x = vertex_coords[elem*6+0];
+    scalar_t elem_min_y = vertex_coords[elem*6+1], elem_max_y = vertex_coords[elem*6+1];
+    for(int_t nd=1;nd<3;++nd){
+      elem_min_x = std::min(elem_min_x,vertex_coords[elem*6+nd*2+0]);
+      elem_max_x = std::max(elem_max_x,vertex_coords[elem*6+nd*2+0]);
+      elem_min_y = std::min(elem_min_y,vertex_coords[elem*6+nd*2+1]);
+      elem_max_y = std::max(elem_max_y,vertex_coords[elem*6+nd*2+1]);
+    }
+    const int_t cx_begin = (int_t)((elem_min_x - min_x)/cell_size);
+    const int_t cx_end = (int_t)((elem_max_x - min_x)/cell_size);
+    const int_t cy_begin = (int_t)((elem_min_y - min_y)/cell_size);
+    const int_t cy_end = (int_t)((elem_max_y - min_y)/cell_size);
+    for(int_t cy=cy_begin;cy<=cy_end;++cy)
+      for(int_t cx=cx_begin;cx<=cx_end;++cx)
+        cells[cy*num_cells_x+cx].push_back(elem);
+  }
+
+  Teuchos::ArrayRCP<const scalar_t> coords = node_mesh->get_field(field_enums::INITIAL_COORDINATES_FS)->get_1d_view();
+  std::vector<scalar_t> natural_coords(2);
+  std::vector<scalar_t> N(num_funcs);
+  int_t num_outside = 0;
+  for(int_t i=0;i<num_local_nodes;++i){
+    const scalar_t x = coords[i*spa_dim+0];
+    const scalar_t y = coords[i*spa_dim+1];
+    int_t best_elem = -1;
+    scalar_t best_outside = std::numeric_limits<scalar_t>::max();
+    scalar_t xi = 0.0, eta = 0.0;
+    // test the elements binned in this node's cell first
+    const int_t cx = std::max(0,std::min(num_cells_x-1,(int_t)((x - min_x)/cell_size)));
+    const int_t cy = std::max(0,std::min(num_cells_y-1,(int_t)((y - min_y)/cell_size)));
+    const std::vector<int_t> & cell = cells[cy*num_cells_x+cx];
+    for(size_t j=0;j<cell.size();++j){
+      const scalar_t outside = tri_natural_coords(&vertex_coords[cell[j]*6],x,y,xi,eta);
+      if(outside<best_outside){
+        best_outside = outside;
+        best_elem = cell[j];
+        natural_coords[0] = xi;
+        natural_coords[1] = eta;
+      }
+      if(best_outside<=1.0E-8) break;
+    }
+    // nodes not covered by the element mesh (along the boundary or owned by another processor's
+    // elements) take the value from the closest element
+    if(best_outside>1.0E-8){
+      num_outside++;
+      for(elem=0;elem<num_elem;++elem){
+        const scalar_t outside = tri_natural_coords(&vertex_coords[elem*6],x,y,xi,eta);
+        if(outside<best_outside){
+          best_outside = outside;
+          best_elem = elem;
+          natural_coords[0] = xi;
+          natural_coords[1] = eta;
+        }
+      }
+      // clamp the natural coordinates to the reference triangle
+      natural_coords[0] = std::max(natural_coords[0],(scalar_t)0.0);
+      natural_coords[1] = std::max(natural_coords[1],(scalar_t)0.0);
+      const scalar_t sum = natural_coords[0] + natural_coords[1];
+      if(sum>1.0){
+        natural_coords[0] /= sum;
+        natural_coords[1] /= sum;
+      }
+    }
+    if(best_elem<0) continue;
+    shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+    for(int_t nd=0;nd<num_funcs;++nd){
+      ids[i*num_funcs+nd] = elem_node_ids[best_elem*num_funcs+nd];
+      weights[i*num_funcs+nd] = N[nd];
+    }
+  }
+  return num_outside;
+}
+
+void
+Global_Algorithm::initialize_prolongation(){
+  TEUCHOS_TEST_FOR_EXCEPTION(coarse_algorithm_==Teuchos::null,std::runtime_error,"Error, coarse algorithm must not be null");
+  DEBUG_MSG("Global_Algorithm::initialize_prolongation(): locating the nodes of mesh level " << mesh_level_ << " in mesh level " << mesh_level_+1);
+  const int_t num_outside = locate_nodes_in_elements(mesh_,coarse_algorithm_->mesh(),coarse_algorithm_->element_type(),
+    std::sqrt(coarse_algorithm_->mesh_size()),prolongation_ids_,prolongation_weights_);
+  DEBUG_MSG("Global_Algorithm::initialize_prolongation(): " << num_outside << " of " <<
+    mesh_->get_scalar_node_dist_map()->get_num_local_elements() << " nodes are outside the coarse mesh");
+}
+
+void
+Global_Algorithm::initialize_restriction(){
+  TEUCHOS_TEST_FOR_EXCEPTION(coarse_algorithm_==Teuchos::null,std::runtime_error,"Error, coarse algorithm must not be null");
+  DEBUG_MSG("Global_Algorithm::initialize_restriction(): locating the nodes of mesh level " << mesh_level_+1 << " in mesh level " << mesh_level_);
+  const int_t num_outside = locate_nodes_in_elements(coarse_algorithm_->mesh(),mesh_,element_type_,
+    std::sqrt(mesh_size_),restriction_ids_,restriction_weights_);
+  DEBUG_MSG("Global_Algorithm::initialize_restriction(): " << num_outside << " of " <<
+    coarse_algorithm_->mesh()->get_scalar_node_dist_map()->get_num_local_elements() << " coarse nodes are outside this mesh");
+}
+
+/// interpolates a nodal vector field from one mesh to the owned nodes of another
+/// using the ids and weights from locate_nodes_in_elements()
+static void
+transfer_nodal_field(const int_t spa_dim,
+  const std::vector<int_t> & ids,
+  const std::vector<scalar_t> & weights,
+  Teuchos::ArrayRCP<const scalar_t> from_values,
+  Teuchos::RCP<MultiField> to_field,
+  Teuchos::RCP<MultiField> to_field_nm1){
+  const int_t num_local_nodes = to_field->get_map()->get_num_local_elements()/spa_dim;
+  if(num_local_nodes==0||ids.empty()) return;
+  const int_t num_funcs = ids.size()/num_local_nodes;
+  for(int_t i=0;i<num_local_nodes;++i){
+    if(ids[i*num_funcs]<0) continue;
+    scalar_t bx = 0.0, by = 0.0;
+    for(int_t nd=0;nd<num_funcs;++nd){
+      const int_t from_id = ids[i*num_funcs+nd];
+      const scalar_t weight = weights[i*num_funcs+nd];
+      bx += weight*from_values[from_id*spa_dim+0];
+      by += weight*from_values[from_id*spa_dim+1];
+    }
+    to_field->local_value(i*spa_dim+0) = bx;
+    to_field->local_value(i*spa_dim+1) = by;
+    to_field_nm1->local_value(i*spa_dim+0) = bx;
+    to_field_nm1->local_value(i*spa_dim+1) = by;
+  }
+}
+
+scalar_t
+Global_Algorithm::compute_image_mismatch(){
+  TEUCHOS_TEST_FOR_EXCEPTION(ref_img_==Teuchos::null||def_img_==Teuchos::null,std::runtime_error,
+    "Error, the images must be set before computing the image mismatch");
+  const int_t spa_dim = mesh_->spatial_dimension();
+  DICe::mesh::Shape_Function_Evaluator_Factory shape_func_eval_factory;
+  Teuchos::RCP<DICe::mesh::Shape_Function_Evaluator> shape_func_evaluator = shape_func_eval_factory.create(element_type_);
+  const int_t num_funcs = shape_func_evaluator->num_functions();
+  std::vector<scalar_t> N(num_funcs);
+  std::vector<scalar_t> DN(num_funcs*spa_dim);
+  std::vector<scalar_t> nodal_coords(num_funcs*spa_dim);
+  std::vector<scalar_t> nodal_disp(num_funcs*spa_dim);
+  std::vector<scalar_t> jac(spa_dim*spa_dim);
+  std::vector<scalar_t> inv_jac(spa_dim*spa_dim);
+  scalar_t J = 0.0;
+  Teuchos::ArrayRCP<Teuchos::ArrayRCP<scalar_t> > image_gp_locs;
+  Teuchos::ArrayRCP<scalar_t> image_gp_weights;
+  int_t num_image_integration_points = -1;
+  tri2d_nonexact_integration_points(num_image_integration_points_,image_gp_locs,image_gp_weights,num_image_integration_points);
+  std::vector<scalar_t> natural_coords(image_gp_locs[0].size());
+
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh_->get_topology();
+  Teuchos::ArrayRCP<const scalar_t> disp_values = mesh_->get_overlap_field(field_enums::DISPLACEMENT_FS)->get_1d_view();
+  scalar_t mismatch = 0.0;
+  const int_t num_elem = topology->num_elem();
+  for(int_t elem=0;elem<num_elem;++elem){
+    const int_t * elem_nodes = topology->elem_nodes(elem);
+    for(int_t nd=0;nd<num_funcs;++nd){
+      const scalar_t * node_coords = topology->node_coords(elem_nodes[nd]);
+      for(int_t dim=0;dim<spa_dim;++dim){
+        nodal_coords[nd*spa_dim+dim] = node_coords[dim];
+        nodal_disp[nd*spa_dim+dim] = disp_values[elem_nodes[nd]*spa_dim + dim];
+      }
+    }
+    for(int_t gp=0;gp<num_image_integration_points;++gp){
+      for(size_t dim=0;dim<natural_coords.size();++dim)
+        natural_coords[dim] = image_gp_locs[gp][dim];
+      shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+      shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
+      scalar_t x = 0.0, y = 0.0, bx = 0.0, by = 0.0;
+      for(int_t i=0;i<num_funcs;++i){
+        x += nodal_coords[i*spa_dim+0]*N[i];
+        y += nodal_coords[i*spa_dim+1]*N[i];
+        bx += nodal_disp[i*spa_dim+0]*N[i];
+        by += nodal_disp[i*spa_dim+1]*N[i];
+      }
+      DICe::global::calc_jacobian(&nodal_coords[0],&DN[0],&jac[0],&inv_jac[0],J,num_funcs,spa_dim);
+      intensity_t phi_0 = 0.0;
+      scalar_t grad_phi_x = 0.0, grad_phi_y = 0.0;
+      interpolate_ref_image(x-bx,y-by,phi_0,grad_phi_x,grad_phi_y);
+      const scalar_t d_phi_dt = def_img_->interpolate_bicubic(x,y) - phi_0;
+      mismatch += d_phi_dt*d_phi_dt*image_gp_weights[gp]*J;
+    } // image gp loop
+  } // elem loop
+  return mismatch;
+}
+
+bool
+Global_Algorithm::solve_coarse_levels(){
+  if(coarse_algorithm_==Teuchos::null) return true;
+  DEBUG_MSG("Global_Algorithm::solve_coarse_levels(): solving mesh level " << mesh_level_+1);
+  const int_t spa_dim = mesh_->spatial_dimension();
+  // a coarse level without a converged solution (first frame, after a failed frame, or after the initial
+  // condition file seeded this level) starts from the current guess on this mesh rather than from zero
+  if(!coarse_algorithm_->has_converged_solution()){
+    if(restriction_ids_.empty())
+      initialize_restriction();
+    DEBUG_MSG("Global_Algorithm::solve_coarse_levels(): seeding mesh level " << mesh_level_+1 << " with the restricted displacement field");
+    transfer_nodal_field(spa_dim,restriction_ids_,restriction_weights_,
+      mesh_->get_overlap_field(field_enums::DISPLACEMENT_FS)->get_1d_view(),
+      coarse_algorithm_->mesh()->get_field(field_enums::DISPLACEMENT_FS),
+      coarse_algorithm_->mesh()->get_field(field_enums::DISPLACEMENT_NM1_FS));
+  }
+  // execute recursively solves the levels below the coarse level first
+  const Status_Flag coarse_status = coarse_algorithm_->execute();
+  if(coarse_status!=CORRELATION_SUCCESSFUL){
+    DEBUG_MSG("Global_Algorithm::solve_coarse_levels(): coarse solve failed, keeping the current initial guess on mesh level " << mesh_level_);
+    return false;
+  }
+  const int_t num_local_nodes = mesh_->get_scalar_node_dist_map()->get_num_local_elements();
+  if(num_local_nodes==0) return true;
+  if(prolongation_ids_.empty())
+    initialize_prolongation();
+
+  // interpolate the coarse displacement solution to the nodes of this mesh, but only keep it
+  // if it matches the images better than the current guess (the comparison is made over the
+  // elements owned by this processor)
+  Teuchos::RCP<MultiField> disp = mesh_->get_field(field_enums::DISPLACEMENT_FS);
+  Teuchos::RCP<MultiField> disp_nm1 = mesh_->get_field(field_enums::DISPLACEMENT_NM1_FS);
+  const int_t num_local_values = disp->get_map()->get_num_local_elements();
+  std::vector<scalar_t> guess(num_local_values);
+  std::vector<scalar_t> guess_nm1(num_local_values);
+  for(int_t i=0;i<num_local_values;++i){
+    guess[i] = disp->local_value(i);
+    guess_nm1[i] = disp_nm1->local_value(i);
+  }
+  const scalar_t guess_mismatch = compute_image_mismatch();
+  transfer_nodal_field(spa_dim,prolongation_ids_,prolongation_weights_,
+    coarse_algorithm_->mesh()->get_overlap_field(field_enums::DISPLACEMENT_FS)->get_1d_view(),disp,disp_nm1);
+  const scalar_t prolongated_mismatch = compute_image_mismatch();
+  DEBUG_MSG("Global_Algorithm::solve_coarse_levels(): image mismatch of the current guess " << guess_mismatch <<
+    " prolongated coarse solution " << prolongated_mismatch);
+  if(prolongated_mismatch>guess_mismatch){
+    DEBUG_MSG("Global_Algorithm::solve_coarse_levels(): coarse solution does not improve the initial guess on mesh level " << mesh_level_ << ", keeping the current guess");
+    for(int_t i=0;i<num_local_values;++i){
+      disp->local_value(i) = guess[i];
+      disp_nm1->local_value(i) = guess_nm1[i];
+    }
+    return false;
+  }
+  return true;
 }
 
 void
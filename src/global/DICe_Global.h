@@ -76,8 +76,10 @@ public:
   /// Constrtuctor with valid pointer to a schema
   /// \param schema pointer to the initializing schema
   /// \param params pointer to a set of parameters that define which terms are included, etc.
+  /// \param mesh_level the level of this algorithm in the coarse-to-fine hierarchy (0 is the target mesh)
   Global_Algorithm(Schema * schema,
-    const Teuchos::RCP<Teuchos::ParameterList> & params);
+    const Teuchos::RCP<Teuchos::ParameterList> & params,
+    const int_t mesh_level=0);
 
   /// Constrtuctor with no schema, but a string name of
   /// manufactured solution problem to run (used for regression testing mostly)
@@ -187,6 +189,28 @@ public:
     return grad_y_img_;
   }
 
+  /// interpolate the reference intensity and gradients at a point, uses the fused
+  /// interpolant on the interleaved reference image channels if they are available
+  /// \param x local image coordinate x
+  /// \param y local image coordinate y
+  /// \param phi output reference intensity
+  /// \param grad_phi_x output x gradient
+  /// \param grad_phi_y output y gradient
+  void interpolate_ref_image(const scalar_t & x,
+    const scalar_t & y,
+    intensity_t & phi,
+    scalar_t & grad_phi_x,
+    scalar_t & grad_phi_y)const{
+    if(ref_img_->has_interleaved_channels()){
+      ref_img_->interpolate_bicubic_fused(phi,grad_phi_x,grad_phi_y,x,y);
+    }
+    else{
+      phi = ref_img_->interpolate_bicubic(x,y);
+      grad_phi_x = grad_x_img_->interpolate_bicubic(x,y);
+      grad_phi_y = grad_y_img_->interpolate_bicubic(x,y);
+    }
+  }
+
   /// return a pointer to the schema
   Schema * schema()const{
     return schema_;
@@ -202,11 +226,62 @@ public:
     return mms_problem_;
   }
 
+  /// Returns the element type
+  DICe::mesh::Base_Element_Type element_type()const{
+    return element_type_;
+  }
+
+  /// Returns the number of image integration points
+  int_t num_image_integration_points()const{
+    return num_image_integration_points_;
+  }
+
+  /// Returns true if the tangent is applied matrix free
+  bool use_matrix_free()const{
+    return use_matrix_free_;
+  }
+
+  /// Returns the level of this algorithm in the coarse-to-fine hierarchy (0 is the target mesh)
+  int_t mesh_level()const{
+    return mesh_level_;
+  }
+
+  /// Returns a pointer to the algorithm for the next coarser mesh level (null if this is the coarsest)
+  Teuchos::RCP<Global_Algorithm> coarse_algorithm()const{
+    return coarse_algorithm_;
+  }
+
+  /// share the reference image and gradient images with this algorithm and all coarser levels
+  /// \param ref_img the reference image (with interleaved channels if available)
+  /// \param grad_x_img the x gradient image
+  /// \param grad_y_img the y gradient image
+  void set_ref_images(Teuchos::RCP<Image> ref_img,
+    Teuchos::RCP<Image> grad_x_img,
+    Teuchos::RCP<Image> grad_y_img);
+
+  /// solve on the coarser mesh levels and interpolate the coarse displacement
+  /// solution onto this mesh as the initial guess (returns false if the coarse solve failed
+  /// or the coarse solution matched the images worse than the current guess, which is then kept)
+  bool solve_coarse_levels();
+
+  /// Returns true if the last call to execute() converged
+  bool has_converged_solution()const{
+    return has_converged_solution_;
+  }
+
+  /// integral over the elements owned by this processor of the squared difference between the
+  /// deformed image and the reference image mapped by the current displacement field
+  scalar_t compute_image_mismatch();
+
 protected:
   /// protect the default constructor
   Global_Algorithm(const Global_Algorithm&);
   /// comparison operator
   Global_Algorithm& operator=(const Global_Algorithm&);
+  /// locate each owned node of this mesh in the coarse mesh and store the coarse shape function values
+  void initialize_prolongation();
+  /// locate each owned node of the coarse mesh in this mesh and store the shape function values
+  void initialize_restriction();
   /// pointer to the calling schema
   Schema * schema_;
   /// mesh size constraint (largest size allowed in pixels^2)
@@ -254,6 +329,26 @@ protected:
   bool use_fixed_point_iterations_;
   /// stabilization parameter set by user
   scalar_t stabilization_tau_;
+  /// apply the tangent element by element rather than assembling it
+  bool use_matrix_free_;
+  /// preconditioner to use for the linear solve (ILU, JACOBI, or CHEBYSHEV)
+  std::string preconditioner_type_;
+  /// level of this algorithm in the coarse-to-fine hierarchy (0 is the target mesh)
+  int_t mesh_level_;
+  /// total number of mesh levels in the hierarchy
+  int_t num_mesh_levels_;
+  /// algorithm for the next coarser mesh level, built once and reused for every frame
+  Teuchos::RCP<Global_Algorithm> coarse_algorithm_;
+  /// for each owned node, the overlap ids of the coarse element nodes that interpolate it
+  std::vector<int_t> prolongation_ids_;
+  /// for each owned node, the coarse shape function values at the node location
+  std::vector<scalar_t> prolongation_weights_;
+  /// for each owned coarse node, the overlap ids of the element nodes of this mesh that interpolate it
+  std::vector<int_t> restriction_ids_;
+  /// for each owned coarse node, the shape function values of this mesh at the coarse node location
+  std::vector<scalar_t> restriction_weights_;
+  /// true if the last call to execute() converged
+  bool has_converged_solution_;
 };
 
 }// end global namespace
@@ -180,11 +180,12 @@ void image_time_force(Global_Algorithm* alg,
     "Error, the pointer to the algorithm must be valid");
 
   // compute the image force terms
-  const intensity_t phi_0 = alg->ref_img()->interpolate_bicubic(x-bx,y-by);
+  intensity_t phi_0 = 0.0;
+  scalar_t grad_phi_x = 0.0;
+  scalar_t grad_phi_y = 0.0;
+  alg->interpolate_ref_image(x-bx,y-by,phi_0,grad_phi_x,grad_phi_y);
   const intensity_t phi = alg->def_img()->interpolate_bicubic(x,y);
   const scalar_t d_phi_dt = phi - phi_0;
-  const scalar_t grad_phi_x = alg->grad_x()->interpolate_bicubic(x-bx,y-by);
-  const scalar_t grad_phi_y = alg->grad_y()->interpolate_bicubic(x-bx,y-by);
   for(int_t i=0;i<num_funcs;++i){
     elem_force[i*spa_dim+0] -= d_phi_dt*grad_phi_x*N[i]*gp_weight*J;
     elem_force[i*spa_dim+1] -= d_phi_dt*grad_phi_y*N[i]*gp_weight*J;
@@ -206,8 +207,10 @@ void image_grad_tensor(Global_Algorithm * alg,
   TEUCHOS_TEST_FOR_EXCEPTION(alg==NULL,std::runtime_error,
     "Error, the pointer to the algorithm must be valid");
   // compute the image stiffness terms
-  const scalar_t grad_phi_x = alg->grad_x()->interpolate_bicubic(x-bx,y-by);
-  const scalar_t grad_phi_y = alg->grad_y()->interpolate_bicubic(x-bx,y-by);
+  intensity_t phi_0 = 0.0;
+  scalar_t grad_phi_x = 0.0;
+  scalar_t grad_phi_y = 0.0;
+  alg->interpolate_ref_image(x-bx,y-by,phi_0,grad_phi_x,grad_phi_y);
 
   // image stiffness terms
   for(int_t i=0;i<num_funcs;++i){
@@ -241,8 +244,10 @@ void image_grad_force(Global_Algorithm* alg,
   TEUCHOS_TEST_FOR_EXCEPTION(alg==NULL,std::runtime_error,
     "Error, the pointer to the algorithm must be valid");
 
-  const scalar_t grad_phi_x = alg->grad_x()->interpolate_bicubic(x-bx,y-by);
-  const scalar_t grad_phi_y = alg->grad_y()->interpolate_bicubic(x-bx,y-by);
+  intensity_t phi_0 = 0.0;
+  scalar_t grad_phi_x = 0.0;
+  scalar_t grad_phi_y = 0.0;
+  alg->interpolate_ref_image(x-bx,y-by,phi_0,grad_phi_x,grad_phi_y);
 
   // image stiffness terms
   for(int_t i=0;i<num_funcs;++i){
@@ -0,0 +1,448 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2015 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+#include <DICe_MatrixFree.h>
+#include <DICe_Global.h>
+#include <DICe_GlobalUtils.h>
+#include <DICe_BCManager.h>
+#include <DICe_Image.h>
+
+#include <cmath>
+
+namespace DICe {
+
+namespace global{
+
+#ifdef DICE_TPETRA
+#else
+
+Matrix_Free_Tangent::Matrix_Free_Tangent(Global_Algorithm * alg,
+  Teuchos::RCP<BC_Manager> bc_manager,
+  const bool use_fixed_point):
+  use_transpose_(false),
+  spa_dim_(2),
+  num_funcs_(0),
+  num_elem_(0),
+  num_gp_(0),
+  div_sym_coeff_(0.0),
+  tikhonov_coeff_(0.0)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(alg==NULL,std::runtime_error,
+    "Error, the pointer to the algorithm must be valid");
+  TEUCHOS_TEST_FOR_EXCEPTION(bc_manager==Teuchos::null,std::runtime_error,
+    "Error, the pointer to the bc manager must be valid");
+  TEUCHOS_TEST_FOR_EXCEPTION(alg->is_mixed_formulation(),std::runtime_error,
+    "Error, the matrix free tangent is not available for mixed formulations");
+  Teuchos::RCP<DICe::mesh::Mesh> mesh = alg->mesh();
+  spa_dim_ = mesh->spatial_dimension();
+  TEUCHOS_TEST_FOR_EXCEPTION(spa_dim_!=2,std::runtime_error,
+    "Error, the matrix free tangent is only implemented for 2d");
+
+  dist_map_ = mesh->get_vector_node_dist_map()->get();
+  overlap_map_ = mesh->get_vector_node_overlap_map()->get();
+  importer_ = Teuchos::rcp(new Epetra_Import(*overlap_map_,*dist_map_));
+  exporter_ = Teuchos::rcp(new Epetra_Export(*overlap_map_,*dist_map_));
+
+  for(int_t i=0;i<dist_map_->NumMyElements();++i)
+    if(bc_manager->is_row_bc(i))
+      bc_rows_.push_back(i);
+
+  if(alg->has_term(DIV_SYMMETRIC_STRAIN_REGULARIZATION))
+    div_sym_coeff_ = alg->alpha2();
+  // tau is always zero for the non-mixed formulations
+  if(alg->has_term(TIKHONOV_REGULARIZATION))
+    tikhonov_coeff_ = alg->alpha2();
+  const bool has_image_term = alg->has_term(IMAGE_GRAD_TENSOR);
+  const bool has_mms_image_term = alg->has_term(MMS_IMAGE_GRAD_TENSOR);
+
+  DICe::mesh::Shape_Function_Evaluator_Factory shape_func_eval_factory;
+  Teuchos::RCP<DICe::mesh::Shape_Function_Evaluator> shape_func_evaluator = alg->element_type()==DICe::mesh::TRI6 ?
+      shape_func_eval_factory.create(DICe::mesh::TRI6):
+      shape_func_eval_factory.create(DICe::mesh::TRI3);
+  num_funcs_ = shape_func_evaluator->num_functions();
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh->get_topology();
+  num_elem_ = topology->num_elem();
+
+  // packed index for the symmetric shape function pairs
+  packed_index_.resize(num_funcs_*num_funcs_);
+  int_t num_pairs = 0;
+  for(int_t i=0;i<num_funcs_;++i){
+    for(int_t j=i;j<num_funcs_;++j){
+      packed_index_[i*num_funcs_+j] = num_pairs;
+      packed_index_[j*num_funcs_+i] = num_pairs;
+      num_pairs++;
+    }
+  }
+
+  // low order integration points (same as the assembled tangent)
+  const int_t integration_order = 6;
+  Teuchos::ArrayRCP<Teuchos::ArrayRCP<scalar_t> > gp_locs;
+  Teuchos::ArrayRCP<scalar_t> gp_weights;
+  shape_func_evaluator->get_natural_integration_points(integration_order,gp_locs,gp_weights,num_gp_);
+  const int_t natural_coord_dim = gp_locs[0].size();
+  std::vector<scalar_t> natural_coords(natural_coord_dim);
+  gp_N_.resize(num_gp_*num_funcs_);
+  std::vector<scalar_t> gp_DN(num_gp_*num_funcs_*spa_dim_);
+  for(int_t gp=0;gp<num_gp_;++gp){
+    for(int_t dim=0;dim<natural_coord_dim;++dim)
+      natural_coords[dim] = gp_locs[gp][dim];
+    shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&gp_N_[gp*num_funcs_]);
+    shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&gp_DN[gp*num_funcs_*spa_dim_]);
+  }
+
+  // image integration points
+  Teuchos::ArrayRCP<Teuchos::ArrayRCP<scalar_t> > image_gp_locs;
+  Teuchos::ArrayRCP<scalar_t> image_gp_weights;
+  int_t num_image_gp = -1;
+  tri2d_nonexact_integration_points(alg->num_image_integration_points(),image_gp_locs,image_gp_weights,num_image_gp);
+  std::vector<scalar_t> image_gp_N(num_image_gp*num_funcs_);
+  std::vector<scalar_t> image_gp_DN(num_image_gp*num_funcs_*spa_dim_);
+  for(int_t gp=0;gp<num_image_gp;++gp){
+    for(int_t dim=0;dim<natural_coord_dim;++dim)
+      natural_coords[dim] = image_gp_locs[gp][dim];
+    shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&image_gp_N[gp*num_funcs_]);
+    shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&image_gp_DN[gp*num_funcs_*spa_dim_]);
+  }
+
+  elem_dofs_.resize(num_elem_*num_funcs_);
+  elem_image_moments_.assign(num_elem_*num_pairs*3,0.0);
+  elem_gp_J_.resize(num_elem_*num_gp_);
+  elem_gp_grad_N_.resize(num_elem_*num_gp_*spa_dim_*num_funcs_);
+
+  Teuchos::ArrayRCP<const scalar_t> disp_values = mesh->get_overlap_field(field_enums::DISPLACEMENT_FS)->get_1d_view();
+  std::vector<scalar_t> nodal_coords(num_funcs_*spa_dim_);
+  std::vector<scalar_t> nodal_disp(num_funcs_*spa_dim_);
+  std::vector<scalar_t> jac(spa_dim_*spa_dim_);
+  std::vector<scalar_t> inv_jac(spa_dim_*spa_dim_);
+  scalar_t J = 0.0;
+  scalar_t x=0.0,y=0.0,bx=0.0,by=0.0;
+  scalar_t grad_phi_x = 0.0, grad_phi_y = 0.0, d_phi_dt = 0.0;
+  intensity_t phi_0 = 0.0;
+
+  for(int_t elem=0;elem<num_elem_;++elem){
+    const int_t * elem_nodes = topology->elem_nodes(elem);
+    for(int_t nd=0;nd<num_funcs_;++nd){
+      const int_t olid = elem_nodes[nd];
+      elem_dofs_[elem*num_funcs_+nd] = olid;
+      const scalar_t * node_coords = topology->node_coords(olid);
+      for(int_t dim=0;dim<spa_dim_;++dim){
+        nodal_coords[nd*spa_dim_+dim] = node_coords[dim];
+        nodal_disp[nd*spa_dim_+dim] = disp_values[olid*spa_dim_ + dim];
+      }
+    }
+    scalar_t * moments = &elem_image_moments_[elem*num_pairs*3];
+
+    // low-order gauss point loop: store the geometry for the regularization terms
+    for(int_t gp=0;gp<num_gp_;++gp){
+      const scalar_t * N = &gp_N_[gp*num_funcs_];
+      const scalar_t * DN = &gp_DN[gp*num_funcs_*spa_dim_];
+      calc_jacobian(&nodal_coords[0],DN,&jac[0],&inv_jac[0],J,num_funcs_,spa_dim_);
+      const scalar_t wJ = gp_weights[gp]*J;
+      elem_gp_J_[elem*num_gp_+gp] = wJ;
+      // physical gradients: j_inv_transpose * DN_transpose (same as calc_B)
+      scalar_t * grad_N = &elem_gp_grad_N_[(elem*num_gp_+gp)*spa_dim_*num_funcs_];
+      for(int_t i=0;i<spa_dim_;++i){
+        for(int_t j=0;j<num_funcs_;++j){
+          grad_N[i*num_funcs_+j] = 0.0;
+          for(int_t k=0;k<spa_dim_;++k)
+            grad_N[i*num_funcs_+j] += inv_jac[k*spa_dim_+i]*DN[j*spa_dim_+k];
+        }
+      }
+      if(has_mms_image_term){
+        x = 0.0; y = 0.0;
+        for(int_t i=0;i<num_funcs_;++i){
+          x += nodal_coords[i*spa_dim_+0]*N[i];
+          y += nodal_coords[i*spa_dim_+1]*N[i];
+        }
+        alg->mms_problem()->phi_derivatives(x,y,d_phi_dt,grad_phi_x,grad_phi_y);
+        for(int_t i=0;i<num_funcs_;++i){
+          for(int_t j=i;j<num_funcs_;++j){
+            const scalar_t NNwJ = N[i]*N[j]*wJ;
+            const int_t p = packed_index_[i*num_funcs_+j];
+            moments[p*3+0] += grad_phi_x*grad_phi_x*NNwJ;
+            moments[p*3+1] += grad_phi_x*grad_phi_y*NNwJ;
+            moments[p*3+2] += grad_phi_y*grad_phi_y*NNwJ;
+          }
+        }
+      }
+    } // gp loop
+
+    // image gauss point loop: reduce the image gradients to the element moments
+    if(!has_image_term) continue;
+    for(int_t gp=0;gp<num_image_gp;++gp){
+      const scalar_t * N = &image_gp_N[gp*num_funcs_];
+      x = 0.0; y = 0.0;
+      bx = 0.0; by = 0.0;
+      for(int_t i=0;i<num_funcs_;++i){
+        x += nodal_coords[i*spa_dim_+0]*N[i];
+        y += nodal_coords[i*spa_dim_+1]*N[i];
+        if(use_fixed_point){
+          bx += nodal_disp[i*spa_dim_+0]*N[i];
+          by += nodal_disp[i*spa_dim_+1]*N[i];
+        }
+      }
+      calc_jacobian(&nodal_coords[0],&image_gp_DN[gp*num_funcs_*spa_dim_],&jac[0],&inv_jac[0],J,num_funcs_,spa_dim_);
+      const scalar_t wJ = image_gp_weights[gp]*J;
+      alg->interpolate_ref_image(x-bx,y-by,phi_0,grad_phi_x,grad_phi_y);
+      const scalar_t gxx = grad_phi_x*grad_phi_x*wJ;
+      const scalar_t gxy = grad_phi_x*grad_phi_y*wJ;
+      const scalar_t gyy = grad_phi_y*grad_phi_y*wJ;
+      for(int_t i=0;i<num_funcs_;++i){
+        for(int_t j=i;j<num_funcs_;++j){
+          const scalar_t NN = N[i]*N[j];
+          const int_t p = packed_index_[i*num_funcs_+j];
+          moments[p*3+0] += gxx*NN;
+          moments[p*3+1] += gxy*NN;
+          moments[p*3+2] += gyy*NN;
+        }
+      }
+    } // image gp loop
+  } // elem loop
+  DEBUG_MSG("Matrix_Free_Tangent::Matrix_Free_Tangent(): num elem " << num_elem_ << " cache size " << cache_size());
+}
+
+void
+Matrix_Free_Tangent::apply_elements(const Epetra_MultiVector & X,
+  Epetra_MultiVector & Y) const{
+  const int_t num_dofs = num_funcs_*spa_dim_;
+  const int_t num_pairs = num_funcs_*(num_funcs_+1)/2;
+  std::vector<scalar_t> xe(num_dofs);
+  std::vector<scalar_t> ye(num_dofs);
+  scalar_t s[2];
+  scalar_t strain[3];
+  for(int_t vec=0;vec<X.NumVectors();++vec){
+    const double * x = X[vec];
+    double * y = Y[vec];
+    for(int_t elem=0;elem<num_elem_;++elem){
+      const int_t * dofs = &elem_dofs_[elem*num_funcs_];
+      for(int_t i=0;i<num_funcs_;++i){
+        xe[i*2+0] = x[dofs[i]*2+0];
+        xe[i*2+1] = x[dofs[i]*2+1];
+        ye[i*2+0] = 0.0;
+        ye[i*2+1] = 0.0;
+      }
+      // image terms
+      const scalar_t * moments = &elem_image_moments_[elem*num_pairs*3];
+      for(int_t i=0;i<num_funcs_;++i){
+        for(int_t j=0;j<num_funcs_;++j){
+          const scalar_t * m = &moments[packed_index_[i*num_funcs_+j]*3];
+          ye[i*2+0] += m[0]*xe[j*2+0] + m[1]*xe[j*2+1];
+          ye[i*2+1] += m[1]*xe[j*2+0] + m[2]*xe[j*2+1];
+        }
+      }
+      // regularization terms
+      for(int_t gp=0;gp<num_gp_;++gp){
+        const scalar_t wJ = elem_gp_J_[elem*num_gp_+gp];
+        if(tikhonov_coeff_!=0.0){
+          const scalar_t * N = &gp_N_[gp*num_funcs_];
+          s[0] = 0.0; s[1] = 0.0;
+          for(int_t j=0;j<num_funcs_;++j){
+            s[0] += N[j]*xe[j*2+0];
+            s[1] += N[j]*xe[j*2+1];
+          }
+          for(int_t i=0;i<num_funcs_;++i){
+            ye[i*2+0] += tikhonov_coeff_*wJ*N[i]*s[0];
+            ye[i*2+1] += tikhonov_coeff_*wJ*N[i]*s[1];
+          }
+        }
+        if(div_sym_coeff_!=0.0){
+          // B*x followed by B'*strain
+          const scalar_t * dNx = &elem_gp_grad_N_[(elem*num_gp_+gp)*2*num_funcs_];
+          const scalar_t * dNy = dNx + num_funcs_;
+          strain[0] = 0.0; strain[1] = 0.0; strain[2] = 0.0;
+          for(int_t j=0;j<num_funcs_;++j){
+            strain[0] += dNx[j]*xe[j*2+0];
+            strain[1] += dNy[j]*xe[j*2+1];
+            strain[2] += dNy[j]*xe[j*2+0] + dNx[j]*xe[j*2+1];
+          }
+          const scalar_t coeff = div_sym_coeff_*wJ;
+          for(int_t i=0;i<num_funcs_;++i){
+            ye[i*2+0] += coeff*(dNx[i]*strain[0] + dNy[i]*strain[2]);
+            ye[i*2+1] += coeff*(dNy[i]*strain[1] + dNx[i]*strain[2]);
+          }
+        }
+      } // gp loop
+      for(int_t i=0;i<num_funcs_;++i){
+        y[dofs[i]*2+0] += ye[i*2+0];
+        y[dofs[i]*2+1] += ye[i*2+1];
+      }
+    } // elem loop
+  } // vec loop
+}
+
+void
+Matrix_Free_Tangent::apply_bc_rows(const Epetra_MultiVector & X,
+  Epetra_MultiVector & Y) const{
+  for(int_t vec=0;vec<X.NumVectors();++vec)
+    for(size_t i=0;i<bc_rows_.size();++i)
+      Y[vec][bc_rows_[i]] = X[vec][bc_rows_[i]];
+}
+
+int
+Matrix_Free_Tangent::Apply(const Epetra_MultiVector & X,
+  Epetra_MultiVector & Y) const{
+  TEUCHOS_TEST_FOR_EXCEPTION(X.NumVectors()!=Y.NumVectors(),std::runtime_error,
+    "Error, X and Y must have the same number of vectors");
+  Epetra_MultiVector X_overlap(*overlap_map_,X.NumVectors(),false);
+  X_overlap.Import(X,*importer_,Insert);
+  Epetra_MultiVector Y_overlap(*overlap_map_,X.NumVectors(),true);
+  apply_elements(X_overlap,Y_overlap);
+  Y.PutScalar(0.0);
+  Y.Export(Y_overlap,*exporter_,Add);
+  apply_bc_rows(X,Y);
+  return 0;
+}
+
+void
+Matrix_Free_Tangent::extract_diagonal(Epetra_Vector & diag) const{
+  TEUCHOS_TEST_FOR_EXCEPTION(!diag.Map().SameAs(*dist_map_),std::runtime_error,
+    "Error, the diagonal must be on the distributed vector map");
+  Epetra_Vector diag_overlap(*overlap_map_,true);
+  const int_t num_pairs = num_funcs_*(num_funcs_+1)/2;
+  for(int_t elem=0;elem<num_elem_;++elem){
+    const int_t * dofs = &elem_dofs_[elem*num_funcs_];
+    const scalar_t * moments = &elem_image_moments_[elem*num_pairs*3];
+    for(int_t i=0;i<num_funcs_;++i){
+      const scalar_t * m = &moments[packed_index_[i*num_funcs_+i]*3];
+      scalar_t dx = m[0];
+      scalar_t dy = m[2];
+      for(int_t gp=0;gp<num_gp_;++gp){
+        const scalar_t wJ = elem_gp_J_[elem*num_gp_+gp];
+        const scalar_t N = gp_N_[gp*num_funcs_+i];
+        const scalar_t * dNx = &elem_gp_grad_N_[(elem*num_gp_+gp)*2*num_funcs_];
+        const scalar_t * dNy = dNx + num_funcs_;
+        dx += tikhonov_coeff_*wJ*N*N + div_sym_coeff_*wJ*(dNx[i]*dNx[i] + dNy[i]*dNy[i]);
+        dy += tikhonov_coeff_*wJ*N*N + div_sym_coeff_*wJ*(dNy[i]*dNy[i] + dNx[i]*dNx[i]);
+      }
+      diag_overlap[dofs[i]*2+0] += dx;
+      diag_overlap[dofs[i]*2+1] += dy;
+    }
+  }
+  diag.PutScalar(0.0);
+  diag.Export(diag_overlap,*exporter_,Add);
+  for(size_t i=0;i<bc_rows_.size();++i)
+    diag[bc_rows_[i]] = 1.0;
+}
+
+Jacobi_Preconditioner::Jacobi_Preconditioner(Teuchos::RCP<Matrix_Free_Tangent> tangent):
+  tangent_(tangent)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(tangent_==Teuchos::null,std::runtime_error,
+    "Error, the pointer to the tangent must be valid");
+  inv_diag_ = Teuchos::rcp(new Epetra_Vector(tangent_->OperatorRangeMap(),true));
+  tangent_->extract_diagonal(*inv_diag_);
+  for(int_t i=0;i<inv_diag_->MyLength();++i){
+    // guard against empty rows (nodes not covered by any image integration points, etc.)
+    (*inv_diag_)[i] = std::abs((*inv_diag_)[i]) > 0.0 ? 1.0/(*inv_diag_)[i] : 1.0;
+  }
+}
+
+int
+Jacobi_Preconditioner::ApplyInverse(const Epetra_MultiVector & X,
+  Epetra_MultiVector & Y) const{
+  return Y.Multiply(1.0,*inv_diag_,X,0.0);
+}
+
+Chebyshev_Preconditioner::Chebyshev_Preconditioner(Teuchos::RCP<Matrix_Free_Tangent> tangent,
+  const int_t degree,
+  const scalar_t & eigen_ratio,
+  const int_t num_power_iterations):
+  Jacobi_Preconditioner(tangent),
+  degree_(degree),
+  lambda_max_(1.0),
+  lambda_min_(1.0)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(degree_<1,std::runtime_error,"Error, invalid Chebyshev degree " << degree_);
+  TEUCHOS_TEST_FOR_EXCEPTION(eigen_ratio<=1.0,std::runtime_error,"Error, invalid Chebyshev eigen ratio " << eigen_ratio);
+  // estimate the largest eigenvalue of D^{-1}A with power iterations
+  Epetra_Vector v(tangent_->OperatorDomainMap(),false);
+  Epetra_Vector w(tangent_->OperatorDomainMap(),false);
+  v.SetSeed(1);
+  v.Random();
+  double norm = 0.0;
+  v.Norm2(&norm);
+  v.Scale(1.0/norm);
+  double lambda = 0.0;
+  for(int_t it=0;it<num_power_iterations;++it){
+    tangent_->Apply(v,w);
+    w.Multiply(1.0,*inv_diag_,w,0.0);
+    w.Dot(v,&lambda);
+    w.Norm2(&norm);
+    if(norm<=0.0) break;
+    v.Update(1.0/norm,w,0.0);
+  }
+  // boost the estimate since power iterations under-estimate the largest eigenvalue
+  lambda_max_ = lambda > 0.0 ? 1.1*lambda : 1.0;
+  lambda_min_ = lambda_max_/eigen_ratio;
+  DEBUG_MSG("Chebyshev_Preconditioner::Chebyshev_Preconditioner(): lambda max " << lambda_max_ << " lambda min " << lambda_min_);
+}
+
+int
+Chebyshev_Preconditioner::ApplyInverse(const Epetra_MultiVector & X,
+  Epetra_MultiVector & Y) const{
+  const scalar_t theta = 0.5*(lambda_max_ + lambda_min_);
+  const scalar_t delta = 0.5*(lambda_max_ - lambda_min_);
+  const scalar_t sigma = theta/delta;
+  scalar_t rho = 1.0/sigma;
+  Epetra_MultiVector D(X.Map(),X.NumVectors(),false);
+  Epetra_MultiVector R(X.Map(),X.NumVectors(),false);
+  // first iterate with a zero initial guess: y = D^{-1}x/theta
+  D.Multiply(1.0/theta,*inv_diag_,X,0.0);
+  Y = D;
+  for(int_t k=1;k<degree_;++k){
+    const scalar_t rho_new = 1.0/(2.0*sigma - rho);
+    const scalar_t c1 = rho_new*rho;
+    const scalar_t c2 = 2.0*rho_new/delta;
+    rho = rho_new;
+    // r = x - A*y
+    tangent_->Apply(Y,R);
+    R.Update(1.0,X,-1.0);
+    // d = c1*d + c2*D^{-1}r
+    D.Multiply(c2,*inv_diag_,R,c1);
+    Y.Update(1.0,D,1.0);
+  }
+  return 0;
+}
+
+#endif
+
+}// end global namespace
+
+}// End DICe Namespace
@@ -0,0 +1,338 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2015 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+#ifndef DICE_MATRIXFREE_H
+#define DICE_MATRIXFREE_H
+
+#include <DICe.h>
+#include <DICe_Mesh.h>
+
+#ifdef DICE_TPETRA
+  #include "DICe_MultiFieldTpetra.h"
+#else
+  #include "DICe_MultiFieldEpetra.h"
+#endif
+
+#include <Teuchos_RCP.hpp>
+
+#include <vector>
+
+namespace DICe {
+
+namespace global{
+
+class Global_Algorithm;
+class BC_Manager;
+
+#ifdef DICE_TPETRA
+#error // the matrix free operators are not set up for Tpetra...
+#else
+
+/// \class Matrix_Free_Tangent
+/// \brief applies the global tangent operator element by element without assembling a matrix
+///
+/// The image gradient terms are integrated once at construction and stored as compact
+/// element moments (grad phi tensor grad phi weighted by the shape function products).
+/// The regularization terms (Horn-Schunck and Tikhonov) only depend on the element geometry,
+/// so only the weighted jacobian determinant and the physical shape function gradients
+/// are stored at the integration points and the element kernels are evaluated on the fly
+/// for each application. Only the non-mixed formulations are supported.
+class
+DICE_LIB_DLL_EXPORT
+Matrix_Free_Tangent : public Epetra_Operator
+{
+public:
+  /// Constructor
+  /// \param alg pointer to the parent global algorithm
+  /// \param bc_manager pointer to the boundary condition manager
+  /// \param use_fixed_point true if the image terms should be evaluated at the current displacement
+  Matrix_Free_Tangent(Global_Algorithm * alg,
+    Teuchos::RCP<BC_Manager> bc_manager,
+    const bool use_fixed_point);
+
+  /// Destructor
+  virtual ~Matrix_Free_Tangent(){};
+
+  /// See Epetra_Operator, transpose is the same since the tangent is symmetric
+  virtual int SetUseTranspose(bool UseTranspose){
+    use_transpose_ = UseTranspose;
+    return 0;
+  }
+
+  /// Apply the tangent to a multivector Y = A*X
+  /// \param X input multivector (distributed map)
+  /// \param Y output multivector (distributed map)
+  virtual int Apply(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const;
+
+  /// Not supported for the tangent
+  virtual int ApplyInverse(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const{
+    return -1;
+  }
+
+  /// Not supported for the tangent
+  virtual double NormInf() const{
+    return 0.0;
+  }
+
+  /// See Epetra_Operator
+  virtual const char * Label() const{
+    return "DICe::global::Matrix_Free_Tangent";
+  }
+
+  /// See Epetra_Operator
+  virtual bool UseTranspose() const{
+    return use_transpose_;
+  }
+
+  /// See Epetra_Operator
+  virtual bool HasNormInf() const{
+    return false;
+  }
+
+  /// See Epetra_Operator
+  virtual const Epetra_Comm & Comm() const{
+    return dist_map_->Comm();
+  }
+
+  /// See Epetra_Operator
+  virtual const Epetra_Map & OperatorDomainMap() const{
+    return *dist_map_;
+  }
+
+  /// See Epetra_Operator
+  virtual const Epetra_Map & OperatorRangeMap() const{
+    return *dist_map_;
+  }
+
+  /// Compute the diagonal of the tangent (with the boundary conditions applied)
+  /// \param diag output vector on the distributed map
+  void extract_diagonal(Epetra_Vector & diag) const;
+
+  /// Returns the number of scalars stored in the integration point cache
+  size_t cache_size()const{
+    return elem_dofs_.size() + elem_image_moments_.size() + elem_gp_J_.size() + elem_gp_grad_N_.size();
+  }
+
+private:
+  /// Element loop that accumulates Y_overlap += A_e*X_overlap for all elements
+  /// \param X overlap multivector input
+  /// \param Y overlap multivector output
+  void apply_elements(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const;
+
+  /// Overwrite the rows that belong to boundary condition dofs with the identity
+  /// \param X the distributed input vector
+  /// \param Y the distributed output vector
+  void apply_bc_rows(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const;
+
+  /// true if the transpose should be used (no effect)
+  bool use_transpose_;
+  /// spatial dimension
+  int_t spa_dim_;
+  /// number of shape functions per element
+  int_t num_funcs_;
+  /// number of local elements
+  int_t num_elem_;
+  /// number of low order integration points per element
+  int_t num_gp_;
+  /// regularization coefficient for the div symmetric strain term (zero if not active)
+  scalar_t div_sym_coeff_;
+  /// regularization coefficient for the tikhonov term (zero if not active)
+  scalar_t tikhonov_coeff_;
+  /// distributed vector map
+  Teuchos::RCP<const Epetra_Map> dist_map_;
+  /// overlap vector map
+  Teuchos::RCP<const Epetra_Map> overlap_map_;
+  /// importer from the dist to the overlap map
+  Teuchos::RCP<Epetra_Import> importer_;
+  /// exporter from the overlap to the dist map
+  Teuchos::RCP<Epetra_Export> exporter_;
+  /// local (distributed map) ids of the rows that have a boundary condition
+  std::vector<int_t> bc_rows_;
+  /// flat element to node connectivity (overlap local node ids) num_elem_*num_funcs_
+  std::vector<int_t> elem_dofs_;
+  /// packed upper triangular index for each shape function pair i,j
+  std::vector<int_t> packed_index_;
+  /// image moments per element and shape function pair (xx, xy, yy)
+  std::vector<scalar_t> elem_image_moments_;
+  /// shape function values at the low order integration points (shared by all elements)
+  std::vector<scalar_t> gp_N_;
+  /// integration weight times the jacobian determinant per element and integration point
+  std::vector<scalar_t> elem_gp_J_;
+  /// physical shape function gradients per element and integration point (dim major)
+  std::vector<scalar_t> elem_gp_grad_N_;
+};
+
+/// \class Jacobi_Preconditioner
+/// \brief inverse diagonal preconditioner built from the diagonal of a matrix free tangent
+class
+DICE_LIB_DLL_EXPORT
+Jacobi_Preconditioner : public Epetra_Operator
+{
+public:
+  /// Constructor
+  /// \param tangent the matrix free tangent that provides the diagonal
+  Jacobi_Preconditioner(Teuchos::RCP<Matrix_Free_Tangent> tangent);
+
+  /// Destructor
+  virtual ~Jacobi_Preconditioner(){};
+
+  /// See Epetra_Operator
+  virtual int SetUseTranspose(bool UseTranspose){
+    return 0;
+  }
+
+  /// Not supported for the preconditioner
+  virtual int Apply(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const{
+    return -1;
+  }
+
+  /// Apply the inverse diagonal Y = D^{-1}*X
+  /// \param X input multivector
+  /// \param Y output multivector
+  virtual int ApplyInverse(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const;
+
+  /// See Epetra_Operator
+  virtual double NormInf() const{
+    return 0.0;
+  }
+
+  /// See Epetra_Operator
+  virtual const char * Label() const{
+    return "DICe::global::Jacobi_Preconditioner";
+  }
+
+  /// See Epetra_Operator
+  virtual bool UseTranspose() const{
+    return false;
+  }
+
+  /// See Epetra_Operator
+  virtual bool HasNormInf() const{
+    return false;
+  }
+
+  /// See Epetra_Operator
+  virtual const Epetra_Comm & Comm() const{
+    return tangent_->Comm();
+  }
+
+  /// See Epetra_Operator
+  virtual const Epetra_Map & OperatorDomainMap() const{
+    return tangent_->OperatorDomainMap();
+  }
+
+  /// See Epetra_Operator
+  virtual const Epetra_Map & OperatorRangeMap() const{
+    return tangent_->OperatorRangeMap();
+  }
+
+  /// Returns the inverse diagonal
+  Teuchos::RCP<Epetra_Vector> inv_diagonal()const{
+    return inv_diag_;
+  }
+
+protected:
+  /// the tangent operator
+  Teuchos::RCP<Matrix_Free_Tangent> tangent_;
+  /// the inverse of the tangent diagonal
+  Teuchos::RCP<Epetra_Vector> inv_diag_;
+};
+
+/// \class Chebyshev_Preconditioner
+/// \brief Chebyshev polynomial preconditioner in D^{-1}A where D is the diagonal of the tangent
+///
+/// The largest eigenvalue of D^{-1}A is estimated with a few power iterations at construction
+/// and the polynomial targets the interval [lambda_max/ratio, lambda_max]
+class
+DICE_LIB_DLL_EXPORT
+Chebyshev_Preconditioner : public Jacobi_Preconditioner
+{
+public:
+  /// Constructor
+  /// \param tangent the matrix free tangent
+  /// \param degree the polynomial degree
+  /// \param eigen_ratio ratio of the largest to smallest eigenvalue targeted
+  /// \param num_power_iterations number of power iterations used to estimate the largest eigenvalue
+  Chebyshev_Preconditioner(Teuchos::RCP<Matrix_Free_Tangent> tangent,
+    const int_t degree=3,
+    const scalar_t & eigen_ratio=30.0,
+    const int_t num_power_iterations=10);
+
+  /// Destructor
+  virtual ~Chebyshev_Preconditioner(){};
+
+  /// Apply the Chebyshev polynomial to X (initial guess for Y is zero)
+  /// \param X input multivector
+  /// \param Y output multivector
+  virtual int ApplyInverse(const Epetra_MultiVector & X,
+    Epetra_MultiVector & Y) const;
+
+  /// See Epetra_Operator
+  virtual const char * Label() const{
+    return "DICe::global::Chebyshev_Preconditioner";
+  }
+
+  /// Returns the estimated max eigenvalue
+  scalar_t lambda_max()const{
+    return lambda_max_;
+  }
+
+private:
+  /// polynomial degree
+  int_t degree_;
+  /// estimate of the max eigenvalue of D^{-1}A
+  scalar_t lambda_max_;
+  /// estimate of the min eigenvalue of D^{-1}A
+  scalar_t lambda_min_;
+};
+
+#endif
+
+}// end global namespace
+
+}// End DICe Namespace
+
+#endif
@@ -43,6 +43,8 @@
 
 #include <Teuchos_Tuple.hpp>
 
+#include <algorithm>
+
 namespace DICe {
 namespace mesh {
 
@@ -320,6 +322,65 @@ Mesh::Mesh(const std::string & input_filename,
   node_set_ = Teuchos::rcp(new node_set);
 }
 
+void
+Mesh::create_topology(){
+  DEBUG_MSG("Mesh::create_topology(): creating the flat element to node topology");
+  topology_ = Teuchos::rcp(new Mesh_Topology(*this));
+}
+
+Mesh_Topology::Mesh_Topology(Mesh & mesh):
+  spatial_dimension_(mesh.spatial_dimension())
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(spatial_dimension_<=0,std::runtime_error,"Error, invalid spatial dimension");
+  // nodes are stored by overlap local id
+  const int_t num_nodes = mesh.get_node_set()->size();
+  node_global_ids_.assign(num_nodes,-1);
+  node_local_ids_.assign(num_nodes,-1);
+  node_coords_.assign(num_nodes*spatial_dimension_,0.0);
+  sorted_node_global_ids_.reserve(num_nodes);
+  sorted_node_overlap_ids_.reserve(num_nodes);
+  Teuchos::ArrayRCP<const scalar_t> coords = mesh.get_overlap_field(field_enums::INITIAL_COORDINATES_FS)->get_1d_view();
+  DICe::mesh::node_set::const_iterator node_it = mesh.get_node_set()->begin();
+  DICe::mesh::node_set::const_iterator node_end = mesh.get_node_set()->end();
+  for(;node_it!=node_end;++node_it){
+    const int_t overlap_id = node_it->second->overlap_local_id();
+    TEUCHOS_TEST_FOR_EXCEPTION(overlap_id<0||overlap_id>=num_nodes,std::runtime_error,
+      "Error, invalid overlap local id " << overlap_id << " for node " << node_it->first);
+    node_global_ids_[overlap_id] = node_it->first;
+    // the node set is ordered by global id
+    sorted_node_global_ids_.push_back(node_it->first);
+    sorted_node_overlap_ids_.push_back(overlap_id);
+    node_local_ids_[overlap_id] = node_it->second->local_id();
+    for(int_t dim=0;dim<spatial_dimension_;++dim)
+      node_coords_[overlap_id*spatial_dimension_+dim] = coords[overlap_id*spatial_dimension_+dim];
+  }
+  // compressed row element to node connectivity
+  const int_t num_elem = mesh.get_element_set()->size();
+  elem_node_offsets_.reserve(num_elem+1);
+  elem_global_ids_.reserve(num_elem);
+  elem_local_ids_.reserve(num_elem);
+  elem_block_ids_.reserve(num_elem);
+  elem_node_offsets_.push_back(0);
+  DICe::mesh::element_set::const_iterator elem_it = mesh.get_element_set()->begin();
+  DICe::mesh::element_set::const_iterator elem_end = mesh.get_element_set()->end();
+  for(;elem_it!=elem_end;++elem_it){
+    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    for(size_t nd=0;nd<connectivity.size();++nd)
+      elem_node_ids_.push_back(connectivity[nd]->overlap_local_id());
+    elem_node_offsets_.push_back(elem_node_ids_.size());
+    elem_global_ids_.push_back(elem_it->get()->global_id());
+    elem_local_ids_.push_back(elem_it->get()->local_id());
+    elem_block_ids_.push_back(elem_it->get()->block_id());
+  }
+}
+
+int_t
+Mesh_Topology::node_overlap_id(const int_t global_id)const{
+  std::vector<int_t>::const_iterator it = std::lower_bound(sorted_node_global_ids_.begin(),sorted_node_global_ids_.end(),global_id);
+  if(it==sorted_node_global_ids_.end()||*it!=global_id) return -1;
+  return sorted_node_overlap_ids_[it - sorted_node_global_ids_.begin()];
+}
+
 /// Create the field maps for the mixed formulation elements
 void
 Mesh::create_mixed_node_field_maps(Teuchos::RCP<Mesh> alt_mesh){
@@ -2124,6 +2185,8 @@ Teuchos::RCP<Mesh> create_point_or_tri_mesh(const DICe::mesh::Base_Element_Type
 
   // export the coordinates back to the non-overlap field
   mesh->field_overlap_export(initial_coords, field_enums::INITIAL_COORDINATES_FS, INSERT);
+  // build the flat element to node topology now that the maps and coordinates are set
+  mesh->create_topology();
   //std::cout << "INITIAL COORDS: " << std::endl;
   //initial_coords_ptr->vec()->describe();
 
@@ -2366,6 +2429,8 @@ Teuchos::RCP<Mesh> create_tri3_mesh_from_tri6(Teuchos::RCP<Mesh> tri6_mesh,
 
   // export the coordinates back to the non-overlap field
   mesh->field_overlap_export(initial_coords, field_enums::INITIAL_COORDINATES_FS, INSERT);
+  // build the flat element to node topology now that the maps and coordinates are set
+  mesh->create_topology();
   //std::cout << "INITIAL COORDS: " << std::endl;
   //initial_coords_ptr->vec()->describe();
 
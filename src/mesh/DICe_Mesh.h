@@ -82,6 +82,8 @@ class External_Face_Edge;
 class Internal_Cell;
 /// forward declaration
 class Mesh_Object;
+/// forward declaration
+class Mesh;
 /// typedef
 typedef std::set<int_t> ordinal_set;
 /// typedef
@@ -784,6 +786,132 @@ struct side_set_info
   }
 };
 
+/// \class Mesh_Topology
+/// \brief Flat, immutable view of the element to node connectivity and nodal coordinates.
+///
+/// The element to node connectivity is stored in compressed row form using the overlap
+/// local ids of the nodes, and the node data is stored in arrays indexed by overlap local id,
+/// so that element loops do not have to chase the reference counted node pointers.
+/// The topology is built once the mesh maps and initial coordinates are set.
+class
+DICE_LIB_DLL_EXPORT
+Mesh_Topology
+{
+public:
+  /// Constructor
+  /// \param mesh the mesh to build the topology for (must have the INITIAL_COORDINATES_FS field)
+  Mesh_Topology(Mesh & mesh);
+
+  /// Destructor
+  ~Mesh_Topology(){};
+
+  /// Returns the spatial dimension
+  int_t spatial_dimension()const{
+    return spatial_dimension_;
+  }
+
+  /// Returns the number of elements on this processor
+  int_t num_elem()const{
+    return elem_global_ids_.size();
+  }
+
+  /// Returns the number of nodes on this processor (including shared nodes)
+  int_t num_nodes()const{
+    return node_global_ids_.size();
+  }
+
+  /// Returns the number of nodes in an element
+  /// \param elem the element index
+  int_t num_elem_nodes(const int_t elem)const{
+    return elem_node_offsets_[elem+1] - elem_node_offsets_[elem];
+  }
+
+  /// Returns a pointer to the overlap local ids of the nodes of an element
+  /// \param elem the element index
+  const int_t * elem_nodes(const int_t elem)const{
+    return &elem_node_ids_[elem_node_offsets_[elem]];
+  }
+
+  /// Returns the global id of an element
+  /// \param elem the element index
+  int_t elem_global_id(const int_t elem)const{
+    return elem_global_ids_[elem];
+  }
+
+  /// Returns the local id of an element
+  /// \param elem the element index
+  int_t elem_local_id(const int_t elem)const{
+    return elem_local_ids_[elem];
+  }
+
+  /// Returns the block id of an element
+  /// \param elem the element index
+  int_t elem_block_id(const int_t elem)const{
+    return elem_block_ids_[elem];
+  }
+
+  /// Returns a pointer to the initial coordinates of a node
+  /// \param node the overlap local id of the node
+  const scalar_t * node_coords(const int_t node)const{
+    return &node_coords_[node*spatial_dimension_];
+  }
+
+  /// Returns the global id of a node
+  /// \param node the overlap local id of the node
+  int_t node_global_id(const int_t node)const{
+    return node_global_ids_[node];
+  }
+
+  /// Returns the local id of a node in the distributed map (-1 if the node is not owned by this processor)
+  /// \param node the overlap local id of the node
+  int_t node_local_id(const int_t node)const{
+    return node_local_ids_[node];
+  }
+
+  /// Returns the overlap local id of a node (-1 if the node is not on this processor)
+  /// \param global_id the global id of the node
+  int_t node_overlap_id(const int_t global_id)const;
+
+  /// Returns the compressed row offsets of the element to node connectivity
+  const std::vector<int_t> & elem_node_offsets()const{
+    return elem_node_offsets_;
+  }
+
+  /// Returns the overlap local ids of the element to node connectivity
+  const std::vector<int_t> & elem_node_ids()const{
+    return elem_node_ids_;
+  }
+
+  /// Returns the nodal coordinates ordered by overlap local id
+  const std::vector<scalar_t> & node_coords()const{
+    return node_coords_;
+  }
+
+private:
+  /// spatial dimension
+  int_t spatial_dimension_;
+  /// compressed row offsets into elem_node_ids_ for each element (size num_elem + 1)
+  std::vector<int_t> elem_node_offsets_;
+  /// overlap local ids of the nodes of each element
+  std::vector<int_t> elem_node_ids_;
+  /// global ids of the elements
+  std::vector<int_t> elem_global_ids_;
+  /// local ids of the elements
+  std::vector<int_t> elem_local_ids_;
+  /// block ids of the elements
+  std::vector<int_t> elem_block_ids_;
+  /// initial coordinates of the nodes ordered by overlap local id
+  std::vector<scalar_t> node_coords_;
+  /// global ids of the nodes ordered by overlap local id
+  std::vector<int_t> node_global_ids_;
+  /// distributed map local ids of the nodes ordered by overlap local id
+  std::vector<int_t> node_local_ids_;
+  /// global ids of the nodes in ascending order (for global to overlap id lookups)
+  std::vector<int_t> sorted_node_global_ids_;
+  /// overlap local ids of the nodes ordered by ascending global id
+  std::vector<int_t> sorted_node_overlap_ids_;
+};
+
 /// \class Mesh
 /// \brief The discretization used by the pysics classes.
 ///
@@ -1103,6 +1231,16 @@ public:
     return element_set_;
   }
 
+  /// Build the flat element to node topology (requires the node maps and initial coordinates)
+  void create_topology();
+
+  /// Returns a pointer to the flat element to node topology (built on first access if necessary)
+  Teuchos::RCP<const Mesh_Topology> get_topology(){
+    if(topology_==Teuchos::null)
+      create_topology();
+    return topology_;
+  }
+
   /// Returns a pointer to the subelements on this processor
   Teuchos::RCP<subelement_set> get_subelement_set(){
     return subelement_set_;
@@ -1457,6 +1595,8 @@ private:
   Teuchos::RCP<subelement_set> subelement_set_;
   /// The set of all nodes local to this processor
   Teuchos::RCP<node_set> node_set_;
+  /// Flat element to node topology
+  Teuchos::RCP<Mesh_Topology> topology_;
   /// The set of internal faces or edges local to this processor
   Teuchos::RCP<internal_cell_set> internal_cell_set_;
   /// The set of internal faces or edges local to this processor
@@ -702,6 +702,8 @@ read_exodus_coordinates(Teuchos::RCP<Mesh> mesh){
 
   // export the coordinates back to the non-overlap field
   mesh->field_overlap_export(initial_coords, field_enums::INITIAL_COORDINATES_FS, INSERT);
+  // build the flat element to node topology now that the maps and coordinates are set
+  mesh->create_topology();
   //std::cout << "INITIAL COORDS: " << std::endl;
   //initial_coords_ptr->vec()->describe();
 
@@ -802,37 +804,32 @@ void create_output_exodus_file(Teuchos::RCP<Mesh> mesh,
   float * y = new float[num_nodes];
   float * z = new float[num_nodes];
 
-  Teuchos::RCP<MultiField > coords = mesh->get_overlap_field(field_enums::INITIAL_COORDINATES_FS);
+  Teuchos::RCP<const Mesh_Topology> topology = mesh->get_topology();
 
   int_t * elem_map = new int_t[num_elem];
   int_t * node_map = new int_t[num_nodes];
 
-  DICe::mesh::node_set::const_iterator node_it = mesh->get_node_set()->begin();
-  DICe::mesh::node_set::const_iterator node_end = mesh->get_node_set()->end();
-  for(;node_it!=node_end;++node_it)
+  for(int_t local_id=0;local_id<topology->num_nodes();++local_id)
   {
-    const int_t local_id = node_it->second->overlap_local_id();
     if(use_model_coordinates){
       x[local_id] = model_x->local_value(local_id);
       y[local_id] = model_y->local_value(local_id);
       z[local_id] = model_z->local_value(local_id);
     }
     else{
-      x[local_id] = coords->local_value(local_id*spa_dim+0);
-      y[local_id] = coords->local_value(local_id*spa_dim+1);
+      const scalar_t * node_coords = topology->node_coords(local_id);
+      x[local_id] = node_coords[0];
+      y[local_id] = node_coords[1];
       if(spa_dim > 2)
-        z[local_id] = coords->local_value(local_id*spa_dim+2);
+        z[local_id] = node_coords[2];
       else
         z[local_id] = 0.0;
     }
-    node_map[local_id]=node_it->first;
+    node_map[local_id]=topology->node_global_id(local_id);
   }
-  DICe::mesh::element_set::const_iterator elem_it = mesh->get_element_set()->begin();
-  DICe::mesh::element_set::const_iterator elem_end = mesh->get_element_set()->end();
-  for(;elem_it!=elem_end;++elem_it)
+  for(int_t elem=0;elem<topology->num_elem();++elem)
   {
-    const int_t local_id = elem_it->get()->local_id();
-    elem_map[local_id]=elem_it->get()->global_id() + 1;
+    elem_map[topology->elem_local_id(elem)]=topology->elem_global_id(elem) + 1;
   }
   error_int = ex_put_coord(output_exoid, x, y, z);
   char * coord_names[3];
@@ -937,18 +934,16 @@ void create_output_exodus_file(Teuchos::RCP<Mesh> mesh,
     const int_t num_elem_in_block = mesh->num_elem_in_block(block_map_it->first);
     int_t conn_index = 0;
     int_t * block_connect = new int_t[num_elem_in_block * num_nodes_per_elem];
-    for(elem_it = mesh->get_element_set()->begin();elem_it!=elem_end;++elem_it)
+    for(int_t elem=0;elem<topology->num_elem();++elem)
     {
       // filter the elements that belong to this block
-      if(elem_it->get()->block_id()==block_map_it->first)
+      if(topology->elem_block_id(elem)==block_map_it->first)
       {
-        const connectivity_vector & connectivity = *elem_it->get()->connectivity();
-        for(size_t node_it = 0;node_it<connectivity.size();++node_it)
+        const int_t * elem_nodes = topology->elem_nodes(elem);
+        for(int_t node_it = 0;node_it<topology->num_elem_nodes(elem);++node_it)
         {
           const int_t stride = conn_index * num_nodes_per_elem + node_it;
-          const Teuchos::RCP<DICe::mesh::Node> node = connectivity[node_it];
-          const int_t local_node_id = node.get()->overlap_local_id();
-          block_connect[stride] = local_node_id + 1;  // connectivity is !ALWAYS! 1 based in exodus file
+          block_connect[stride] = elem_nodes[node_it] + 1;  // connectivity is !ALWAYS! 1 based in exodus file
         }
         conn_index++;
       }
@@ -979,11 +974,7 @@ void create_output_exodus_file(Teuchos::RCP<Mesh> mesh,
     int_t * dist_facts = new int_t[node_set_it->second.size()];
     for(size_t i=0;i<node_set_it->second.size();++i)
     {
-      for(int_t mapit=0;mapit<num_nodes;++mapit)
-      {
-        if(node_map[mapit]==node_set_it->second[i])
-          node_list[i] = mapit + 1;
-      }
+      node_list[i] = topology->node_overlap_id(node_set_it->second[i]) + 1; //ids are 1 based in exodus
       //node_list[i] =
       //node_list[i] = mesh->node_global_to_local_id(node_set_it->second[i]) + 1; //ids are 1 based in exodus
       dist_facts[i] = 0.0; // no dist factors stored or written to output
@@ -1113,18 +1104,19 @@ exodus_output_dump(Teuchos::RCP<Mesh> mesh,
     else if(field_it->first.get_rank()==field_enums::NODE_RANK)
     {
       Teuchos::RCP<MultiField > field = mesh->get_overlap_field(field_it->first);
-      float * values = new float[mesh->num_nodes()];
+      const int_t num_nodes = mesh->num_nodes();
+      float * values = new float[num_nodes];
       std::string components[3];
       components[0] = (field_it->first.get_field_type()==field_enums::VECTOR_FIELD_TYPE) ? "X" : "";
       components[1] = "Y";
       components[2] = "Z";
+      // the exodus node ordering is the overlap local id ordering
+      Teuchos::ArrayRCP<const scalar_t> field_values = field->get_1d_view();
       for (int_t comp = 0; comp < num_comps; ++comp)
       {
-        DICe::mesh::node_set::const_iterator node_it = mesh->get_node_set()->begin();
-        DICe::mesh::node_set::const_iterator node_end = mesh->get_node_set()->end();
-        for(;node_it!=node_end;++node_it)
+        for(int_t node=0;node<num_nodes;++node)
         {
-          values[node_it->second->overlap_local_id()] = field->local_value(node_it->second->overlap_local_id()*num_comps+comp);
+          values[node] = field_values[node*num_comps+comp];
         }
         const int_t var_index = get_var_index(mesh, DICe::tostring(field_it->first.get_name()), components[comp], field_it->first.get_rank());
         error_int = ex_put_nodal_var(mesh->get_output_exoid(), time_step_num, var_index,mesh->num_nodes(), values);
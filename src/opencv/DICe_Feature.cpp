@@ -46,6 +46,7 @@
 #include <opencv2/opencv.hpp>
 
 #include <cstdio>
+#include <algorithm>
 
 namespace DICe {
 
@@ -59,46 +60,120 @@ void match_features(Teuchos::RCP<Image> left_image,
   const float & feature_tol,
   const std::string & result_image_name,
   const int_t threshold_block_size){
+  Feature_Matcher matcher(threshold_block_size);
+  matcher.match(left_image,right_image,left_x,left_y,right_x,right_y,feature_tol,result_image_name);
+}
 
-  left_x.clear();
-  left_y.clear();
-  right_x.clear();
-  right_y.clear();
+Feature_Matcher::Feature_Matcher(const int_t threshold_block_size,
+  const int_t min_indexed_descriptors):
+  threshold_block_size_(threshold_block_size),
+  min_indexed_descriptors_(min_indexed_descriptors),
+  roi_min_x_(-1),
+  roi_min_y_(-1),
+  roi_max_x_(-1),
+  roi_max_y_(-1){
+}
 
-  DEBUG_MSG("match_features(): initializing OpenCV Mats");
-  unsigned char * left_array = new unsigned char[left_image->width()*left_image->height()];
-  unsigned char * right_array = new unsigned char[right_image->width()*right_image->height()];
-  opencv_8UC1(left_image,left_array);
-  opencv_8UC1(right_image,right_array);
-  cv::Mat img1 =   cv::Mat(left_image->height(),left_image->width(),CV_8U,left_array);
-  cv::Mat img2 =   cv::Mat(right_image->height(),right_image->width(),CV_8U,right_array);
-  const float nn_match_ratio = 0.6f;   // Nearest neighbor matching ratio
-  DEBUG_MSG("match_features(): detect and compute features");
+void
+Feature_Matcher::set_roi(const int_t min_x,
+  const int_t min_y,
+  const int_t max_x,
+  const int_t max_y){
+  TEUCHOS_TEST_FOR_EXCEPTION(max_x>=0&&(max_x<min_x||max_y<min_y),std::invalid_argument,"Error, invalid feature matching region of interest");
+  if(min_x==roi_min_x_&&min_y==roi_min_y_&&max_x==roi_max_x_&&max_y==roi_max_y_) return;
+  roi_min_x_ = min_x;
+  roi_min_y_ = min_y;
+  roi_max_x_ = max_x;
+  roi_max_y_ = max_y;
+  // the cached features were detected in a different region
+  clear();
+}
 
-  if(threshold_block_size>0){
-    DEBUG_MSG("match_features(): applying a pre-threshold to the image with block size " << threshold_block_size);
-    cv::equalizeHist(img1,img1);
-    cv::equalizeHist(img2,img2);
+Teuchos::RCP<Feature_Matcher::Image_Features>
+Feature_Matcher::features(const Teuchos::RCP<Image> & image,
+  const float & feature_tol){
+  for(size_t i=0;i<cache_.size();++i){
+    if(cache_[i]->image.get()==image.get()&&cache_[i]->feature_tol==feature_tol){
+      DEBUG_MSG("Feature_Matcher::features(): using cached features");
+      return cache_[i];
+    }
+  }
+  // only the features for the most recent images are kept
+  const size_t max_cached_images = 4;
+  if(cache_.size()>=max_cached_images)
+    cache_.erase(cache_.begin());
+  Teuchos::RCP<Image_Features> image_features = Teuchos::rcp(new Image_Features());
+  image_features->image = image;
+  image_features->feature_tol = feature_tol;
+  const int_t w = image->width();
+  const int_t h = image->height();
+  image_features->mat = cv::Mat(h,w,CV_8U);
+  opencv_8UC1(image,image_features->mat.ptr<unsigned char>(0));
+  if(threshold_block_size_>0){
+    DEBUG_MSG("Feature_Matcher::features(): applying a pre-threshold to the image with block size " << threshold_block_size_);
+    cv::equalizeHist(image_features->mat,image_features->mat);
     // the 1 represents ADAPTIVE_THRESH_GAUSSIAN, 0 is THRESH_BINARY
-    cv::adaptiveThreshold(img1,img1,255,1,0,threshold_block_size,2);
-    cv::adaptiveThreshold(img2,img2,255,1,0,threshold_block_size,2);
+    cv::adaptiveThreshold(image_features->mat,image_features->mat,255,1,0,threshold_block_size_,2);
   }
-
-  std::vector<cv::KeyPoint> kpts1, kpts2;
-  cv::Mat desc1, desc2;
+  // restrict the detection to the region of interest
+  cv::Mat mask;
+  if(roi_max_x_>=0){
+    const int_t x0 = std::max(roi_min_x_ - image->offset_x(),0);
+    const int_t y0 = std::max(roi_min_y_ - image->offset_y(),0);
+    const int_t x1 = std::min(roi_max_x_ - image->offset_x(),w-1);
+    const int_t y1 = std::min(roi_max_y_ - image->offset_y(),h-1);
+    mask = cv::Mat::zeros(h,w,CV_8U);
+    if(x1>=x0&&y1>=y0)
+      mask(cv::Rect(x0,y0,x1-x0+1,y1-y0+1)).setTo(cv::Scalar(255));
+  }
+  DEBUG_MSG("Feature_Matcher::features(): detect and compute features");
   cv::Ptr<cv::AKAZE> akaze = cv::AKAZE::create(cv::AKAZE::DESCRIPTOR_MLDB,0,3,feature_tol,4,4,cv::KAZE::DIFF_PM_G2);
-  akaze->detectAndCompute(img1, cv::noArray(), kpts1, desc1);
-  akaze->detectAndCompute(img2, cv::noArray(), kpts2, desc2);
+  // an empty mask means the whole image is used
+  akaze->detectAndCompute(image_features->mat, mask, image_features->keypoints, image_features->descriptors);
+  DEBUG_MSG("Feature_Matcher::features(): number of features " << image_features->keypoints.size());
+  cache_.push_back(image_features);
+  return image_features;
+}
+
+void
+Feature_Matcher::match(Teuchos::RCP<Image> left_image,
+  Teuchos::RCP<Image> right_image,
+  std::vector<scalar_t> & left_x,
+  std::vector<scalar_t> & left_y,
+  std::vector<scalar_t> & right_x,
+  std::vector<scalar_t> & right_y,
+  const float & feature_tol,
+  const std::string & result_image_name){
 
-  DEBUG_MSG("match_features(): matching features");
+  left_x.clear();
+  left_y.clear();
+  right_x.clear();
+  right_y.clear();
 
-  cv::BFMatcher matcher(cv::NORM_HAMMING);
+  Teuchos::RCP<Image_Features> left_features = features(left_image,feature_tol);
+  Teuchos::RCP<Image_Features> right_features = features(right_image,feature_tol);
+  const std::vector<cv::KeyPoint> & kpts1 = left_features->keypoints;
+  const std::vector<cv::KeyPoint> & kpts2 = right_features->keypoints;
+  const float nn_match_ratio = 0.6f;   // Nearest neighbor matching ratio
+
+  DEBUG_MSG("Feature_Matcher::match(): matching features");
   std::vector< std::vector<cv::DMatch> > nn_matches;
-  matcher.knnMatch(desc1, desc2, nn_matches, 2);
+  if(left_features->descriptors.rows>0&&right_features->descriptors.rows>1){
+    // the brute force search is faster for small sets of descriptors
+    if(min_indexed_descriptors_>=0&&right_features->descriptors.rows>=min_indexed_descriptors_){
+      // the MLDB descriptors are binary so a locality sensitive hash index is used
+      cv::FlannBasedMatcher matcher(cv::makePtr<cv::flann::LshIndexParams>(12,20,2));
+      matcher.knnMatch(left_features->descriptors, right_features->descriptors, nn_matches, 2);
+    }
+    else{
+      cv::BFMatcher matcher(cv::NORM_HAMMING);
+      matcher.knnMatch(left_features->descriptors, right_features->descriptors, nn_matches, 2);
+    }
+  }
 
-  DEBUG_MSG("match_features(): removing outliers");
+  DEBUG_MSG("Feature_Matcher::match(): removing outliers");
 
-  std::vector<cv::KeyPoint> matched1, matched2, inliers1, inliers2;
+  std::vector<cv::KeyPoint> inliers1, inliers2;
   std::vector<cv::DMatch> good_matches;
   for(size_t i = 0; i < nn_matches.size(); i++) {
     if(nn_matches[i].size()<2)continue;
@@ -106,19 +181,14 @@ void match_features(Teuchos::RCP<Image> left_image,
     float dist1 = nn_matches[i][0].distance;
     float dist2 = nn_matches[i][1].distance;
     if(dist1 < nn_match_ratio * dist2) {
-      matched1.push_back(kpts1[first.queryIdx]);
-      matched2.push_back(kpts2[first.trainIdx]);
+      int new_i = static_cast<int>(inliers1.size());
+      inliers1.push_back(kpts1[first.queryIdx]);
+      inliers2.push_back(kpts2[first.trainIdx]);
+      good_matches.push_back(cv::DMatch(new_i, new_i, 0));
     }
   }
-
-  for(unsigned i = 0; i < matched1.size(); i++) {
-    int new_i = static_cast<int>(inliers1.size());
-    inliers1.push_back(matched1[i]);
-    inliers2.push_back(matched2[i]);
-    good_matches.push_back(cv::DMatch(new_i, new_i, 0));
-  }
   assert(inliers1.size()==inliers2.size());
-  DEBUG_MSG("match_features(): number of features matched: " << inliers1.size());
+  DEBUG_MSG("Feature_Matcher::match(): number of features matched: " << inliers1.size());
   if(inliers1.size()==0)
     DEBUG_MSG("***Warning: no matching features matched");
   left_x.resize(inliers1.size(),0.0);
@@ -138,11 +208,9 @@ void match_features(Teuchos::RCP<Image> left_image,
   // draw results image if requested
   if(result_image_name!=""){
     cv::Mat res;
-    cv::drawMatches(img1, inliers1, img2, inliers2, good_matches, res);
+    cv::drawMatches(left_features->mat, inliers1, right_features->mat, inliers2, good_matches, res);
     cv::imwrite(result_image_name.c_str(), res);
   }
-
-  delete [] left_array;
 }
 
 void opencv_8UC1(Teuchos::RCP<Image> image, unsigned char * array){
@@ -47,8 +47,106 @@
 
 #include <Teuchos_RCP.hpp>
 
+#include <opencv2/features2d.hpp>
+
+#include <vector>
+
 namespace DICe {
 
+/// \class DICe::Feature_Matcher
+/// \brief Matches AKAZE features between pairs of images and keeps the keypoints and
+/// descriptors of the most recently used images so that an image that takes part in more
+/// than one match (the reference image, or the previous deformed image in a sequence) is
+/// only described once. Images are identified by their pointer, so an image should not
+/// be modified in place once it has been matched (call clear() if it is).
+class DICE_LIB_DLL_EXPORT
+Feature_Matcher{
+public:
+  /// constructor
+  /// \param threshold_block_size if positive, the images are equalized and adaptively thresholded with this block size before detection
+  /// \param min_indexed_descriptors an LSH index rather than a brute force search is used to match at least this many
+  /// descriptors (the index is approximate so the matches can differ from call to call, negative always uses brute force)
+  Feature_Matcher(const int_t threshold_block_size=-1,
+    const int_t min_indexed_descriptors=1000);
+
+  /// destructor
+  ~Feature_Matcher(){};
+
+  /// restrict the feature detection to a region of the images (in global image coordinates, includes the image offsets)
+  /// \param min_x left edge of the region
+  /// \param min_y top edge of the region
+  /// \param max_x right edge of the region
+  /// \param max_y bottom edge of the region
+  void set_roi(const int_t min_x,
+    const int_t min_y,
+    const int_t max_x,
+    const int_t max_y);
+
+  /// clear the cached features
+  void clear(){
+    cache_.clear();
+  }
+
+  /// number of images with cached features
+  int_t num_cached_images()const{
+    return cache_.size();
+  }
+
+  /// match features from one image to another
+  /// \param left_image pointer to the left image
+  /// \param right_image pointer to the right image
+  /// \param left_x [out] image x coordinates in the left image for features
+  /// \param left_y [out] image y coordinate in the left image for features
+  /// \param right_x [out] image x coordinates in the right image for features
+  /// \param right_y [out] image y coordinate in the right image for features
+  /// \param feature_tol tolerance to use for AKAZE features
+  /// \param result_image_name output an image showing the matched features with this filename
+  void match(Teuchos::RCP<Image> left_image,
+    Teuchos::RCP<Image> right_image,
+    std::vector<scalar_t> & left_x,
+    std::vector<scalar_t> & left_y,
+    std::vector<scalar_t> & right_x,
+    std::vector<scalar_t> & right_y,
+    const float & feature_tol=0.001f,
+    const std::string & result_image_name="");
+
+private:
+  /// keypoints and descriptors for one image
+  struct Image_Features{
+    /// the image the features were detected in (held so the pointer is not reused)
+    Teuchos::RCP<Image> image;
+    /// tolerance the features were detected with
+    float feature_tol;
+    /// 8 bit (and possibly thresholded) copy of the image used for the detection
+    cv::Mat mat;
+    /// feature locations
+    std::vector<cv::KeyPoint> keypoints;
+    /// feature descriptors
+    cv::Mat descriptors;
+  };
+
+  /// returns the features for an image, detecting them if they are not cached
+  /// \param image pointer to the image
+  /// \param feature_tol tolerance to use for AKAZE features
+  Teuchos::RCP<Image_Features> features(const Teuchos::RCP<Image> & image,
+    const float & feature_tol);
+
+  /// block size for the adaptive threshold
+  int_t threshold_block_size_;
+  /// minimum number of descriptors matched with the LSH index (negative means never)
+  int_t min_indexed_descriptors_;
+  /// region of interest extents (negative max_x means the whole image is used)
+  int_t roi_min_x_;
+  /// region of interest extents
+  int_t roi_min_y_;
+  /// region of interest extents
+  int_t roi_max_x_;
+  /// region of interest extents
+  int_t roi_max_y_;
+  /// features of the most recently matched images (oldest first)
+  std::vector<Teuchos::RCP<Image_Features> > cache_;
+};
+
 /// Free function to match features from one DICe image to another
 /// \param left_image pointer to the left image
 /// \param right_image pointer to the right image
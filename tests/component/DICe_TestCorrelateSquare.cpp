@@ -53,6 +53,7 @@
 
 #include <iostream>
 #include <cstdio>
+#include <cmath>
 
 #include <cassert>
 
@@ -163,6 +164,37 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   }
 
+  *outStream << "testing the same subsets with the reliability guided ordering" << std::endl;
+  Teuchos::RCP<Teuchos::ParameterList> reliability_params = rcp(new Teuchos::ParameterList());
+  reliability_params->setParameters(*params);
+  reliability_params->set(DICe::use_reliability_guided_ordering,true);
+  Teuchos::RCP<DICe::Schema> schemaReliability = Teuchos::rcp(new DICe::Schema(roi_w,roi_h,multiple_step_size_x,multiple_step_size_y,multiple_subset_size,reliability_params));
+  schemaReliability->set_ref_image("./images/refSpeckled.tif");
+  schemaReliability->set_def_image("./images/defSpeckled.tif");
+  schemaReliability->execute_correlation();
+  bool reliability_error = false;
+  for(int_t i=0;i<schemaReliability->local_num_subsets();++i){
+    const int_t gid = schemaReliability->subset_global_id(i);
+    const scalar_t disp_x = schemaReliability->global_field_value(gid,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS);
+    const scalar_t disp_y = schemaReliability->global_field_value(gid,DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS);
+    const scalar_t flag = schemaReliability->global_field_value(gid,DICe::field_enums::STATUS_FLAG_FS);
+    if(std::abs(disp_x - schemaMultiple->global_field_value(gid,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS)) > 1.0E-3 ||
+        std::abs(disp_y - schemaMultiple->global_field_value(gid,DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS)) > 1.0E-3){
+      *outStream << "subset " << gid << " reliability guided solution " << disp_x << " " << disp_y << " does not match the seed order solution" << std::endl;
+      reliability_error = true;
+    }
+    if(flag!=DICe::INITIALIZE_USING_PREVIOUS_FRAME_SUCCESSFUL&&flag!=DICe::INITIALIZE_USING_NEIGHBOR_VALUE_SUCCESSFUL) reliability_error = true;
+    // the neighbor used by the reliability guided ordering must not overwrite the user defined neighbor field
+    if(schemaReliability->global_field_value(gid,DICe::field_enums::NEIGHBOR_ID_FS)!=schemaMultiple->global_field_value(gid,DICe::field_enums::NEIGHBOR_ID_FS)){
+      *outStream << "subset " << gid << " neighbor id was modified by the reliability guided ordering" << std::endl;
+      reliability_error = true;
+    }
+  }
+  if(reliability_error){
+    *outStream << "---> POSSIBLE ERROR ABOVE! Error in the reliability guided solution." << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -48,6 +48,7 @@
 #include <Teuchos_ParameterList.hpp>
 
 #include <iostream>
+#include <algorithm>
 
 using namespace DICe;
 
@@ -168,6 +169,43 @@ int main(int argc, char *argv[]) {
   }
 #endif
 
+  *outStream << "testing the real input and paired image transforms against the complex transform" << std::endl;
+  const int_t fft_w = baboon->width();
+  const int_t fft_h = baboon->height();
+  Teuchos::ArrayRCP<scalar_t> complex_r(fft_w*fft_h,0.0), complex_i(fft_w*fft_h,0.0);
+  for(int_t y=0;y<fft_h;++y)
+    for(int_t x=0;x<fft_w;++x)
+      complex_r[y*fft_w+x] = (*baboon)(x,y);
+  array_2d_fft_in_place(fft_w,fft_h,complex_r,complex_i,0);
+  Teuchos::ArrayRCP<scalar_t> real_input_r, real_input_i;
+  image_fft(baboon,real_input_r,real_input_i,0,false);
+  Teuchos::ArrayRCP<scalar_t> pair_a_r, pair_a_i, pair_b_r, pair_b_i;
+  image_pair_fft(baboon,polar_baboon,pair_a_r,pair_a_i,pair_b_r,pair_b_i,false);
+  Teuchos::ArrayRCP<scalar_t> polar_r, polar_i;
+  image_fft(polar_baboon,polar_r,polar_i,0,false);
+  scalar_t max_real_input_diff = 0.0;
+  scalar_t max_pair_diff = 0.0;
+  scalar_t max_mag = 0.0;
+  for(int_t i=0;i<fft_w*fft_h;++i){
+    max_mag = std::max(max_mag,std::abs(complex_r[i]));
+    max_real_input_diff = std::max(max_real_input_diff,std::abs(real_input_r[i]-complex_r[i]));
+    max_real_input_diff = std::max(max_real_input_diff,std::abs(real_input_i[i]-complex_i[i]));
+    max_pair_diff = std::max(max_pair_diff,std::abs(pair_a_r[i]-complex_r[i]));
+    max_pair_diff = std::max(max_pair_diff,std::abs(pair_a_i[i]-complex_i[i]));
+    max_pair_diff = std::max(max_pair_diff,std::abs(pair_b_r[i]-polar_r[i]));
+    max_pair_diff = std::max(max_pair_diff,std::abs(pair_b_i[i]-polar_i[i]));
+  }
+  *outStream << "max real input fft diff: " << max_real_input_diff << " max paired fft diff: " << max_pair_diff << " max magnitude " << max_mag << std::endl;
+  // the transforms differ only by round off
+  if(max_real_input_diff > 1.0E-4*max_mag){
+    *outStream << "Error, the real input fft does not match the complex fft" << std::endl;
+    errorFlag++;
+  }
+  if(max_pair_diff > 1.0E-4*max_mag){
+    *outStream << "Error, the paired image fft does not match the individual image ffts" << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -155,6 +155,18 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   }
 
+  *outStream << "creating a sub-image of whole rows of its parent" << std::endl;
+  Teuchos::RCP<Image> band = Teuchos::rcp(new Image(img,0,100,img->width(),50));
+  bool band_match_error = false;
+  for(int_t y=0;y<band->height();++y)
+    for(int_t x=0;x<band->width();++x)
+      if((*band)(x,y)!=(*img)(x,y+100)||band->grad_x(x,y)!=img->grad_x(x,y+100))
+        band_match_error = true;
+  if(band_match_error){
+    *outStream << "Error, the sub-image values do not match the parent" << std::endl;
+    errorFlag++;
+  }
+
   // create an image from an array
   *outStream << "creating an image from an array" << std::endl;
   const int_t array_w = 30;
@@ -442,6 +454,356 @@ int main(int argc, char *argv[]) {
   }
   *outStream << "hierarchical image filter has been checked" << std::endl;
 
+  *outStream << "comparing the separable gauss filter to a full 2D convolution for a tall image" << std::endl;
+  // tall enough that the filter is applied in several bands of rows
+  const int_t band_w = 120;
+  const int_t band_h = 500;
+  // separate arrays since the images share the intensity array they are constructed with
+  Teuchos::ArrayRCP<intensity_t> band_intensities(band_w*band_h,0.0);
+  Teuchos::ArrayRCP<intensity_t> band_exact_intensities(band_w*band_h,0.0);
+  for(int_t y=0;y<band_h;++y){
+    for(int_t x=0;x<band_w;++x){
+      band_intensities[y*band_w+x] = (intensity_t)((x*37 + y*91 + (x*y)%13)%255);
+      band_exact_intensities[y*band_w+x] = band_intensities[y*band_w+x];
+    }
+  }
+  Image band_img(band_w,band_h,band_intensities);
+  Image band_exact(band_w,band_h,band_exact_intensities);
+  band_img.gauss_filter(7);
+  const scalar_t coeffs_7[] = {0.0060,0.0606,0.2418,0.3831,0.2418,0.0606,0.0060};
+  bool band_error = false;
+  for(int_t y=0;y<band_h;++y){
+    for(int_t x=0;x<band_w;++x){
+      scalar_t value = band_exact(x,y);
+      if(x>=4&&x<band_w-4&&y>=4&&y<band_h-4){
+        value = 0.0;
+        for(int_t j=0;j<7;++j)
+          for(int_t i=0;i<7;++i)
+            value += coeffs_7[i]*coeffs_7[j]*band_exact(x+i-3,y+j-3);
+      }
+      if(std::abs(band_img(x,y) - value) > 1.0E-2)
+        band_error = true;
+    }
+  }
+  if(band_error){
+    *outStream << "Error, the separable gauss filter does not match the 2D convolution" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "comparing the fused gauss filter and gradients to the separate steps" << std::endl;
+  Teuchos::ArrayRCP<intensity_t> band_fused_intensities(band_w*band_h,0.0);
+  for(int_t i=0;i<band_w*band_h;++i)
+    band_fused_intensities[i] = band_exact_intensities[i];
+  Image band_fused(band_w,band_h,band_fused_intensities);
+  band_fused.gauss_filter_and_compute_gradients(7);
+  band_img.compute_gradients();
+  if(!band_fused.has_gauss_filter()||!band_fused.has_gradients()){
+    *outStream << "Error, the fused image should be flagged as filtered with gradients" << std::endl;
+    errorFlag++;
+  }
+  bool fused_error = false;
+  for(int_t y=0;y<band_h;++y){
+    for(int_t x=0;x<band_w;++x){
+      if(std::abs(band_fused(x,y) - band_img(x,y)) > 1.0E-4
+          || std::abs(band_fused.grad_x(x,y) - band_img.grad_x(x,y)) > 1.0E-4
+          || std::abs(band_fused.grad_y(x,y) - band_img.grad_y(x,y)) > 1.0E-4)
+        fused_error = true;
+    }
+  }
+  if(fused_error){
+    *outStream << "Error, the fused gauss filter and gradients do not match the separate steps" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "checking the gradient storage type" << std::endl;
+#if DICE_FLOAT_GRADIENTS && !DICE_KOKKOS
+  const size_t expected_gradient_size = sizeof(float);
+#else
+  const size_t expected_gradient_size = sizeof(scalar_t);
+#endif
+  *outStream << "gradient storage size " << sizeof(gradient_t) << " bytes, scalar size " << sizeof(scalar_t) << " bytes" << std::endl;
+  if(sizeof(gradient_t)!=expected_gradient_size){
+    *outStream << "Error, the gradient storage type does not match the build configuration" << std::endl;
+    errorFlag++;
+  }
+  // the stored gradients only carry the storage precision, compare them to the stencil evaluated in double
+  scalar_t max_gradient_error = 0.0;
+  for(int_t y=2;y<band_h-2;++y){
+    for(int_t x=2;x<band_w-2;++x){
+      const double exact_gx = (1.0/12.0)*band_img(x-2,y) - (8.0/12.0)*band_img(x-1,y) + (8.0/12.0)*band_img(x+1,y) - (1.0/12.0)*band_img(x+2,y);
+      const double exact_gy = (1.0/12.0)*band_img(x,y-2) - (8.0/12.0)*band_img(x,y-1) + (8.0/12.0)*band_img(x,y+1) - (1.0/12.0)*band_img(x,y+2);
+      const scalar_t error_gx = std::abs(band_img.grad_x(x,y) - exact_gx)/(1.0 + std::abs(exact_gx));
+      const scalar_t error_gy = std::abs(band_img.grad_y(x,y) - exact_gy)/(1.0 + std::abs(exact_gy));
+      if(error_gx > max_gradient_error) max_gradient_error = error_gx;
+      if(error_gy > max_gradient_error) max_gradient_error = error_gy;
+    }
+  }
+  *outStream << "max relative gradient error: " << max_gradient_error << std::endl;
+  if(max_gradient_error > 1.0E-4){ // loose tolerance in case float is used vs. double
+    *outStream << "Error, the stored gradients are not accurate to the storage precision" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "preprocessing only a set of tiles of the image" << std::endl;
+  const int_t tile_size = 32;
+  const int_t tiles_x = (band_w + tile_size - 1)/tile_size;
+  const int_t tiles_y = (band_h + tile_size - 1)/tile_size;
+  std::vector<bool> active_tiles(tiles_x*tiles_y,false);
+  for(size_t i=0;i<active_tiles.size();i+=3)
+    active_tiles[i] = true;
+  Teuchos::ArrayRCP<intensity_t> band_tile_intensities(band_w*band_h,0.0);
+  for(int_t i=0;i<band_w*band_h;++i)
+    band_tile_intensities[i] = band_exact_intensities[i];
+  Image band_tiles(band_w,band_h,band_tile_intensities);
+  band_tiles.preprocess_tiles(tile_size,active_tiles,true,true,7);
+  bool tile_error = false;
+  for(int_t y=0;y<band_h;++y){
+    for(int_t x=0;x<band_w;++x){
+      if(active_tiles[(y/tile_size)*tiles_x + x/tile_size]){
+        if(std::abs(band_tiles(x,y) - band_img(x,y)) > 1.0E-4
+            || std::abs(band_tiles.grad_x(x,y) - band_img.grad_x(x,y)) > 1.0E-4
+            || std::abs(band_tiles.grad_y(x,y) - band_img.grad_y(x,y)) > 1.0E-4)
+          tile_error = true;
+      }
+      else if(band_tiles(x,y)!=band_exact(x,y)){
+        tile_error = true;
+      }
+    }
+  }
+  if(tile_error){
+    *outStream << "Error, the preprocessed tiles do not match the whole image result" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "preprocessing only a set of tiles of the image with the 5 point gradient smoothing" << std::endl;
+  Teuchos::RCP<Teuchos::ParameterList> smooth_params = Teuchos::rcp(new Teuchos::ParameterList());
+  smooth_params->set(DICe::gradient_method,DICe::CONVOLUTION_5_POINT);
+  Teuchos::ArrayRCP<intensity_t> band_smooth_intensities(band_w*band_h,0.0);
+  Teuchos::ArrayRCP<intensity_t> band_smooth_tile_intensities(band_w*band_h,0.0);
+  for(int_t i=0;i<band_w*band_h;++i){
+    band_smooth_intensities[i] = band_exact_intensities[i];
+    band_smooth_tile_intensities[i] = band_exact_intensities[i];
+  }
+  Image band_smooth(band_w,band_h,band_smooth_intensities,smooth_params);
+  band_smooth.gauss_filter(7);
+  band_smooth.compute_gradients();
+  Image band_smooth_tiles(band_w,band_h,band_smooth_tile_intensities,smooth_params);
+  band_smooth_tiles.preprocess_tiles(tile_size,active_tiles,true,true,7);
+  bool smooth_tile_error = false;
+  bool smooth_differs = false;
+  for(int_t y=0;y<band_h;++y){
+    for(int_t x=0;x<band_w;++x){
+      if(active_tiles[(y/tile_size)*tiles_x + x/tile_size]){
+        if(std::abs(band_smooth_tiles(x,y) - band_smooth(x,y)) > 1.0E-4
+            || std::abs(band_smooth_tiles.grad_x(x,y) - band_smooth.grad_x(x,y)) > 1.0E-4
+            || std::abs(band_smooth_tiles.grad_y(x,y) - band_smooth.grad_y(x,y)) > 1.0E-4)
+          smooth_tile_error = true;
+        if(std::abs(band_smooth.grad_x(x,y) - band_img.grad_x(x,y)) > 1.0E-2)
+          smooth_differs = true;
+      }
+      else if(band_smooth_tiles(x,y)!=band_exact(x,y)){
+        smooth_tile_error = true;
+      }
+    }
+  }
+  if(smooth_tile_error){
+    *outStream << "Error, the preprocessed tiles with the 5 point smoothing do not match the whole image result" << std::endl;
+    errorFlag++;
+  }
+  if(!smooth_differs){
+    *outStream << "Error, the 5 point smoothing should change the gradients" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "filtering and smoothing the gradients in the same banded pass" << std::endl;
+  // the image is tall enough to be split into several bands so the rows around the band boundaries are checked too
+  Teuchos::ArrayRCP<intensity_t> band_fused_intensities(band_w*band_h,0.0);
+  for(int_t i=0;i<band_w*band_h;++i)
+    band_fused_intensities[i] = band_exact_intensities[i];
+  Image band_fused(band_w,band_h,band_fused_intensities,smooth_params);
+  band_fused.gauss_filter_and_compute_gradients(7);
+  bool fused_smooth_error = false;
+  for(int_t y=0;y<band_h;++y){
+    for(int_t x=0;x<band_w;++x){
+      if(std::abs(band_fused(x,y) - band_smooth(x,y)) > 1.0E-4
+          || std::abs(band_fused.grad_x(x,y) - band_smooth.grad_x(x,y)) > 1.0E-4
+          || std::abs(band_fused.grad_y(x,y) - band_smooth.grad_y(x,y)) > 1.0E-4)
+        fused_smooth_error = true;
+    }
+  }
+  if(fused_smooth_error){
+    *outStream << "Error, the banded pass with the 5 point smoothing does not match filtering then smoothing the gradients" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "checking the image mean and normalization" << std::endl;
+  scalar_t band_sum = 0.0;
+  for(int_t i=0;i<band_w*band_h;++i)
+    band_sum += band_exact(i);
+  if(std::abs(band_exact.mean() - band_sum/(band_w*band_h)) > 1.0E-3){
+    *outStream << "Error, the image mean is not correct" << std::endl;
+    errorFlag++;
+  }
+  Teuchos::RCP<Image> band_normalized = band_exact.normalize();
+  // the normalization uses the pixels at least 10 from the edge
+  scalar_t norm_sum = 0.0;
+  scalar_t norm_sum_sq = 0.0;
+  for(int_t y=10;y<band_h-10;++y){
+    for(int_t x=10;x<band_w-10;++x){
+      norm_sum += (*band_normalized)(x,y);
+      norm_sum_sq += (*band_normalized)(x,y)*(*band_normalized)(x,y);
+    }
+  }
+  if(std::abs(norm_sum) > 1.0E-2||std::abs(norm_sum_sq - 1.0) > 1.0E-3){
+    *outStream << "Error, the normalized image should have zero mean and unit norm, sum " << norm_sum << " norm " << norm_sum_sq << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "checking the block sum image diff" << std::endl;
+  Teuchos::ArrayRCP<intensity_t> band_copy_intensities(band_w*band_h,0.0);
+  Teuchos::ArrayRCP<intensity_t> band_shifted_intensities(band_w*band_h,0.0);
+  for(int_t i=0;i<band_w*band_h;++i){
+    band_copy_intensities[i] = band_exact(i);
+    band_shifted_intensities[i] = band_exact(i) + 2.0;
+  }
+  Teuchos::RCP<Image> band_copy = Teuchos::rcp(new Image(band_w,band_h,band_copy_intensities));
+  Teuchos::RCP<Image> band_shifted = Teuchos::rcp(new Image(band_w,band_h,band_shifted_intensities));
+  const scalar_t full_diff = band_shifted->diff(band_copy);
+  if(std::abs(band_shifted->block_diff(band_copy) - full_diff) > 1.0E-4*full_diff){
+    *outStream << "Error, the block diff with a block size of 1 should match the image diff" << std::endl;
+    errorFlag++;
+  }
+  // a uniform shift gives the same result for any block size that divides the region evenly
+  const int_t diff_border = 6;
+  const scalar_t shift_diff = 2.0*std::sqrt((scalar_t)((band_w-2*diff_border)*(band_h-2*diff_border)));
+  const scalar_t pixel_block_diff = band_shifted->block_diff(band_copy,diff_border,1);
+  const scalar_t block_4_diff = band_shifted->block_diff(band_copy,diff_border,4);
+  *outStream << "block diff with block size 1: " << pixel_block_diff << " block size 4: " << block_4_diff << " expected: " << shift_diff << std::endl;
+  if(std::abs(pixel_block_diff - shift_diff) > 1.0E-3*shift_diff||std::abs(block_4_diff - shift_diff) > 1.0E-3*shift_diff){
+    *outStream << "Error, the block diff is not correct for a uniform shift" << std::endl;
+    errorFlag++;
+  }
+  if(band_shifted->block_diff(band_shifted,diff_border,4)!=0.0){
+    *outStream << "Error, the block diff of an image with itself should be zero" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "creating an image with a Gaussian pyramid" << std::endl;
+  Teuchos::RCP<Teuchos::ParameterList> pyramid_params = rcp(new Teuchos::ParameterList());
+  pyramid_params->set(DICe::num_image_pyramid_levels,3);
+  Image pyramid_img("./images/ImageB.tif",pyramid_params);
+  if(pyramid_img.num_pyramid_levels()!=3){
+    *outStream << "Error, the image should have 3 pyramid levels, has " << pyramid_img.num_pyramid_levels() << std::endl;
+    errorFlag++;
+  }
+  else{
+    int_t level_width = pyramid_img.width();
+    int_t level_height = pyramid_img.height();
+    for(int_t level=1;level<pyramid_img.num_pyramid_levels();++level){
+      level_width /= 2;
+      level_height /= 2;
+      Teuchos::RCP<Image> level_img = pyramid_img.pyramid_level(level);
+      if(level_img->width()!=level_width||level_img->height()!=level_height){
+        *outStream << "Error, pyramid level " << level << " has the wrong dimensions" << std::endl;
+        errorFlag++;
+      }
+      // low pass filtering and decimation should not change the average intensity much
+      if(std::abs(level_img->mean()-pyramid_img.mean()) > 0.05*pyramid_img.mean()){
+        *outStream << "Error, pyramid level " << level << " mean " << level_img->mean() << " does not match the image mean " << pyramid_img.mean() << std::endl;
+        errorFlag++;
+      }
+    }
+  }
+  // the coarse levels are built from the unmasked intensities so masking the image has to drop them
+  DICe::multi_shape pyramid_boundary;
+  pyramid_boundary.push_back(Teuchos::rcp(new DICe::Rectangle(pyramid_img.width()/2,pyramid_img.height()/2,pyramid_img.width()/2,pyramid_img.height()/2)));
+  DICe::Conformal_Area_Def pyramid_area_def(pyramid_boundary);
+  pyramid_img.apply_mask(pyramid_area_def,false);
+  if(pyramid_img.num_pyramid_levels()!=1){
+    *outStream << "Error, applying a mask should clear the pyramid, " << pyramid_img.num_pyramid_levels() << " levels remain" << std::endl;
+    errorFlag++;
+  }
+  *outStream << "image pyramid has been checked" << std::endl;
+
+  *outStream << "checking the native depth intensity storage" << std::endl;
+  Teuchos::RCP<Teuchos::ParameterList> native_params = rcp(new Teuchos::ParameterList());
+  native_params->set(DICe::compute_image_gradients,true);
+  Teuchos::RCP<Image> native_img = Teuchos::rcp(new Image("./images/ImageB.tif",native_params));
+  *outStream << "native depth of the unfiltered image: " << native_img->native_depth() << std::endl;
+#if DICE_KOKKOS
+  if(native_img->native_depth()!=0){
+#else
+  if(native_img->native_depth()!=8&&native_img->native_depth()!=16){
+#endif
+    *outStream << "Error, the unfiltered image was not stored at the expected depth" << std::endl;
+    errorFlag++;
+  }
+  const int_t native_w = native_img->width();
+  const int_t native_h = native_img->height();
+  Teuchos::ArrayRCP<intensity_t> working_intensities(native_w*native_h,0.0);
+  for(int_t i=0;i<native_w*native_h;++i)
+    working_intensities[i] = (*native_img)(i);
+  Teuchos::RCP<Image> working_img = Teuchos::rcp(new Image(native_w,native_h,working_intensities,native_params));
+  if(working_img->native_depth()!=0){
+    *outStream << "Error, an image created from an array should keep the intensity type" << std::endl;
+    errorFlag++;
+  }
+  // the values are widened before any arithmetic so the interpolants have to match exactly
+  bool native_error = false;
+  intensity_t native_intens = 0.0, working_intens = 0.0;
+  scalar_t native_gx = 0.0, native_gy = 0.0, working_gx = 0.0, working_gy = 0.0;
+  for(scalar_t y=0.25;y<native_h;y+=7.37){
+    for(scalar_t x=0.25;x<native_w;x+=5.51){
+      if(native_img->interpolate_bilinear(x,y)!=working_img->interpolate_bilinear(x,y)
+          || native_img->interpolate_bicubic(x,y)!=working_img->interpolate_bicubic(x,y)
+          || native_img->interpolate_keys_fourth(x,y)!=working_img->interpolate_keys_fourth(x,y))
+        native_error = true;
+      native_img->interpolate_bicubic_all(native_intens,native_gx,native_gy,true,x,y);
+      working_img->interpolate_bicubic_all(working_intens,working_gx,working_gy,true,x,y);
+      if(native_intens!=working_intens||native_gx!=working_gx||native_gy!=working_gy)
+        native_error = true;
+    }
+  }
+  if(native_error){
+    *outStream << "Error, the native depth image does not interpolate the same as the working copy" << std::endl;
+    errorFlag++;
+  }
+  // sub images and modified images use the working copy
+  Teuchos::RCP<Image> native_sub = Teuchos::rcp(new Image(native_img,10,20,100,50));
+  bool native_sub_error = native_sub->native_depth()!=0;
+  for(int_t y=0;y<50;++y)
+    for(int_t x=0;x<100;++x)
+      if((*native_sub)(x,y)!=(*working_img)(x+10,y+20)) native_sub_error = true;
+  if(native_sub_error){
+    *outStream << "Error, the sub image of a native depth image has the wrong intensities" << std::endl;
+    errorFlag++;
+  }
+  Teuchos::ArrayRCP<intensity_t> released_intensities = native_img->intensities();
+  if(native_img->native_depth()!=0||native_img->diff(working_img)!=0.0){
+    *outStream << "Error, requesting the intensity array should convert the image to the intensity type" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "checking the interleaved channels keep the intensity precision" << std::endl;
+  // values that are not exact in float so the check fails if the channels are stored with a lower precision
+  for(int_t i=0;i<native_w*native_h;++i)
+    working_intensities[i] /= 3.0;
+  working_img->replace_intensities(working_intensities);
+  working_img->create_interleaved_channels();
+  bool channel_error = false;
+  intensity_t fused_intens = 0.0;
+  scalar_t fused_gx = 0.0, fused_gy = 0.0;
+  for(int_t y=2;y<native_h-3;y+=11){
+    for(int_t x=2;x<native_w-3;x+=13){
+      working_img->interpolate_bicubic_fused(fused_intens,fused_gx,fused_gy,x,y);
+      if(fused_intens!=(*working_img)(x,y)) channel_error = true;
+    }
+  }
+  if(channel_error){
+    *outStream << "Error, the fused interpolant does not return the stored intensities at the pixel centers" << std::endl;
+    errorFlag++;
+  }
+
   // create an image from jpeg file:
   *outStream << "creating an image from a jpeg file " << std::endl;
   Teuchos::RCP<Image> img_jpg = Teuchos::rcp(new Image("./images/ImageB.jpg"));
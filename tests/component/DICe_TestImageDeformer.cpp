@@ -49,6 +49,8 @@
 #include <Teuchos_ParameterList.hpp>
 
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 using namespace DICe;
 
@@ -82,6 +84,45 @@ int main(int argc, char *argv[]) {
   def_img->write("sincos_def.tif");
 #endif
 
+  *outStream << "comparing the row evaluation of the deformation to the point evaluation" << std::endl;
+  std::vector<Teuchos::RCP<Image_Deformer> > deformers;
+  deformers.push_back(Teuchos::rcp(new SinCos_Image_Deformer(37.0,1.5)));
+  deformers.push_back(Teuchos::rcp(new DICChallenge14_Image_Deformer()));
+  deformers.push_back(Teuchos::rcp(new ConstantValue_Image_Deformer(0.25,-0.75)));
+  const int_t row_pts = 150;
+  std::vector<scalar_t> row_bx(row_pts,0.0);
+  std::vector<scalar_t> row_by(row_pts,0.0);
+  for(size_t d=0;d<deformers.size();++d){
+    const scalar_t row_x = 20.5;
+    const scalar_t row_y = 33.5;
+    deformers[d]->compute_deformation_row(row_x,row_y,row_pts,&row_bx[0],&row_by[0]);
+    for(int_t i=0;i<row_pts;++i){
+      scalar_t bx = 0.0, by = 0.0;
+      deformers[d]->compute_deformation(row_x+i,row_y,bx,by);
+      if(std::abs(bx-row_bx[i])>1.0E-5||std::abs(by-row_by[i])>1.0E-5){
+        *outStream << "Error, the row deformation does not match the point deformation for deformer " << d << " point " << i << std::endl;
+        errorFlag++;
+        break;
+      }
+    }
+  }
+
+  *outStream << "checking the synthetic speckle image" << std::endl;
+  const scalar_t speckle_size = 5.0;
+  Teuchos::RCP<Image> speckle_img = create_synthetic_speckle_image(64,48,10,20,speckle_size);
+  const scalar_t gamma = DICE_TWOPI/(2.0*speckle_size);
+  bool speckle_error = false;
+  for(int_t y=0;y<speckle_img->height();++y){
+    for(int_t x=0;x<speckle_img->width();++x){
+      const scalar_t exact = 127.5 + 127.5*std::cos(gamma*(x+10))*std::cos(gamma*(y+20));
+      if(std::abs((*speckle_img)(x,y)-exact)>1.0E-3) speckle_error = true;
+    }
+  }
+  if(speckle_error){
+    *outStream << "Error, the synthetic speckle image intensities are not correct" << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
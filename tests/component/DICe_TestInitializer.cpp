@@ -56,10 +56,47 @@
 #include <iostream>
 #include <fstream>
 #include <cassert>
+#include <cmath>
 
 using namespace DICe;
 using namespace DICe::field_enums;
 
+/// pattern with several frequencies (enough texture for phase correlation)
+scalar_t textured_pattern(const scalar_t & x,
+  const scalar_t & y){
+  return 128.0 + 30.0*std::sin(0.71*x + 0.23*y) + 25.0*std::cos(0.37*x - 0.61*y)
+    + 20.0*std::sin(1.13*x)*std::cos(0.89*y) + 15.0*std::cos(0.17*x + 1.31*y);
+}
+
+/// pattern with only low frequencies (the gradients hold over several pixels for optical flow)
+scalar_t smooth_pattern(const scalar_t & x,
+  const scalar_t & y){
+  return 128.0 + 40.0*std::sin(0.13*x + 0.07*y) + 30.0*std::cos(0.09*x - 0.15*y);
+}
+
+/// fill a square reference and deformed image from the given pattern, the pixels left of split_x are
+/// shifted by (left_u,left_v) in the deformed image and the rest by (right_u,right_v)
+void create_shifted_images(const int_t img_dim,
+  scalar_t (*pattern)(const scalar_t &, const scalar_t &),
+  const int_t split_x,
+  const scalar_t & left_u,
+  const scalar_t & left_v,
+  const scalar_t & right_u,
+  const scalar_t & right_v,
+  Teuchos::ArrayRCP<intensity_t> & ref_intensities,
+  Teuchos::ArrayRCP<intensity_t> & def_intensities){
+  ref_intensities = Teuchos::ArrayRCP<intensity_t>(img_dim*img_dim,0.0);
+  def_intensities = Teuchos::ArrayRCP<intensity_t>(img_dim*img_dim,0.0);
+  for(int_t y=0;y<img_dim;++y){
+    for(int_t x=0;x<img_dim;++x){
+      const scalar_t u = x < split_x ? left_u : right_u;
+      const scalar_t v = x < split_x ? left_v : right_v;
+      ref_intensities[y*img_dim+x] = pattern(x,y);
+      def_intensities[y*img_dim+x] = pattern(x-u,y-v);
+    }
+  }
+}
+
 int main(int argc, char *argv[]) {
 
   DICe::initialize(argc, argv);
@@ -256,6 +293,295 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  *outStream << "testing the local phase correlation initializer with two regions that move differently" << std::endl;
+  {
+    const int_t img_dim = 200;
+    const scalar_t left_u = 6.0, left_v = -4.0;
+    const scalar_t right_u = -5.0, right_v = 3.0;
+    // the left half of the image moves one way and the right half the other
+    Teuchos::ArrayRCP<intensity_t> ref_intensities;
+    Teuchos::ArrayRCP<intensity_t> def_intensities;
+    create_shifted_images(img_dim,textured_pattern,img_dim/2,left_u,left_v,right_u,right_v,ref_intensities,def_intensities);
+    Teuchos::ArrayRCP<scalar_t> local_coords_x(2,0.0);
+    Teuchos::ArrayRCP<scalar_t> local_coords_y(2,0.0);
+    local_coords_x[0] = 50; local_coords_y[0] = 100;
+    local_coords_x[1] = 150; local_coords_y[1] = 100;
+    Teuchos::RCP<Teuchos::ParameterList> local_params = Teuchos::rcp(new Teuchos::ParameterList());
+    local_params->set(DICe::initialization_method,USE_LOCAL_PHASE_CORRELATION);
+    Teuchos::RCP<DICe::Schema> local_schema = Teuchos::rcp(new DICe::Schema(local_coords_x,local_coords_y,31,Teuchos::null,Teuchos::null,local_params));
+    local_schema->set_ref_image(img_dim,img_dim,ref_intensities);
+    local_schema->set_def_image(img_dim,img_dim,def_intensities);
+    for(int_t i=0;i<local_schema->local_num_subsets();++i){
+      local_schema->local_field_value(i,SUBSET_COORDINATES_X_FS) = local_coords_x[i];
+      local_schema->local_field_value(i,SUBSET_COORDINATES_Y_FS) = local_coords_y[i];
+    }
+    Local_Phase_Correlation_Initializer local_initializer(local_schema.getRawPtr());
+    local_initializer.pre_execution_tasks();
+    Teuchos::RCP<Local_Shape_Function> local_sf = shape_function_factory(local_schema.getRawPtr());
+    for(int_t i=0;i<local_schema->local_num_subsets();++i){
+      const int_t gid = local_schema->subset_global_id(i);
+      local_sf->clear();
+      local_initializer.initial_guess(gid,local_sf);
+      scalar_t out_u = 0.0, out_v = 0.0, out_t = 0.0;
+      local_sf->map_to_u_v_theta(local_coords_x[i],local_coords_y[i],out_u,out_v,out_t);
+      const scalar_t exact_u = local_coords_x[i] < img_dim/2 ? left_u : right_u;
+      const scalar_t exact_v = local_coords_x[i] < img_dim/2 ? left_v : right_v;
+      *outStream << "subset " << gid << " local phase correlation u: " << out_u << " v: " << out_v << std::endl;
+      if(std::abs(out_u-exact_u) > 0.25 || std::abs(out_v-exact_v) > 0.25){
+        *outStream << "Error, the local phase correlation shift is not correct, should be " << exact_u << "," << exact_v << std::endl;
+        errorFlag++;
+      }
+    }
+  }
+  *outStream << "local phase correlation initializer has been checked" << std::endl;
+
+  *outStream << "testing the predictor initializer" << std::endl;
+  {
+    // a row of subsets with a displacement that is quadratic in time and linear in space
+    const int_t num_pred_subsets = 5;
+    Teuchos::ArrayRCP<scalar_t> pred_coords_x(num_pred_subsets,0.0);
+    Teuchos::ArrayRCP<scalar_t> pred_coords_y(num_pred_subsets,0.0);
+    for(int_t i=0;i<num_pred_subsets;++i){
+      pred_coords_x[i] = 30.0 + 20.0*i;
+      pred_coords_y[i] = 50.0;
+    }
+    Teuchos::RCP<DICe::Schema> pred_schema = Teuchos::rcp(new DICe::Schema(pred_coords_x,pred_coords_y,15,Teuchos::null,Teuchos::null,Teuchos::null));
+    for(int_t i=0;i<num_pred_subsets;++i){
+      pred_schema->local_field_value(i,SUBSET_COORDINATES_X_FS) = pred_coords_x[i];
+      pred_schema->local_field_value(i,SUBSET_COORDINATES_Y_FS) = pred_coords_y[i];
+    }
+    Predictor_Initializer pred_initializer(pred_schema.getRawPtr());
+    // push three frames of converged values into the initializer's history
+    for(int_t frame=1;frame<=3;++frame){
+      for(int_t i=0;i<num_pred_subsets;++i){
+        pred_schema->local_field_value(i,SUBSET_DISPLACEMENT_X_FS) = 0.5*frame*frame + 0.01*pred_coords_x[i];
+        pred_schema->local_field_value(i,SUBSET_DISPLACEMENT_Y_FS) = -0.25*frame*frame;
+        pred_schema->local_field_value(i,SIGMA_FS) = 1.0;
+      }
+      pred_initializer.pre_execution_tasks();
+    }
+    Teuchos::RCP<Local_Shape_Function> pred_sf = shape_function_factory(pred_schema.getRawPtr());
+    // the first subset has no converged neighbors yet so the guess is the temporal extrapolation
+    scalar_t out_u = 0.0, out_v = 0.0, out_t = 0.0;
+    pred_sf->clear();
+    pred_initializer.initial_guess(pred_schema->subset_global_id(0),pred_sf);
+    pred_sf->map_to_u_v_theta(pred_coords_x[0],pred_coords_y[0],out_u,out_v,out_t);
+    *outStream << "temporal prediction u: " << out_u << " v: " << out_v << std::endl;
+    if(std::abs(out_u-(8.0 + 0.01*pred_coords_x[0])) > 1.0E-4 || std::abs(out_v+4.0) > 1.0E-4){
+      *outStream << "Error, the temporal prediction is not correct" << std::endl;
+      errorFlag++;
+    }
+    // the first subset converges to a value that is off from the prediction, the next subset
+    // should pick up the same correction from its neighbor
+    pred_schema->local_field_value(0,SUBSET_DISPLACEMENT_X_FS) = 8.0 + 0.01*pred_coords_x[0] + 1.5;
+    pred_schema->local_field_value(0,SUBSET_DISPLACEMENT_Y_FS) = -4.0 - 0.5;
+    pred_sf->clear();
+    pred_initializer.initial_guess(pred_schema->subset_global_id(1),pred_sf);
+    pred_sf->map_to_u_v_theta(pred_coords_x[1],pred_coords_y[1],out_u,out_v,out_t);
+    *outStream << "spatio-temporal prediction u: " << out_u << " v: " << out_v << std::endl;
+    if(std::abs(out_u-(8.0 + 0.01*pred_coords_x[1] + 1.5)) > 1.0E-4 || std::abs(out_v+4.5) > 1.0E-4){
+      *outStream << "Error, the spatio-temporal prediction is not correct" << std::endl;
+      errorFlag++;
+    }
+  }
+  *outStream << "predictor initializer has been checked" << std::endl;
+
+  *outStream << "testing the predictor initializer in the tracking routine" << std::endl;
+  {
+    // in the tracking routine all the subsets share the same predictor, its history must
+    // only advance once per frame (not once per subset) for the extrapolation to hold
+    const int_t img_dim = 200;
+    const int_t num_track_subsets = 5;
+    Teuchos::ArrayRCP<intensity_t> ref_intensities;
+    Teuchos::ArrayRCP<intensity_t> def_intensities;
+    create_shifted_images(img_dim,textured_pattern,img_dim,0.0,0.0,0.0,0.0,ref_intensities,def_intensities);
+    Teuchos::ArrayRCP<scalar_t> track_coords_x(num_track_subsets,0.0);
+    Teuchos::ArrayRCP<scalar_t> track_coords_y(num_track_subsets,0.0);
+    for(int_t i=0;i<num_track_subsets;++i){
+      track_coords_x[i] = 60.0 + 20.0*i;
+      track_coords_y[i] = 100.0;
+    }
+    Teuchos::RCP<Teuchos::ParameterList> track_params = Teuchos::rcp(new Teuchos::ParameterList());
+    track_params->set(DICe::correlation_routine,TRACKING_ROUTINE);
+    track_params->set(DICe::initialization_method,USE_PREDICTOR);
+    // the recorded values are the initial guesses
+    track_params->set(DICe::skip_all_solves,true);
+    Teuchos::RCP<DICe::Schema> track_schema = Teuchos::rcp(new DICe::Schema(track_coords_x,track_coords_y,15,Teuchos::null,Teuchos::null,track_params));
+    track_schema->set_ref_image(img_dim,img_dim,ref_intensities);
+    for(int_t i=0;i<num_track_subsets;++i){
+      track_schema->local_field_value(i,SUBSET_COORDINATES_X_FS) = track_coords_x[i];
+      track_schema->local_field_value(i,SUBSET_COORDINATES_Y_FS) = track_coords_y[i];
+    }
+    // before each frame the fields hold the converged values of the previous frame (quadratic in time)
+    for(int_t frame=1;frame<=3;++frame){
+      for(int_t i=0;i<num_track_subsets;++i){
+        track_schema->local_field_value(i,SUBSET_DISPLACEMENT_X_FS) = 0.5*frame*frame + 0.01*track_coords_x[i];
+        track_schema->local_field_value(i,SUBSET_DISPLACEMENT_Y_FS) = -0.25*frame*frame;
+        track_schema->local_field_value(i,ROTATION_Z_FS) = 0.0;
+        track_schema->local_field_value(i,SIGMA_FS) = 1.0;
+      }
+      track_schema->set_def_image(img_dim,img_dim,def_intensities);
+      track_schema->execute_correlation();
+    }
+    // after three frames of history the guesses are the quadratic extrapolation to the fourth frame
+    for(int_t i=0;i<num_track_subsets;++i){
+      const scalar_t u = track_schema->local_field_value(i,SUBSET_DISPLACEMENT_X_FS);
+      const scalar_t v = track_schema->local_field_value(i,SUBSET_DISPLACEMENT_Y_FS);
+      *outStream << "subset " << i << " tracking prediction u: " << u << " v: " << v << std::endl;
+      if(std::abs(u-(8.0 + 0.01*track_coords_x[i])) > 1.0E-4 || std::abs(v+4.0) > 1.0E-4){
+        *outStream << "Error, the tracking routine prediction is not correct" << std::endl;
+        errorFlag++;
+      }
+    }
+  }
+  *outStream << "predictor initializer in the tracking routine has been checked" << std::endl;
+
+  *outStream << "testing the motion model initializer" << std::endl;
+  {
+    // a single subset with a constant acceleration
+    Teuchos::ArrayRCP<scalar_t> model_coords_x(1,50.0);
+    Teuchos::ArrayRCP<scalar_t> model_coords_y(1,50.0);
+    Teuchos::RCP<DICe::Schema> model_schema = Teuchos::rcp(new DICe::Schema(model_coords_x,model_coords_y,15,Teuchos::null,Teuchos::null,Teuchos::null));
+    model_schema->local_field_value(0,SUBSET_COORDINATES_X_FS) = model_coords_x[0];
+    model_schema->local_field_value(0,SUBSET_COORDINATES_Y_FS) = model_coords_y[0];
+    Motion_Model_Initializer model_initializer(model_schema.getRawPtr());
+    for(int_t frame=1;frame<=5;++frame){
+      model_schema->local_field_value(0,SUBSET_DISPLACEMENT_X_FS) = frame*frame;
+      model_schema->local_field_value(0,SUBSET_DISPLACEMENT_Y_FS) = -0.5*frame*frame;
+      model_schema->local_field_value(0,ROTATION_Z_FS) = 0.0;
+      model_schema->local_field_value(0,SIGMA_FS) = 1.0;
+      model_initializer.pre_execution_tasks();
+    }
+    const int_t model_gid = model_schema->subset_global_id(0);
+    scalar_t motion[3];
+    scalar_t std_dev[3];
+    if(!model_initializer.prediction(model_gid,motion,std_dev)){
+      *outStream << "Error, the motion model should have a prediction" << std::endl;
+      errorFlag++;
+    }
+    *outStream << "motion model prediction u: " << motion[0] << " v: " << motion[1] << " std dev: " << std_dev[0] << std::endl;
+    if(std::abs(motion[0]-36.0) > 0.05 || std::abs(motion[1]+18.0) > 0.05 || std_dev[0] > 0.5){
+      *outStream << "Error, the motion model prediction is not correct" << std::endl;
+      errorFlag++;
+    }
+    Teuchos::RCP<Local_Shape_Function> model_sf = shape_function_factory(model_schema.getRawPtr());
+    model_sf->clear();
+    model_initializer.initial_guess(model_gid,model_sf);
+    scalar_t out_u = 0.0, out_v = 0.0, out_t = 0.0;
+    model_sf->map_to_u_v_theta(model_coords_x[0],model_coords_y[0],out_u,out_v,out_t);
+    if(std::abs(out_u-motion[0]) > 1.0E-4 || std::abs(out_v-motion[1]) > 1.0E-4){
+      *outStream << "Error, the motion model initial guess does not match the prediction" << std::endl;
+      errorFlag++;
+    }
+    // a failed frame coasts on the prediction
+    model_schema->local_field_value(0,SIGMA_FS) = -1.0;
+    model_initializer.pre_execution_tasks();
+    model_initializer.prediction(model_gid,motion,std_dev);
+    *outStream << "motion model coasting prediction u: " << motion[0] << " v: " << motion[1] << std::endl;
+    if(std::abs(motion[0]-49.0) > 0.1 || std::abs(motion[1]+24.5) > 0.1){
+      *outStream << "Error, the motion model coasting prediction is not correct" << std::endl;
+      errorFlag++;
+    }
+    // the fallback search covers three predicted standard deviations around the prediction
+    const scalar_t max_search_dim = 10.0;
+    scalar_t prev_search_dim = model_initializer.search_dim(model_gid,1.0,max_search_dim);
+    for(int_t frame=0;frame<3;++frame){
+      model_initializer.prediction(model_gid,motion,std_dev);
+      const scalar_t search_dim = model_initializer.search_dim(model_gid,1.0,max_search_dim);
+      const scalar_t three_std_dev = std::ceil(3.0*std::max(std_dev[0],std_dev[1]));
+      const scalar_t expected_dim = std::min(max_search_dim,std::max((scalar_t)1.0,three_std_dev));
+      *outStream << "motion model search dim " << search_dim << " (std dev " << std_dev[0] << ")" << std::endl;
+      if(search_dim!=expected_dim||search_dim<prev_search_dim||search_dim>=max_search_dim){
+        *outStream << "Error, the motion model search dim is not three standard deviations of the prediction" << std::endl;
+        errorFlag++;
+      }
+      prev_search_dim = search_dim;
+      model_initializer.pre_execution_tasks();
+    }
+    // coasting too long discards the prediction and the full window is searched
+    if(model_initializer.prediction(model_gid,motion,std_dev)||model_initializer.search_dim(model_gid,1.0,max_search_dim)!=max_search_dim){
+      *outStream << "Error, the motion model search dim should be the full window without a prediction" << std::endl;
+      errorFlag++;
+    }
+  }
+  *outStream << "motion model initializer has been checked" << std::endl;
+
+  *outStream << "testing the pyramidal optical flow tracking" << std::endl;
+  {
+    // a smooth pattern shifted by more than a single level of optical flow can recover
+    const int_t img_dim = 200;
+    const scalar_t shift_u = 6.0, shift_v = -4.0;
+    Teuchos::ArrayRCP<intensity_t> prev_intensities;
+    Teuchos::ArrayRCP<intensity_t> def_intensities;
+    create_shifted_images(img_dim,smooth_pattern,img_dim,shift_u,shift_v,shift_u,shift_v,prev_intensities,def_intensities);
+    Teuchos::RCP<Image> prev_img = Teuchos::rcp(new Image(img_dim,img_dim,prev_intensities));
+    Teuchos::RCP<Image> def_img = Teuchos::rcp(new Image(img_dim,img_dim,def_intensities));
+    prev_img->create_pyramid(3);
+    def_img->create_pyramid(3);
+    std::vector<scalar_t> flow_x(3,0.0);
+    std::vector<scalar_t> flow_y(3,0.0);
+    flow_x[0] = 60.0; flow_y[0] = 70.0;
+    flow_x[1] = 100.0; flow_y[1] = 100.0;
+    flow_x[2] = 140.0; flow_y[2] = 120.0;
+    std::vector<scalar_t> flow_update_x;
+    std::vector<scalar_t> flow_update_y;
+    Optical_Flow_Initializer::track_points(prev_img,def_img,flow_x,flow_y,flow_update_x,flow_update_y);
+    for(size_t i=0;i<flow_x.size();++i){
+      *outStream << "point " << i << " optical flow u: " << flow_update_x[i] << " v: " << flow_update_y[i] << std::endl;
+      if(std::abs(flow_update_x[i]-shift_u) > 0.25 || std::abs(flow_update_y[i]-shift_v) > 0.25){
+        *outStream << "Error, the pyramidal optical flow displacement is not correct, should be " << shift_u << "," << shift_v << std::endl;
+        errorFlag++;
+      }
+    }
+  }
+  *outStream << "pyramidal optical flow tracking has been checked" << std::endl;
+
+  *outStream << "testing the coarse-to-fine pyramid initializer" << std::endl;
+  {
+    // the shift is well outside the reach of the optimizer from a zero guess, but only a few pixels on the coarsest level
+    const int_t img_dim = 200;
+    const scalar_t shift_u = 10.0, shift_v = -8.0;
+    Teuchos::ArrayRCP<intensity_t> ref_intensities;
+    Teuchos::ArrayRCP<intensity_t> def_intensities;
+    create_shifted_images(img_dim,smooth_pattern,img_dim,shift_u,shift_v,shift_u,shift_v,ref_intensities,def_intensities);
+    const int_t pyr_cx = 100, pyr_cy = 100, pyr_subset_size = 41;
+    Teuchos::ArrayRCP<scalar_t> pyr_coords_x(1,pyr_cx);
+    Teuchos::ArrayRCP<scalar_t> pyr_coords_y(1,pyr_cy);
+    Teuchos::RCP<Teuchos::ParameterList> pyr_params = Teuchos::rcp(new Teuchos::ParameterList());
+    pyr_params->set(DICe::num_image_pyramid_levels,3);
+    Teuchos::RCP<DICe::Schema> pyr_schema = Teuchos::rcp(new DICe::Schema(pyr_coords_x,pyr_coords_y,pyr_subset_size,Teuchos::null,Teuchos::null,pyr_params));
+    pyr_schema->set_ref_image(img_dim,img_dim,ref_intensities);
+    pyr_schema->set_def_image(img_dim,img_dim,def_intensities);
+    if(pyr_schema->ref_img()->num_pyramid_levels()!=3||pyr_schema->def_img()->num_pyramid_levels()!=3){
+      *outStream << "Error, the schema images should have 3 pyramid levels" << std::endl;
+      errorFlag++;
+    }
+    Teuchos::RCP<Subset> pyr_subset = Teuchos::rcp(new Subset(pyr_cx,pyr_cy,pyr_subset_size,pyr_subset_size));
+    Pyramid_Initializer pyr_initializer(pyr_schema.getRawPtr(),pyr_subset);
+    Teuchos::RCP<Local_Shape_Function> pyr_sf = shape_function_factory(pyr_schema.getRawPtr());
+    // a zero guess is moved to the shift
+    pyr_sf->clear();
+    pyr_initializer.initial_guess(pyr_schema->subset_global_id(0),pyr_sf);
+    scalar_t out_u = 0.0, out_v = 0.0, out_t = 0.0;
+    pyr_sf->map_to_u_v_theta(pyr_cx,pyr_cy,out_u,out_v,out_t);
+    *outStream << "pyramid initializer from a zero guess u: " << out_u << " v: " << out_v << std::endl;
+    if(std::abs(out_u-shift_u) > 0.25 || std::abs(out_v-shift_v) > 0.25){
+      *outStream << "Error, the pyramid initializer did not recover the shift " << shift_u << "," << shift_v << std::endl;
+      errorFlag++;
+    }
+    // a guess that is already correct is left alone
+    pyr_sf->clear();
+    pyr_sf->insert_motion(shift_u,shift_v,0.0);
+    pyr_initializer.initial_guess(pyr_schema->subset_global_id(0),pyr_sf);
+    pyr_sf->map_to_u_v_theta(pyr_cx,pyr_cy,out_u,out_v,out_t);
+    *outStream << "pyramid initializer from the exact guess u: " << out_u << " v: " << out_v << std::endl;
+    if(std::abs(out_u-shift_u) > errorTol || std::abs(out_v-shift_v) > errorTol){
+      *outStream << "Error, the pyramid initializer should not change a correct guess" << std::endl;
+      errorFlag++;
+    }
+  }
+  *outStream << "pyramid initializer has been checked" << std::endl;
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -126,6 +126,44 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   }
 
+  *outStream << "testing the fused bicubic interpolant" << std::endl;
+  Teuchos::RCP<Teuchos::ParameterList> grad_params = Teuchos::rcp(new Teuchos::ParameterList());
+  grad_params->set(DICe::compute_image_gradients,true);
+  Teuchos::RCP<Image> grad_img = Teuchos::rcp(new Image(intensities,array_w,array_h,grad_params));
+  grad_img->create_interleaved_channels();
+  if(!grad_img->has_interleaved_channels()){
+    *outStream << "Error, the interleaved channels should have been created" << std::endl;
+    errorFlag++;
+  }
+  scalar_t error_fused = 0.0;
+  intensity_t fused_intens = 0.0;
+  scalar_t fused_gx = 0.0, fused_gy = 0.0;
+  // sample the interior as well as the bilinear fall back near the edges
+  for(scalar_t y=0.25;y<array_h;y+=1.37){
+    for(scalar_t x=0.25;x<array_w;x+=1.51){
+      grad_img->interpolate_bicubic_fused(fused_intens,fused_gx,fused_gy,x,y);
+      const scalar_t intens = grad_img->interpolate_bicubic(x,y);
+      const scalar_t gx = grad_img->interpolate_grad_x_bicubic(x,y);
+      const scalar_t gy = grad_img->interpolate_grad_y_bicubic(x,y);
+      const scalar_t diff_intens = std::abs(fused_intens - intens)/(1.0 + std::abs(intens));
+      const scalar_t diff_gx = std::abs(fused_gx - gx)/(1.0 + std::abs(gx));
+      const scalar_t diff_gy = std::abs(fused_gy - gy)/(1.0 + std::abs(gy));
+      if(diff_intens > error_fused) error_fused = diff_intens;
+      if(diff_gx > error_fused) error_fused = diff_gx;
+      if(diff_gy > error_fused) error_fused = diff_gy;
+    }
+  }
+  *outStream << "fused bicubic interp max relative difference: " << error_fused << std::endl;
+  if(error_fused > 1.0E-4){ // loose tolerance in case float is used vs. double
+    *outStream << "Error, the fused bicubic interpolant does not match the single channel interpolants" << std::endl;
+    errorFlag++;
+  }
+  grad_img->gauss_filter();
+  if(grad_img->has_interleaved_channels()){
+    *outStream << "Error, the interleaved channels should be cleared when the intensities change" << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -290,6 +290,32 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   }
 
+  *outStream << "testing the batched trial gamma evaluation" << std::endl;
+  std::vector<Teuchos::RCP<Local_Shape_Function> > trial_shape_funcs;
+  trial_shape_funcs.push_back(quad_shape_func);
+  for(int_t i=0;i<3;++i){
+    Teuchos::RCP<Local_Shape_Function> trial_shape_func = Teuchos::rcp(new Quadratic_Shape_Function());
+    trial_shape_func->clone(quad_shape_func_exact);
+    (*trial_shape_func)(5) += 0.4*(i+1); // shift in x
+    (*trial_shape_func)(11) -= 0.3*i; // shift in y
+    trial_shape_funcs.push_back(trial_shape_func);
+  }
+  std::vector<scalar_t> trial_gammas;
+  obj->trial_gammas(trial_shape_funcs,trial_gammas);
+  std::vector<scalar_t> estimated_gammas;
+  obj->trial_gammas(trial_shape_funcs,estimated_gammas,4);
+  for(size_t i=0;i<trial_shape_funcs.size();++i){
+    const scalar_t trial_gamma = obj->gamma(trial_shape_funcs[i]);
+    *outStream << "trial " << i << " gamma: " << trial_gamma << " batched gamma: " << trial_gammas[i] << " estimated gamma: " << estimated_gammas[i] << std::endl;
+    if(std::abs(trial_gammas[i] - trial_gamma) > 1.0E-6){
+      *outStream << "Error, the batched gamma does not match the objective gamma" << std::endl;
+      errorFlag++;
+    }
+    if(i>0&&std::abs(estimated_gammas[i] - trial_gamma) > 0.25*trial_gamma){
+      *outStream << "Error, the subsampled gamma estimate is too far from the objective gamma" << std::endl;
+      errorFlag++;
+    }
+  }
 
   delete schema;
 
@@ -42,16 +42,22 @@
 /*! \file  DICe_TestSchema.cpp
     \brief Testing of schema class
     NOTE: correlations are not tested here as they depend on DICe::Objective
+    (the resolution error estimate runs correlations, but only its sweep and output files are checked)
 */
 
 #include <DICe_Schema.h>
 #include <DICe_Image.h>
+#include <DICe_ImageUtils.h>
 #include <DICe.h>
 
 #include <Teuchos_oblackholestream.hpp>
 #include <Teuchos_ParameterList.hpp>
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
 
 using namespace DICe;
 
@@ -161,6 +167,229 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   };
 
+  *outStream << "testing the cached field handles" << std::endl;
+  Teuchos::RCP<DICe::Schema> handle_schema = Teuchos::rcp(new DICe::Schema(200,200,40,40,21));
+  if(!handle_schema->has_field_handles()){
+    *outStream << "Error, the field handles should be cached once the mesh fields are created" << std::endl;
+    errorFlag++;
+  }
+  std::map<DICe::field_enums::Field_Spec,size_t> handle_spec_map;
+  handle_spec_map.insert(std::pair<DICe::field_enums::Field_Spec,size_t>(DICe::field_enums::SUBSET_DISPLACEMENT_X_FS,0));
+  handle_spec_map.insert(std::pair<DICe::field_enums::Field_Spec,size_t>(DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS,1));
+  handle_spec_map.insert(std::pair<DICe::field_enums::Field_Spec,size_t>(DICe::field_enums::ROTATION_Z_FS,2));
+  // 0 checks the cached handles, 1 the registry lookups after the cache has been dropped
+  for(int_t handle_case=0;handle_case<2;++handle_case){
+    if(handle_case==1){
+      handle_schema->invalidate_field_handles();
+      if(handle_schema->has_field_handles()){
+        *outStream << "Error, the field handles should have been invalidated" << std::endl;
+        errorFlag++;
+      }
+    }
+    bool handle_error = false;
+    std::map<DICe::field_enums::Field_Spec,size_t>::const_iterator it = handle_spec_map.begin();
+    for(;it!=handle_spec_map.end();++it){
+      if(handle_schema->field_values(it->first)!=handle_schema->mesh()->get_field(it->first)->local_values())
+        handle_error = true;
+    }
+    if(handle_error){
+      *outStream << "Error, the field values do not point to the mesh fields in case " << handle_case << std::endl;
+      errorFlag++;
+    }
+    // scatter a parameter vector for every subset then gather it back and save it off to the nm1 fields
+    bool gather_error = false;
+    for(int_t i=0;i<handle_schema->local_num_subsets();++i){
+      std::vector<scalar_t> values(3,0.0);
+      values[0] = i + handle_case;
+      values[1] = -2.0*i;
+      values[2] = 0.01*i;
+      handle_schema->scatter_local_field_values(i,handle_spec_map,values);
+      const int_t gid = handle_schema->subset_global_id(i);
+      if(handle_schema->global_field_value(gid,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS)!=values[0]
+          || handle_schema->global_field_value(gid,DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS)!=values[1]
+          || handle_schema->global_field_value(gid,DICe::field_enums::ROTATION_Z_FS)!=values[2])
+        gather_error = true;
+      std::vector<scalar_t> gathered(3,-1.0);
+      handle_schema->gather_local_field_values(i,handle_spec_map,gathered);
+      if(gathered!=values)
+        gather_error = true;
+      handle_schema->save_off_fields(gid);
+      if(handle_schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_X_NM1_FS)!=values[0]
+          || handle_schema->local_field_value(i,DICe::field_enums::ROTATION_Z_NM1_FS)!=values[2])
+        gather_error = true;
+    }
+    if(gather_error){
+      *outStream << "Error, the bulk field accessors are not consistent with the mesh fields in case " << handle_case << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "testing the deformed image preprocessing limited to the region of interest" << std::endl;
+  // two subsets far apart in a wide image, the pixels between them are inside the extents but outside the region of interest
+  const std::string roiString = "./images/ImageA.tif";
+  const int_t roi_subset_size = 21;
+  const int_t roi_y = 294;
+  const int_t roi_x[] = {300,1700};
+  const int_t gap_x = 1000;
+  Teuchos::RCP<Teuchos::ParameterList> fullParams = rcp(new Teuchos::ParameterList());
+  fullParams->set(DICe::gauss_filter_images,true);
+  fullParams->set(DICe::compute_image_gradients,true);
+  fullParams->set(DICe::gradient_method,DICe::CONVOLUTION_5_POINT);
+  Image full_img(roiString.c_str(),fullParams);
+  Image raw_img(roiString.c_str());
+  // case 0 uses the region of interest, the incremental formulation (1) and the image pyramid (2) need the whole image
+  for(int_t roi_case=0;roi_case<3;++roi_case){
+    Teuchos::RCP<Teuchos::ParameterList> roiParams = rcp(new Teuchos::ParameterList());
+    roiParams->set(DICe::gauss_filter_images,true);
+    roiParams->set(DICe::compute_def_gradients,true);
+    roiParams->set(DICe::gradient_method,DICe::CONVOLUTION_5_POINT);
+    if(roi_case==1)
+      roiParams->set(DICe::use_incremental_formulation,true);
+    if(roi_case==2)
+      roiParams->set(DICe::num_image_pyramid_levels,2);
+    Teuchos::ArrayRCP<scalar_t> roi_coords_x(2,0.0);
+    Teuchos::ArrayRCP<scalar_t> roi_coords_y(2,0.0);
+    for(int_t i=0;i<2;++i){
+      roi_coords_x[i] = roi_x[i];
+      roi_coords_y[i] = roi_y;
+    }
+    Teuchos::RCP<DICe::Schema> roi_schema = Teuchos::rcp(new DICe::Schema(roi_coords_x,roi_coords_y,roi_subset_size,Teuchos::null,Teuchos::null,roiParams));
+    roi_schema->update_extents();
+    roi_schema->set_ref_image(roiString);
+    roi_schema->set_def_image(roiString);
+    Teuchos::RCP<Image> roi_def = roi_schema->def_img();
+    const int_t ox = roi_def->offset_x();
+    const int_t oy = roi_def->offset_y();
+    *outStream << "case " << roi_case << " deformed image offset " << ox << " " << oy << " size " << roi_def->width() << " x " << roi_def->height() << std::endl;
+    if(ox<=0||gap_x-ox>=roi_def->width()){
+      *outStream << "Error, the deformed image should be read using the extents" << std::endl;
+      errorFlag++;
+      continue;
+    }
+    // the pixels of the subsets must match the whole image preprocessing in every case
+    bool roi_error = false;
+    for(int_t s=0;s<2;++s){
+      for(int_t y=roi_y-roi_subset_size/2;y<=roi_y+roi_subset_size/2;++y){
+        for(int_t x=roi_x[s]-roi_subset_size/2;x<=roi_x[s]+roi_subset_size/2;++x){
+          if(std::abs((*roi_def)(x-ox,y-oy) - full_img(x,y)) > 1.0E-4
+              || std::abs(roi_def->grad_x(x-ox,y-oy) - full_img.grad_x(x,y)) > 1.0E-4
+              || std::abs(roi_def->grad_y(x-ox,y-oy) - full_img.grad_y(x,y)) > 1.0E-4)
+            roi_error = true;
+        }
+      }
+    }
+    if(roi_error){
+      *outStream << "Error, the deformed image does not match the whole image preprocessing at the subsets" << std::endl;
+      errorFlag++;
+    }
+    // between the subsets the pixels are only filtered when the whole image is preprocessed
+    const scalar_t gap_value = (*roi_def)(gap_x-ox,roi_y-oy);
+    const scalar_t expected_gap_value = roi_case==0 ? raw_img(gap_x,roi_y) : full_img(gap_x,roi_y);
+    *outStream << "case " << roi_case << " value between the subsets " << gap_value << " expected " << expected_gap_value << std::endl;
+    if(std::abs(gap_value - expected_gap_value) > 1.0E-4){
+      *outStream << "Error, the pixels outside the region of interest were not preprocessed as expected" << std::endl;
+      errorFlag++;
+    }
+  }
+
+#if DICE_KOKKOS
+#else
+  *outStream << "testing the resolution error estimate" << std::endl;
+  const std::string res_ref_string = "./images/refSpeckled.tif";
+  Teuchos::RCP<Teuchos::ParameterList> res_params = rcp(new Teuchos::ParameterList());
+  res_params->set(DICe::optimization_method,DICe::GRADIENT_BASED);
+  res_params->set(DICe::initialization_method,DICe::USE_FIELD_VALUES);
+  res_params->set(DICe::enable_rotation,false);
+  res_params->set(DICe::enable_normal_strain,false);
+  res_params->set(DICe::enable_shear_strain,false);
+  Teuchos::RCP<DICe::Schema> res_schema = Teuchos::rcp(new DICe::Schema(512,512,40,40,31,res_params));
+  res_schema->update_extents();
+  res_schema->set_ref_image(res_ref_string);
+  res_schema->set_def_image(res_ref_string);
+  const scalar_t res_min_period = 100.0;
+  const scalar_t res_max_period = 200.0;
+  const scalar_t res_period_factor = 0.5;
+  const scalar_t res_min_amp = 0.5;
+  const scalar_t res_max_amp = 1.0;
+  const scalar_t res_amp_step = 0.5;
+  Teuchos::RCP<Teuchos::ParameterList> res_corr_params = rcp(new Teuchos::ParameterList());
+  res_corr_params->set(DICe::estimate_resolution_error_min_period,res_min_period);
+  res_corr_params->set(DICe::estimate_resolution_error_max_period,res_max_period);
+  res_corr_params->set(DICe::estimate_resolution_error_period_factor,res_period_factor);
+  res_corr_params->set(DICe::estimate_resolution_error_min_amplitude,res_min_amp);
+  res_corr_params->set(DICe::estimate_resolution_error_max_amplitude,res_max_amp);
+  res_corr_params->set(DICe::estimate_resolution_error_amplitude_step,res_amp_step);
+  std::string res_output_folder = "./";
+  std::string res_folder = "./";
+  std::string res_prefix = "DICe_error_estimation_solution";
+  // the results are appended to an existing file so start from a clean one
+  const std::string res_data_name = "./synthetic_results/spatial_resolution.txt";
+  std::remove(res_data_name.c_str());
+  res_schema->estimate_resolution_error(res_corr_params,res_output_folder,res_folder,res_prefix,outStream);
+  // one line per period and amplitude in the order of the sweep (periods from large to small)
+  std::vector<scalar_t> expected_periods;
+  std::vector<scalar_t> expected_amps;
+  for(scalar_t period=res_max_period;period>=res_min_period;period*=res_period_factor){
+    for(scalar_t amplitude=res_min_amp;amplitude<=res_max_amp;amplitude+=res_amp_step){
+      expected_periods.push_back(period);
+      expected_amps.push_back(amplitude);
+    }
+  }
+  std::ifstream res_file(res_data_name.c_str());
+  if(!res_file.good()){
+    *outStream << "Error, the spatial resolution file was not written" << std::endl;
+    errorFlag++;
+  }
+  else{
+    std::string res_line;
+    std::getline(res_file,res_line); // header
+    size_t res_row = 0;
+    while(std::getline(res_file,res_line)){
+      if(res_line.empty()) continue;
+      std::stringstream res_ss(res_line);
+      std::vector<scalar_t> res_values;
+      scalar_t res_value = 0.0;
+      while(res_ss >> res_value)
+        res_values.push_back(res_value);
+      *outStream << "resolution row " << res_row << ": " << res_line << std::endl;
+      // columns 6 and 7 are the period and amplitude, 10 is the average relative u error
+      if(res_values.size()<20||res_row>=expected_periods.size()){
+        *outStream << "Error, unexpected spatial resolution row" << std::endl;
+        errorFlag++;
+      }
+      else if(std::abs(res_values[6]-expected_periods[res_row])>1.0E-3||std::abs(res_values[7]-expected_amps[res_row])>1.0E-3
+          ||!(res_values[10]>=0.0)){
+        *outStream << "Error, the spatial resolution row does not match the sweep, expected period " << expected_periods[res_row]
+          << " amplitude " << expected_amps[res_row] << std::endl;
+        errorFlag++;
+      }
+      res_row++;
+    }
+    if(res_row!=expected_periods.size()){
+      *outStream << "Error, the spatial resolution file has " << res_row << " rows, expected " << expected_periods.size() << std::endl;
+      errorFlag++;
+    }
+  }
+  // the written synthetic image is the sin cos deformation of the reference image
+  SinCos_Image_Deformer res_deformer(res_max_period,res_min_amp);
+  Teuchos::RCP<Image> res_exact = res_deformer.deform_image(res_schema->ref_img());
+  Image res_written("./synthetic_images/amp_0p5_period_200_proc_0.tif");
+  scalar_t max_res_diff = 0.0;
+  if(res_written.width()!=res_exact->width()||res_written.height()!=res_exact->height())
+    max_res_diff = 255.0;
+  else{
+    for(int_t i=0;i<res_exact->num_pixels();++i){
+      const scalar_t diff = std::abs(res_written(i) - (*res_exact)(i));
+      if(diff > max_res_diff) max_res_diff = diff;
+    }
+  }
+  *outStream << "max difference of the written synthetic image: " << max_res_diff << std::endl;
+  if(max_res_diff > 1.0){ // the tiff is written with integer intensities
+    *outStream << "Error, the written synthetic image does not match the deformed reference image" << std::endl;
+    errorFlag++;
+  }
+#endif
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
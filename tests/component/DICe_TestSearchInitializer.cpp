@@ -101,6 +101,18 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   }
 
+  *outStream << "repeating the search with the integer pre-search disabled in a small window" << std::endl;
+  Search_Initializer warp_searcher(schema.getRawPtr(),subset,step_size_xy,3.0,step_size_xy,3.0,step_size_theta,search_dim_theta,false);
+  shape_function->clear();
+  shape_function->insert_motion(u_exact-2.0,v_exact+1.0,0.0);
+  warp_searcher.initial_guess(-1,shape_function);
+  shape_function->map_to_u_v_theta(subset->centroid_x(),subset->centroid_y(),out_u,out_v,out_t);
+  if(std::abs(out_u - u_exact) > errorTol || std::abs(out_v - v_exact) > errorTol){
+    *outStream << "Error, the initialized value without the pre-search is not correct" << std::endl;
+    *outStream << "       should be 138,-138 and is " << out_u << "," << out_v << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
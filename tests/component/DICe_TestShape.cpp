@@ -168,6 +168,74 @@ int main(int argc, char *argv[]) {
   DICe::Image small_skin_image(imgW,imgW,small_skin_intensities);
   small_skin_image.write("shape_small_skin.tif");
 
+  *outStream << "testing the scanline spans against the per-pixel tests" << std::endl;
+  // a concave polygon with a vertex in the middle of the rows
+  std::vector<int_t> concave_x(6);
+  std::vector<int_t> concave_y(6);
+  concave_x[0] = 30; concave_y[0] = 20;
+  concave_x[1] = 90; concave_y[1] = 35;
+  concave_x[2] = 60; concave_y[2] = 52;
+  concave_x[3] = 95; concave_y[3] = 80;
+  concave_x[4] = 25; concave_y[4] = 71;
+  concave_x[5] = 47; concave_y[5] = 50;
+  std::vector<Teuchos::RCP<DICe::Shape> > test_shapes;
+  test_shapes.push_back(poly1);
+  test_shapes.push_back(Teuchos::rcp(new DICe::Polygon(concave_x,concave_y)));
+  test_shapes.push_back(Teuchos::rcp(new DICe::Circle(60,60,23.5)));
+  test_shapes.push_back(Teuchos::rcp(new DICe::Rectangle(70,40,31,18)));
+  const int_t num_test_pixels = imgW*imgW;
+  std::vector<int_t> test_x(num_test_pixels);
+  std::vector<int_t> test_y(num_test_pixels);
+  for(int_t y=0;y<imgW;++y){
+    for(int_t x=0;x<imgW;++x){
+      test_x[y*imgW+x] = x;
+      test_y[y*imgW+x] = y;
+    }
+  }
+  std::vector<pixel_spans> test_spans(test_shapes.size());
+  for(size_t i=0;i<test_shapes.size();++i){
+    test_spans[i] = test_shapes[i]->get_owned_spans();
+    Teuchos::ArrayRCP<bool> flags(num_test_pixels,true);
+    test_shapes[i]->deactivate_pixels(num_test_pixels,flags.getRawPtr(),&test_x[0],&test_y[0]);
+    int_t num_mismatch = 0;
+    int_t num_inside = 0;
+    for(int_t j=0;j<num_test_pixels;++j){
+      if(!flags[j]) num_inside++;
+      if(spans_contain(test_spans[i],test_x[j],test_y[j])==flags[j]) num_mismatch++;
+    }
+    *outStream << "shape " << i << " has " << num_span_pixels(test_spans[i]) << " pixels in " << test_spans[i].size() << " spans" << std::endl;
+    if(num_mismatch!=0||num_inside!=num_span_pixels(test_spans[i])){
+      *outStream << "Error, the spans for shape " << i << " do not match the per-pixel test, mismatches: " << num_mismatch << std::endl;
+      errorFlag++;
+    }
+  }
+  *outStream << "testing the union and difference of spans" << std::endl;
+  const pixel_spans merged_spans = union_spans(test_spans[1],test_spans[3]);
+  const pixel_spans cut_spans = subtract_spans(test_spans[1],test_spans[2]);
+  int_t num_merged = 0;
+  int_t num_cut = 0;
+  for(int_t j=0;j<num_test_pixels;++j){
+    const bool in_concave = spans_contain(test_spans[1],test_x[j],test_y[j]);
+    const bool in_circle = spans_contain(test_spans[2],test_x[j],test_y[j]);
+    const bool in_rect = spans_contain(test_spans[3],test_x[j],test_y[j]);
+    if(in_concave||in_rect) num_merged++;
+    if(in_concave&&!in_circle) num_cut++;
+    if(spans_contain(merged_spans,test_x[j],test_y[j])!=(in_concave||in_rect)||
+        spans_contain(cut_spans,test_x[j],test_y[j])!=(in_concave&&!in_circle)){
+      *outStream << "Error, the span union or difference is wrong at " << test_x[j] << " " << test_y[j] << std::endl;
+      errorFlag++;
+      break;
+    }
+  }
+  if(num_merged!=num_span_pixels(merged_spans)||num_cut!=num_span_pixels(cut_spans)){
+    *outStream << "Error, the span union or difference has the wrong number of pixels" << std::endl;
+    errorFlag++;
+  }
+  if(spans_to_set(merged_spans).size()!=(size_t)num_merged){
+    *outStream << "Error, the set from the spans has the wrong size" << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
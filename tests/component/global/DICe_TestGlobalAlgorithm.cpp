@@ -41,6 +41,9 @@
 
 #include <DICe.h>
 #include <DICe_Global.h>
+#include <DICe_GlobalUtils.h>
+#include <DICe_Image.h>
+#include <DICe_Schema.h>
 #include <DICe_Parser.h>
 #include <DICe_ParameterUtilities.h>
 
@@ -49,6 +52,10 @@
 #include <Teuchos_ParameterList.hpp>
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
 
 using namespace DICe;
 
@@ -83,30 +90,55 @@ int main(int argc, char *argv[]) {
   std::vector<std::string> out_file_name;
   std::vector<Global_Formulation> formulation;
   std::vector<scalar_t> alpha;
+  std::vector<bool> matrix_free;
+  std::vector<std::string> preconditioner;
 
   // HORN SCHNUNCK
   formulation.push_back(HORN_SCHUNCK);
   out_file_name.push_back("test_global_alg_hs");
   alpha.push_back(1.0);
+  matrix_free.push_back(false);
+  preconditioner.push_back("ILU");
   // MIXED HORN SCHUNCK
   formulation.push_back(MIXED_HORN_SCHUNCK);
   out_file_name.push_back("test_global_alg_hs_mixed");
   alpha.push_back(1.0);
+  matrix_free.push_back(false);
+  preconditioner.push_back("ILU");
   // LEHOUCQ TURNER
   formulation.push_back(LEHOUCQ_TURNER);
   out_file_name.push_back("test_global_alg_lt_mixed");
   alpha.push_back(1.0);
+  matrix_free.push_back(false);
+  preconditioner.push_back("ILU");
   // LEVENBERG_MARQUARDT
   formulation.push_back(LEVENBERG_MARQUARDT);
   out_file_name.push_back("test_global_alg_lm");
   alpha.push_back(1.0);
+  matrix_free.push_back(false);
+  preconditioner.push_back("ILU");
   // UNREGULARIZED
   formulation.push_back(UNREGULARIZED);
   out_file_name.push_back("test_global_alg_unreg");
   alpha.push_back(1.0);
+  matrix_free.push_back(false);
+  preconditioner.push_back("ILU");
+  // HORN SCHNUNCK matrix free with jacobi preconditioner
+  formulation.push_back(HORN_SCHUNCK);
+  out_file_name.push_back("test_global_alg_hs_mf");
+  alpha.push_back(1.0);
+  matrix_free.push_back(true);
+  preconditioner.push_back("JACOBI");
+  // LEVENBERG_MARQUARDT matrix free with chebyshev preconditioner
+  formulation.push_back(LEVENBERG_MARQUARDT);
+  out_file_name.push_back("test_global_alg_lm_mf");
+  alpha.push_back(1.0);
+  matrix_free.push_back(true);
+  preconditioner.push_back("CHEBYSHEV");
 
   const scalar_t error_max = 0.1;
-  TEUCHOS_TEST_FOR_EXCEPTION(formulation.size()!=out_file_name.size()||formulation.size()!=alpha.size(),
+  TEUCHOS_TEST_FOR_EXCEPTION(formulation.size()!=out_file_name.size()||formulation.size()!=alpha.size()
+    ||formulation.size()!=matrix_free.size()||formulation.size()!=preconditioner.size(),
     std::runtime_error,"Error missing a parameter");
   std::vector<scalar_t> error_x(formulation.size(),-1.0);
   std::vector<scalar_t> error_y(formulation.size(),-1.0);
@@ -120,7 +152,7 @@ int main(int argc, char *argv[]) {
     scalar_t max_error_bx = 0.0;
     scalar_t max_error_by = 0.0;
     scalar_t max_error_lambda = 0.0;
-    *outStream << " TESTING " << to_string(formulation[i]) << " FORMULATION " << std::endl;
+    *outStream << " TESTING " << to_string(formulation[i]) << " FORMULATION " << (matrix_free[i] ? "(MATRIX FREE) " : "") << std::endl;
     global_params->set(DICe::global_regularization_alpha,alpha[i]);
     global_params->set(DICe::global_stabilization_tau,0.0);
     global_params->set(DICe::global_formulation,formulation[i]);
@@ -128,6 +160,8 @@ int main(int argc, char *argv[]) {
     global_params->set(DICe::parser_use_regular_grid,true);
     global_params->set(DICe::parser_enforce_lagrange_bc,true);
     global_params->set(DICe::num_image_integration_points,75);
+    global_params->set(DICe::global_use_matrix_free,(bool)matrix_free[i]);
+    global_params->set(DICe::global_preconditioner,preconditioner[i]);
     //if(formulation[i]==UNREGULARIZED)
     //  global_params->set(DICe::mesh_size,10000.0);
     //else
@@ -152,11 +186,242 @@ int main(int argc, char *argv[]) {
     }
   } // end formulation loop
 
+  *outStream << "checking that coarse-to-fine mesh levels are rejected for an mms problem" << std::endl;
+  global_params->set(DICe::global_num_mesh_levels,2);
+  bool levels_exception_thrown = false;
+  try{
+    Teuchos::RCP<DICe::global::Global_Algorithm> multilevel_alg = Teuchos::rcp(new DICe::global::Global_Algorithm(global_params));
+  }
+  catch(std::exception & e){
+    levels_exception_thrown = true;
+  }
+  if(!levels_exception_thrown){
+    *outStream << "error, global_num_mesh_levels > 1 should not be allowed for an mms problem" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "comparing a coarse-to-fine mesh continuation solve with a single level solve" << std::endl;
+  {
+    // synthetic image pair with a known rigid shift, the initial guess is zero so each
+    // solve has to find the shift (through the coarse mesh for the multilevel solve)
+    const int_t w = 500;
+    const int_t h = 500;
+    const scalar_t shift_x = 0.6;
+    const scalar_t shift_y = -0.4;
+    Teuchos::RCP<Teuchos::ParameterList> shift_mms_params = Teuchos::rcp(new Teuchos::ParameterList());
+    shift_mms_params->set(DICe::problem_name,"div_curl_modulator");
+    shift_mms_params->set(DICe::phi_coeff,40.0);
+    shift_mms_params->set(DICe::b_coeff,2.0);
+    MMS_Problem_Factory mms_factory;
+    Teuchos::RCP<MMS_Problem> prob = mms_factory.create(shift_mms_params);
+    Teuchos::ArrayRCP<intensity_t> ref_intens(w*h,0.0);
+    Teuchos::ArrayRCP<intensity_t> def_intens(w*h,0.0);
+    for(int_t y=0;y<h;++y){
+      for(int_t x=0;x<w;++x){
+        scalar_t phi_0 = 0.0,phi = 0.0;
+        prob->phi(x,y,phi_0);
+        prob->phi(x-shift_x,y-shift_y,phi);
+        ref_intens[y*w+x] = 0.5 + phi_0*0.5;
+        def_intens[y*w+x] = 0.5 + phi*0.5;
+      }
+    }
+    Teuchos::RCP<Image> ref = Teuchos::rcp(new Image(w,h,ref_intens));
+    Teuchos::RCP<Image> def = Teuchos::rcp(new Image(w,h,def_intens));
+    const std::string ref_name = "ref_global_mesh_levels.tif";
+    ref->write(ref_name);
+    const std::string roi_file_name = "global_mesh_levels_roi.txt";
+    std::ofstream roi_file;
+    roi_file.open(roi_file_name.c_str());
+    roi_file << "begin region_of_interest\n";
+    roi_file << "  begin boundary\n";
+    roi_file << "    begin polygon\n";
+    roi_file << "      begin vertices\n";
+    roi_file << "        20 20\n";
+    roi_file << "        480 20\n";
+    roi_file << "        480 480\n";
+    roi_file << "        20 480\n";
+    roi_file << "      end vertices\n";
+    roi_file << "    end polygon\n";
+    roi_file << "  end boundary\n";
+    roi_file << "  use_regular_grid\n";
+    roi_file << "  dirichlet_bc boundary 0 0 1 " << shift_x << " " << shift_y << "\n";
+    roi_file << "  dirichlet_bc boundary 0 1 2 " << shift_x << " " << shift_y << "\n";
+    roi_file << "  dirichlet_bc boundary 0 2 3 " << shift_x << " " << shift_y << "\n";
+    roi_file << "  dirichlet_bc boundary 0 3 0 " << shift_x << " " << shift_y << "\n";
+    roi_file << "end region_of_interest\n";
+    roi_file.close();
+
+    const int_t num_levels_cases = 2;
+    std::vector<scalar_t> level_disp[num_levels_cases];
+    for(int_t levels=1;levels<=num_levels_cases;++levels){
+      Teuchos::RCP<Teuchos::ParameterList> input_params = Teuchos::rcp(new Teuchos::ParameterList());
+      Teuchos::RCP<Teuchos::ParameterList> corr_params = Teuchos::rcp(new Teuchos::ParameterList());
+      std::stringstream prefix;
+      prefix << "test_global_alg_levels_" << levels;
+      input_params->set(DICe::subset_file,roi_file_name);
+      input_params->set(DICe::output_folder,"");
+      input_params->set(DICe::output_prefix,prefix.str());
+      input_params->set(DICe::image_folder,"");
+      input_params->set(DICe::reference_image,ref_name);
+      Teuchos::ParameterList def_img_params;
+      def_img_params.set(ref_name,true);
+      input_params->set(DICe::deformed_images,def_img_params);
+      input_params->set(DICe::mesh_size,100.0);
+      corr_params->set(DICe::use_global_dic,true);
+      corr_params->set(DICe::global_solver,GMRES_SOLVER);
+      corr_params->set(DICe::max_solver_iterations_fast,200);
+      corr_params->set(DICe::global_formulation,UNREGULARIZED);
+      corr_params->set(DICe::global_element_type,"TRI6");
+      corr_params->set(DICe::num_image_integration_points,125);
+      corr_params->set(DICe::global_num_mesh_levels,levels);
+      DICe::Schema schema(input_params,corr_params);
+      schema.set_ref_image(ref);
+      schema.set_def_image(def);
+      schema.execute_correlation();
+      schema.post_execution_tasks();
+      Teuchos::RCP<MultiField> disp = schema.global_algorithm()->mesh()->get_field(field_enums::DISPLACEMENT_FS);
+      const int_t num_nodes = schema.global_algorithm()->mesh()->get_scalar_node_dist_map()->get_num_local_elements();
+      scalar_t error_bx = 0.0;
+      scalar_t error_by = 0.0;
+      for(int_t i=0;i<num_nodes;++i){
+        level_disp[levels-1].push_back(disp->local_value(i*2+0));
+        level_disp[levels-1].push_back(disp->local_value(i*2+1));
+        error_bx += (disp->local_value(i*2+0) - shift_x)*(disp->local_value(i*2+0) - shift_x);
+        error_by += (disp->local_value(i*2+1) - shift_y)*(disp->local_value(i*2+1) - shift_y);
+      }
+      error_bx = std::sqrt(error_bx/num_nodes);
+      error_by = std::sqrt(error_by/num_nodes);
+      *outStream << "mesh levels " << levels << " rms error x: " << error_bx << " rms error y: " << error_by << std::endl;
+      if(error_bx > 1.0E-3 || error_by > 1.0E-3){
+        *outStream << "error, the solution error is too large for " << levels << " mesh levels" << std::endl;
+        errorFlag++;
+      }
+    }
+    // the continuation only changes the initial guess so both solves must land on the same solution
+    scalar_t max_diff = 0.0;
+    if(level_disp[0].size()!=level_disp[1].size()){
+      *outStream << "error, the single level and multilevel meshes should be the same" << std::endl;
+      errorFlag++;
+    }
+    else{
+      for(size_t i=0;i<level_disp[0].size();++i)
+        max_diff = std::max(max_diff,std::abs(level_disp[0][i]-level_disp[1][i]));
+    }
+    *outStream << "max difference between the single level and multilevel solutions: " << max_diff << std::endl;
+    if(max_diff > 1.0E-3){
+      *outStream << "error, the multilevel solution does not match the single level solution" << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "solving a large motion frame that is outside the capture range of the target mesh" << std::endl;
+  {
+    // the shift is more than half the period of the speckle pattern so a solve from a zero initial guess on
+    // the target mesh falls into the neighboring minimum, the coarsest level of the hierarchy has only a few
+    // nodes off the (dirichlet) boundary so its solution and the prolongated initial guess for every finer
+    // level are inside the capture range
+    const int_t w = 500;
+    const int_t h = 500;
+    const scalar_t shift_x = 15.0;
+    const scalar_t shift_y = 0.0;
+    Teuchos::RCP<Teuchos::ParameterList> shift_mms_params = Teuchos::rcp(new Teuchos::ParameterList());
+    shift_mms_params->set(DICe::problem_name,"div_curl_modulator");
+    shift_mms_params->set(DICe::phi_coeff,40.0); // 25 pixel period
+    shift_mms_params->set(DICe::b_coeff,2.0);
+    MMS_Problem_Factory mms_factory;
+    Teuchos::RCP<MMS_Problem> prob = mms_factory.create(shift_mms_params);
+    Teuchos::ArrayRCP<intensity_t> ref_intens(w*h,0.0);
+    Teuchos::ArrayRCP<intensity_t> def_intens(w*h,0.0);
+    for(int_t y=0;y<h;++y){
+      for(int_t x=0;x<w;++x){
+        scalar_t phi_0 = 0.0,phi = 0.0;
+        prob->phi(x,y,phi_0);
+        prob->phi(x-shift_x,y-shift_y,phi);
+        ref_intens[y*w+x] = 0.5 + phi_0*0.5;
+        def_intens[y*w+x] = 0.5 + phi*0.5;
+      }
+    }
+    Teuchos::RCP<Image> ref = Teuchos::rcp(new Image(w,h,ref_intens));
+    Teuchos::RCP<Image> def = Teuchos::rcp(new Image(w,h,def_intens));
+    const std::string ref_name = "ref_global_large_motion.tif";
+    ref->write(ref_name);
+    const std::string roi_file_name = "global_large_motion_roi.txt";
+    std::ofstream roi_file;
+    roi_file.open(roi_file_name.c_str());
+    roi_file << "begin region_of_interest\n";
+    roi_file << "  begin boundary\n";
+    roi_file << "    begin polygon\n";
+    roi_file << "      begin vertices\n";
+    roi_file << "        20 20\n";
+    roi_file << "        480 20\n";
+    roi_file << "        480 480\n";
+    roi_file << "        20 480\n";
+    roi_file << "      end vertices\n";
+    roi_file << "    end polygon\n";
+    roi_file << "  end boundary\n";
+    roi_file << "  use_regular_grid\n";
+    roi_file << "  dirichlet_bc boundary 0 0 1 " << shift_x << " " << shift_y << "\n";
+    roi_file << "  dirichlet_bc boundary 0 1 2 " << shift_x << " " << shift_y << "\n";
+    roi_file << "  dirichlet_bc boundary 0 2 3 " << shift_x << " " << shift_y << "\n";
+    roi_file << "  dirichlet_bc boundary 0 3 0 " << shift_x << " " << shift_y << "\n";
+    roi_file << "end region_of_interest\n";
+    roi_file.close();
+
+    // the coarsest of the seven levels has an area constraint larger than the region of interest
+    const int_t num_levels_cases = 2;
+    const int_t levels[num_levels_cases] = {1,7};
+    scalar_t rms_error[num_levels_cases];
+    for(int_t level_case=0;level_case<num_levels_cases;++level_case){
+      Teuchos::RCP<Teuchos::ParameterList> input_params = Teuchos::rcp(new Teuchos::ParameterList());
+      Teuchos::RCP<Teuchos::ParameterList> corr_params = Teuchos::rcp(new Teuchos::ParameterList());
+      std::stringstream prefix;
+      prefix << "test_global_alg_large_motion_levels_" << levels[level_case];
+      input_params->set(DICe::subset_file,roi_file_name);
+      input_params->set(DICe::output_folder,"");
+      input_params->set(DICe::output_prefix,prefix.str());
+      input_params->set(DICe::image_folder,"");
+      input_params->set(DICe::reference_image,ref_name);
+      Teuchos::ParameterList def_img_params;
+      def_img_params.set(ref_name,true);
+      input_params->set(DICe::deformed_images,def_img_params);
+      input_params->set(DICe::mesh_size,100.0);
+      corr_params->set(DICe::use_global_dic,true);
+      corr_params->set(DICe::global_solver,GMRES_SOLVER);
+      corr_params->set(DICe::max_solver_iterations_fast,200);
+      corr_params->set(DICe::global_formulation,UNREGULARIZED);
+      corr_params->set(DICe::global_element_type,"TRI6");
+      corr_params->set(DICe::num_image_integration_points,125);
+      corr_params->set(DICe::global_num_mesh_levels,levels[level_case]);
+      DICe::Schema schema(input_params,corr_params);
+      schema.set_ref_image(ref);
+      schema.set_def_image(def);
+      schema.execute_correlation();
+      schema.post_execution_tasks();
+      Teuchos::RCP<MultiField> disp = schema.global_algorithm()->mesh()->get_field(field_enums::DISPLACEMENT_FS);
+      const int_t num_nodes = schema.global_algorithm()->mesh()->get_scalar_node_dist_map()->get_num_local_elements();
+      scalar_t error = 0.0;
+      for(int_t i=0;i<num_nodes;++i){
+        error += (disp->local_value(i*2+0) - shift_x)*(disp->local_value(i*2+0) - shift_x);
+        error += (disp->local_value(i*2+1) - shift_y)*(disp->local_value(i*2+1) - shift_y);
+      }
+      rms_error[level_case] = std::sqrt(error/num_nodes);
+      *outStream << "mesh levels " << levels[level_case] << " large motion rms error: " << rms_error[level_case] << std::endl;
+    }
+    if(rms_error[0] < 1.0E-2){
+      *outStream << "error, the large motion frame should be outside the capture range of the single level solve" << std::endl;
+      errorFlag++;
+    }
+    if(rms_error[1] > 1.0E-2){
+      *outStream << "error, the coarse-to-fine continuation did not converge for the large motion frame" << std::endl;
+      errorFlag++;
+    }
+  }
+
   *outStream << "-----------------------------------------------------------------------------------------------------------" << std::endl;
   *outStream << "Results Summary:" << std::endl;
   *outStream << "-----------------------------------------------------------------------------------------------------------" << std::endl;
   for(size_t i=0;i<formulation.size();++i){
-    *outStream << std::setw(25) << to_string(formulation[i]) << " error x: " << std::setw(15) << error_x[i] << " error y: "
+    *outStream << std::setw(25) << to_string(formulation[i]) << std::setw(12) << preconditioner[i] << " error x: " << std::setw(15) << error_x[i] << " error y: "
         << std::setw(15) << error_y [i] << " error l: " << std::setw(15) << error_l[i] << " max error x: " << max_error_x[i] << std::endl;
   }
   *outStream << "-----------------------------------------------------------------------------------------------------------" << std::endl;
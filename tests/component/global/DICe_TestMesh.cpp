@@ -126,6 +126,36 @@ int main(int argc, char *argv[]) {
   }
   *outStream << "coordinate fields have been checked" << std::endl;
 
+  *outStream << "checking the flat mesh topology" << std::endl;
+  Teuchos::RCP<const DICe::mesh::Mesh_Topology> topology = mesh->get_topology();
+  if(topology->num_elem()!=(int_t)mesh->num_elem()||topology->num_nodes()!=(int_t)mesh->num_nodes()){
+    *outStream << "Error, the topology sizes do not match the mesh" << std::endl;
+    errorFlag++;
+  }
+  DICe::mesh::element_set::iterator elem_it = mesh->get_element_set()->begin();
+  DICe::mesh::element_set::iterator elem_end = mesh->get_element_set()->end();
+  int_t topo_elem = 0;
+  bool topology_error = false;
+  for(;elem_it!=elem_end;++elem_it,++topo_elem){
+    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    if(topology->num_elem_nodes(topo_elem)!=(int_t)connectivity.size()||
+        topology->elem_global_id(topo_elem)!=elem_it->get()->global_id()){
+      topology_error = true;
+      continue;
+    }
+    const int_t * elem_nodes = topology->elem_nodes(topo_elem);
+    for(size_t i=0;i<connectivity.size();++i){
+      if(elem_nodes[i]!=connectivity[i]->overlap_local_id()||
+          topology->node_overlap_id(connectivity[i]->global_id())!=elem_nodes[i])
+        topology_error = true;
+    }
+  }
+  if(topology_error){
+    *outStream << "Error, the topology connectivity does not match the element set" << std::endl;
+    errorFlag++;
+  }
+  *outStream << "mesh topology has been checked" << std::endl;
+
   *outStream << "checking the boundary conditions on the input mesh" << std::endl;
   DICe::mesh::side_set_info & ss_info = *mesh->get_side_set_info();
   int_t num_side_sets = ss_info.ids.size();
@@ -105,6 +105,38 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  *outStream << "testing the feature matcher cache and region of interest" << std::endl;
+  // the LSH index is approximate and randomized, brute force matching gives the same matches every call
+  Feature_Matcher matcher(-1,-1);
+  matcher.match(left_img,right_img,left_x,left_y,right_x,right_y,tol);
+  const int_t num_first_matches = left_x.size();
+  matcher.match(left_img,right_img,left_x,left_y,right_x,right_y,tol);
+  if(matcher.num_cached_images()!=2||(int_t)left_x.size()!=num_first_matches){
+    errorFlag++;
+    *outStream << "Error, the cached features should give the same matches (" << num_first_matches << " first, " << left_x.size() << " cached)" << std::endl;
+  }
+  // only detect features in the upper left corner of the left image (and the area it moves to in the right image)
+  const int_t roi_max_x = left_img->width()/2 + 160;
+  const int_t roi_max_y = left_img->height()/2 + 140;
+  matcher.set_roi(0,0,roi_max_x,roi_max_y);
+  if(matcher.num_cached_images()!=0){
+    errorFlag++;
+    *outStream << "Error, changing the region of interest should clear the cache" << std::endl;
+  }
+  matcher.match(left_img,right_img,left_x,left_y,right_x,right_y,tol);
+  *outStream << "number of features matched in the region of interest: " << left_x.size() << std::endl;
+  if(left_x.size()==0||(int_t)left_x.size()>=num_first_matches){
+    errorFlag++;
+    *outStream << "Error, the region of interest should reduce the number of matches" << std::endl;
+  }
+  for(size_t i=0;i<left_x.size();++i){
+    if(left_x[i]>roi_max_x+1||left_y[i]>roi_max_y+1||right_x[i]>roi_max_x+1||right_y[i]>roi_max_y+1){
+      errorFlag++;
+      *outStream << "Error, feature (" << left_x[i] << "," << left_y[i] << ") is outside the region of interest" << std::endl;
+      break;
+    }
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();